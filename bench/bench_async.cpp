@@ -0,0 +1,115 @@
+// AsyncResolver: 请求线程中 "打印一个栈" 的开销 —— 就地 print() 与交给后台线程解析
+// - 栈预先抓好 (16 条不同的调用路径, 约 20 帧), 只测量之后的部分; 抓栈本身两种方式相同
+// - 模拟一次突发: 每个线程连续打印 1000 个栈, 队列容量足以容纳整个突发
+// - 就地 print(): ModuleManager 不是线程安全的, 多线程时由一把锁串行化 (日志库的常见做法)
+// - 异步: submit() 之后立即返回, 回调在后台线程中格式化 (to_string) 并写入 sink; Block 策略, 不丢栈
+// - 输出请求线程中每次调用的平均值与 p99, 以及全部解析完成 (flush) 的总耗时
+
+#include "sst_async.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+using namespace stacktrace;
+using Clock = std::chrono::steady_clock;
+
+static const int kPerThread = 1000;
+static const int kPaths = 16;
+
+static double seconds_since(Clock::time_point begin) {
+    return std::chrono::duration<double>(Clock::now() - begin).count();
+}
+
+__attribute__((noinline)) static Stacktrace deep_capture(int depth) {
+    Stacktrace st = depth > 0 ? deep_capture(depth - 1) : Stacktrace::capture();
+    asm volatile("" ::: "memory"); // 防止尾调用, 保留每一层的帧
+    return st;
+}
+
+struct Latency {
+    double mean_ns;
+    double p99_ns;
+};
+
+static Latency summarize(std::vector<double>& ns) {
+    std::sort(ns.begin(), ns.end());
+    double sum = 0;
+    for (double v : ns) sum += v;
+    return Latency{sum / static_cast<double>(ns.size()), ns[ns.size() * 99 / 100]};
+}
+
+// 每个线程调用 log(t, i) kPerThread 次, 返回所有调用的耗时
+template <typename Log>
+static std::vector<double> run_threads(int threads, Log log) {
+    std::vector<std::vector<double>> per(static_cast<size_t>(threads));
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t] {
+            std::vector<double>& out = per[static_cast<size_t>(t)];
+            out.reserve(kPerThread);
+            for (int i = 0; i < kPerThread; ++i) {
+                auto begin = Clock::now();
+                log(t, i);
+                out.push_back(std::chrono::duration<double, std::nano>(Clock::now() - begin).count());
+            }
+        });
+    }
+    for (auto& w : workers) w.join();
+    std::vector<double> all;
+    for (const auto& v : per) all.insert(all.end(), v.begin(), v.end());
+    return all;
+}
+
+int main() {
+    std::vector<Stacktrace> stacks;
+    for (int i = 0; i < kPaths; ++i) stacks.push_back(deep_capture(12 + i % 8));
+    // 预热: 两条路径都只测符号已加载之后的稳态
+    std::ostringstream warm;
+    stacks[0].print(warm);
+
+    for (int threads : {1, 4, 8}) {
+        std::mutex print_mu;
+        std::vector<std::ostringstream> sinks(static_cast<size_t>(threads));
+        auto begin = Clock::now();
+        std::vector<double> inline_ns = run_threads(threads, [&](int t, int i) {
+            std::ostringstream& os = sinks[static_cast<size_t>(t)];
+            os.str("");
+            std::lock_guard<std::mutex> lock(print_mu);
+            stacks[static_cast<size_t>(i % kPaths)].print(os);
+        });
+        double inline_total = seconds_since(begin);
+        Latency in = summarize(inline_ns);
+
+        AsyncResolverOptions options;
+        options.capacity = 8192; // 一次突发全部放得下
+        options.overflow = AsyncOverflow::Block;
+        AsyncResolver resolver(options);
+        resolver.submit(stacks[0], nullptr);
+        resolver.flush();
+        std::string sink;
+        begin = Clock::now();
+        std::vector<double> async_ns = run_threads(threads, [&](int, int i) {
+            resolver.submit(stacks[static_cast<size_t>(i % kPaths)], [&sink](const AsyncResult& r) {
+                sink = r.to_string();
+            });
+        });
+        double submit_total = seconds_since(begin);
+        resolver.flush();
+        double async_total = seconds_since(begin);
+        Latency as = summarize(async_ns);
+        AsyncResolverStats st = resolver.stats();
+
+        printf("%d thread(s) x %d stacks\n", threads, kPerThread);
+        printf("  inline print()   %8.0f ns/call (p99 %8.0f ns), total %7.1f ms\n", in.mean_ns, in.p99_ns, inline_total * 1e3);
+        printf("  async submit()   %8.0f ns/call (p99 %8.0f ns), submit %7.1f ms, all delivered %7.1f ms\n", as.mean_ns,
+               as.p99_ns, submit_total * 1e3, async_total * 1e3);
+        printf("  %llu batches, %llu lookups for %llu frames, %llu blocked submits\n",
+               static_cast<unsigned long long>(st.batches), static_cast<unsigned long long>(st.lookups),
+               static_cast<unsigned long long>(st.frames), static_cast<unsigned long long>(st.blocked));
+    }
+    return 0;
+}
@@ -0,0 +1,89 @@
+// CallTree 聚合吞吐与内存: 1000 万条样本
+// - real:   64 条不同深度 (8..71) 的真实栈重复合并, 之后导出 folded / pprof
+// - random: 栈顶 3 帧为随机地址, 不同路径远多于节点上限 (100000), 内存应停在上限附近
+
+#include "sst_calltree.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <sstream>
+
+using namespace stacktrace;
+using Clock = std::chrono::steady_clock;
+
+static const int kDistinct = 64;
+static const int kSamples = 10000000;
+
+using DeepStacktrace = BasicStacktrace<128>;
+
+__attribute__((noinline)) static DeepStacktrace capture_at(int depth) {
+    if (depth > 0) {
+        DeepStacktrace st = capture_at(depth - 1);
+        __asm__ volatile("" ::: "memory");
+        return st;
+    }
+    return DeepStacktrace::capture();
+}
+
+static double seconds_since(Clock::time_point begin) {
+    return std::chrono::duration<double>(Clock::now() - begin).count();
+}
+
+static void print_stats(const char* what, const CallTree& tree, double secs) {
+    CallTreeStats st = tree.stats();
+    printf("%-8s %lu samples in %.2f s (%.1f M/s), %zu nodes, %.1f MB, %lu truncated\n",
+           what,
+           static_cast<unsigned long>(st.samples),
+           secs,
+           static_cast<double>(st.samples) / secs / 1e6,
+           st.nodes,
+           static_cast<double>(st.memory_bytes) / (1 << 20),
+           static_cast<unsigned long>(st.truncated));
+}
+
+int main() {
+    std::vector<DeepStacktrace> traces;
+    size_t frames = 0;
+    for (int i = 0; i < kDistinct; ++i) {
+        traces.push_back(capture_at(4 + i));
+    }
+
+    CallTree real("samples", "count");
+    auto begin = Clock::now();
+    for (int i = 0; i < kSamples; ++i) {
+        const DeepStacktrace& st = traces[static_cast<size_t>(i % kDistinct)];
+        frames += st.size();
+        real.add(st);
+    }
+    print_stats("real", real, seconds_since(begin));
+    printf("         avg depth %.1f\n", static_cast<double>(frames) / kSamples);
+
+    begin = Clock::now();
+    std::ostringstream folded;
+    real.write_folded(folded);
+    double folded_secs = seconds_since(begin);
+    begin = Clock::now();
+    std::string proto = real.to_pprof();
+    printf("         folded %zu bytes in %.3f s, pprof %zu bytes in %.3f s\n",
+           folded.str().size(), folded_secs, proto.size(), seconds_since(begin));
+
+    CallTree random("samples", "count", 100000);
+    void* stack[16];
+    const DeepStacktrace& base = traces[8];
+    for (size_t k = 0; k < 13; ++k) {
+        stack[3 + k] = base.addresses()[k];
+    }
+    uint64_t x = 88172645463325252ull;
+    begin = Clock::now();
+    for (int i = 0; i < kSamples; ++i) {
+        for (int k = 0; k < 3; ++k) {
+            x ^= x << 13;
+            x ^= x >> 7;
+            x ^= x << 17;
+            stack[k] = reinterpret_cast<void*>(x & 0xffffffffffull);
+        }
+        random.add(stack, 16);
+    }
+    print_stats("random", random, seconds_since(begin));
+    return 0;
+}
@@ -0,0 +1,47 @@
+// 不同深度 / 不同 unwinder 下单次 capture() 的开销
+// 构建: make && ./build/bench_capture
+
+#include "sst.hpp"
+
+#include <chrono>
+#include <cstdio>
+
+using namespace stacktrace;
+
+static const int kIters = 200000;
+static const int kCallDepth = 160; // 比最大捕获深度更深, 保证每次都能抓满
+
+template <typename ST>
+__attribute__((noinline)) static void run(const char* name) {
+    size_t frames = 0;
+    auto begin = std::chrono::steady_clock::now();
+    for (int i = 0; i < kIters; ++i) {
+        ST st = ST::capture();
+        frames += st.size();
+    }
+    auto end = std::chrono::steady_clock::now();
+    double ns = std::chrono::duration<double, std::nano>(end - begin).count() / kIters;
+    printf("%-36s %8.1f ns/capture  (%zu frames, sizeof=%zu)\n", name, ns, frames / kIters, sizeof(ST));
+}
+
+__attribute__((noinline)) static int recurse(int depth) {
+    if (depth > 0) {
+        int r = recurse(depth - 1);
+        asm volatile("" ::: "memory"); // 防止尾调用优化
+        return r + 1;
+    }
+
+    run<BasicStacktrace<8>>("execinfo      depth=8");
+    run<BasicStacktrace<32>>("execinfo      depth=32");
+    run<BasicStacktrace<128>>("execinfo      depth=128");
+    run<BasicStacktrace<8, FramePointerUnwinder>>("frame-pointer depth=8");
+    run<BasicStacktrace<32, FramePointerUnwinder>>("frame-pointer depth=32");
+    run<BasicStacktrace<128, FramePointerUnwinder>>("frame-pointer depth=128");
+    return 0;
+}
+
+int main() {
+    Stacktrace::capture(); // 预热: 首次 backtrace() 会加载 libgcc_s
+    recurse(kCallDepth);
+    return 0;
+}
@@ -0,0 +1,70 @@
+// libstdc++.so.6 中全部 _Z 函数符号的 demangle 耗时
+// - cxa:        abi::__cxa_demangle, 每次调用都分配结果缓冲区
+// - full:       demangle_into() 写入栈上缓冲区, 不分配内存
+// - simplified: demangle_into() 简化模式, 省略模板实参与参数列表
+
+#include "sst.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <link.h>
+
+using namespace stacktrace;
+using Clock = std::chrono::steady_clock;
+
+static const int kRounds = 20;
+
+static double seconds_since(Clock::time_point begin) {
+    return std::chrono::duration<double>(Clock::now() - begin).count();
+}
+
+static int find_libstdcxx(struct dl_phdr_info* info, size_t, void* data) {
+    if (info->dlpi_name && strstr(info->dlpi_name, "libstdc++.so")) {
+        *static_cast<std::string*>(data) = info->dlpi_name;
+        return 1;
+    }
+    return 0;
+}
+
+template <typename F>
+static void time_names(const char* name, const std::vector<const char*>& names, F&& fn) {
+    size_t bytes = 0;
+    auto begin = Clock::now();
+    for (int r = 0; r < kRounds; ++r) {
+        for (const char* n : names) bytes += fn(n);
+    }
+    double secs = seconds_since(begin) / kRounds;
+    printf("%-10s %zu names, %.2f ms (%.0f ns/name, %.1f bytes/name)\n", name, names.size(), secs * 1e3,
+           secs * 1e9 / static_cast<double>(names.size()), static_cast<double>(bytes) / kRounds / static_cast<double>(names.size()));
+}
+
+int main() {
+    std::string path;
+    dl_iterate_phdr(find_libstdcxx, &path);
+    if (path.empty()) {
+        fprintf(stderr, "libstdc++.so not loaded\n");
+        return 1;
+    }
+    std::vector<Symbol> syms = load_symbols(path.c_str(), 0);
+    std::vector<const char*> names;
+    for (const auto& s : syms) {
+        if (s.name.compare(0, 2, "_Z") == 0) names.push_back(s.name.c_str());
+    }
+
+    time_names("cxa", names, [](const char* n) -> size_t {
+        int status = 0;
+        char* out = abi::__cxa_demangle(n, nullptr, nullptr, &status);
+        size_t len = out ? strlen(out) : 0;
+        free(out);
+        return len;
+    });
+    time_names("full", names, [](const char* n) {
+        char buf[1024];
+        return demangle_into(n, buf, sizeof(buf));
+    });
+    time_names("simplified", names, [](const char* n) {
+        char buf[1024];
+        return demangle_into(n, buf, sizeof(buf), DemangleStyle::Simplified);
+    });
+    return 0;
+}
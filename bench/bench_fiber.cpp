@@ -0,0 +1,87 @@
+// FiberRegistry: 每次切换的 park()/resume() 开销, 以及 1 万个挂起协程的 dump_parked()
+// - 协程栈是手工构造的帧指针链 (12 帧, 返回地址取自少数几个函数), 模拟大量协程停在相同的调度点上
+// - dump_parked() 按地址去重后批量解析; 对照为逐帧调用 Stacktrace::resolve()
+
+#include "sst_fiber.hpp"
+
+#include <chrono>
+#include <cstdio>
+
+using namespace stacktrace;
+using Clock = std::chrono::steady_clock;
+
+static const int kFibers = 10000;
+static const size_t kStackWords = 512;
+static const int kDepth = 12;
+static const int kSwitches = 10000000;
+
+static double seconds_since(Clock::time_point begin) {
+    return std::chrono::duration<double>(Clock::now() - begin).count();
+}
+
+__attribute__((noinline)) void sched_point_a() {
+    asm volatile("");
+}
+
+__attribute__((noinline)) void sched_point_b() {
+    asm volatile("");
+}
+
+__attribute__((noinline)) void handler_c() {
+    asm volatile("");
+}
+
+int main() {
+    const uintptr_t pcs[3] = {reinterpret_cast<uintptr_t>(&sched_point_a) + 1, reinterpret_cast<uintptr_t>(&sched_point_b) + 1,
+                              reinterpret_cast<uintptr_t>(&handler_c) + 1};
+    auto& reg = FiberRegistry::instance();
+    std::vector<std::vector<uintptr_t>> stacks(kFibers, std::vector<uintptr_t>(kStackWords));
+    std::vector<int> handles(kFibers);
+    for (int i = 0; i < kFibers; ++i) {
+        uintptr_t* words = stacks[i].data();
+        // 栈顶向下依次放置 {上一帧 fp, 返回地址} 帧记录
+        size_t top = kStackWords - 2 * kDepth - 2;
+        for (int d = 0; d < kDepth; ++d) {
+            uintptr_t* record = words + top + 2 * d;
+            record[0] = d + 1 < kDepth ? reinterpret_cast<uintptr_t>(record + 2) : 0;
+            record[1] = pcs[(i + d) % 3];
+        }
+        handles[i] = reg.add(words, kStackWords * sizeof(uintptr_t), "fiber");
+        FiberContext ctx = {pcs[i % 3], reinterpret_cast<uintptr_t>(words + top), reinterpret_cast<uintptr_t>(words + top)};
+        reg.park(handles[i], ctx);
+    }
+
+    FiberContext ctx = {pcs[0], reinterpret_cast<uintptr_t>(stacks[0].data()), reinterpret_cast<uintptr_t>(stacks[0].data())};
+    auto begin = Clock::now();
+    for (int i = 0; i < kSwitches; ++i) {
+        reg.resume(handles[0]);
+        reg.park(handles[0], ctx);
+        asm volatile("" ::: "memory");
+    }
+    double secs = seconds_since(begin);
+    printf("resume + park    %.1f ns/switch\n", secs * 1e9 / kSwitches);
+    ctx.sp = ctx.fp = reinterpret_cast<uintptr_t>(stacks[0].data() + kStackWords - 2 * kDepth - 2);
+    reg.park(handles[0], ctx);
+
+    // 预热: 加载模块与符号表, 并让堆增长到结果所需的大小
+    reg.dump_parked();
+    reg.dump_parked();
+    size_t frames = 0;
+    begin = Clock::now();
+    std::vector<FiberTrace> traces = reg.dump_parked();
+    secs = seconds_since(begin);
+    for (const auto& t : traces) frames += t.frames.size();
+    printf("dump_parked      %zu fibers, %zu frames, %.2f ms\n", traces.size(), frames, secs * 1e3);
+
+    // 对照: 同样构造全部 FiberTrace, 但逐帧解析
+    begin = Clock::now();
+    std::vector<FiberTrace> naive(traces.size());
+    for (size_t i = 0; i < traces.size(); ++i) {
+        for (const auto& f : traces[i].frames) naive[i].frames.push_back(Stacktrace::resolve(reinterpret_cast<void*>(f.abs_addr)));
+    }
+    secs = seconds_since(begin);
+    printf("per-frame resolve %zu frames, %.2f ms\n", frames, secs * 1e3);
+
+    for (int h : handles) reg.remove(h);
+    return 0;
+}
@@ -0,0 +1,42 @@
+// 采样堆分析器的开销: 分别在有无 LD_PRELOAD=libsst_heap.so 时运行, 比较 ns/op
+//   make heap-overhead
+// 每个线程维护一个 1024 项的存活窗口, 随机大小 16..1040 字节的 malloc/free 交替进行
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+static const int kThreads = 4;
+static const int kOpsPerThread = 4000000;
+static const int kWindow = 1024;
+
+static void worker(unsigned seed) {
+    std::vector<void*> window(kWindow, nullptr);
+    unsigned x = seed;
+    for (int i = 0; i < kOpsPerThread; ++i) {
+        x = x * 1103515245u + 12345u;
+        size_t slot = (x >> 8) % kWindow;
+        free(window[slot]);
+        window[slot] = malloc(16 + (x >> 20) % 1024);
+    }
+    for (void* p : window) {
+        free(p);
+    }
+}
+
+int main() {
+    auto begin = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back(worker, static_cast<unsigned>(t + 1));
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    auto end = std::chrono::steady_clock::now();
+    double ns = std::chrono::duration<double, std::nano>(end - begin).count();
+    printf("%d threads x %d malloc+free: %.1f ns/op (wall)\n", kThreads, kOpsPerThread, ns / kOpsPerThread);
+    return 0;
+}
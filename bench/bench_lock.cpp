@@ -0,0 +1,71 @@
+// 锁竞争分析器的开销: 分别在有无 LD_PRELOAD=libsst_lock.so 时运行, 比较 ns/op
+//   make lock-overhead
+// - uncontended: 单线程反复加解锁, 只走 trylock 快路径
+// - contended:   4 个线程争用同一把锁, 其中 slow_path() 每 1000 次在持锁时睡眠 200 us,
+//                其他线程大多阻塞在 fast_path() 中, 报告中 fast_path 的栈应排在第一位
+// 加载了 libsst_lock.so 时, 结束后打印竞争报告
+
+#include <dlfcn.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+static const int kThreads = 4;
+static const int kUncontendedOps = 20000000;
+static const int kOpsPerThread = 200000;
+
+static pthread_mutex_t g_mutex = PTHREAD_MUTEX_INITIALIZER;
+static volatile unsigned long g_counter = 0;
+
+__attribute__((noinline)) static void slow_path() {
+    pthread_mutex_lock(&g_mutex);
+    usleep(200);
+    ++g_counter;
+    pthread_mutex_unlock(&g_mutex);
+}
+
+__attribute__((noinline)) static void fast_path() {
+    pthread_mutex_lock(&g_mutex);
+    ++g_counter;
+    pthread_mutex_unlock(&g_mutex);
+}
+
+static void worker() {
+    for (int i = 0; i < kOpsPerThread; ++i) {
+        if (i % 1000 == 0) {
+            slow_path();
+        } else {
+            fast_path();
+        }
+    }
+}
+
+int main() {
+    auto begin = std::chrono::steady_clock::now();
+    for (int i = 0; i < kUncontendedOps; ++i) {
+        fast_path();
+    }
+    double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - begin).count();
+    printf("uncontended lock+unlock: %.1f ns/op\n", ns / kUncontendedOps);
+
+    begin = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back(worker);
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - begin).count();
+    printf("%d threads x %d contended lock+unlock: %.1f ns/op (wall)\n", kThreads, kOpsPerThread, ns / kOpsPerThread);
+
+    typedef int (*dump_fn)(FILE*, int);
+    if (auto dump = reinterpret_cast<dump_fn>(dlsym(RTLD_DEFAULT, "sst_lock_dump"))) {
+        dump(stdout, 0);
+    }
+    return 0;
+}
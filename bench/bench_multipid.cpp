@@ -0,0 +1,109 @@
+// MultiPidResolver: 整机快照 —— 解析 200 个进程各自的栈
+// - 子进程由本程序 fork + exec 自身得到, 各自有独立的 ASLR 布局, 抓一个栈与几个 libc / libstdc++ 函数的地址后挂起
+// - 对照为逐个进程调用 resolve_on_pid(), 每次都重新加载该进程所有模块的符号表
+// - MultiPidResolver 冷启动 (新对象) 与热缓存 (再次快照) 各测一次
+// 用法: bench_multipid [进程数]
+
+#include "sst_multipid.hpp"
+
+#include <chrono>
+#include <cstdio>
+
+#include <dlfcn.h>
+#include <signal.h>
+#include <sys/wait.h>
+
+using namespace stacktrace;
+using Clock = std::chrono::steady_clock;
+
+static double seconds_since(Clock::time_point begin) {
+    return std::chrono::duration<double>(Clock::now() - begin).count();
+}
+
+__attribute__((noinline)) static Stacktrace deep_capture(int depth) {
+    Stacktrace st = depth > 0 ? deep_capture(depth - 1) : Stacktrace::capture();
+    asm volatile("" ::: "memory");
+    return st;
+}
+
+// 子进程: 把地址写到 fd 后一直挂起, 直到被父进程杀掉
+static int child_main(int fd) {
+    Stacktrace st = deep_capture(8);
+    std::vector<void*> addrs(st.addresses(), st.addresses() + st.size());
+    for (const char* name : {"malloc", "qsort", "pthread_create", "_ZNSt6chrono3_V212steady_clock3nowEv", "_ZSt9terminatev"}) {
+        if (void* p = dlsym(RTLD_DEFAULT, name)) addrs.push_back(static_cast<char*>(p) + 4);
+    }
+    size_t n = addrs.size();
+    if (write(fd, &n, sizeof(n)) != sizeof(n) || write(fd, addrs.data(), n * sizeof(void*)) != static_cast<ssize_t>(n * sizeof(void*))) return 1;
+    close(fd);
+    for (;;) pause();
+}
+
+static bool read_full(int fd, void* buf, size_t len) {
+    char* p = static_cast<char*>(buf);
+    while (len > 0) {
+        ssize_t r = read(fd, p, len);
+        if (r <= 0) return false;
+        p += r;
+        len -= static_cast<size_t>(r);
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    if (argc == 3 && strcmp(argv[1], "--child") == 0) return child_main(atoi(argv[2]));
+    int procs = argc > 1 ? atoi(argv[1]) : 200;
+
+    std::vector<PidAddresses> req;
+    auto begin = Clock::now();
+    for (int i = 0; i < procs; ++i) {
+        int fds[2];
+        if (pipe(fds) != 0) break;
+        pid_t pid = fork();
+        if (pid == 0) {
+            close(fds[0]);
+            std::string fd = std::to_string(fds[1]);
+            execl("/proc/self/exe", argv[0], "--child", fd.c_str(), static_cast<char*>(nullptr));
+            _exit(127);
+        }
+        close(fds[1]);
+        PidAddresses p;
+        p.pid = pid;
+        size_t n = 0;
+        if (pid > 0 && read_full(fds[0], &n, sizeof(n)) && n <= 256) {
+            p.addrs.resize(n);
+            if (! read_full(fds[0], p.addrs.data(), n * sizeof(void*))) p.addrs.clear();
+        }
+        close(fds[0]);
+        if (! p.addrs.empty()) req.push_back(p);
+    }
+    size_t addrs = 0;
+    for (const auto& p : req) addrs += p.addrs.size();
+    printf("%zu processes, %zu addresses (spawned in %.2f s), %u hardware threads\n", req.size(), addrs, seconds_since(begin),
+           std::thread::hardware_concurrency());
+
+    begin = Clock::now();
+    size_t naive_symbols = 0;
+    for (const auto& p : req) {
+        for (const auto& f : resolve_on_pid(p.addrs, p.pid)) naive_symbols += f.has_symbol ? 1 : 0;
+    }
+    double naive = seconds_since(begin);
+    printf("resolve_on_pid x %zu        %8.1f ms  (%zu frames with symbols)\n", req.size(), naive * 1e3, naive_symbols);
+
+    MultiPidResolver resolver;
+    for (const char* label : {"MultiPidResolver (cold)", "MultiPidResolver (warm)"}) {
+        auto frames = resolver.resolve(req);
+        size_t symbols = 0;
+        for (const auto& v : frames) {
+            for (const auto& f : v) symbols += f.has_symbol ? 1 : 0;
+        }
+        const MultiPidStats& st = resolver.last_stats();
+        printf("%-27s %8.1f ms  (%zu frames with symbols; maps %.1f ms, load %.1f ms, resolve %.1f ms; "
+               "%zu mappings -> %zu files, %zu indexes loaded)\n",
+               label, st.total_ms, symbols, st.maps_ms, st.load_ms, st.resolve_ms, st.mappings, st.files, st.loaded);
+    }
+
+    for (const auto& p : req) kill(p.pid, SIGKILL);
+    for (const auto& p : req) waitpid(p.pid, nullptr, 0);
+    return 0;
+}
@@ -0,0 +1,72 @@
+// PerfMapProvider: 20 万条 perf map 的首次解析, 之后每批追加 100 条的增量读取, 以及命中查询
+// 增量读取只处理新增的字节, 耗时应与批大小相关而与文件总大小无关
+
+#include "sst_perfmap.hpp"
+
+#include <chrono>
+#include <cstdio>
+
+using namespace stacktrace;
+using Clock = std::chrono::steady_clock;
+
+static const uintptr_t kBase = 0x7f0000000000ull;
+static const int kInitial = 200000;
+static const int kBatches = 100;
+static const int kBatch = 100;
+static const int kLookups = 2000000;
+
+static double seconds_since(Clock::time_point begin) {
+    return std::chrono::duration<double>(Clock::now() - begin).count();
+}
+
+static void append_entries(FILE* f, int first, int count) {
+    for (int i = first; i < first + count; ++i) {
+        fprintf(f, "%lx 40 LUA:trace_%d.lua:%d\n", static_cast<unsigned long>(kBase + static_cast<uintptr_t>(i) * 0x40), i, i % 1000);
+    }
+    fflush(f);
+}
+
+int main() {
+    const pid_t pid = 999999; // 不存在的 pid, 只用于定位文件
+    std::string path = "/tmp/perf-" + std::to_string(pid) + ".map";
+    FILE* f = fopen(path.c_str(), "w");
+    if (! f) {
+        perror(path.c_str());
+        return 1;
+    }
+    append_entries(f, 0, kInitial);
+
+    PerfMapProvider provider("/tmp", 0);
+    ProvidedSymbol ps;
+    auto begin = Clock::now();
+    provider.find(pid, kBase, ps);
+    printf("initial  %d entries, %zu bytes in %.1f ms\n", kInitial, provider.stats(pid).bytes_read, seconds_since(begin) * 1e3);
+
+    int next = kInitial;
+    double tail_secs = 0;
+    for (int b = 0; b < kBatches; ++b) {
+        append_entries(f, next, kBatch);
+        begin = Clock::now();
+        provider.find(pid, kBase + static_cast<uintptr_t>(next) * 0x40, ps);
+        tail_secs += seconds_since(begin);
+        next += kBatch;
+    }
+    printf("tail     %d x %d entries, %.1f us per batch, %zu entries\n", kBatches, kBatch, tail_secs / kBatches * 1e6, provider.stats(pid).entries);
+    fclose(f);
+
+    // 命中查询: 默认 100 ms 检查一次文件
+    PerfMapProvider cached;
+    cached.find(pid, kBase, ps);
+    uint64_t x = 88172645463325252ull, found = 0;
+    begin = Clock::now();
+    for (int i = 0; i < kLookups; ++i) {
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+        found += cached.find(pid, kBase + (x % static_cast<uint64_t>(next)) * 0x40 + 8, ps);
+    }
+    double secs = seconds_since(begin);
+    printf("lookup   %d in %.2f s (%.0f ns each), %lu found\n", kLookups, secs, secs / kLookups * 1e9, static_cast<unsigned long>(found));
+    unlink(path.c_str());
+    return 0;
+}
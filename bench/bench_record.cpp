@@ -0,0 +1,108 @@
+// 紧凑栈记录格式 vs 文本输出: 体积与编码/解码吞吐
+// 语料为 64 条不同深度 (8..71) 的真实栈, 重复写入 100000 条
+
+#include "sst_record.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using namespace stacktrace;
+using Clock = std::chrono::steady_clock;
+
+static const int kDistinct = 64;
+static const int kStacks = 100000;
+
+using DeepStacktrace = BasicStacktrace<128>;
+
+__attribute__((noinline)) static DeepStacktrace capture_at(int depth) {
+    if (depth > 0) {
+        DeepStacktrace st = capture_at(depth - 1);
+        __asm__ volatile("" ::: "memory");
+        return st;
+    }
+    return DeepStacktrace::capture();
+}
+
+static double seconds_since(Clock::time_point begin) {
+    return std::chrono::duration<double>(Clock::now() - begin).count();
+}
+
+int main() {
+    std::vector<DeepStacktrace> traces;
+    std::vector<std::vector<RawFrame>> raws;
+    size_t frames = 0;
+    for (int i = 0; i < kDistinct; ++i) {
+        traces.push_back(capture_at(4 + i));
+        raws.push_back(traces.back().get_raw_frames());
+    }
+    for (int i = 0; i < kStacks; ++i) {
+        frames += raws[static_cast<size_t>(i % kDistinct)].size();
+    }
+
+    // print() 的完整文本 (需要符号化)
+    traces[0].get_frames();
+    std::string text;
+    auto begin = Clock::now();
+    for (int i = 0; i < kStacks; ++i) {
+        for (const auto& f : traces[static_cast<size_t>(i % kDistinct)].get_frames()) {
+            text += f.to_string();
+        }
+    }
+    double text_secs = seconds_since(begin);
+
+    // 原始帧文本: "module+0xoffset" 每行一帧
+    std::string raw_text;
+    char line[64];
+    begin = Clock::now();
+    for (int i = 0; i < kStacks; ++i) {
+        for (const auto& f : raws[static_cast<size_t>(i % kDistinct)]) {
+            raw_text += f.module;
+            snprintf(line, sizeof(line), "+0x%lx\n", static_cast<unsigned long>(f.offset));
+            raw_text += line;
+        }
+        raw_text += '\n';
+    }
+    double raw_text_secs = seconds_since(begin);
+
+    // 紧凑二进制格式
+    StackRecordWriter writer;
+    std::string encoded;
+    begin = Clock::now();
+    for (int i = 0; i < kStacks; ++i) {
+        writer.write(raws[static_cast<size_t>(i % kDistinct)]);
+        if (writer.size() >= 64 * 1024) {
+            encoded.append(writer.data(), writer.size());
+            writer.consume();
+        }
+    }
+    encoded.append(writer.data(), writer.size());
+    writer.consume();
+    double encode_secs = seconds_since(begin);
+
+    StackRecordReader reader;
+    std::vector<RawFrame> decoded;
+    uint64_t fp = 0;
+    int records = 0;
+    begin = Clock::now();
+    for (size_t off = 0; off < encoded.size(); off += 64 * 1024) {
+        reader.feed(encoded.data() + off, std::min<size_t>(64 * 1024, encoded.size() - off));
+        while (reader.next(decoded, fp) == StackRecordReader::kRecord) {
+            ++records;
+        }
+    }
+    double decode_secs = seconds_since(begin);
+
+    printf("%d stacks, %zu frames (avg depth %.1f)\n", kStacks, frames, static_cast<double>(frames) / kStacks);
+    printf("%-22s %12s %12s %14s\n", "format", "bytes", "B/frame", "stacks/s");
+    printf("%-22s %12zu %12.1f %14.0f\n", "text (print)", text.size(), static_cast<double>(text.size()) / static_cast<double>(frames),
+           kStacks / text_secs);
+    printf("%-22s %12zu %12.1f %14.0f\n", "text (module+offset)", raw_text.size(),
+           static_cast<double>(raw_text.size()) / static_cast<double>(frames), kStacks / raw_text_secs);
+    printf("%-22s %12zu %12.1f %14.0f\n", "sst_record encode", encoded.size(),
+           static_cast<double>(encoded.size()) / static_cast<double>(frames), kStacks / encode_secs);
+    printf("%-22s %12s %12s %14.0f%s\n", "sst_record decode", "", "", records / decode_secs,
+           records == kStacks ? "" : "  (record count mismatch!)");
+    return records == kStacks ? 0 : 1;
+}
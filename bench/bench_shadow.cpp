@@ -0,0 +1,92 @@
+// 影子调用栈: 插桩带来的每次调用开销 与 抓栈省下的时间
+// - 本文件以 -finstrument-functions 编译; 对照函数用 no_instrument_function 排除插桩, 其余代码完全相同
+// - 抓栈在同一条插桩过的调用链上进行, 分别使用 ShadowStackUnwinder、FramePointerUnwinder 与 ExecinfoUnwinder
+// - 盈亏平衡点: 每抓一次栈之间最多能执行多少次插桩函数调用, 插桩才比 backtrace() / frame pointer 更划算
+
+#include "sst_shadow.hpp"
+
+#include <chrono>
+#include <cstdio>
+
+SST_DEFINE_SHADOW_STACK_HOOKS()
+
+using namespace stacktrace;
+using Clock = std::chrono::steady_clock;
+
+static const int kCalls = 50000000;
+static const int kCaptures = 200000;
+
+static double seconds_since(Clock::time_point begin) {
+    return std::chrono::duration<double>(Clock::now() - begin).count();
+}
+
+// 典型的小函数: 插桩的开销占比最高的情形
+__attribute__((noinline)) static int leaf_instrumented(int x) {
+    asm volatile("" : "+r"(x));
+    return x + 1;
+}
+
+__attribute__((noinline, no_instrument_function)) static int leaf_plain(int x) {
+    asm volatile("" : "+r"(x));
+    return x + 1;
+}
+
+template <typename F>
+__attribute__((no_instrument_function)) static double ns_per_call(F leaf) {
+    auto begin = Clock::now();
+    int x = 0;
+    for (int i = 0; i < kCalls; ++i) x = leaf(x);
+    double s = seconds_since(begin);
+    if (x != kCalls) printf("unexpected %d\n", x);
+    return s * 1e9 / kCalls;
+}
+
+template <typename St>
+__attribute__((no_instrument_function)) static double ns_per_capture() {
+    auto begin = Clock::now();
+    size_t frames = 0;
+    for (int i = 0; i < kCaptures; ++i) frames += St::capture().size();
+    double s = seconds_since(begin);
+    if (frames == 0) printf("no frames\n");
+    return s * 1e9 / kCaptures;
+}
+
+struct Row {
+    const char* name;
+    double ns;
+    size_t frames;
+};
+
+__attribute__((noinline)) static void measure_at(int depth, Row* rows) {
+    if (depth > 0) {
+        measure_at(depth - 1, rows);
+        asm volatile("" ::: "memory");
+        return;
+    }
+    using Shadow = BasicStacktrace<64, ShadowStackUnwinder>;
+    using Fp = BasicStacktrace<64, FramePointerUnwinder>;
+    using Execinfo = BasicStacktrace<64, ExecinfoUnwinder>;
+    rows[0] = Row{"shadow stack", ns_per_capture<Shadow>(), Shadow::capture().size()};
+    rows[1] = Row{"frame pointer", ns_per_capture<Fp>(), Fp::capture().size()};
+    rows[2] = Row{"backtrace()", ns_per_capture<Execinfo>(), Execinfo::capture().size()};
+}
+
+int main() {
+    double plain = ns_per_call(leaf_plain);
+    double instrumented = ns_per_call(leaf_instrumented);
+    double overhead = instrumented - plain;
+    printf("call: plain %.2f ns, instrumented %.2f ns, overhead %.2f ns per call\n", plain, instrumented, overhead);
+
+    for (int depth : {8, 30, 60}) {
+        Row rows[3];
+        measure_at(depth, rows);
+        printf("depth %2d:", depth);
+        for (const Row& r : rows) printf("  %s %7.1f ns (%zu frames)", r.name, r.ns, r.frames);
+        printf("\n");
+        if (overhead > 0) {
+            printf("          break-even: one capture per %.0f calls (vs frame pointer), per %.0f calls (vs backtrace())\n",
+                   (rows[1].ns - rows[0].ns) / overhead, (rows[2].ns - rows[0].ns) / overhead);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,35 @@
+// SlowOpGuard 进入 + 离开的开销: 看门狗未启动 / 已启动 / 两层嵌套
+
+#include "sst_slowop.hpp"
+
+#include <chrono>
+#include <cstdio>
+
+using namespace stacktrace;
+
+static const int kIters = 20000000;
+
+template <typename F>
+static double ns_per_iter(F&& body) {
+    auto begin = std::chrono::steady_clock::now();
+    for (int i = 0; i < kIters; ++i) {
+        body();
+        __asm__ volatile("" ::: "memory");
+    }
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - begin).count() / kIters;
+}
+
+int main() {
+    auto single = [] { SlowOpGuard g(std::chrono::milliseconds(100), "bench"); };
+    auto nested = [] {
+        SlowOpGuard outer(std::chrono::milliseconds(100), "outer");
+        SlowOpGuard inner(std::chrono::milliseconds(10), "inner");
+    };
+
+    printf("guard, watchdog stopped: %.2f ns\n", ns_per_iter(single));
+    SlowOpWatchdog::start();
+    printf("guard, watchdog running: %.2f ns\n", ns_per_iter(single));
+    printf("nested guards (2 levels): %.2f ns\n", ns_per_iter(nested));
+    SlowOpWatchdog::stop();
+    return 0;
+}
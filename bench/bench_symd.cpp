@@ -0,0 +1,154 @@
+// sst-symbolized 的本机压测: 启动守护进程, 用 1/2/4 个客户端连接并发发送 64 帧一批的原始帧, 统计吞吐
+//   make run  (需要先 make -C ../src 生成 sst-symbolized 与 libsst.a)
+// 同时给出进程内 sst_resolve() 的冷/热耗时作为对照
+
+#include "sst.h"
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <pthread.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+static const char* kDaemon = "../src/build/sst-symbolized";
+static const size_t kBatch = 64;
+static const double kSeconds = 1.0;
+
+using Clock = std::chrono::steady_clock;
+
+// 取 libc / libstdc++ / 本程序中若干函数内部的地址作为语料
+static std::vector<void*> collect_addresses() {
+    void* funcs[] = {
+        reinterpret_cast<void*>(&printf),  reinterpret_cast<void*>(&malloc),        reinterpret_cast<void*>(&qsort),
+        reinterpret_cast<void*>(&strtoul), reinterpret_cast<void*>(&pthread_create), reinterpret_cast<void*>(&sqrt),
+        reinterpret_cast<void*>(&fopen),   reinterpret_cast<void*>(&waitpid),        reinterpret_cast<void*>(&collect_addresses),
+        reinterpret_cast<void*>(&sst_symd_resolve),
+    };
+    std::vector<void*> addrs;
+    for (void* f : funcs) {
+        for (uintptr_t off = 1; off <= 49; off += 8) {
+            addrs.push_back(reinterpret_cast<char*>(f) + off);
+        }
+    }
+    return addrs;
+}
+
+static pid_t start_daemon(const std::string& sock) {
+    pid_t pid = fork();
+    if (pid == 0) {
+        execl(kDaemon, kDaemon, "-s", sock.c_str(), static_cast<char*>(nullptr));
+        perror(kDaemon);
+        _exit(127);
+    }
+    // 等待 socket 可连接
+    for (int i = 0; i < 500; ++i) {
+        sst_symd* c = sst_symd_connect(sock.c_str());
+        if (c) {
+            sst_symd_close(c);
+            return pid;
+        }
+        usleep(10000);
+    }
+    kill(pid, SIGTERM);
+    waitpid(pid, nullptr, 0);
+    return -1;
+}
+
+static void client(const std::string& sock, const std::vector<sst_raw_frame>* corpus, std::atomic<uint64_t>* frames,
+                   std::atomic<bool>* stop) {
+    sst_symd* c = sst_symd_connect(sock.c_str());
+    if (! c) return;
+    std::vector<sst_frame> outs(kBatch);
+    uint64_t done = 0;
+    size_t pos = 0;
+    while (! stop->load(std::memory_order_relaxed)) {
+        if (pos + kBatch > corpus->size()) pos = 0;
+        if (sst_symd_resolve(c, corpus->data() + pos, kBatch, outs.data()) != 0) break;
+        pos += kBatch;
+        done += kBatch;
+    }
+    *frames += done;
+    sst_symd_close(c);
+}
+
+int main() {
+    std::string sock = "/tmp/sst-bench-symd." + std::to_string(getpid()) + ".sock";
+    pid_t daemon = start_daemon(sock);
+    if (daemon < 0) {
+        fprintf(stderr, "failed to start %s\n", kDaemon);
+        return 1;
+    }
+
+    std::vector<void*> addrs = collect_addresses();
+    std::vector<sst_raw_frame> corpus(addrs.size());
+    sst_resolve_raw_batch(addrs.data(), addrs.size(), corpus.data());
+    // 把语料重复到足够长, 每批帧来自多个模块
+    while (corpus.size() < 4096) {
+        corpus.insert(corpus.end(), corpus.begin(), corpus.begin() + static_cast<long>(addrs.size()));
+    }
+
+    // 第一批: 守护进程冷启动 (加载并 demangle 所需模块)
+    sst_symd* c = sst_symd_connect(sock.c_str());
+    std::vector<sst_frame> outs(addrs.size());
+    auto t0 = Clock::now();
+    sst_symd_resolve(c, corpus.data(), addrs.size(), outs.data());
+    auto t1 = Clock::now();
+    sst_symd_resolve(c, corpus.data(), addrs.size(), outs.data());
+    auto t2 = Clock::now();
+    size_t resolved = 0;
+    for (const auto& f : outs) {
+        resolved += f.has_symbol ? 1 : 0;
+    }
+    sst_symd_close(c);
+    printf("symd cold batch: %zu frames, %zu resolved, %.2f ms\n",
+           addrs.size(),
+           resolved,
+           std::chrono::duration<double, std::milli>(t1 - t0).count());
+    printf("symd warm batch: %.1f us\n", std::chrono::duration<double, std::micro>(t2 - t1).count());
+
+    for (int nclients : {1, 2, 4}) {
+        std::atomic<uint64_t> frames{0};
+        std::atomic<bool> stop{false};
+        std::vector<std::thread> threads;
+        auto begin = Clock::now();
+        for (int i = 0; i < nclients; ++i) {
+            threads.emplace_back(client, sock, &corpus, &frames, &stop);
+        }
+        std::this_thread::sleep_for(std::chrono::duration<double>(kSeconds));
+        stop = true;
+        for (auto& t : threads) {
+            t.join();
+        }
+        double secs = std::chrono::duration<double>(Clock::now() - begin).count();
+        printf("symd %d client(s), batch %zu: %.0f frames/s\n", nclients, kBatch, static_cast<double>(frames.load()) / secs);
+    }
+
+    // 对照: 进程内解析 (首次调用包含加载所有模块符号表的开销)
+    sst_clear_modules_cache();
+    sst_frame f;
+    t0 = Clock::now();
+    sst_resolve(addrs[0], &f);
+    t1 = Clock::now();
+    const int kIters = 100000;
+    for (int i = 0; i < kIters; ++i) {
+        sst_resolve(addrs[static_cast<size_t>(i) % addrs.size()], &f);
+    }
+    t2 = Clock::now();
+    printf("in-process sst_resolve: first %.2f ms, then %.0f frames/s\n",
+           std::chrono::duration<double, std::milli>(t1 - t0).count(),
+           kIters / std::chrono::duration<double>(t2 - t1).count());
+
+    sst_free_raw_frames(corpus.data(), addrs.size());
+    kill(daemon, SIGTERM);
+    waitpid(daemon, nullptr, 0);
+    return 0;
+}
@@ -0,0 +1,164 @@
+// load_symbols() 冷加载: 合成的 100 万符号 ET_DYN (约 60% 为非零地址的 STT_FUNC, 顺序随机)
+// - filter: 只比较过滤内核 (逐个判断并 push_back 的旧循环 / 无分支标量 / AVX2 gather)
+// - load:   完整的 load_symbols() 与旧实现 (逐个 push_back Symbol 再按地址排序)
+
+#include "sst.hpp"
+
+#include <chrono>
+#include <cstdio>
+
+using namespace stacktrace;
+using Clock = std::chrono::steady_clock;
+
+static const size_t kSymbols = 1000000;
+static const int kRounds = 20;
+
+static double seconds_since(Clock::time_point begin) {
+    return std::chrono::duration<double>(Clock::now() - begin).count();
+}
+
+static uint64_t g_rng = 88172645463325252ull;
+
+static uint64_t next_random() {
+    g_rng ^= g_rng << 13;
+    g_rng ^= g_rng >> 7;
+    g_rng ^= g_rng << 17;
+    return g_rng;
+}
+
+static std::vector<Elf64_Sym> make_symbols(std::string& strtab) {
+    static const unsigned char kTypes[] = {STT_FUNC, STT_FUNC, STT_FUNC, STT_OBJECT, STT_NOTYPE};
+    std::vector<Elf64_Sym> syms(kSymbols);
+    strtab.assign(1, '\0');
+    for (size_t i = 0; i < kSymbols; ++i) {
+        uint64_t r = next_random();
+        Elf64_Sym& s = syms[i];
+        s.st_name = static_cast<Elf64_Word>(strtab.size());
+        strtab += "_ZN7service6module8functionEi_" + std::to_string(i);
+        strtab += '\0';
+        s.st_info = static_cast<unsigned char>(ELF64_ST_INFO(STB_GLOBAL, kTypes[r % 5]));
+        s.st_other = 0;
+        s.st_shndx = 1;
+        s.st_value = (r >> 8) % 20 == 0 ? 0 : 0x1000 + ((r >> 16) & 0xffffff0);
+        s.st_size = 64;
+    }
+    return syms;
+}
+
+static bool write_elf(const char* path, const std::vector<Elf64_Sym>& syms, const std::string& strtab) {
+    Elf64_Ehdr ehdr;
+    memset(&ehdr, 0, sizeof(ehdr));
+    memcpy(ehdr.e_ident, ELFMAG, SELFMAG);
+    ehdr.e_ident[EI_CLASS] = ELFCLASS64;
+    ehdr.e_ident[EI_DATA] = ELFDATA2LSB;
+    ehdr.e_ident[EI_VERSION] = EV_CURRENT;
+    ehdr.e_type = ET_DYN;
+    ehdr.e_machine = EM_X86_64;
+    ehdr.e_version = EV_CURRENT;
+    ehdr.e_ehsize = sizeof(Elf64_Ehdr);
+    ehdr.e_shentsize = sizeof(Elf64_Shdr);
+    ehdr.e_shnum = 3;
+
+    Elf64_Shdr shdrs[3];
+    memset(shdrs, 0, sizeof(shdrs));
+    shdrs[1].sh_type = SHT_SYMTAB;
+    shdrs[1].sh_offset = sizeof(Elf64_Ehdr);
+    shdrs[1].sh_size = syms.size() * sizeof(Elf64_Sym);
+    shdrs[1].sh_link = 2;
+    shdrs[1].sh_entsize = sizeof(Elf64_Sym);
+    shdrs[2].sh_type = SHT_STRTAB;
+    shdrs[2].sh_offset = shdrs[1].sh_offset + shdrs[1].sh_size;
+    shdrs[2].sh_size = strtab.size();
+    ehdr.e_shoff = shdrs[2].sh_offset + shdrs[2].sh_size;
+
+    FILE* f = fopen(path, "wb");
+    if (! f) return false;
+    fwrite(&ehdr, sizeof(ehdr), 1, f);
+    fwrite(syms.data(), sizeof(Elf64_Sym), syms.size(), f);
+    fwrite(strtab.data(), 1, strtab.size(), f);
+    fwrite(shdrs, sizeof(shdrs), 1, f);
+    return fclose(f) == 0;
+}
+
+// 旧的 load_symbols(): 逐个判断并 push_back Symbol, 再对 Symbol 排序, 作为对照
+static std::vector<Symbol> legacy_load(const char* path, uintptr_t base) {
+    std::vector<Symbol> syms;
+    int fd = open(path, O_RDONLY);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) != 0) return syms;
+    void* data = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) return syms;
+    const char* raw = static_cast<const char*>(data);
+    auto* ehdr = reinterpret_cast<const Elf64_Ehdr*>(raw);
+    auto* shdrs = reinterpret_cast<const Elf64_Shdr*>(raw + ehdr->e_shoff);
+    auto* symtab = reinterpret_cast<const Elf64_Sym*>(raw + shdrs[1].sh_offset);
+    size_t nsyms = shdrs[1].sh_size / sizeof(Elf64_Sym);
+    const char* strtab = raw + shdrs[2].sh_offset;
+    bool is_pie = is_pie_binary(path);
+    for (size_t i = 0; i < nsyms; ++i) {
+        const auto& s = symtab[i];
+        if (ELF64_ST_TYPE(s.st_info) == STT_FUNC && s.st_value > 0) {
+            syms.push_back({is_pie ? s.st_value + base : s.st_value, strtab + s.st_name, static_cast<size_t>(s.st_size)});
+        }
+    }
+    munmap(data, static_cast<size_t>(st.st_size));
+    std::sort(syms.begin(), syms.end(), [](const Symbol& a, const Symbol& b) { return a.addr < b.addr; });
+    return syms;
+}
+
+template <typename F>
+static void time_filter(const char* name, F&& filter) {
+    size_t count = 0;
+    auto begin = Clock::now();
+    for (int r = 0; r < kRounds; ++r) {
+        count = filter();
+    }
+    double secs = seconds_since(begin) / kRounds;
+    printf("filter %-8s %zu hits, %.2f ms (%.2f ns/symbol)\n", name, count, secs * 1e3, secs * 1e9 / kSymbols);
+}
+
+int main() {
+    std::string strtab;
+    std::vector<Elf64_Sym> syms = make_symbols(strtab);
+
+    std::vector<uint32_t> out(kSymbols + 8);
+    time_filter("legacy", [&] {
+        std::vector<uint32_t> hits;
+        for (size_t i = 0; i < syms.size(); ++i) {
+            if (ELF64_ST_TYPE(syms[i].st_info) == STT_FUNC && syms[i].st_value > 0) hits.push_back(static_cast<uint32_t>(i));
+        }
+        return hits.size();
+    });
+    time_filter("scalar", [&] { return symtab_filter_scalar(syms.data(), syms.size(), out.data()); });
+#if defined(__x86_64__)
+    if (__builtin_cpu_supports("avx2")) {
+        time_filter("avx2", [&] { return symtab_filter_avx2(syms.data(), syms.size(), out.data()); });
+    }
+#endif
+
+    char path[] = "/tmp/sst_bench_symtab_XXXXXX";
+    int fd = mkstemp(path);
+    if (fd < 0 || ! write_elf(path, syms, strtab)) {
+        perror(path);
+        return 1;
+    }
+    close(fd);
+
+    // 交替运行, 避免堆状态与页缓存的先后影响
+    double legacy_secs = 0, current_secs = 0;
+    size_t legacy_n = 0, current_n = 0;
+    for (int r = 0; r < 4; ++r) {
+        for (int which = 0; which < 2; ++which) {
+            bool legacy = (r + which) % 2 == 0; // 每轮交换先后顺序
+            auto begin = Clock::now();
+            size_t n = legacy ? legacy_load(path, 0x10000000).size() : load_symbols(path, 0x10000000).size();
+            (legacy ? legacy_secs : current_secs) += seconds_since(begin);
+            (legacy ? legacy_n : current_n) = n;
+        }
+    }
+    printf("load   legacy   %zu symbols, %.1f ms\n", legacy_n, legacy_secs / 4 * 1e3);
+    printf("load   current  %zu symbols, %.1f ms\n", current_n, current_secs / 4 * 1e3);
+    unlink(path);
+    return 0;
+}
@@ -0,0 +1,45 @@
+#!/bin/bash
+# header-only 与 SST_COMPILED 两种模式的编译开销: N 个都抓栈并打印的源文件, 统计编译耗时、目标文件与可执行文件大小
+# 用法: ./compile_cost.sh [N] [CXXFLAGS...]   默认 N=20, CXXFLAGS="-O2"
+set -e
+
+N=${1:-20}
+shift || true
+FLAGS=${*:--O2}
+INC=$(cd "$(dirname "$0")/../include" && pwd)
+DIR=$(mktemp -d /tmp/sst_compile_cost.XXXXXX)
+trap 'rm -rf "$DIR"' EXIT
+
+gen() { # $1 = 目录, $2 = 头文件
+    mkdir -p "$1"
+    for i in $(seq 1 "$N"); do
+        printf '#include "%s"\nvoid log_error_%d() { stacktrace::Stacktrace::capture().print(); }\n' "$2" "$i" > "$1/tu_$i.cpp"
+    done
+    {
+        for i in $(seq 1 "$N"); do printf 'void log_error_%d();\n' "$i"; done
+        printf 'int main() {\n'
+        for i in $(seq 1 "$N"); do printf '    log_error_%d();\n' "$i"; done
+        printf '}\n'
+    } > "$1/main.cpp"
+}
+
+build() { # $1 = 目录, $2 = 额外参数
+    local begin end
+    begin=$(date +%s.%N)
+    for f in "$1"/*.cpp; do
+        g++ -std=c++11 $FLAGS $2 -I"$INC" -c "$f" -o "${f%.cpp}.o"
+    done
+    end=$(date +%s.%N)
+    g++ "$1"/*.o -o "$1/app" -ldl -lpthread
+    printf '%-14s compile %6.2f s (%d TUs), objects %7d KB, binary %6d KB\n' \
+        "$3" "$(awk "BEGIN { print $end - $begin }")" "$(ls "$1"/*.o | wc -l)" \
+        $(( $(cat "$1"/*.o | wc -c) / 1024 )) $(( $(stat -c %s "$1/app") / 1024 ))
+}
+
+gen "$DIR/header_only" sst.hpp
+gen "$DIR/compiled" sst_fwd.hpp
+printf '#define SST_IMPLEMENTATION\n#include "sst.hpp"\n' > "$DIR/compiled/sst_impl.cpp"
+
+echo "N=$N CXXFLAGS=$FLAGS"
+build "$DIR/header_only" "" "header-only"
+build "$DIR/compiled" "-DSST_COMPILED" "SST_COMPILED"
@@ -0,0 +1,24 @@
+// compile with: nothing
+// usage: core_summary <core file>
+// 打印 core 的崩溃摘要: 进程、信号以及每个线程符号化后的调用栈
+
+#include "../include/sst_core.hpp"
+
+#include <chrono>
+
+int main(const int argc, const char** argv) {
+    if (argc != 2) {
+        std::cerr << "usage: " << argv[0] << " <core file>" << std::endl;
+        return 2;
+    }
+    auto begin = std::chrono::steady_clock::now();
+    stacktrace::CoreFile core;
+    if (! core.open(argv[1])) {
+        std::cerr << core.error() << std::endl;
+        return 1;
+    }
+    std::cout << core.summary();
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - begin).count();
+    std::cout << "\n(" << ms << " ms)" << std::endl;
+    return 0;
+}
@@ -0,0 +1,55 @@
+// compile with: nothing
+// usage: ./perf_pid <pid> [seconds]
+// 用 perf_event_open 对目标进程采样, 输出出现次数最多的用户态调用栈
+
+#include "../include/sst_perf.hpp"
+
+#include <cstdio>
+#include <map>
+
+int main(const int argc, const char** argv) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s <pid> [seconds]\n", argv[0]);
+        return 1;
+    }
+    pid_t target_pid = atoi(argv[1]);
+    int seconds = argc > 2 ? atoi(argv[2]) : 3;
+
+    stacktrace::PerfSampler sampler(target_pid);
+    if (sampler.start() == 0) {
+        perror("perf_event_open");
+        return 1;
+    }
+
+    std::map<std::vector<uint64_t>, size_t> stacks;
+    size_t total = 0;
+    for (int i = 0; i < seconds * 10; ++i) {
+        total += sampler.poll(
+            [&](const stacktrace::PerfSample& s) {
+                ++stacks[std::vector<uint64_t>(s.user_ips, s.user_ips + s.user_nr)];
+            },
+            100);
+    }
+    sampler.stop();
+
+    std::vector<std::pair<size_t, const std::vector<uint64_t>*>> top;
+    for (const auto& kv : stacks) {
+        top.emplace_back(kv.second, &kv.first);
+    }
+    std::sort(top.begin(), top.end(), [](const std::pair<size_t, const std::vector<uint64_t>*>& a,
+                                         const std::pair<size_t, const std::vector<uint64_t>*>& b) {
+        return a.first > b.first;
+    });
+
+    std::cout << total << " samples, " << stacks.size() << " unique stacks, " << sampler.lost() << " lost\n";
+    for (size_t i = 0; i < top.size() && i < 5; ++i) {
+        std::cout << "--- " << top[i].first << " samples\n";
+        size_t index = 0;
+        for (uint64_t ip : *top[i].second) {
+            auto f = sampler.resolve(ip);
+            f.index = index++;
+            std::cout << f.to_string();
+        }
+    }
+    return 0;
+}
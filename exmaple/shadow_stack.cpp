@@ -0,0 +1,44 @@
+// compile with: -finstrument-functions -finstrument-functions-exclude-file-list=include/sst,/usr/include -DSST_SHADOW_STACK
+// 影子调用栈: Stacktrace::capture() 只复制 TLS 中由插桩钩子维护的调用栈, 与 backtrace() 的结果对照
+
+#include "../include/sst_shadow.hpp"
+
+#include <chrono>
+
+SST_DEFINE_SHADOW_STACK_HOOKS()
+
+using namespace stacktrace;
+
+static const int kLoops = 100000;
+
+template <typename St>
+double capture_ns() {
+    auto begin = std::chrono::steady_clock::now();
+    size_t frames = 0;
+    for (int i = 0; i < kLoops; ++i) frames += St::capture().size();
+    double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - begin).count();
+    return frames > 0 ? ns / kLoops : 0;
+}
+
+void handle_request(int depth) {
+    if (depth > 0) {
+        handle_request(depth - 1);
+        return;
+    }
+    std::cout << "shadow stack (depth " << shadow::depth() << "):" << std::endl;
+    Stacktrace::capture().print();
+    std::cout << "backtrace():" << std::endl;
+    BasicStacktrace<Stacktrace::kMaxFrames, ExecinfoUnwinder>::capture().print();
+
+    std::cout << "capture cost: shadow " << capture_ns<Stacktrace>() << " ns, backtrace() "
+              << capture_ns<BasicStacktrace<Stacktrace::kMaxFrames, ExecinfoUnwinder>>() << " ns" << std::endl;
+}
+
+void dispatch() {
+    handle_request(8);
+}
+
+int main() {
+    dispatch();
+    return 0;
+}
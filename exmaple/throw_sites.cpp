@@ -0,0 +1,67 @@
+// compile with: -fexceptions, 以及
+//   -static -DSST_THROW_WRAP -Wl,--wrap=__cxa_throw   (静态链接只能用 --wrap)
+//   -no-pie                                            (直接覆盖 __cxa_throw, 也能统计 libstdc++.so 内部的 throw)
+
+#include "../include/sst_throw.hpp"
+
+#include <cstdio>
+#include <stdexcept>
+#include <vector>
+
+#ifdef SST_THROW_WRAP
+SST_DEFINE_THROW_HOOK_WRAP()
+#else
+SST_DEFINE_THROW_HOOK_INTERPOSE()
+#endif
+
+// 用异常做控制流的典型写法
+int parse_digit(char c) {
+    if (c < '0' || c > '9') throw std::invalid_argument("not a digit");
+    return c - '0';
+}
+
+int at_or_zero(const std::vector<int>& v, size_t i) {
+    try {
+        return v.at(i); // 越界时由 libstdc++ 内部抛出 std::out_of_range
+    } catch (const std::out_of_range&) {
+        return 0;
+    }
+}
+
+int main(const int argc, const char** argv) {
+    stacktrace::ThrowTracerOptions options;
+    options.report_interval_ms = 0; // 最后手动取一次 top
+    options.max_captures_per_sec = 500;
+    stacktrace::ThrowTracer::start(options);
+
+    int sum = 0;
+    std::vector<int> v{1, 2, 3};
+    for (size_t i = 0; i < 100; ++i) {
+        sum += at_or_zero(v, i % 5);
+    }
+    // 2000 次抛出超过每秒 500 次的抓栈上限, 其余只按类型计数
+    const char* input = "12a4b";
+    for (int round = 0; round < 1000; ++round) {
+        for (const char* p = input; *p; ++p) {
+            try {
+                sum += parse_digit(*p);
+            } catch (const std::invalid_argument&) {
+            }
+        }
+    }
+
+    stacktrace::ThrowTracer::stop();
+    stacktrace::ThrowStats st = stacktrace::ThrowTracer::stats();
+    printf("sum %d, throws %lu, captured %lu, rate limited %lu\n",
+           sum,
+           static_cast<unsigned long>(st.throws),
+           static_cast<unsigned long>(st.captured),
+           static_cast<unsigned long>(st.rate_limited));
+    for (const auto& site : stacktrace::ThrowTracer::top(5)) {
+        printf("%lu x %s%s\n", static_cast<unsigned long>(site.count), site.type.c_str(), site.has_stack ? "" : " (stack not captured)");
+        for (const auto& f : site.frames) {
+            printf("    %s", f.to_string().c_str());
+        }
+    }
+    return 0;
+}
@@ -4,13 +4,19 @@
 // - Handles PIE vs non-PIE automatically
 // - Handles static vs dynamic linking automatically
 // - Resolves symbols in all loaded modules (including dlopen'd ones)
+// - Public types live in sst_fwd.hpp; build with -DSST_COMPILED to move the implementation into one TU
 
 #pragma once
 
+#include "sst_fwd.hpp"
+#include "sst_demangle.hpp"
+
 #include <cassert>
 #include <cstddef>
 
 #include <cstdint>
+#include <cstring>
+#include <cstdio>
 #include <ios>
 #include <unordered_map>
 #include <vector>
@@ -19,8 +25,12 @@
 #include <iostream>
 #include <algorithm>
 #include <array>
+#include <memory>
+#include <atomic>
 #include <fstream>
 
+#include <fnmatch.h>
+
 #include <limits.h>
 #include <execinfo.h>
 #include <unistd.h>
@@ -29,6 +39,11 @@
 #include <cxxabi.h>
 #include <elf.h>
 #include <link.h>
+#include <pthread.h>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
 
 #include <sys/types.h>
 #include <sys/mman.h>
@@ -39,56 +54,77 @@ namespace stacktrace {
 struct Symbol {
     uintptr_t addr;
     std::string name;
+    size_t size; // st_size, 可能为 0 (例如部分手写汇编函数)
 };
 
-struct RawFrame {
-    uintptr_t abs_addr = 0;
-    uintptr_t offset = 0;
-    std::string module;
-    bool has_symbol = false;
+// 只读映射的整个文件, 析构时解除映射
+class MappedFile {
+  public:
+    explicit MappedFile(const char* path) : data_(nullptr), size_(0) {
+        int fd = open(path, O_RDONLY);
+        if (fd < 0) return;
+        struct stat st;
+        if (fstat(fd, &st) == 0 && st.st_size > 0) {
+            void* data = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+            if (data != MAP_FAILED) {
+                data_ = static_cast<const char*>(data);
+                size_ = static_cast<size_t>(st.st_size);
+            }
+        }
+        close(fd);
+    }
 
-    RawFrame() : abs_addr(0), offset(0), module(), has_symbol(false) {}
-};
+    ~MappedFile() {
+        if (data_) munmap(const_cast<char*>(data_), size_);
+    }
 
-struct ResolvedFrame {
-    size_t index = 0;
-    uintptr_t abs_addr = 0;
-    std::string function;
-    std::string module;
-    uintptr_t offset = 0;
-    bool has_symbol = false;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
 
-    ResolvedFrame() : index(0), abs_addr(0), function(), module(), offset(0), has_symbol(false) {}
+    const char* data() const {
+        return data_;
+    }
 
-    std::string to_string() const {
-        std::ostringstream oss;
-        oss << "[" << index << "] ";
-        if (has_symbol) {
-            oss << function << "+0x" << std::hex << offset << std::dec;
-        } else {
-            oss << "(no symbol)";
-        }
-        oss << " in " << module;
-        oss << " (" << reinterpret_cast<void*>(abs_addr) << ")\n";
-        return oss.str();
+    size_t size() const {
+        return size_;
     }
+
+  private:
+    const char* data_;
+    size_t size_;
 };
 
-namespace {
-inline bool is_pie_binary(const char* path) {
+// [off, off + len) 是否完整地落在 size 字节的文件内 (不会溢出)
+inline bool in_file(uint64_t off, uint64_t len, size_t size) {
+    return off <= size && len <= size - off;
+}
+
+// data 是否以完整的 64 位 ELF 文件头开始
+inline bool is_elf64(const char* data, size_t size) {
+    return data && size >= sizeof(Elf64_Ehdr) && memcmp(data, ELFMAG, SELFMAG) == 0 && data[EI_CLASS] == ELFCLASS64;
+}
+
+// 读取文件头; 不是 64 位 ELF 文件 (例如进程 mmap 的数据文件、locale-archive) 时返回 false
+inline bool read_elf_header(const char* path, Elf64_Ehdr& ehdr) {
     int fd = open(path, O_RDONLY);
     if (fd < 0) return false;
-    Elf64_Ehdr ehdr;
-    if (read(fd, &ehdr, sizeof(ehdr)) != sizeof(ehdr)) {
-        close(fd);
-        return false;
-    }
+    bool ok = read(fd, &ehdr, sizeof(ehdr)) == sizeof(ehdr);
     close(fd);
-    return ehdr.e_type == ET_DYN;
+    return ok && is_elf64(reinterpret_cast<const char*>(&ehdr), sizeof(ehdr));
+}
+
+inline bool is_elf_file(const char* path) {
+    Elf64_Ehdr ehdr;
+    return read_elf_header(path, ehdr);
+}
+
+inline bool is_pie_binary(const char* path) {
+    Elf64_Ehdr ehdr;
+    return read_elf_header(path, ehdr) && ehdr.e_type == ET_DYN;
 }
 
 // 获取 -no-pie 主程序基地址
-uintptr_t get_nopie_main_base(const dl_phdr_info* info) {
+inline uintptr_t get_nopie_main_base(const dl_phdr_info* info) {
     assert(info->dlpi_addr == 0); // no-pie 的主程序 dlpi_addr 必然是 0, 但它不是加载地址
     uintptr_t base = UINTPTR_MAX;
     for (int i = 0; i < info->dlpi_phnum; ++i) {
@@ -101,7 +137,7 @@ uintptr_t get_nopie_main_base(const dl_phdr_info* info) {
     return base;
 }
 
-static std::string get_real_exe_path() {
+inline std::string get_real_exe_path() {
     std::ifstream ifs("/proc/self/cmdline", std::ios::in | std::ios::binary);
     if (! ifs) return "/proc/self/exe"; // fallback
 
@@ -110,7 +146,7 @@ static std::string get_real_exe_path() {
     return path.empty() ? "/proc/self/exe" : path;
 }
 
-static std::pair<uintptr_t, uintptr_t> get_addr_range_from_info(const dl_phdr_info* info) {
+inline std::pair<uintptr_t, uintptr_t> get_addr_range_from_info(const dl_phdr_info* info) {
     uintptr_t min_addr = static_cast<uintptr_t>(-1), max_addr = 0;
     for (int i = 0; i < info->dlpi_phnum; ++i) {
         /*
@@ -132,7 +168,14 @@ static std::pair<uintptr_t, uintptr_t> get_addr_range_from_info(const dl_phdr_in
     return {min_addr, max_addr};
 }
 
-inline std::string demangle(const char* name) {
+// 符号名先用不分配内存的 demangle_into(), 不支持的构造或结果超过 1KB 时退回 __cxa_demangle;
+// 不以 _Z 开头的 (typeid 的类型名等) 直接交给 __cxa_demangle, 失败时原样返回
+inline std::string demangle(const char* name, DemangleStyle style = DemangleStyle::Full) {
+    if (name[0] == '_' && name[1] == 'Z') {
+        char buf[1024];
+        size_t len = demangle_into(name, buf, sizeof(buf), style);
+        if (len > 0 && len < sizeof(buf)) return std::string(buf, len);
+    }
     int status = 0;
     char* realname = abi::__cxa_demangle(name, nullptr, nullptr, &status);
     std::string result = (status == 0 && realname) ? realname : name;
@@ -140,38 +183,165 @@ inline std::string demangle(const char* name) {
     return result;
 }
 
-inline std::vector<Symbol> load_symbols(const char* path, uintptr_t base) {
-    std::vector<Symbol> syms;
-    int fd = open(path, O_RDONLY);
-    if (fd < 0) return syms;
+inline std::atomic<DemangleStyle>& demangle_style_storage() {
+    static std::atomic<DemangleStyle> style(DemangleStyle::Full);
+    return style;
+}
 
-    struct stat st;
-    if (fstat(fd, &st) != 0) {
-        close(fd);
-        return syms;
+// 在一段 note 数据中查找 GNU build-id (NT_GNU_BUILD_ID)
+inline bool find_build_id_note(const char* notes, size_t size, std::string& out) {
+    size_t off = 0;
+    while (off + sizeof(Elf64_Nhdr) <= size) {
+        const auto* nhdr = reinterpret_cast<const Elf64_Nhdr*>(notes + off);
+        size_t name_off = off + sizeof(Elf64_Nhdr);
+        size_t desc_off = name_off + ((nhdr->n_namesz + 3) & ~size_t(3));
+        size_t next = desc_off + ((nhdr->n_descsz + 3) & ~size_t(3));
+        if (next > size) break;
+        if (nhdr->n_type == NT_GNU_BUILD_ID && nhdr->n_namesz == 4 && memcmp(notes + name_off, "GNU", 4) == 0) {
+            out.assign(notes + desc_off, nhdr->n_descsz);
+            return true;
+        }
+        off = next;
     }
+    return false;
+}
 
-    void* data = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
-    if (data == MAP_FAILED) {
-        close(fd);
-        return syms;
+// 读取 ELF 文件的 GNU build-id, 返回原始字节, 不存在时返回空串 (包括不是 ELF 或已损坏的文件)
+inline std::string read_build_id(const char* path) {
+    std::string id;
+    MappedFile file(path);
+    const char* raw = file.data();
+    size_t file_size = file.size();
+    if (! is_elf64(raw, file_size)) return id;
+
+    auto* ehdr = reinterpret_cast<const Elf64_Ehdr*>(raw);
+    // build-id 位于 PT_NOTE 段中, 即便去掉了 section header 也能找到
+    if (in_file(ehdr->e_phoff, uint64_t(ehdr->e_phnum) * sizeof(Elf64_Phdr), file_size)) {
+        auto* phdrs = reinterpret_cast<const Elf64_Phdr*>(raw + ehdr->e_phoff);
+        for (int i = 0; i < ehdr->e_phnum; ++i) {
+            if (phdrs[i].p_type != PT_NOTE || ! in_file(phdrs[i].p_offset, phdrs[i].p_filesz, file_size)) continue;
+            if (find_build_id_note(raw + phdrs[i].p_offset, phdrs[i].p_filesz, id)) break;
+        }
     }
+    return id;
+}
+
+inline std::string build_id_to_hex(const std::string& id) {
+    static const char digits[] = "0123456789abcdef";
+    std::string hex;
+    hex.reserve(id.size() * 2);
+    for (unsigned char c : id) {
+        hex.push_back(digits[c >> 4]);
+        hex.push_back(digits[c & 0xf]);
+    }
+    return hex;
+}
 
-    auto* ehdr = reinterpret_cast<Elf64_Ehdr*>(data);
-    auto* shdrs = reinterpret_cast<Elf64_Shdr*>(reinterpret_cast<char*>(data) + ehdr->e_shoff);
+// 符号表过滤内核: 依次写出 STT_FUNC 且 st_value != 0 的符号下标, 返回个数
+// out 至少要有 n + 8 个元素 (AVX2 版本每次整块写入 8 个下标)
+inline size_t symtab_filter_scalar(const Elf64_Sym* syms, size_t n, uint32_t* out, size_t first = 0) {
+    size_t k = 0;
+    for (size_t i = 0; i < n; ++i) {
+        out[k] = static_cast<uint32_t>(first + i); // 无分支: 总是写入, 只在命中时前进
+        k += static_cast<size_t>(ELF64_ST_TYPE(syms[i].st_info) == STT_FUNC) & static_cast<size_t>(syms[i].st_value != 0);
+    }
+    return k;
+}
 
-    Elf64_Sym* symtab = nullptr;
+#if defined(__x86_64__)
+// 8 位命中掩码 -> 把命中的 lane 依次排到前面的 permutevar8x32 控制字, 每个 lane 占 4 位
+inline const uint32_t* symtab_compress_lut() {
+    static const std::array<uint32_t, 256> lut = [] {
+        std::array<uint32_t, 256> t{};
+        for (uint32_t m = 0; m < 256; ++m) {
+            uint32_t packed = 0, k = 0;
+            for (uint32_t lane = 0; lane < 8; ++lane) {
+                if (m & (1u << lane)) packed |= lane << (4 * k++);
+            }
+            t[m] = packed;
+        }
+        return t;
+    }();
+    return lut.data();
+}
+
+// 每次处理 8 个 24 字节的符号: 以 gather 取出 st_info 所在的 8 字节与 st_value, 比较得到 8 位掩码,
+// 再用查表得到的 permute 模拟 compress-store
+__attribute__((target("avx2"))) inline size_t symtab_filter_avx2(const Elf64_Sym* syms, size_t n, uint32_t* out) {
+    static_assert(sizeof(Elf64_Sym) == 24 && offsetof(Elf64_Sym, st_info) == 4 && offsetof(Elf64_Sym, st_value) == 8,
+                  "unexpected Elf64_Sym layout");
+    const uint32_t* lut = symtab_compress_lut();
+    const long long* words = reinterpret_cast<const long long*>(syms); // 以 8 字节为单位, 每个符号 3 个
+    const __m256i type_mask = _mm256_set1_epi64x(0xfll << 32);         // st_info 的低 4 位
+    const __m256i func = _mm256_set1_epi64x(static_cast<long long>(STT_FUNC) << 32);
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    const __m256i nibbles = _mm256_setr_epi32(0, 4, 8, 12, 16, 20, 24, 28);
+    __m256i word_idx = _mm256_setr_epi64x(0, 3, 6, 9);
+    const __m256i step4 = _mm256_set1_epi64x(12);
+
+    size_t k = 0, i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i idx_hi = _mm256_add_epi64(word_idx, step4);
+        __m256i head_lo = _mm256_i64gather_epi64(words, word_idx, 8);
+        __m256i head_hi = _mm256_i64gather_epi64(words, idx_hi, 8);
+        __m256i value_lo = _mm256_i64gather_epi64(words + 1, word_idx, 8);
+        __m256i value_hi = _mm256_i64gather_epi64(words + 1, idx_hi, 8);
+        __m256i ok_lo = _mm256_andnot_si256(_mm256_cmpeq_epi64(value_lo, zero), _mm256_cmpeq_epi64(_mm256_and_si256(head_lo, type_mask), func));
+        __m256i ok_hi = _mm256_andnot_si256(_mm256_cmpeq_epi64(value_hi, zero), _mm256_cmpeq_epi64(_mm256_and_si256(head_hi, type_mask), func));
+        unsigned mask = static_cast<unsigned>(_mm256_movemask_pd(_mm256_castsi256_pd(ok_lo)))
+                        | (static_cast<unsigned>(_mm256_movemask_pd(_mm256_castsi256_pd(ok_hi))) << 4);
+
+        __m256i perm = _mm256_and_si256(_mm256_srlv_epi32(_mm256_set1_epi32(static_cast<int>(lut[mask])), nibbles), _mm256_set1_epi32(7));
+        __m256i ids = _mm256_add_epi32(_mm256_set1_epi32(static_cast<int>(i)), lanes);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + k), _mm256_permutevar8x32_epi32(ids, perm));
+        k += static_cast<size_t>(__builtin_popcount(mask));
+        word_idx = _mm256_add_epi64(idx_hi, step4);
+    }
+    return k + symtab_filter_scalar(syms + i, n - i, out + k, i);
+}
+#endif
+
+// 按 CPU 特性在运行时选择实现 (只检测一次)
+inline size_t symtab_filter(const Elf64_Sym* syms, size_t n, uint32_t* out) {
+#if defined(__x86_64__)
+    static const bool has_avx2 = [] {
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2") != 0;
+    }();
+    if (has_avx2) return symtab_filter_avx2(syms, n, out);
+#endif
+    return symtab_filter_scalar(syms, n, out);
+}
+
+// 文件头、节头表、符号表与字符串表的范围都对照文件大小检查, 不是 ELF 或已损坏的文件得到空表
+inline std::vector<Symbol> load_symbols(const char* path, uintptr_t base) {
+    std::vector<Symbol> syms;
+    MappedFile file(path);
+    const char* raw = file.data();
+    size_t file_size = file.size();
+    if (! is_elf64(raw, file_size)) return syms;
+
+    auto* ehdr = reinterpret_cast<const Elf64_Ehdr*>(raw);
+    if (! in_file(ehdr->e_shoff, uint64_t(ehdr->e_shnum) * sizeof(Elf64_Shdr), file_size)) return syms;
+    auto* shdrs = reinterpret_cast<const Elf64_Shdr*>(raw + ehdr->e_shoff);
+
+    const Elf64_Sym* symtab = nullptr;
     const char* strtab = nullptr;
     size_t nsyms = 0;
+    size_t strtab_size = 0;
 
     auto try_section = [&](uint32_t target_type) -> bool {
         for (int i = 0; i < ehdr->e_shnum; ++i) {
-            if (shdrs[i].sh_type == target_type) {
-                symtab = reinterpret_cast<Elf64_Sym*>(reinterpret_cast<char*>(data) + shdrs[i].sh_offset);
-                nsyms = shdrs[i].sh_size / sizeof(Elf64_Sym);
-                strtab = reinterpret_cast<const char*>(data) + shdrs[shdrs[i].sh_link].sh_offset;
-                return true;
-            }
+            const Elf64_Shdr& sh = shdrs[i];
+            if (sh.sh_type != target_type || sh.sh_link >= ehdr->e_shnum) continue;
+            const Elf64_Shdr& str_sh = shdrs[sh.sh_link];
+            if (! in_file(sh.sh_offset, sh.sh_size, file_size) || ! in_file(str_sh.sh_offset, str_sh.sh_size, file_size)) continue;
+            symtab = reinterpret_cast<const Elf64_Sym*>(raw + sh.sh_offset);
+            nsyms = sh.sh_size / sizeof(Elf64_Sym);
+            strtab = raw + str_sh.sh_offset;
+            strtab_size = str_sh.sh_size;
+            return true;
         }
         return false;
     };
@@ -183,21 +353,25 @@ inline std::vector<Symbol> load_symbols(const char* path, uintptr_t base) {
     }
 
     if (symtab && strtab) {
-        bool is_pie = is_pie_binary(path);
-        for (size_t i = 0; i < nsyms; ++i) {
-            const auto& s = symtab[i];
-            if (ELF64_ST_TYPE(s.st_info) == STT_FUNC && s.st_value > 0) {
-                // 如果是非 pie, 则符号地址就是绝对地址
-                // 如果是 ET_DYN, st_value 表示 相对地址, 必须加 base 才能得出真实的地址
-                uintptr_t symbol_addr = is_pie ? (s.st_value + base) : s.st_value;
-                syms.push_back({symbol_addr, strtab + s.st_name});
+        // 如果是非 pie, 则符号地址就是绝对地址
+        // 如果是 ET_DYN, st_value 表示 相对地址, 必须加 base 才能得出真实的地址
+        uintptr_t bias = ehdr->e_type == ET_DYN ? base : 0;
+
+        // 分块过滤出命中的下标再构造, 下标缓冲留在栈上 (L1 内), 不额外分配
+        // 按符号表顺序构造, strtab 通常也按此顺序排列, 读取是顺序的
+        const size_t kChunk = 256;
+        uint32_t hits[kChunk + 8];
+        for (size_t first = 0; first < nsyms; first += kChunk) {
+            size_t count = symtab_filter(symtab + first, std::min(kChunk, nsyms - first), hits);
+            for (size_t i = 0; i < count; ++i) {
+                const auto& s = symtab[first + hits[i]];
+                if (s.st_name >= strtab_size) continue;
+                const char* name = strtab + s.st_name;
+                syms.push_back({s.st_value + bias, std::string(name, strnlen(name, strtab_size - s.st_name)), static_cast<size_t>(s.st_size)});
             }
         }
     }
 
-    munmap(data, st.st_size);
-    close(fd);
-
     std::sort(syms.begin(), syms.end(), [](const Symbol& a, const Symbol& b) { return a.addr < b.addr; });
 
     return syms;
@@ -211,6 +385,190 @@ inline const Symbol* find_symbol(uintptr_t addr, const std::vector<Symbol>& symb
     return &(*it);
 }
 
+// GNU hash 函数, 见 https://sourceware.org/ml/binutils/2006-10/msg00377.html
+inline uint32_t gnu_hash(const char* name) {
+    uint32_t h = 5381;
+    for (const unsigned char* p = reinterpret_cast<const unsigned char*>(name); *p; ++p) {
+        h = (h << 5) + h + *p;
+    }
+    return h;
+}
+
+// 通过 .gnu_hash 精确查找导出的函数符号, 不需要构建任何索引; raw 为整个 ELF 文件的内容
+// 注意 .gnu_hash 只覆盖 .dynsym 中导出的符号, 查不到时调用方应退化到完整的符号表
+// 各节的偏移与大小、哈希表与符号的下标都对照文件大小检查, 截断或损坏的文件只会查不到
+inline bool gnu_hash_lookup(const char* raw, size_t file_size, const char* name, uintptr_t base, uintptr_t& addr, size_t& size) {
+    if (! raw || file_size < sizeof(Elf64_Ehdr) || memcmp(raw, ELFMAG, SELFMAG) != 0) return false;
+    auto* ehdr = reinterpret_cast<const Elf64_Ehdr*>(raw);
+    if (! in_file(ehdr->e_shoff, uint64_t(ehdr->e_shnum) * sizeof(Elf64_Shdr), file_size)) return false;
+    auto* shdrs = reinterpret_cast<const Elf64_Shdr*>(raw + ehdr->e_shoff);
+    size_t name_len = strlen(name);
+    uint32_t h = gnu_hash(name);
+
+    for (int i = 0; i < ehdr->e_shnum; ++i) {
+        const Elf64_Shdr& hash_sh = shdrs[i];
+        if (hash_sh.sh_type != SHT_GNU_HASH || hash_sh.sh_link >= ehdr->e_shnum) continue;
+        const Elf64_Shdr& dynsym_sh = shdrs[hash_sh.sh_link];
+        if (dynsym_sh.sh_link >= ehdr->e_shnum) continue;
+        const Elf64_Shdr& dynstr_sh = shdrs[dynsym_sh.sh_link];
+        if (! in_file(hash_sh.sh_offset, hash_sh.sh_size, file_size) || ! in_file(dynsym_sh.sh_offset, dynsym_sh.sh_size, file_size)
+            || ! in_file(dynstr_sh.sh_offset, dynstr_sh.sh_size, file_size) || hash_sh.sh_size < 4 * sizeof(uint32_t)) {
+            continue;
+        }
+        auto* dynsym = reinterpret_cast<const Elf64_Sym*>(raw + dynsym_sh.sh_offset);
+        uint64_t nsyms = dynsym_sh.sh_size / sizeof(Elf64_Sym);
+        const char* dynstr = raw + dynstr_sh.sh_offset;
+
+        // 布局: nbuckets, symoffset, bloom_size, bloom_shift, bloom[bloom_size], buckets[nbuckets], chain[]
+        auto* hdr = reinterpret_cast<const uint32_t*>(raw + hash_sh.sh_offset);
+        uint32_t nbuckets = hdr[0], symoffset = hdr[1], bloom_size = hdr[2], bloom_shift = hdr[3];
+        uint64_t chain_off = 4 * sizeof(uint32_t) + uint64_t(bloom_size) * sizeof(uint64_t) + uint64_t(nbuckets) * sizeof(uint32_t);
+        if (nbuckets == 0 || bloom_size == 0 || chain_off > hash_sh.sh_size) continue;
+        auto* bloom = reinterpret_cast<const uint64_t*>(hdr + 4);
+        auto* buckets = reinterpret_cast<const uint32_t*>(bloom + bloom_size);
+        const uint32_t* chain = buckets + nbuckets;
+        uint64_t nchain = (hash_sh.sh_size - chain_off) / sizeof(uint32_t);
+
+        uint64_t word = bloom[(h / 64) % bloom_size];
+        uint64_t mask = (uint64_t(1) << (h % 64)) | (uint64_t(1) << ((h >> bloom_shift) % 64));
+        if ((word & mask) != mask) continue; // bloom filter 判定一定不存在
+
+        uint32_t idx = buckets[h % nbuckets];
+        if (idx < symoffset) continue;
+        for (; idx < nsyms && idx - symoffset < nchain; ++idx) {
+            uint32_t h2 = chain[idx - symoffset];
+            const Elf64_Sym& s = dynsym[idx];
+            if ((h | 1) == (h2 | 1) && ELF64_ST_TYPE(s.st_info) == STT_FUNC && s.st_value > 0
+                && in_file(s.st_name, name_len + 1, dynstr_sh.sh_size) && memcmp(name, dynstr + s.st_name, name_len + 1) == 0) {
+                addr = ehdr->e_type == ET_DYN ? (s.st_value + base) : s.st_value;
+                size = static_cast<size_t>(s.st_size);
+                return true;
+            }
+            if (h2 & 1) break; // 链尾
+        }
+    }
+    return false;
+}
+
+inline bool gnu_hash_lookup(const char* path, const char* name, uintptr_t base, uintptr_t& addr, size_t& size) {
+    MappedFile file(path);
+    return gnu_hash_lookup(file.data(), file.size(), name, base, addr, size);
+}
+
+inline bool starts_with(const std::string& s, const std::string& prefix) {
+    return s.size() >= prefix.size() && s.compare(0, prefix.size(), prefix) == 0;
+}
+
+// 全局的符号内存预算: 超出预算时, 最久未使用的模块的符号表会被释放, 下次访问时透明地重新加载
+class SymbolBudget {
+  public:
+    static SymbolBudget& instance() {
+        static SymbolBudget b;
+        return b;
+    }
+
+    void set_budget(size_t bytes) {
+        budget_.store(bytes, std::memory_order_relaxed);
+    }
+
+    bool over_budget() const {
+        size_t b = budget_.load(std::memory_order_relaxed);
+        return b != 0 && footprint_.load(std::memory_order_relaxed) > b;
+    }
+
+    uint64_t tick() {
+        return clock_.fetch_add(1, std::memory_order_relaxed) + 1;
+    }
+
+    void charge(size_t bytes) {
+        footprint_.fetch_add(bytes, std::memory_order_relaxed);
+    }
+
+    void release(size_t bytes) {
+        footprint_.fetch_sub(bytes, std::memory_order_relaxed);
+    }
+
+    void on_load(bool reload) {
+        resident_.fetch_add(1, std::memory_order_relaxed);
+        if (reload) reloads_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void on_unload(bool evicted) {
+        resident_.fetch_sub(1, std::memory_order_relaxed);
+        if (evicted) evictions_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    SymbolMemoryStats stats() const {
+        return SymbolMemoryStats{footprint_.load(std::memory_order_relaxed),
+                                 budget_.load(std::memory_order_relaxed),
+                                 resident_.load(std::memory_order_relaxed),
+                                 evictions_.load(std::memory_order_relaxed),
+                                 reloads_.load(std::memory_order_relaxed)};
+    }
+
+  private:
+    SymbolBudget() : budget_(0), footprint_(0), resident_(0), clock_(0), evictions_(0), reloads_(0) {}
+
+    std::atomic<size_t> budget_;
+    std::atomic<size_t> footprint_;
+    std::atomic<size_t> resident_;
+    std::atomic<uint64_t> clock_;
+    std::atomic<uint64_t> evictions_;
+    std::atomic<uint64_t> reloads_;
+};
+
+// 一个模块计入 SymbolBudget 的字节数与驻留状态; 随 Module 移动时转移, 析构时归还
+class SymbolCharge {
+  public:
+    SymbolCharge() : bytes_(0), resident_(false) {}
+    SymbolCharge(const SymbolCharge& o) : bytes_(o.bytes_), resident_(o.resident_) {
+        SymbolBudget::instance().charge(bytes_);
+        if (resident_) SymbolBudget::instance().on_load(false);
+    }
+    SymbolCharge(SymbolCharge&& o) noexcept : bytes_(o.bytes_), resident_(o.resident_) {
+        o.bytes_ = 0;
+        o.resident_ = false;
+    }
+    SymbolCharge& operator=(SymbolCharge o) noexcept {
+        std::swap(bytes_, o.bytes_);
+        std::swap(resident_, o.resident_);
+        return *this;
+    }
+    ~SymbolCharge() {
+        unload(false);
+    }
+
+    void load(bool reload) {
+        if (! resident_) SymbolBudget::instance().on_load(reload);
+        resident_ = true;
+    }
+
+    void unload(bool evicted) {
+        SymbolBudget::instance().release(bytes_);
+        bytes_ = 0;
+        if (resident_) SymbolBudget::instance().on_unload(evicted);
+        resident_ = false;
+    }
+
+    void add(size_t bytes) {
+        bytes_ += bytes;
+        SymbolBudget::instance().charge(bytes);
+    }
+
+    size_t bytes() const {
+        return bytes_;
+    }
+
+  private:
+    size_t bytes_;
+    bool resident_;
+};
+
+inline size_t string_heap_bytes(const std::string& s) {
+    // 短字符串存放在对象内部 (SSO), 不占额外的堆内存
+    return s.capacity() > 15 ? s.capacity() + 1 : 0;
+}
+
 struct Module {
     std::string path;
     uintptr_t base;
@@ -218,26 +576,230 @@ struct Module {
     std::vector<Symbol> symbols;
     bool symbols_loaded = false;
 
+    // symbols 下标 -> demangled 名, 只缓存解析过的符号; 节点式容器保证 FrameView 持有的指针稳定
+    std::unordered_map<uint32_t, std::string> demangled_cache;
+
+    // 名字 -> 符号 的反查索引, 直到第一次按名字查询时才会构建
+    std::vector<uint32_t> by_mangled;                           // symbols 下标, 按 mangled 名排序
+    std::vector<std::pair<std::string, uint32_t>> by_demangled; // (demangled 名, symbols 下标), 按 demangled 名排序
+    bool mangled_index_built = false;
+    bool demangled_index_built = false;
+
+    // 符号内存预算: 以上符号数据的估算字节数, 最近一次使用的时间戳, 是否曾被预算释放过
+    SymbolCharge charge;
+    uint64_t last_used = 0;
+    bool evicted = false;
+
+    // 按 mangled 名查找导出符号时映射的文件, 第一次查找时建立, 之后复用 (复制出的 Module 共享同一份)
+    std::shared_ptr<const MappedFile> file;
+
     Module(const std::string& path, uintptr_t base, size_t size, std::vector<Symbol> symbols = {}, bool loaded = false)
-        : path(path), base(base), size(size), symbols(std::move(symbols)), symbols_loaded(loaded) {}
+        : path(path), base(base), size(size), symbols(std::move(symbols)), symbols_loaded(loaded), demangled_cache(), by_mangled(),
+          by_demangled(), mangled_index_built(false), demangled_index_built(false), charge(), last_used(0), evicted(false), file() {
+        if (loaded) on_symbols_loaded();
+    }
 
     void ensure_symbols_loaded() {
         if (! symbols_loaded) {
             symbols = load_symbols(path.c_str(), base);
             symbols_loaded = true;
+            on_symbols_loaded();
         }
+        last_used = SymbolBudget::instance().tick();
+    }
+
+    // 释放符号表及其派生的缓存与索引, 下次 ensure_symbols_loaded() 时重新加载
+    void release_symbols(bool by_budget = true) {
+        if (! symbols_loaded) return;
+        std::vector<Symbol>().swap(symbols);
+        std::unordered_map<uint32_t, std::string>().swap(demangled_cache);
+        std::vector<uint32_t>().swap(by_mangled);
+        std::vector<std::pair<std::string, uint32_t>>().swap(by_demangled);
+        symbols_loaded = mangled_index_built = demangled_index_built = false;
+        charge.unload(by_budget);
+        evicted = evicted || by_budget;
     }
 
     bool contains(uintptr_t addr) const {
         return addr >= base && addr < base + size;
     }
+
+    // 第一次访问时 demangle 并缓存, 之后的访问不再分配内存
+    const std::string& demangled_name(const Symbol* sym) {
+        uint32_t idx = static_cast<uint32_t>(sym - symbols.data());
+        auto it = demangled_cache.find(idx);
+        if (it == demangled_cache.end()) {
+            it = demangled_cache.emplace(idx, demangle(sym->name.c_str(), demangle_style_storage().load(std::memory_order_relaxed))).first;
+            // 节点 + 字符串的估算大小
+            charge.add(sizeof(std::pair<const uint32_t, std::string>) + 2 * sizeof(void*) + string_heap_bytes(it->second));
+        }
+        return it->second;
+    }
+
+    // 按名字查找本模块中的函数, 返回其完整的 [start, end) 区间
+    std::vector<SymbolRange> lookup(const std::string& pattern, NameMatch mode) {
+        std::vector<SymbolRange> out;
+
+        if (mode == NameMatch::Mangled) {
+            // 导出符号直接走 .gnu_hash, 不必加载整个符号表
+            uintptr_t addr = 0;
+            size_t sym_size = 0;
+            if (! file) file = std::make_shared<const MappedFile>(path.c_str());
+            if (gnu_hash_lookup(file->data(), file->size(), pattern.c_str(), base, addr, sym_size) && sym_size > 0) {
+                out.push_back(make_range(addr, addr + sym_size, pattern));
+                return out;
+            }
+
+            ensure_mangled_index();
+            auto range = std::equal_range(
+                by_mangled.begin(), by_mangled.end(), pattern, MangledLess{&symbols});
+            for (auto it = range.first; it != range.second; ++it) {
+                out.push_back(range_of(*it));
+            }
+            return out;
+        }
+
+        ensure_demangled_index();
+        // glob 模式中第一个通配符之前的部分是字面前缀, 可借助有序表缩小扫描范围
+        std::string literal = pattern;
+        if (mode == NameMatch::Glob) {
+            literal = pattern.substr(0, pattern.find_first_of("*?[\\"));
+        }
+
+        auto it = std::lower_bound(by_demangled.begin(),
+                                   by_demangled.end(),
+                                   literal,
+                                   [](const std::pair<std::string, uint32_t>& e, const std::string& key) {
+                                       return e.first < key;
+                                   });
+        for (; it != by_demangled.end(); ++it) {
+            const std::string& name = it->first;
+            if (mode == NameMatch::Demangled) {
+                if (name != pattern) break;
+            } else {
+                if (! starts_with(name, literal)) break;
+                if (mode == NameMatch::Glob && fnmatch(pattern.c_str(), name.c_str(), 0) != 0) continue;
+            }
+            out.push_back(range_of(it->second));
+        }
+        return out;
+    }
+
+  private:
+    void on_symbols_loaded() {
+        size_t bytes = symbols.capacity() * sizeof(Symbol);
+        for (const auto& sym : symbols) {
+            bytes += string_heap_bytes(sym.name);
+        }
+        charge.add(bytes);
+        charge.load(evicted);
+    }
+
+    struct MangledLess {
+        const std::vector<Symbol>* syms;
+        bool operator()(uint32_t a, uint32_t b) const {
+            return (*syms)[a].name < (*syms)[b].name;
+        }
+        bool operator()(uint32_t a, const std::string& key) const {
+            return (*syms)[a].name < key;
+        }
+        bool operator()(const std::string& key, uint32_t b) const {
+            return key < (*syms)[b].name;
+        }
+    };
+
+    void ensure_mangled_index() {
+        if (mangled_index_built) return;
+        ensure_symbols_loaded();
+        by_mangled.resize(symbols.size());
+        for (size_t i = 0; i < symbols.size(); ++i) {
+            by_mangled[i] = static_cast<uint32_t>(i);
+        }
+        std::sort(by_mangled.begin(), by_mangled.end(), MangledLess{&symbols});
+        mangled_index_built = true;
+        charge.add(by_mangled.capacity() * sizeof(uint32_t));
+    }
+
+    void ensure_demangled_index() {
+        if (demangled_index_built) return;
+        ensure_symbols_loaded();
+        by_demangled.reserve(symbols.size());
+        for (size_t i = 0; i < symbols.size(); ++i) {
+            by_demangled.emplace_back(demangle(symbols[i].name.c_str()), static_cast<uint32_t>(i));
+        }
+        std::sort(by_demangled.begin(), by_demangled.end());
+        demangled_index_built = true;
+        size_t bytes = by_demangled.capacity() * sizeof(by_demangled[0]);
+        for (const auto& e : by_demangled) {
+            bytes += string_heap_bytes(e.first);
+        }
+        charge.add(bytes);
+    }
+
+    SymbolRange make_range(uintptr_t start, uintptr_t end, const std::string& name) const {
+        SymbolRange r;
+        r.start = start;
+        r.end = end;
+        r.name = name;
+        r.module = path;
+        return r;
+    }
+
+    // st_size 为 0 时, 以下一个更高地址的符号 (或模块末尾) 作为区间终点
+    SymbolRange range_of(uint32_t idx) const {
+        const Symbol& sym = symbols[idx];
+        uintptr_t end = sym.addr + sym.size;
+        if (sym.size == 0) {
+            end = base + size;
+            for (size_t j = idx + 1; j < symbols.size(); ++j) {
+                if (symbols[j].addr > sym.addr) {
+                    end = symbols[j].addr;
+                    break;
+                }
+            }
+        }
+        return make_range(sym.addr, end, sym.name);
+    }
 };
 
 using Modules = std::vector<Module>;
 
+// 超出预算时按 LRU 释放 modules 中的符号表, keep (正在使用的模块) 除外
+// 预算是全局的, 但只能从调用方给出的这组模块中释放
+inline void enforce_symbol_budget(Modules& modules, const Module* keep) {
+    auto& budget = SymbolBudget::instance();
+    while (budget.over_budget()) {
+        Module* victim = nullptr;
+        for (auto& m : modules) {
+            if (&m == keep || ! m.symbols_loaded) continue;
+            if (! victim || m.last_used < victim->last_used) victim = &m;
+        }
+        if (! victim) break;
+        victim->release_symbols();
+    }
+}
+
+// 非文件映射代码 (JIT 等) 的符号来源, 只在地址不属于任何 ELF 模块时查询
+struct ProvidedSymbol {
+    uintptr_t start = 0;
+    size_t size = 0;
+    const std::string* name = nullptr;   // 在 provider 销毁或重置之前有效
+    const std::string* source = nullptr; // 作为 module 显示, 例如 /tmp/perf-<pid>.map
+
+    ProvidedSymbol() = default;
+};
+
+class SymbolProvider {
+  public:
+    virtual ~SymbolProvider() {}
+
+    // pid 为被解析的进程 (自身或 resolve_on_pid 的目标); 可能被多个线程同时调用
+    virtual bool find(pid_t pid, uintptr_t addr, ProvidedSymbol& out) = 0;
+};
+
 class ModuleManager {
   public:
-    ModuleManager() : initialized_(false), modules_{} {}
+    ModuleManager() : initialized_(false), modules_{}, providers_{} {}
 
     static ModuleManager& instance() {
         static ModuleManager m;
@@ -253,12 +815,33 @@ class ModuleManager {
         return modules_;
     }
 
+    // 预算调低后立即按 LRU 释放已加载的符号表
+    void trim_symbols() {
+        if (initialized_) enforce_symbol_budget(modules_, nullptr);
+    }
+
     // for after dlopen(), new modules has been install/uninstall so `modules_` cache is old
     void clear() {
         initialized_ = false;
         modules_.clear();
     }
 
+    // 注册额外的符号来源, 按注册顺序查询; 应在开始解析之前完成, clear() 不会移除
+    void add_symbol_provider(std::shared_ptr<SymbolProvider> provider) {
+        providers_.push_back(std::move(provider));
+    }
+
+    void clear_symbol_providers() {
+        providers_.clear();
+    }
+
+    bool find_provided_symbol(pid_t pid, uintptr_t addr, ProvidedSymbol& out) const {
+        for (const auto& p : providers_) {
+            if (p->find(pid ? pid : getpid(), addr, out)) return true;
+        }
+        return false;
+    }
+
     // load modules of target program
     // could be used to load modules of self-program or target-program
     static void load_modules(Modules& modules, pid_t target_pid) {
@@ -274,6 +857,7 @@ class ModuleManager {
   private:
     bool initialized_;
     Modules modules_;
+    std::vector<std::shared_ptr<SymbolProvider>> providers_;
 
     static void load_modules_from_dl_iter(Modules& modules) {
         dl_iterate_phdr(
@@ -369,135 +953,215 @@ class ModuleManager {
     }
 };
 
-} // namespace
-
-class Stacktrace {
-    static constexpr size_t kMaxFrames = 32;
-
-  private:
-    static ResolvedFrame resolve_with_modules(void* address, Modules& modules) {
-        uintptr_t addr = reinterpret_cast<uintptr_t>(address);
-        ResolvedFrame f;
-        f.abs_addr = addr;
-        for (auto& m : modules) {
-            if (m.contains(addr)) {
-                m.ensure_symbols_loaded();
-                auto* sym = find_symbol(addr, m.symbols);
-                if (sym) {
-                    f.has_symbol = true;
-                    f.offset = addr - sym->addr;
-                    f.function = demangle(sym->name.c_str());
-                    f.module = m.path;
-                } else {
-                    f.module = m.path;
-                }
-                break;
+// pid 为 modules 所属的进程, 0 表示自身, 只用于查询 SymbolProvider
+inline ResolvedFrame resolve_with_modules(void* address, Modules& modules, pid_t pid = 0) {
+    uintptr_t addr = reinterpret_cast<uintptr_t>(address);
+    ResolvedFrame f;
+    f.abs_addr = addr;
+    for (auto& m : modules) {
+        if (m.contains(addr)) {
+            m.ensure_symbols_loaded();
+            enforce_symbol_budget(modules, &m);
+            auto* sym = find_symbol(addr, m.symbols);
+            if (sym) {
+                f.has_symbol = true;
+                f.offset = addr - sym->addr;
+                f.function = m.demangled_name(sym);
+                f.module = m.path;
+            } else {
+                f.module = m.path;
             }
+            break;
         }
-        return f;
     }
+    ProvidedSymbol ps;
+    if (f.module.empty() && ModuleManager::instance().find_provided_symbol(pid, addr, ps)) {
+        f.has_symbol = true;
+        f.offset = addr - ps.start;
+        f.function = *ps.name;
+        f.module = *ps.source;
+    }
+    return f;
+}
 
-    static RawFrame resolve_to_raw_with_modules(void* address, const Modules& modules) {
-        uintptr_t addr = reinterpret_cast<uintptr_t>(address);
-        RawFrame f;
-        f.abs_addr = addr;
-        for (auto& m : modules) {
-            // rawframe 不需要 ensure_symbols_loaded 解析符号
-            if (m.contains(addr)) {
-                f.has_symbol = true;
-                // 虽然有点低效, 但必须逐个 m.path 都要调用
-                if (is_pie_binary(m.path.c_str())) {
-                    f.offset = addr - m.base;
-                } else {
-                    f.offset = addr;
-                }
-                f.module = m.path;
-
-                break;
+inline void resolve_view_with_modules(void* address, Modules& modules, FrameView& v, pid_t pid = 0) {
+    uintptr_t addr = reinterpret_cast<uintptr_t>(address);
+    v = FrameView{0, addr, 0, "", 0, "", 0, false};
+    for (auto& m : modules) {
+        if (m.contains(addr)) {
+            m.ensure_symbols_loaded();
+            enforce_symbol_budget(modules, &m);
+            v.module = m.path.c_str();
+            v.module_len = m.path.size();
+            auto* sym = find_symbol(addr, m.symbols);
+            if (sym) {
+                const std::string& name = m.demangled_name(sym);
+                v.has_symbol = true;
+                v.offset = addr - sym->addr;
+                v.function = name.c_str();
+                v.function_len = name.size();
             }
+            break;
         }
-
-        return f;
     }
+    ProvidedSymbol ps;
+    if (v.module_len == 0 && ModuleManager::instance().find_provided_symbol(pid, addr, ps)) {
+        v.has_symbol = true;
+        v.offset = addr - ps.start;
+        v.function = ps.name->c_str();
+        v.function_len = ps.name->size();
+        v.module = ps.source->c_str();
+        v.module_len = ps.source->size();
+    }
+}
 
-  public:
-    static Stacktrace capture(size_t max_frames = kMaxFrames) {
-        Stacktrace st;
-        if (max_frames > st.frames_.size()) {
-            max_frames = st.frames_.size(); // 确保不越界
+inline RawFrame resolve_to_raw_with_modules(void* address, const Modules& modules) {
+    uintptr_t addr = reinterpret_cast<uintptr_t>(address);
+    RawFrame f;
+    f.abs_addr = addr;
+    for (auto& m : modules) {
+        // rawframe 不需要 ensure_symbols_loaded 解析符号
+        if (m.contains(addr)) {
+            f.has_symbol = true;
+            // 虽然有点低效, 但必须逐个 m.path 都要调用
+            if (is_pie_binary(m.path.c_str())) {
+                f.offset = addr - m.base;
+            } else {
+                f.offset = addr;
+            }
+            f.module = m.path;
+
+            break;
         }
-        st.size_ = ::backtrace(st.frames_.data(), static_cast<int>(max_frames));
-        return st;
     }
 
-    static void clear_modules_cache() {
-        ModuleManager::instance().clear();
-    }
+    return f;
+}
 
-    static ResolvedFrame resolve(void* address) {
-        auto& mods = ModuleManager::instance().load_self_modules();
-        return resolve_with_modules(address, mods);
+inline std::vector<SymbolRange> lookup_with_modules(const std::string& pattern, NameMatch mode, Modules& modules) {
+    std::vector<SymbolRange> out;
+    for (auto& m : modules) {
+        auto found = m.lookup(pattern, mode);
+        out.insert(out.end(), found.begin(), found.end());
+        enforce_symbol_budget(modules, &m);
     }
+    return out;
+}
 
-    static RawFrame resolve_to_raw(void* address) {
-        auto& mods = ModuleManager::instance().load_self_modules();
-        return resolve_to_raw_with_modules(address, mods);
-    }
+#if ! defined(SST_COMPILED) || defined(SST_IMPLEMENTATION)
 
-    static std::vector<ResolvedFrame> resolve_on_pid(const std::vector<void*>& addr_batch, pid_t target_pid) {
-        std::vector<ResolvedFrame> out;
-        Modules mods;
-        ModuleManager::load_modules(mods, target_pid);
-        const std::size_t batch_count = addr_batch.size();
-        for (std::size_t i = 0; i < batch_count; i++) {
-            auto rf = resolve_with_modules(addr_batch[i], mods);
-            out.push_back(std::move(rf));
-        }
-        return out;
+SST_API std::string ResolvedFrame::to_string() const {
+    std::ostringstream oss;
+    oss << "[" << index << "] ";
+    if (has_symbol) {
+        oss << function << "+0x" << std::hex << offset << std::dec;
+    } else {
+        oss << "(no symbol)";
     }
+    oss << " in " << module;
+    oss << " (" << reinterpret_cast<void*>(abs_addr) << ")\n";
+    return oss.str();
+}
 
-    static std::vector<RawFrame> resolve_to_raw_on_pid(const std::vector<void*>& addr_batch, pid_t target_pid) {
-        std::vector<RawFrame> out;
-        Modules mods;
-        ModuleManager::load_modules(mods, target_pid);
-        const std::size_t batch_count = addr_batch.size();
-        for (std::size_t i = 0; i < batch_count; i++) {
-            auto rf = resolve_to_raw_with_modules(addr_batch[i], mods);
-            out.push_back(std::move(rf));
+SST_API StackBounds current_stack_bounds() {
+    static thread_local StackBounds bounds = {0, 0};
+    if (bounds.high == 0) {
+        // 每个线程只查询一次 (主线程会读 /proc/self/maps, 比较慢)
+        pthread_attr_t attr;
+        if (pthread_getattr_np(pthread_self(), &attr) == 0) {
+            void* addr = nullptr;
+            size_t size = 0;
+            if (pthread_attr_getstack(&attr, &addr, &size) == 0) {
+                bounds.low = reinterpret_cast<uintptr_t>(addr);
+                bounds.high = bounds.low + size;
+            }
+            pthread_attr_destroy(&attr);
         }
-        return out;
     }
+    return bounds;
+}
 
-    std::vector<RawFrame> get_raw_frames() const {
-        auto& mods = ModuleManager::instance().load_self_modules();
-        std::vector<RawFrame> out;
-        for (size_t i = 0; i < size_; ++i) {
-            auto rf = resolve_to_raw_with_modules(frames_[i], mods);
-            out.push_back(std::move(rf));
-        }
-        return out;
+SST_API ResolvedFrame ModuleResolver::resolve(void* address) {
+    auto& mods = ModuleManager::instance().load_self_modules();
+    return resolve_with_modules(address, mods);
+}
+
+SST_API RawFrame ModuleResolver::resolve_to_raw(void* address) {
+    auto& mods = ModuleManager::instance().load_self_modules();
+    return resolve_to_raw_with_modules(address, mods);
+}
+
+SST_API void ModuleResolver::resolve_view(void* address, FrameView& view) {
+    auto& mods = ModuleManager::instance().load_self_modules();
+    resolve_view_with_modules(address, mods, view);
+}
+
+SST_API void ModuleResolver::clear_cache() {
+    ModuleManager::instance().clear();
+}
+
+SST_API void set_symbol_memory_budget(size_t bytes) {
+    SymbolBudget::instance().set_budget(bytes);
+    ModuleManager::instance().trim_symbols();
+}
+
+SST_API SymbolMemoryStats symbol_memory_stats() {
+    return SymbolBudget::instance().stats();
+}
+
+SST_API void set_demangle_style(DemangleStyle style) {
+    if (demangle_style_storage().exchange(style) != style) ModuleManager::instance().clear();
+}
+
+SST_API DemangleStyle demangle_style() {
+    return demangle_style_storage().load(std::memory_order_relaxed);
+}
+
+SST_API std::vector<ResolvedFrame> resolve_on_pid(const std::vector<void*>& addr_batch, pid_t target_pid) {
+    std::vector<ResolvedFrame> out;
+    Modules mods;
+    ModuleManager::load_modules(mods, target_pid);
+    const std::size_t batch_count = addr_batch.size();
+    for (std::size_t i = 0; i < batch_count; i++) {
+        auto rf = resolve_with_modules(addr_batch[i], mods, target_pid);
+        out.push_back(std::move(rf));
     }
+    return out;
+}
 
-    std::vector<ResolvedFrame> get_frames() const {
-        auto& mods = ModuleManager::instance().load_self_modules();
-        std::vector<ResolvedFrame> out;
-        for (size_t i = 0; i < size_; ++i) {
-            auto f = resolve_with_modules(frames_[i], mods);
-            f.index = i;
-            out.push_back(std::move(f));
-        }
-        return out;
+SST_API std::vector<RawFrame> resolve_to_raw_on_pid(const std::vector<void*>& addr_batch, pid_t target_pid) {
+    std::vector<RawFrame> out;
+    Modules mods;
+    ModuleManager::load_modules(mods, target_pid);
+    const std::size_t batch_count = addr_batch.size();
+    for (std::size_t i = 0; i < batch_count; i++) {
+        auto rf = resolve_to_raw_with_modules(addr_batch[i], mods);
+        out.push_back(std::move(rf));
     }
+    return out;
+}
 
-    void print(std::ostream& os = std::cout) const {
-        for (const auto& f : get_frames()) {
-            os << f.to_string();
-        }
+SST_API std::vector<SymbolRange> find_symbols(const std::string& pattern, NameMatch mode) {
+    auto& mods = ModuleManager::instance().load_self_modules();
+    return lookup_with_modules(pattern, mode, mods);
+}
+
+SST_API std::vector<SymbolRange> find_symbols_on_pid(const std::string& pattern, NameMatch mode, pid_t target_pid) {
+    Modules mods;
+    ModuleManager::load_modules(mods, target_pid);
+    return lookup_with_modules(pattern, mode, mods);
+}
+
+SST_API void print_frames(std::ostream& os, const std::vector<ResolvedFrame>& frames) {
+    for (const auto& f : frames) {
+        os << f.to_string();
     }
+}
 
-  private:
-    std::array<void*, kMaxFrames> frames_{};
-    size_t size_ = 0;
-};
+SST_API void print_frames(const std::vector<ResolvedFrame>& frames) {
+    print_frames(std::cout, frames);
+}
+
+#endif // ! SST_COMPILED || SST_IMPLEMENTATION
 
 } // namespace stacktrace
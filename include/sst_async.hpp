@@ -0,0 +1,388 @@
+// sst_async.hpp - 异步符号化队列: 请求线程只抓栈并入队, 后台线程批量解析后交付结果
+// - 队列是定长槽位组成的有界多生产者 / 单消费者无锁环形队列 (Vyukov), 入队只是抢占槽位、复制地址、发布 seq;
+//   后台线程空闲时才需要唤醒, 否则入队不加锁, 也没有系统调用
+// - 后台线程一次取出至多 max_batch 个栈, 同一批中相同的地址只解析一次; 使用自己的模块表,
+//   不与业务线程共享 ModuleManager, 遇到未知地址且 dlopen / dlclose 过时重新加载模块表
+// - 结果按入队顺序在后台线程中交给回调 (或 std::future), 格式化 (to_string) 也可以放在回调里完成
+// - 队列满时的策略: 丢弃 (Drop)、等待 (Block) 或在请求线程中立即给出只含地址的结果 (RawAddresses);
+//   无论入队与否, 回调都恰好被调用一次
+// 注意:
+// - 回调在后台线程中执行, 不要在回调中调用 flush(), Block 策略下回调中的 submit() 不会等待
+// - 捕获超过 16 字节的 lambda 构造 std::function 时会分配内存; 每个栈至多保留 async::kMaxFrames 帧
+//
+//   stacktrace::AsyncResolver resolver;
+//   resolver.submit(stacktrace::Stacktrace::capture(), [](const stacktrace::AsyncResult& r) {
+//       fputs(r.to_string().c_str(), stderr);
+//   });
+
+#pragma once
+
+#include "sst.hpp"
+
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+#include <link.h>
+
+namespace stacktrace {
+
+enum class AsyncStatus {
+    Resolved,     // 已由后台线程解析
+    RawAddresses, // 队列满, 只有地址 (在 submit() 的调用线程中交付)
+    Dropped,      // 队列满, 被丢弃, 没有任何帧 (在 submit() 的调用线程中交付)
+};
+
+// 队列满时的策略
+enum class AsyncOverflow {
+    Drop,
+    Block,
+    RawAddresses,
+};
+
+struct AsyncResult {
+    AsyncStatus status;
+    std::vector<ResolvedFrame> frames;
+
+    AsyncResult() : status(AsyncStatus::Dropped), frames() {}
+
+    // 与 print() 的输出格式相同
+    std::string to_string() const {
+        std::string out;
+        for (const auto& f : frames) {
+            out += f.to_string();
+        }
+        return out;
+    }
+};
+
+struct AsyncResolverOptions {
+    size_t capacity = 1024; // 队列容量, 向上取整为 2 的幂
+    size_t max_batch = 256; // 后台线程一次取出的最多栈数
+    AsyncOverflow overflow = AsyncOverflow::Drop;
+};
+
+struct AsyncResolverStats {
+    size_t capacity;
+    uint64_t submitted;      // 成功入队
+    uint64_t delivered;      // 后台线程已解析并交付
+    uint64_t dropped;        // 队列满, 丢弃
+    uint64_t degraded;       // 队列满, 只给出地址
+    uint64_t blocked;        // 队列满, 等待过的提交
+    uint64_t batches;        // 后台线程处理的批次
+    uint64_t lookups;        // 去重后实际解析的地址数
+    uint64_t frames;         // 交付的总帧数
+    uint64_t module_reloads; // 重新加载模块表的次数
+};
+
+namespace async {
+
+static constexpr size_t kMaxFrames = 64;
+
+// seq 的用法与 sst_channel.hpp 相同: 等于 pos 时可写, 等于 pos + 1 时可读, 读走后置为 pos + capacity
+struct Slot {
+    std::atomic<uint64_t> seq;
+    size_t depth;
+    uintptr_t frames[kMaxFrames];
+    std::function<void(const AsyncResult&)> done;
+
+    Slot() : seq(0), depth(0), frames(), done() {}
+};
+
+// 后台线程从槽位中取出的栈, 取出后槽位立即归还给生产者
+struct Pending {
+    size_t depth;
+    uintptr_t frames[kMaxFrames];
+    std::function<void(const AsyncResult&)> done;
+
+    Pending() : depth(0), frames(), done() {}
+};
+
+// dl_iterate_phdr 的加载 / 卸载计数, 变化时说明发生过 dlopen / dlclose
+inline uint64_t dl_generation() {
+    uint64_t gen = 0;
+    dl_iterate_phdr(
+        [](struct dl_phdr_info* info, size_t size, void* data) {
+            if (size >= offsetof(struct dl_phdr_info, dlpi_subs) + sizeof(info->dlpi_subs)) {
+                *reinterpret_cast<uint64_t*>(data) = info->dlpi_adds + info->dlpi_subs;
+            }
+            return 1;
+        },
+        &gen);
+    return gen;
+}
+
+} // namespace async
+
+class AsyncResolver {
+  public:
+    using Callback = std::function<void(const AsyncResult&)>;
+
+    explicit AsyncResolver(const AsyncResolverOptions& options = AsyncResolverOptions())
+        : options_(options), slots_(), mask_(0), head_(0), pad_(), tail_(0), running_(true), sleeping_(false),
+          waiting_producers_(0), delivered_(0), dropped_(0), degraded_(0), blocked_(0), batches_(0), lookups_(0),
+          frames_(0), module_reloads_(0), mu_(), wake_cv_(), space_cv_(), done_cv_(), worker_() {
+        size_t cap = 1;
+        while (cap < options_.capacity) cap <<= 1;
+        options_.capacity = cap;
+        if (options_.max_batch == 0) options_.max_batch = 1;
+        mask_ = cap - 1;
+        slots_.reset(new async::Slot[cap]);
+        for (size_t i = 0; i < cap; ++i) {
+            slots_[i].seq.store(i, std::memory_order_relaxed);
+        }
+        worker_ = std::thread(&AsyncResolver::worker_loop, this);
+    }
+
+    // 交付所有已入队的栈之后退出; 析构时不能再有并发的 submit()
+    ~AsyncResolver() {
+        {
+            std::lock_guard<std::mutex> lock(mu_);
+            running_.store(false, std::memory_order_relaxed);
+        }
+        wake_cv_.notify_all();
+        space_cv_.notify_all();
+        worker_.join();
+    }
+
+    AsyncResolver(const AsyncResolver&) = delete;
+    AsyncResolver& operator=(const AsyncResolver&) = delete;
+
+    // 入队 frames[0, depth), 结果交给 done (可为空); 入队成功返回 true
+    bool submit(void* const* frames, size_t depth, Callback done) {
+        if (depth > async::kMaxFrames) depth = async::kMaxFrames;
+        uint64_t pos = 0;
+        async::Slot* s = claim(pos);
+        if (! s && options_.overflow == AsyncOverflow::Block) s = claim_blocking(pos);
+        if (! s) {
+            overflow(frames, depth, done);
+            return false;
+        }
+        s->depth = depth;
+        memcpy(s->frames, frames, depth * sizeof(void*));
+        s->done = std::move(done);
+        s->seq.store(pos + 1, std::memory_order_release);
+        wake_worker();
+        return true;
+    }
+
+    template <size_t MaxFrames, typename Unwinder, typename Resolver>
+    bool submit(const BasicStacktrace<MaxFrames, Unwinder, Resolver>& st, Callback done) {
+        return submit(st.addresses(), st.size(), std::move(done));
+    }
+
+    // 以 std::future 取得结果; 队列满时 future 立即就绪
+    template <size_t MaxFrames, typename Unwinder, typename Resolver>
+    std::future<AsyncResult> submit(const BasicStacktrace<MaxFrames, Unwinder, Resolver>& st) {
+        auto promise = std::make_shared<std::promise<AsyncResult>>();
+        std::future<AsyncResult> f = promise->get_future();
+        submit(st.addresses(), st.size(), [promise](const AsyncResult& r) { promise->set_value(r); });
+        return f;
+    }
+
+    // 等待调用前已入队的栈全部交付
+    void flush() {
+        uint64_t target = head_.load(std::memory_order_acquire);
+        wake_worker();
+        std::unique_lock<std::mutex> lock(mu_);
+        done_cv_.wait(lock, [&] { return delivered_.load(std::memory_order_acquire) >= target; });
+    }
+
+    AsyncResolverStats stats() const {
+        AsyncResolverStats st;
+        st.capacity = options_.capacity;
+        st.submitted = head_.load(std::memory_order_relaxed);
+        st.delivered = delivered_.load(std::memory_order_relaxed);
+        st.dropped = dropped_.load(std::memory_order_relaxed);
+        st.degraded = degraded_.load(std::memory_order_relaxed);
+        st.blocked = blocked_.load(std::memory_order_relaxed);
+        st.batches = batches_.load(std::memory_order_relaxed);
+        st.lookups = lookups_.load(std::memory_order_relaxed);
+        st.frames = frames_.load(std::memory_order_relaxed);
+        st.module_reloads = module_reloads_.load(std::memory_order_relaxed);
+        return st;
+    }
+
+  private:
+    AsyncResolverOptions options_;
+    std::unique_ptr<async::Slot[]> slots_;
+    uint64_t mask_;
+    std::atomic<uint64_t> head_; // 生产者抢占的位置, 即成功入队的总数
+    char pad_[64];               // 与后台线程频繁修改的成员分开
+    uint64_t tail_;              // 只由后台线程访问
+    std::atomic<bool> running_;
+    std::atomic<bool> sleeping_;
+    std::atomic<int> waiting_producers_;
+    std::atomic<uint64_t> delivered_;
+    std::atomic<uint64_t> dropped_;
+    std::atomic<uint64_t> degraded_;
+    std::atomic<uint64_t> blocked_;
+    std::atomic<uint64_t> batches_;
+    std::atomic<uint64_t> lookups_;
+    std::atomic<uint64_t> frames_;
+    std::atomic<uint64_t> module_reloads_;
+
+    std::mutex mu_; // 只用于等待与唤醒
+    std::condition_variable wake_cv_;  // 后台线程等待新的栈
+    std::condition_variable space_cv_; // Block 策略下生产者等待空位
+    std::condition_variable done_cv_;  // flush() 等待交付
+    std::thread worker_;
+
+    // 抢占下一个可写的槽位, 队列满时返回 nullptr
+    async::Slot* claim(uint64_t& pos) {
+        pos = head_.load(std::memory_order_relaxed);
+        for (;;) {
+            async::Slot& s = slots_[pos & mask_];
+            uint64_t seq = s.seq.load(std::memory_order_acquire);
+            int64_t diff = static_cast<int64_t>(seq - pos);
+            if (diff == 0) {
+                if (head_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) return &s;
+            } else if (diff < 0) {
+                return nullptr;
+            } else {
+                pos = head_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // 后台线程归还槽位时会唤醒; 另以 1 ms 为周期重试, 不依赖唤醒的时序
+    async::Slot* claim_blocking(uint64_t& pos) {
+        if (std::this_thread::get_id() == worker_.get_id()) return nullptr; // 回调中提交, 等待会死锁
+        blocked_.fetch_add(1, std::memory_order_relaxed);
+        std::unique_lock<std::mutex> lock(mu_);
+        waiting_producers_.fetch_add(1, std::memory_order_relaxed);
+        async::Slot* s = nullptr;
+        while (! (s = claim(pos)) && running_.load(std::memory_order_relaxed)) {
+            space_cv_.wait_for(lock, std::chrono::milliseconds(1));
+        }
+        waiting_producers_.fetch_sub(1, std::memory_order_relaxed);
+        return s;
+    }
+
+    void overflow(void* const* frames, size_t depth, const Callback& done) {
+        AsyncResult r;
+        if (options_.overflow == AsyncOverflow::RawAddresses) {
+            degraded_.fetch_add(1, std::memory_order_relaxed);
+            r.status = AsyncStatus::RawAddresses;
+            r.frames.resize(depth);
+            for (size_t i = 0; i < depth; ++i) {
+                r.frames[i] = AddressOnlyResolver::resolve(frames[i]);
+                r.frames[i].index = i;
+            }
+        } else {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            r.status = AsyncStatus::Dropped;
+        }
+        if (done) done(r);
+    }
+
+    // 与后台线程入睡前的检查配对: 两边各自先写后读, 中间的 seq_cst fence 保证至少一方看到对方的写入
+    void wake_worker() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (sleeping_.load(std::memory_order_relaxed)) {
+            std::lock_guard<std::mutex> lock(mu_);
+            wake_cv_.notify_one();
+        }
+    }
+
+    bool ready() const {
+        return slots_[tail_ & mask_].seq.load(std::memory_order_acquire) == tail_ + 1;
+    }
+
+    // 取出至多 max_batch 个已发布的栈, 遇到已被抢占但还没有发布的槽位时停止
+    void take(std::vector<async::Pending>& batch) {
+        batch.clear();
+        while (batch.size() < options_.max_batch && ready()) {
+            async::Slot& s = slots_[tail_ & mask_];
+            batch.emplace_back();
+            async::Pending& p = batch.back();
+            p.depth = s.depth;
+            memcpy(p.frames, s.frames, s.depth * sizeof(void*));
+            p.done = std::move(s.done);
+            s.done = nullptr;
+            s.seq.store(tail_ + options_.capacity, std::memory_order_release);
+            ++tail_;
+        }
+        if (! batch.empty() && waiting_producers_.load(std::memory_order_relaxed) > 0) {
+            std::lock_guard<std::mutex> lock(mu_);
+            space_cv_.notify_all();
+        }
+    }
+
+    void worker_loop() {
+        Modules mods;
+        ModuleManager::load_modules(mods, getpid());
+        uint64_t generation = async::dl_generation();
+        std::vector<async::Pending> batch;
+        std::unordered_map<uintptr_t, ResolvedFrame> resolved;
+        AsyncResult result;
+        result.status = AsyncStatus::Resolved;
+
+        for (;;) {
+            take(batch);
+            if (batch.empty()) {
+                if (! running_.load(std::memory_order_relaxed)) return;
+                sleeping_.store(true, std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                if (! ready()) {
+                    std::unique_lock<std::mutex> lock(mu_);
+                    wake_cv_.wait_for(lock, std::chrono::milliseconds(10), [this] {
+                        return ready() || ! running_.load(std::memory_order_relaxed);
+                    });
+                }
+                sleeping_.store(false, std::memory_order_relaxed);
+                continue;
+            }
+
+            // 同一批中相同的地址只解析一次; 有未知地址且发生过 dlopen / dlclose 时重新加载模块表, 再解析这些地址
+            resolved.clear();
+            bool unknown = false;
+            for (const auto& p : batch) {
+                for (size_t i = 0; i < p.depth; ++i) {
+                    auto it = resolved.find(p.frames[i]);
+                    if (it != resolved.end()) continue;
+                    it = resolved.emplace(p.frames[i], resolve_with_modules(reinterpret_cast<void*>(p.frames[i]), mods)).first;
+                    unknown = unknown || it->second.module.empty();
+                }
+            }
+            if (unknown) {
+                uint64_t gen = async::dl_generation();
+                if (gen != generation) {
+                    generation = gen;
+                    mods.clear();
+                    ModuleManager::load_modules(mods, getpid());
+                    module_reloads_.fetch_add(1, std::memory_order_relaxed);
+                    for (auto& kv : resolved) {
+                        if (kv.second.module.empty()) kv.second = resolve_with_modules(reinterpret_cast<void*>(kv.first), mods);
+                    }
+                }
+            }
+
+            batches_.fetch_add(1, std::memory_order_relaxed);
+            lookups_.fetch_add(resolved.size(), std::memory_order_relaxed);
+            uint64_t frames = 0;
+            for (auto& p : batch) {
+                result.frames.resize(p.depth);
+                for (size_t i = 0; i < p.depth; ++i) {
+                    result.frames[i] = resolved[p.frames[i]];
+                    result.frames[i].index = i;
+                }
+                frames += p.depth;
+                if (p.done) p.done(result);
+                p.done = nullptr;
+            }
+            frames_.fetch_add(frames, std::memory_order_relaxed);
+            {
+                std::lock_guard<std::mutex> lock(mu_);
+                delivered_.fetch_add(batch.size(), std::memory_order_release);
+            }
+            done_cv_.notify_all();
+        }
+    }
+};
+
+} // namespace stacktrace
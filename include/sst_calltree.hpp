@@ -0,0 +1,381 @@
+// sst_calltree.hpp - 调用树聚合与导出
+// - CallTree 以 (父节点, 返回地址) 为键逐条合并原始栈, 每个节点记录 self / total 的次数与权重
+// - 合并时只处理地址, 符号化推迟到导出, 每个不同地址只解析一次
+// - 节点数有上限: 达到上限后新路径截断到已有的最深前缀, 内存只与不同路径数有关, 与样本数无关
+// - 导出 folded stacks (flamegraph.pl) 与 pprof 的 profile.proto (未压缩, pprof 可直接读取)
+//
+//   CallTree tree("alloc_space", "bytes");
+//   tree.add(Stacktrace::capture(), size);
+//   tree.write_folded(std::cout);
+//   std::ofstream("heap.pb", std::ios::binary) << tree.to_pprof();
+
+#pragma once
+
+#include "sst.hpp"
+
+#include <algorithm>
+#include <ostream>
+#include <unordered_map>
+
+namespace stacktrace {
+
+// 最小的 protobuf 编码器, 只支持 profile.proto 用到的 varint 与 length-delimited 字段
+namespace pb {
+
+inline void put_varint(std::string& out, uint64_t v) {
+    while (v >= 0x80) {
+        out.push_back(static_cast<char>((v & 0x7f) | 0x80));
+        v >>= 7;
+    }
+    out.push_back(static_cast<char>(v));
+}
+
+inline void put_tag(std::string& out, uint32_t field, uint32_t wire_type) {
+    put_varint(out, (static_cast<uint64_t>(field) << 3) | wire_type);
+}
+
+// 值为 0 的标量字段按 proto3 的约定省略
+inline void put_uint(std::string& out, uint32_t field, uint64_t v) {
+    if (v == 0) return;
+    put_tag(out, field, 0);
+    put_varint(out, v);
+}
+
+inline void put_bytes(std::string& out, uint32_t field, const std::string& bytes) {
+    put_tag(out, field, 2);
+    put_varint(out, bytes.size());
+    out.append(bytes);
+}
+
+inline void put_packed(std::string& out, uint32_t field, const std::vector<uint64_t>& values) {
+    if (values.empty()) return;
+    std::string body;
+    for (uint64_t v : values) {
+        put_varint(body, v);
+    }
+    put_bytes(out, field, body);
+}
+
+} // namespace pb
+
+struct CallTreeStats {
+    uint64_t samples;      // add() 的次数
+    uint64_t truncated;    // 节点数达到上限而被截断的样本数
+    size_t nodes;          // 节点数 (不含根)
+    size_t memory_bytes;   // 节点与索引占用的内存
+};
+
+class CallTree {
+  public:
+    enum : uint32_t { kNone = 0xffffffffu }; // 空槽 / 无子节点
+
+    struct Node {
+        uintptr_t addr;        // 返回地址, 根节点为 0
+        uint32_t parent;
+        uint32_t first_child;
+        uint32_t next_sibling;
+        uint64_t self_count;
+        uint64_t self_weight;
+        uint64_t total_count;
+        uint64_t total_weight;
+    };
+
+    // weight_type / weight_unit 为 pprof 中第二个样本值的名字与单位, 例如 ("cpu", "nanoseconds")
+    explicit CallTree(std::string weight_type = "weight", std::string weight_unit = "count", size_t max_nodes = 1 << 20)
+        : weight_type_(std::move(weight_type)), weight_unit_(std::move(weight_unit)), max_nodes_(max_nodes), nodes_(),
+          index_(), samples_(0), truncated_(0) {
+        nodes_.push_back(Node{0, kNone, kNone, kNone, 0, 0, 0, 0});
+        index_.assign(1024, kNone);
+    }
+
+    // frames[0] 为栈顶 (与 capture() 的顺序一致)
+    void add(void* const* frames, size_t depth, uint64_t weight = 1) {
+        samples_++;
+        uint32_t cur = 0;
+        account_total(cur, 1, weight);
+        for (size_t i = depth; i-- > 0;) {
+            uint32_t child = find_or_insert(cur, reinterpret_cast<uintptr_t>(frames[i]));
+            if (child == kNone) {
+                truncated_++;
+                break;
+            }
+            cur = child;
+            account_total(cur, 1, weight);
+        }
+        nodes_[cur].self_count++;
+        nodes_[cur].self_weight += weight;
+    }
+
+    template <size_t N, typename U, typename R>
+    void add(const BasicStacktrace<N, U, R>& st, uint64_t weight = 1) {
+        add(st.addresses(), st.size(), weight);
+    }
+
+    void add(const std::vector<void*>& frames, uint64_t weight = 1) {
+        add(frames.data(), frames.size(), weight);
+    }
+
+    // 合并另一棵树, 例如各线程各自聚合后再汇总
+    void merge(const CallTree& other) {
+        samples_ += other.samples_;
+        truncated_ += other.truncated_;
+        // 子节点总是在父节点之后插入, 按下标顺序处理即可保证父节点已映射
+        std::vector<uint32_t> mapped(other.nodes_.size(), 0);
+        std::vector<bool> cut(other.nodes_.size(), false);
+        for (size_t i = 0; i < other.nodes_.size(); ++i) {
+            const Node& src = other.nodes_[i];
+            uint32_t dst = 0;
+            bool truncated = false;
+            if (i > 0) {
+                uint32_t parent = mapped[src.parent];
+                truncated = cut[src.parent];
+                dst = truncated ? kNone : find_or_insert(parent, src.addr);
+                if (dst == kNone) {
+                    dst = parent;
+                    truncated = true;
+                }
+            }
+            mapped[i] = dst;
+            cut[i] = truncated;
+            // 被截断的子树的 total 已经计入了祖先, 只需要把 self 挂到祖先上
+            if (! truncated) account_total(dst, src.total_count, src.total_weight);
+            nodes_[dst].self_count += src.self_count;
+            nodes_[dst].self_weight += src.self_weight;
+        }
+    }
+
+    const Node& root() const {
+        return nodes_[0];
+    }
+
+    const std::vector<Node>& nodes() const {
+        return nodes_;
+    }
+
+    CallTreeStats stats() const {
+        return CallTreeStats{samples_, truncated_, nodes_.size() - 1,
+                             nodes_.capacity() * sizeof(Node) + index_.capacity() * sizeof(uint32_t)};
+    }
+
+    void clear() {
+        nodes_.resize(1);
+        nodes_[0] = Node{0, kNone, kNone, kNone, 0, 0, 0, 0};
+        index_.assign(1024, kNone);
+        samples_ = truncated_ = 0;
+    }
+
+    // folded stacks: 每个 self 非零的节点一行 "root;...;leaf value", value 为权重 (use_weight) 或次数
+    // 地址按 pid 的模块表符号化, 默认为当前进程
+    void write_folded(std::ostream& os, bool use_weight = true, pid_t pid = getpid()) const {
+        Modules mods;
+        ModuleManager::load_modules(mods, pid);
+        std::unordered_map<uintptr_t, std::string> names;
+        std::vector<uint32_t> path;
+        for (uint32_t i = 1; i < nodes_.size(); ++i) {
+            const Node& n = nodes_[i];
+            uint64_t value = use_weight ? n.self_weight : n.self_count;
+            if (value == 0) continue;
+            path.clear();
+            for (uint32_t p = i; p != 0; p = nodes_[p].parent) {
+                path.push_back(p);
+            }
+            for (size_t k = path.size(); k-- > 0;) {
+                os << folded_name(nodes_[path[k]].addr, mods, pid, names) << (k > 0 ? ";" : "");
+            }
+            os << ' ' << value << '\n';
+        }
+        uint64_t root_value = use_weight ? nodes_[0].self_weight : nodes_[0].self_count;
+        if (root_value > 0) os << "[empty] " << root_value << '\n';
+    }
+
+    // pprof profile.proto (未压缩), 样本值为 [samples/count, weight_type/weight_unit]
+    // 每个地址对应一个 location, 同名函数共用一个 function, 已映射的模块各对应一个 mapping
+    std::string to_pprof(pid_t pid = getpid()) const {
+        Modules mods;
+        ModuleManager::load_modules(mods, pid);
+        PprofBuilder b;
+
+        std::string out;
+        for (const auto& vt : {std::make_pair(std::string("samples"), std::string("count")),
+                               std::make_pair(weight_type_, weight_unit_)}) {
+            std::string msg;
+            pb::put_uint(msg, 1, b.str(vt.first));
+            pb::put_uint(msg, 2, b.str(vt.second));
+            pb::put_bytes(out, 1, msg);
+        }
+
+        std::vector<uint64_t> locs;
+        for (uint32_t i = 0; i < nodes_.size(); ++i) {
+            const Node& n = nodes_[i];
+            if (n.self_count == 0 && n.self_weight == 0) continue;
+            locs.clear();
+            for (uint32_t p = i; p != 0; p = nodes_[p].parent) {
+                locs.push_back(b.location(nodes_[p].addr, mods, pid));
+            }
+            std::string msg;
+            pb::put_packed(msg, 1, locs);
+            pb::put_packed(msg, 2, {n.self_count, n.self_weight});
+            pb::put_bytes(out, 2, msg);
+        }
+
+        out.append(b.mappings);
+        out.append(b.locations);
+        out.append(b.functions);
+        for (const auto& s : b.strings) {
+            pb::put_bytes(out, 6, s);
+        }
+        return out;
+    }
+
+  private:
+    std::string weight_type_;
+    std::string weight_unit_;
+    size_t max_nodes_;
+    std::vector<Node> nodes_;     // nodes_[0] 为根
+    std::vector<uint32_t> index_; // (parent, addr) -> 节点下标的开放寻址表, 容量为 2 的幂, 负载不超过 1/2
+    uint64_t samples_;
+    uint64_t truncated_;
+
+    static size_t slot_of(uint32_t parent, uintptr_t addr, size_t mask) {
+        // 递归调用中同一返回地址会出现在很多父节点下, parent 必须参与低位的混合
+        uint64_t h = (static_cast<uint64_t>(addr) ^ (static_cast<uint64_t>(parent) * 0x9E3779B97F4A7C15ull)) * 0xBF58476D1CE4E5B9ull;
+        return static_cast<size_t>(h ^ (h >> 31)) & mask;
+    }
+
+    void account_total(uint32_t idx, uint64_t count, uint64_t weight) {
+        nodes_[idx].total_count += count;
+        nodes_[idx].total_weight += weight;
+    }
+
+    uint32_t find_or_insert(uint32_t parent, uintptr_t addr) {
+        size_t mask = index_.size() - 1;
+        for (size_t s = slot_of(parent, addr, mask);; s = (s + 1) & mask) {
+            uint32_t idx = index_[s];
+            if (idx == kNone) {
+                if (nodes_.size() > max_nodes_) return kNone;
+                idx = static_cast<uint32_t>(nodes_.size());
+                nodes_.push_back(Node{addr, parent, kNone, nodes_[parent].first_child, 0, 0, 0, 0});
+                nodes_[parent].first_child = idx;
+                index_[s] = idx;
+                if (nodes_.size() * 2 > index_.size()) rehash(index_.size() * 2);
+                return idx;
+            }
+            const Node& n = nodes_[idx];
+            if (n.addr == addr && n.parent == parent) return idx;
+        }
+    }
+
+    void rehash(size_t capacity) {
+        index_.assign(capacity, kNone);
+        size_t mask = capacity - 1;
+        for (uint32_t i = 1; i < nodes_.size(); ++i) {
+            size_t s = slot_of(nodes_[i].parent, nodes_[i].addr, mask);
+            while (index_[s] != kNone) {
+                s = (s + 1) & mask;
+            }
+            index_[s] = i;
+        }
+    }
+
+    // 函数名中的 ';' 与空格会破坏 folded 格式, 替换为 '_'; 无符号时用模块名, 无模块时用地址
+    static const std::string& folded_name(uintptr_t addr, Modules& mods, pid_t pid, std::unordered_map<uintptr_t, std::string>& names) {
+        auto it = names.find(addr);
+        if (it != names.end()) return it->second;
+        ResolvedFrame f = resolve_with_modules(reinterpret_cast<void*>(addr), mods, pid);
+        std::string name;
+        if (f.has_symbol) {
+            name = f.function;
+            std::replace(name.begin(), name.end(), ';', '_');
+            std::replace(name.begin(), name.end(), ' ', '_');
+        } else if (! f.module.empty()) {
+            name = "[" + f.module.substr(f.module.rfind('/') + 1) + "]";
+        } else {
+            char buf[32];
+            snprintf(buf, sizeof(buf), "%p", reinterpret_cast<void*>(addr));
+            name = buf;
+        }
+        return names.emplace(addr, std::move(name)).first->second;
+    }
+
+    // profile.proto 中各张表的增量构建, id 从 1 开始, string_table[0] 必须为 ""
+    struct PprofBuilder {
+        std::vector<std::string> strings;
+        std::unordered_map<std::string, uint64_t> string_ids;
+        std::unordered_map<uintptr_t, uint64_t> location_ids;
+        std::unordered_map<std::string, uint64_t> function_ids;
+        std::unordered_map<const Module*, uint64_t> mapping_ids;
+        std::string mappings;
+        std::string locations;
+        std::string functions;
+
+        PprofBuilder()
+            : strings(), string_ids(), location_ids(), function_ids(), mapping_ids(), mappings(), locations(), functions() {
+            str("");
+        }
+
+        uint64_t str(const std::string& s) {
+            auto it = string_ids.find(s);
+            if (it != string_ids.end()) return it->second;
+            uint64_t id = strings.size();
+            strings.push_back(s);
+            string_ids.emplace(s, id);
+            return id;
+        }
+
+        uint64_t mapping(const Module& m) {
+            auto it = mapping_ids.find(&m);
+            if (it != mapping_ids.end()) return it->second;
+            uint64_t id = mapping_ids.size() + 1;
+            mapping_ids.emplace(&m, id);
+            std::string msg;
+            pb::put_uint(msg, 1, id);
+            pb::put_uint(msg, 2, m.base);
+            pb::put_uint(msg, 3, m.base + m.size);
+            pb::put_uint(msg, 5, str(m.path));
+            pb::put_uint(msg, 6, str(build_id_to_hex(read_build_id(m.path.c_str()))));
+            pb::put_uint(msg, 7, 1); // has_functions
+            pb::put_bytes(mappings, 3, msg);
+            return id;
+        }
+
+        uint64_t function(const std::string& name) {
+            auto it = function_ids.find(name);
+            if (it != function_ids.end()) return it->second;
+            uint64_t id = function_ids.size() + 1;
+            function_ids.emplace(name, id);
+            std::string msg;
+            pb::put_uint(msg, 1, id);
+            pb::put_uint(msg, 2, str(name));
+            pb::put_uint(msg, 3, str(name));
+            pb::put_bytes(functions, 5, msg);
+            return id;
+        }
+
+        uint64_t location(uintptr_t addr, Modules& mods, pid_t pid) {
+            auto it = location_ids.find(addr);
+            if (it != location_ids.end()) return it->second;
+            uint64_t id = location_ids.size() + 1;
+            location_ids.emplace(addr, id);
+
+            ResolvedFrame f = resolve_with_modules(reinterpret_cast<void*>(addr), mods, pid);
+            std::string msg;
+            pb::put_uint(msg, 1, id);
+            for (const auto& m : mods) {
+                if (m.contains(addr)) {
+                    pb::put_uint(msg, 2, mapping(m));
+                    break;
+                }
+            }
+            pb::put_uint(msg, 3, addr);
+            if (f.has_symbol) {
+                std::string line;
+                pb::put_uint(line, 1, function(f.function));
+                pb::put_bytes(msg, 4, line);
+            }
+            pb::put_bytes(locations, 4, msg);
+            return id;
+        }
+    };
+};
+
+} // namespace stacktrace
@@ -0,0 +1,659 @@
+// sst_channel.hpp - 共享内存中的栈事件通道 (仅 Linux): 业务进程写入原始栈, 旁路进程 (sidecar) 离线符号化
+// - 段由 memfd_create() 或 shm_open() 创建, 布局为一个头部加 2 的幂个定长记录, 多生产者 / 单消费者的无锁环形队列
+// - 写入一个栈只是: 抢占一个槽位 (CAS), 复制时间戳、tid 与地址, 发布槽位的 seq; 没有系统调用, 也不做任何格式化
+//   时间戳取 CLOCK_MONOTONIC (vDSO), tid 每个线程只取一次; 队列满时直接丢弃并计数, 生产者从不等待消费者
+// - 模块的加载与卸载 (基址、大小、build-id、路径) 作为事件写入同一个通道: 创建时写入全部模块,
+//   之后栈中出现不在已发布模块内的地址时 (dlopen 之后) 以及每隔一段时间检查一次 (dlclose), 有变化时写入差异;
+//   模块事件总是排在引用它的栈之前, 消费者无需读取 /proc/<pid>/maps, 进程退出或 dlclose 之后也能符号化
+// - StackChannelReader 是参考消费者, ChannelSymbolizer 按通道中的模块事件维护模块表并解析地址
+//
+//   // 业务进程
+//   stacktrace::StackChannelWriter ch;
+//   ch.create("/sst-myapp");                 // 或 ch.create_memfd(), 由 sidecar 打开 /proc/<pid>/fd/<ch.fd()>
+//   ch.write(stacktrace::Stacktrace::capture());
+//
+//   // sidecar
+//   stacktrace::StackChannelReader rd;
+//   rd.open("/sst-myapp");
+//   stacktrace::ChannelSymbolizer sym(rd.pid());
+//   rd.poll([&](const ChannelStack& s) { print_frames(sym.resolve(s)); },
+//           [&](const ChannelModule& m) { sym.on_module(m); });
+
+#pragma once
+
+#include "sst.hpp"
+
+#include <algorithm>
+#include <climits>
+#include <mutex>
+#include <new>
+
+#include <fcntl.h>
+#include <sys/syscall.h>
+#include <time.h>
+
+namespace stacktrace {
+
+// 通道中的一个栈, 只在 poll() 的回调期间有效
+struct ChannelStack {
+    uint64_t timestamp_ns; // CLOCK_MONOTONIC
+    pid_t tid;
+    size_t depth;
+    const uintptr_t* addrs;
+};
+
+// 模块加载 / 卸载事件; base 与 size 的含义同 Module (base 为加载偏移, 非 PIE 主程序为最低的段地址)
+struct ChannelModule {
+    bool loaded;
+    uint64_t timestamp_ns;
+    uintptr_t base;
+    size_t size;
+    std::string path;
+    std::string build_id; // 原始字节, 不存在时为空
+
+    ChannelModule() : loaded(false), timestamp_ns(0), base(0), size(0), path(), build_id() {}
+};
+
+struct ChannelStats {
+    size_t capacity;   // 记录槽位数
+    uint64_t written;  // 写入成功的记录数 (栈 + 模块事件)
+    uint64_t consumed; // 消费者已读取的记录数
+    uint64_t dropped;  // 队列满而丢弃的栈
+};
+
+namespace channel {
+
+static constexpr char kMagic[8] = {'S', 'S', 'T', 'C', 'H', 'A', 'N', 0};
+static constexpr uint32_t kVersion = 1;
+static constexpr size_t kHeaderBytes = 4096; // 记录区从第二页开始
+static constexpr size_t kMaxDepth = 61;      // 每条记录最多的帧数, 使记录恰好为 512 字节
+static constexpr size_t kMaxBuildId = 40;
+static constexpr size_t kDefaultCapacity = 16384;
+// 按时间检查模块变化 (发现 dlclose) 的间隔
+static constexpr uint64_t kModuleCheckIntervalNs = 100000000;
+
+enum RecordKind : uint16_t {
+    kStackRecord = 1,
+    kModuleLoaded = 2,
+    kModuleUnloaded = 3,
+};
+
+// 定长记录; seq 按有界 MPMC 队列 (Vyukov) 的方式使用: 等于 pos 时可写, 等于 pos + 1 时可读,
+// 消费者读完后置为 pos + capacity, 供下一圈的生产者使用
+struct Record {
+    std::atomic<uint64_t> seq;
+    uint16_t kind;
+    uint16_t count; // 栈: 帧数; 模块事件: build-id 的字节数
+    int32_t tid;
+    uint64_t timestamp_ns;
+    uint64_t payload[kMaxDepth];
+};
+
+// 模块事件存放在 payload 中
+struct ModulePayload {
+    uint64_t base;
+    uint64_t size;
+    uint8_t build_id[kMaxBuildId];
+    char path[sizeof(Record::payload) - 2 * sizeof(uint64_t) - kMaxBuildId]; // 以 '\0' 结尾, 过长时截断
+};
+
+static_assert(sizeof(Record) == 512, "channel record must stay 512 bytes");
+static_assert(sizeof(ModulePayload) == sizeof(Record::payload), "module payload must fill the record payload");
+
+// 段的头部; 生产者共享 head, 消费者独占 tail, 分别放在各自的 cache line 上
+struct Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t record_size;
+    uint64_t capacity;
+    int32_t pid;
+    uint32_t reserved;
+    alignas(64) std::atomic<uint64_t> head;
+    alignas(64) std::atomic<uint64_t> tail;
+    alignas(64) std::atomic<uint64_t> dropped;
+};
+
+static_assert(sizeof(Header) <= kHeaderBytes, "channel header must fit in the first page");
+static_assert(ATOMIC_LLONG_LOCK_FREE == 2, "channel requires lock-free 64-bit atomics across processes");
+
+inline uint64_t now_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+inline pid_t current_tid() {
+    static thread_local pid_t tid = static_cast<pid_t>(syscall(SYS_gettid));
+    return tid;
+}
+
+inline size_t segment_bytes(size_t capacity) {
+    return kHeaderBytes + capacity * sizeof(Record);
+}
+
+// 一段映射好的通道内存, 由写端与读端共用
+class Segment {
+  public:
+    Segment() : fd_(-1), base_(nullptr), bytes_(0), header_(nullptr), records_(nullptr), mask_(0) {}
+
+    ~Segment() {
+        reset();
+    }
+
+    Segment(const Segment&) = delete;
+    Segment& operator=(const Segment&) = delete;
+
+    // 在 fd 上建立容量为 capacity (2 的幂) 的新通道, 接管 fd
+    bool init(int fd, size_t capacity) {
+        size_t bytes = segment_bytes(capacity);
+        if (ftruncate(fd, static_cast<off_t>(bytes)) != 0 || ! map(fd, bytes)) {
+            close(fd);
+            return false;
+        }
+        Header* h = new (base_) Header();
+        memcpy(h->magic, kMagic, sizeof(kMagic));
+        h->version = kVersion;
+        h->record_size = sizeof(Record);
+        h->capacity = capacity;
+        h->pid = getpid();
+        h->head.store(0, std::memory_order_relaxed);
+        h->tail.store(0, std::memory_order_relaxed);
+        h->dropped.store(0, std::memory_order_relaxed);
+        attach(h);
+        for (size_t i = 0; i < capacity; ++i) new (&records_[i].seq) std::atomic<uint64_t>(i);
+        return true;
+    }
+
+    // 映射已有的通道并校验头部, 接管 fd
+    bool attach_fd(int fd) {
+        struct stat st;
+        if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < kHeaderBytes || ! map(fd, static_cast<size_t>(st.st_size))) {
+            close(fd);
+            return false;
+        }
+        Header* h = reinterpret_cast<Header*>(base_);
+        uint64_t cap = h->capacity;
+        if (memcmp(h->magic, kMagic, sizeof(kMagic)) != 0 || h->version != kVersion || h->record_size != sizeof(Record) || cap == 0 ||
+            (cap & (cap - 1)) != 0 || segment_bytes(cap) > bytes_) {
+            reset();
+            return false;
+        }
+        attach(h);
+        return true;
+    }
+
+    void reset() {
+        if (base_) munmap(base_, bytes_);
+        if (fd_ >= 0) close(fd_);
+        fd_ = -1;
+        base_ = nullptr;
+        bytes_ = 0;
+        header_ = nullptr;
+        records_ = nullptr;
+        mask_ = 0;
+    }
+
+    int fd() const {
+        return fd_;
+    }
+
+    Header* header() const {
+        return header_;
+    }
+
+    Record& record(uint64_t pos) const {
+        return records_[pos & mask_];
+    }
+
+    // 抢占下一个可写的槽位, 队列满时返回 nullptr
+    Record* claim(uint64_t& pos) const {
+        pos = header_->head.load(std::memory_order_relaxed);
+        for (;;) {
+            Record& r = record(pos);
+            uint64_t seq = r.seq.load(std::memory_order_acquire);
+            int64_t diff = static_cast<int64_t>(seq - pos);
+            if (diff == 0) {
+                if (header_->head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) return &r;
+            } else if (diff < 0) {
+                return nullptr; // 这个槽位上一圈的记录还没有被读走
+            } else {
+                pos = header_->head.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    static void commit(Record& r, uint64_t pos) {
+        r.seq.store(pos + 1, std::memory_order_release);
+    }
+
+  private:
+    int fd_;
+    void* base_;
+    size_t bytes_;
+    Header* header_;
+    Record* records_;
+    uint64_t mask_;
+
+    bool map(int fd, size_t bytes) {
+        void* p = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (p == MAP_FAILED) return false;
+        fd_ = fd;
+        base_ = p;
+        bytes_ = bytes;
+        return true;
+    }
+
+    void attach(Header* h) {
+        header_ = h;
+        records_ = reinterpret_cast<Record*>(reinterpret_cast<char*>(base_) + kHeaderBytes);
+        mask_ = h->capacity - 1;
+    }
+};
+
+// 写端记住的一个已发布模块
+struct ModuleEntry {
+    uintptr_t base;
+    size_t size;
+    std::string path;
+    std::string build_id;
+
+    ModuleEntry() : base(0), size(0), path(), build_id() {}
+
+    bool same(const ModuleEntry& o) const {
+        return base == o.base && size == o.size && path == o.path;
+    }
+};
+
+// 已发布模块的地址区间, 按起始地址排序; 发布后不再修改, 热路径无锁读取
+using RangeTable = std::vector<std::pair<uintptr_t, uintptr_t>>;
+
+// 用 dl_iterate_phdr 得到的加载 / 卸载计数判断模块是否有变化, 只访问第一个模块, 不遍历
+inline std::pair<uint64_t, uint64_t> dl_counters() {
+    std::pair<uint64_t, uint64_t> c(0, 0);
+    dl_iterate_phdr(
+        [](struct dl_phdr_info* info, size_t size, void* data) {
+            auto& out = *reinterpret_cast<std::pair<uint64_t, uint64_t>*>(data);
+            if (size >= offsetof(struct dl_phdr_info, dlpi_subs) + sizeof(info->dlpi_subs)) {
+                out.first = info->dlpi_adds;
+                out.second = info->dlpi_subs;
+            }
+            return 1;
+        },
+        &c);
+    return c;
+}
+
+// 当前进程的模块, 与 ModuleManager 的地址区间一致; build-id 从内存中的 PT_NOTE 读取, 不打开文件
+// 主程序使用 /proc/self/exe 指向的绝对路径, 消费者的工作目录可能与业务进程不同
+inline std::vector<ModuleEntry> snapshot_modules() {
+    std::vector<ModuleEntry> mods;
+    dl_iterate_phdr(
+        [](struct dl_phdr_info* info, size_t, void* data) {
+            auto& out = *reinterpret_cast<std::vector<ModuleEntry>*>(data);
+            ModuleEntry m;
+            bool is_main_prog = ! (info->dlpi_name && *info->dlpi_name);
+            if (is_main_prog) {
+                char buf[PATH_MAX];
+                ssize_t n = readlink("/proc/self/exe", buf, sizeof(buf) - 1);
+                m.path = n > 0 ? std::string(buf, static_cast<size_t>(n)) : get_real_exe_path();
+            } else {
+                m.path = info->dlpi_name;
+            }
+            m.base = info->dlpi_addr;
+            if (is_main_prog && m.base == 0) m.base = get_nopie_main_base(info);
+            auto range = get_addr_range_from_info(info);
+            if (range.first >= range.second) return 0;
+            m.size = range.second - range.first;
+            for (int i = 0; i < info->dlpi_phnum; ++i) {
+                const ElfW(Phdr)& ph = info->dlpi_phdr[i];
+                if (ph.p_type != PT_NOTE) continue;
+                const char* notes = reinterpret_cast<const char*>(info->dlpi_addr + ph.p_vaddr);
+                if (find_build_id_note(notes, ph.p_memsz, m.build_id)) break;
+            }
+            out.push_back(std::move(m));
+            return 0;
+        },
+        &mods);
+    return mods;
+}
+
+} // namespace channel
+
+// 写端: 由业务进程创建并持有, write() 可在任意线程并发调用
+// 段的生命周期跟随写端: 析构时解除映射, 按名字创建的段同时 shm_unlink (已打开的消费者不受影响)
+class StackChannelWriter {
+  public:
+    StackChannelWriter()
+        : seg_(), name_(), mu_(), published_(), ranges_(nullptr), retired_(), dl_adds_(0), dl_subs_(0), next_check_ns_(0) {}
+
+    ~StackChannelWriter() {
+        if (! name_.empty()) shm_unlink(name_.c_str());
+    }
+
+    StackChannelWriter(const StackChannelWriter&) = delete;
+    StackChannelWriter& operator=(const StackChannelWriter&) = delete;
+
+    // 以 shm_open 名字 (形如 "/sst-myapp") 创建通道, 已存在的同名段会被覆盖; capacity 向上取 2 的幂
+    bool create(const char* name, size_t capacity = channel::kDefaultCapacity) {
+        int fd = shm_open(name, O_CREAT | O_RDWR | O_TRUNC | O_CLOEXEC, 0600);
+        if (fd < 0) return false;
+        if (! setup(fd, capacity)) {
+            shm_unlink(name);
+            return false;
+        }
+        name_ = name;
+        return true;
+    }
+
+    // 创建匿名通道, 消费者通过 /proc/<pid>/fd/<fd()> 打开, 或经 Unix domain socket 传递 fd
+    bool create_memfd(size_t capacity = channel::kDefaultCapacity) {
+        int fd = memfd_create("sst-channel", MFD_CLOEXEC);
+        return fd >= 0 && setup(fd, capacity);
+    }
+
+    int fd() const {
+        return seg_.fd();
+    }
+
+    // 写入一个栈, 超过 kMaxDepth 的帧被截断; 队列满时返回 false 并计入 dropped
+    bool write(void* const* frames, size_t depth) {
+        if (! seg_.header()) return false;
+        uint64_t now = channel::now_ns();
+        maybe_check_modules(frames, depth, now);
+        uint64_t pos;
+        channel::Record* r = seg_.claim(pos);
+        if (! r) {
+            seg_.header()->dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        if (depth > channel::kMaxDepth) depth = channel::kMaxDepth;
+        r->kind = channel::kStackRecord;
+        r->count = static_cast<uint16_t>(depth);
+        r->tid = channel::current_tid();
+        r->timestamp_ns = now;
+        memcpy(r->payload, frames, depth * sizeof(void*));
+        channel::Segment::commit(*r, pos);
+        return true;
+    }
+
+    template <size_t N, typename U, typename R>
+    bool write(const BasicStacktrace<N, U, R>& st) {
+        return write(st.addresses(), st.size());
+    }
+
+    // 立即检查模块变化并写入差异, 返回写入的模块事件数; 可在 dlopen / dlclose 之后显式调用
+    size_t sync_modules() {
+        if (! seg_.header()) return 0;
+        std::lock_guard<std::mutex> lock(mu_);
+        return sync_locked();
+    }
+
+    ChannelStats stats() const {
+        ChannelStats st = {0, 0, 0, 0};
+        const channel::Header* h = seg_.header();
+        if (! h) return st;
+        st.capacity = h->capacity;
+        st.consumed = h->tail.load(std::memory_order_relaxed);
+        st.written = h->head.load(std::memory_order_relaxed);
+        st.dropped = h->dropped.load(std::memory_order_relaxed);
+        return st;
+    }
+
+  private:
+    channel::Segment seg_;
+    std::string name_;
+    std::mutex mu_; // 串行化模块同步
+    std::vector<channel::ModuleEntry> published_;
+    std::atomic<const channel::RangeTable*> ranges_;
+    std::vector<std::unique_ptr<channel::RangeTable>> retired_; // 旧的区间表可能仍在被读取, 随写端一起释放
+    uint64_t dl_adds_;
+    uint64_t dl_subs_;
+    std::atomic<uint64_t> next_check_ns_;
+
+    bool setup(int fd, size_t capacity) {
+        size_t cap = 2;
+        while (cap < capacity) cap <<= 1;
+        if (! seg_.init(fd, cap)) return false;
+        sync_modules();
+        return true;
+    }
+
+    // 所有地址都落在已发布的模块内; 相邻的帧大多在同一个模块里, 先与上一次命中的区间比较
+    bool all_known(void* const* frames, size_t depth) const {
+        const channel::RangeTable& t = *ranges_.load(std::memory_order_acquire);
+        uintptr_t lo = 0, hi = 0;
+        for (size_t i = 0; i < depth; ++i) {
+            uintptr_t addr = reinterpret_cast<uintptr_t>(frames[i]);
+            if (addr >= lo && addr < hi) continue;
+            auto it = std::upper_bound(t.begin(), t.end(), addr, [](uintptr_t a, const std::pair<uintptr_t, uintptr_t>& r) { return a < r.first; });
+            if (it == t.begin() || addr >= (--it)->second) return false;
+            lo = it->first;
+            hi = it->second;
+        }
+        return true;
+    }
+
+    // 热路径上只做区间查找与一次原子读
+    // - 栈中有未发布的地址时, 必须在写栈之前完成同步: 等待正在同步的线程, 醒来后可能已经发布, 再查一次;
+    //   地址确实不属于任何模块 (JIT 等) 时每次都要检查 dl 计数, 但只有计数变化时才重新枚举模块
+    // - 定时检查 (发现 dlclose) 由抢到锁的线程完成, 其他线程不等待
+    void maybe_check_modules(void* const* frames, size_t depth, uint64_t now) {
+        if (! all_known(frames, depth)) {
+            std::lock_guard<std::mutex> lock(mu_);
+            if (! all_known(frames, depth)) check_locked(now);
+            return;
+        }
+        if (now < next_check_ns_.load(std::memory_order_relaxed)) return;
+        std::unique_lock<std::mutex> lock(mu_, std::try_to_lock);
+        if (lock.owns_lock()) check_locked(now);
+    }
+
+    void check_locked(uint64_t now) {
+        next_check_ns_.store(now + channel::kModuleCheckIntervalNs, std::memory_order_relaxed);
+        auto c = channel::dl_counters();
+        if (c.first != dl_adds_ || c.second != dl_subs_) sync_locked();
+    }
+
+    size_t sync_locked() {
+        auto c = channel::dl_counters();
+        std::vector<channel::ModuleEntry> now = channel::snapshot_modules();
+        size_t events = 0;
+        bool complete = true;
+        auto in = [](const std::vector<channel::ModuleEntry>& v, const channel::ModuleEntry& m) {
+            for (const auto& x : v) {
+                if (x.same(m)) return true;
+            }
+            return false;
+        };
+        // 先写卸载再写加载, 同一地址区间被新模块复用时消费者不会短暂看到两个模块重叠
+        for (size_t i = 0; i < published_.size();) {
+            if (in(now, published_[i])) {
+                ++i;
+            } else if (push_module(channel::kModuleUnloaded, published_[i])) {
+                published_.erase(published_.begin() + static_cast<std::ptrdiff_t>(i));
+                ++events;
+            } else {
+                complete = false;
+                ++i;
+            }
+        }
+        for (const auto& m : now) {
+            if (in(published_, m)) continue;
+            if (push_module(channel::kModuleLoaded, m)) {
+                published_.push_back(m);
+                ++events;
+            } else {
+                complete = false;
+            }
+        }
+        // 队列满导致事件没有写入时, 保留旧计数, 下次检查时重试
+        if (complete) {
+            dl_adds_ = c.first;
+            dl_subs_ = c.second;
+        }
+        if (events > 0 || ! ranges_.load(std::memory_order_relaxed)) publish_ranges();
+        return events;
+    }
+
+    void publish_ranges() {
+        std::unique_ptr<channel::RangeTable> t(new channel::RangeTable());
+        for (const auto& m : published_) t->emplace_back(m.base, m.base + m.size);
+        std::sort(t->begin(), t->end());
+        ranges_.store(t.get(), std::memory_order_release);
+        retired_.push_back(std::move(t));
+    }
+
+    bool push_module(channel::RecordKind kind, const channel::ModuleEntry& m) {
+        uint64_t pos;
+        channel::Record* r = seg_.claim(pos);
+        if (! r) return false;
+        channel::ModulePayload p;
+        memset(&p, 0, sizeof(p));
+        p.base = m.base;
+        p.size = m.size;
+        size_t id_len = std::min(m.build_id.size(), channel::kMaxBuildId);
+        memcpy(p.build_id, m.build_id.data(), id_len);
+        snprintf(p.path, sizeof(p.path), "%s", m.path.c_str());
+        r->kind = kind;
+        r->count = static_cast<uint16_t>(id_len);
+        r->tid = channel::current_tid();
+        r->timestamp_ns = channel::now_ns();
+        memcpy(r->payload, &p, sizeof(p));
+        channel::Segment::commit(*r, pos);
+        return true;
+    }
+};
+
+// 读端: 同一通道只能有一个消费者
+class StackChannelReader {
+  public:
+    StackChannelReader() : seg_() {}
+
+    StackChannelReader(const StackChannelReader&) = delete;
+    StackChannelReader& operator=(const StackChannelReader&) = delete;
+
+    // 按 shm_open 名字打开
+    bool open(const char* name) {
+        int fd = shm_open(name, O_RDWR | O_CLOEXEC, 0);
+        return fd >= 0 && seg_.attach_fd(fd);
+    }
+
+    // 按路径打开, 例如写端 memfd 的 /proc/<pid>/fd/<n>
+    bool open_path(const char* path) {
+        int fd = ::open(path, O_RDWR | O_CLOEXEC);
+        return fd >= 0 && seg_.attach_fd(fd);
+    }
+
+    // 打开已持有的 fd (例如经 SCM_RIGHTS 收到的), fd 仍归调用方所有
+    bool open_fd(int fd) {
+        int dup_fd = fcntl(fd, F_DUPFD_CLOEXEC, 0);
+        return dup_fd >= 0 && seg_.attach_fd(dup_fd);
+    }
+
+    // 写端进程的 pid
+    pid_t pid() const {
+        return seg_.header() ? seg_.header()->pid : 0;
+    }
+
+    // 按写入顺序读取已发布的记录, 栈交给 on_stack(const ChannelStack&), 模块事件交给 on_module(const ChannelModule&)
+    // 遇到已被抢占但还没有发布的槽位时停止 (它之后的记录留到下次), 返回读取的记录数
+    template <typename OnStack, typename OnModule>
+    size_t poll(OnStack&& on_stack, OnModule&& on_module, size_t max_records = SIZE_MAX) {
+        channel::Header* h = seg_.header();
+        if (! h) return 0;
+        uint64_t pos = h->tail.load(std::memory_order_relaxed);
+        size_t n = 0;
+        for (; n < max_records; ++n, ++pos) {
+            channel::Record& r = seg_.record(pos);
+            if (r.seq.load(std::memory_order_acquire) != pos + 1) break;
+            if (r.kind == channel::kStackRecord) {
+                ChannelStack s = {r.timestamp_ns, static_cast<pid_t>(r.tid), std::min<size_t>(r.count, channel::kMaxDepth),
+                                  reinterpret_cast<const uintptr_t*>(r.payload)};
+                on_stack(static_cast<const ChannelStack&>(s));
+            } else if (r.kind == channel::kModuleLoaded || r.kind == channel::kModuleUnloaded) {
+                channel::ModulePayload p;
+                memcpy(&p, r.payload, sizeof(p));
+                ChannelModule m;
+                m.loaded = r.kind == channel::kModuleLoaded;
+                m.timestamp_ns = r.timestamp_ns;
+                m.base = static_cast<uintptr_t>(p.base);
+                m.size = static_cast<size_t>(p.size);
+                m.path.assign(p.path, strnlen(p.path, sizeof(p.path)));
+                m.build_id.assign(reinterpret_cast<const char*>(p.build_id), std::min<size_t>(r.count, channel::kMaxBuildId));
+                on_module(static_cast<const ChannelModule&>(m));
+            }
+            r.seq.store(pos + h->capacity, std::memory_order_release);
+            h->tail.store(pos + 1, std::memory_order_relaxed);
+        }
+        return n;
+    }
+
+    ChannelStats stats() const {
+        ChannelStats st = {0, 0, 0, 0};
+        const channel::Header* h = seg_.header();
+        if (! h) return st;
+        st.capacity = h->capacity;
+        st.consumed = h->tail.load(std::memory_order_relaxed);
+        st.written = h->head.load(std::memory_order_relaxed);
+        st.dropped = h->dropped.load(std::memory_order_relaxed);
+        return st;
+    }
+
+  private:
+    channel::Segment seg_;
+};
+
+// 参考的离线符号化: 模块表完全来自通道中的模块事件, 不读取写端进程的 /proc
+// 本地文件的 build-id 与事件中的不一致 (二进制已被替换) 时, 该模块的帧只给出模块路径, 不给出可能错误的函数名
+class ChannelSymbolizer {
+  public:
+    explicit ChannelSymbolizer(pid_t pid = 0) : pid_(pid), modules_(), mismatches_(0) {}
+
+    void on_module(const ChannelModule& m) {
+        for (size_t i = 0; i < modules_.size(); ++i) {
+            if (modules_[i].base == m.base && modules_[i].path == m.path) {
+                modules_.erase(modules_.begin() + static_cast<std::ptrdiff_t>(i));
+                break;
+            }
+        }
+        if (! m.loaded) return;
+        // 本地读不到 build-id (文件不存在, 例如 linux-vdso.so.1) 时不算不一致
+        std::string local = m.build_id.empty() ? std::string() : read_build_id(m.path.c_str());
+        if (local.empty() || local == m.build_id) {
+            modules_.emplace_back(m.path, m.base, m.size);
+        } else {
+            ++mismatches_;
+            modules_.emplace_back(m.path, m.base, m.size, std::vector<Symbol>(), true);
+        }
+    }
+
+    ResolvedFrame resolve(uintptr_t addr) {
+        return resolve_with_modules(reinterpret_cast<void*>(addr), modules_, pid_);
+    }
+
+    std::vector<ResolvedFrame> resolve(const ChannelStack& s) {
+        std::vector<ResolvedFrame> frames;
+        frames.reserve(s.depth);
+        for (size_t i = 0; i < s.depth; ++i) {
+            frames.push_back(resolve(s.addrs[i]));
+            frames.back().index = i;
+        }
+        return frames;
+    }
+
+    size_t module_count() const {
+        return modules_.size();
+    }
+
+    // build-id 不一致的模块数
+    size_t build_id_mismatches() const {
+        return mismatches_;
+    }
+
+  private:
+    pid_t pid_;
+    Modules modules_;
+    size_t mismatches_;
+};
+
+} // namespace stacktrace
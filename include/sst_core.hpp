@@ -0,0 +1,388 @@
+// sst_core.hpp - 从 ELF core 文件离线还原各线程调用栈 (x86_64 / aarch64)
+// - 模块表来自 NT_FILE note (与 /proc/<pid>/maps 的分组方式相同), 符号仍由 load_symbols() 只读 symtab
+// - 线程寄存器来自 NT_PRSTATUS, 栈内容从 core 的 PT_LOAD 段读取, 按帧指针链回溯
+// - 模块的 build-id 与 core 中转储的 ELF 头页对比, 不一致时说明本机的文件已不是崩溃时的版本
+//
+// 回溯依赖帧指针: 没有帧指针的代码 (例如多数发行版的 libc) 中只能得到 pc, 其直接调用者可能缺失;
+// 崩溃在不建栈帧的叶子函数中时, 用 [sp] (aarch64 为 x30) 补上调用者, 前提是磁盘上的文件中
+// 返回地址之前恰好是一条调用该函数的直接 call 指令
+//
+//   CoreFile core;
+//   if (core.open("core.1234")) std::cout << core.summary();
+
+#pragma once
+
+#include "sst.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#include <sys/procfs.h>
+
+namespace stacktrace {
+
+struct CoreThread {
+    pid_t tid = 0;
+    int signal = 0;         // 导致转储的信号 (pr_cursig), 内核为每个线程写入相同的值
+    uintptr_t pc = 0;
+    uintptr_t sp = 0;
+    uintptr_t fp = 0;
+    uintptr_t lr = 0;       // aarch64 的 x30, x86_64 为 0
+    std::vector<void*> frames; // frames[0] 为 pc, 之后为帧指针链上的返回地址
+
+    CoreThread() : frames() {}
+};
+
+class CoreFile {
+  public:
+    CoreFile()
+        : path_(), error_(), data_(nullptr), size_(0), loads_(), files_(), modules_(), threads_(), mismatched_(), name_(), pid_(0) {}
+
+    CoreFile(const CoreFile&) = delete;
+    CoreFile& operator=(const CoreFile&) = delete;
+
+    ~CoreFile() {
+        close();
+    }
+
+    // 打开并解析 core 文件, 回溯所有线程; 失败时返回 false, 原因见 error()
+    bool open(const std::string& path, size_t max_frames = 128) {
+        close();
+        path_ = path;
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return fail("cannot open " + path + ": " + strerror(errno));
+        struct stat st;
+        if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(Elf64_Ehdr)) {
+            ::close(fd);
+            return fail(path + ": too small for an ELF file");
+        }
+        size_ = static_cast<size_t>(st.st_size);
+        void* data = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (data == MAP_FAILED) {
+            size_ = 0;
+            return fail("cannot mmap " + path + ": " + strerror(errno));
+        }
+        data_ = static_cast<const char*>(data);
+
+        auto* ehdr = reinterpret_cast<const Elf64_Ehdr*>(data_);
+        if (memcmp(ehdr->e_ident, ELFMAG, SELFMAG) != 0 || ehdr->e_ident[EI_CLASS] != ELFCLASS64) {
+            return fail(path + ": not a 64-bit ELF file");
+        }
+        if (ehdr->e_type != ET_CORE) return fail(path + ": not a core file");
+        if (ehdr->e_machine != kMachine) return fail(path + ": core is for a different architecture");
+        if (ehdr->e_phoff + size_t(ehdr->e_phnum) * sizeof(Elf64_Phdr) > size_) return fail(path + ": truncated program headers");
+
+        auto* phdrs = reinterpret_cast<const Elf64_Phdr*>(data_ + ehdr->e_phoff);
+        for (int i = 0; i < ehdr->e_phnum; ++i) {
+            const Elf64_Phdr& ph = phdrs[i];
+            if (ph.p_offset + ph.p_filesz > size_) continue; // 被截断的 core
+            if (ph.p_type == PT_LOAD) {
+                loads_.push_back(Load{ph.p_vaddr, ph.p_memsz, ph.p_filesz, ph.p_offset});
+            } else if (ph.p_type == PT_NOTE) {
+                parse_notes(data_ + ph.p_offset, ph.p_filesz);
+            }
+        }
+        std::sort(loads_.begin(), loads_.end(), [](const Load& a, const Load& b) { return a.vaddr < b.vaddr; });
+        if (threads_.empty()) return fail(path + ": no NT_PRSTATUS note");
+
+        check_build_ids();
+        for (auto& t : threads_) {
+            walk(t, max_frames);
+        }
+        return true;
+    }
+
+    void close() {
+        if (data_) munmap(const_cast<char*>(data_), size_);
+        data_ = nullptr;
+        size_ = 0;
+        loads_.clear();
+        files_.clear();
+        modules_.clear();
+        threads_.clear();
+        mismatched_.clear();
+        name_.clear();
+        pid_ = 0;
+    }
+
+    const std::string& error() const {
+        return error_;
+    }
+
+    // 进程名 (NT_PRPSINFO 中的 pr_fname)
+    const std::string& process_name() const {
+        return name_;
+    }
+
+    // 进程 pid (NT_PRPSINFO 中的 pr_pid); 没有该 note 的 core (非内核生成) 中为触发转储的线程的 tid
+    pid_t pid() const {
+        return pid_ ? pid_ : (threads_.empty() ? 0 : threads_[0].tid);
+    }
+
+    // NT_PRSTATUS 的顺序, 内核总是先写触发转储的线程
+    const std::vector<CoreThread>& threads() const {
+        return threads_;
+    }
+
+    Modules& modules() {
+        return modules_;
+    }
+
+    // build-id 与 core 中记录的不一致的模块路径
+    const std::vector<std::string>& mismatched_modules() const {
+        return mismatched_;
+    }
+
+    // 从 core 中读取崩溃时的内存; 未转储的区域 (例如只读的文件映射) 返回 false
+    bool read_memory(uintptr_t addr, void* out, size_t len) const {
+        auto it = std::upper_bound(loads_.begin(), loads_.end(), addr, [](uintptr_t a, const Load& l) { return a < l.vaddr; });
+        if (it == loads_.begin()) return false;
+        const Load& l = *(it - 1);
+        if (addr - l.vaddr + len > l.filesz) return false;
+        memcpy(out, data_ + l.offset + (addr - l.vaddr), len);
+        return true;
+    }
+
+    std::vector<ResolvedFrame> resolve(const CoreThread& t) {
+        std::vector<ResolvedFrame> out;
+        for (size_t i = 0; i < t.frames.size(); ++i) {
+            ResolvedFrame f = resolve_with_modules(t.frames[i], modules_, pid());
+            f.index = i;
+            out.push_back(std::move(f));
+        }
+        return out;
+    }
+
+    // 崩溃摘要: 进程与信号, 然后是每个线程的调用栈
+    std::string summary() {
+        std::ostringstream oss;
+        int sig = threads_.empty() ? 0 : threads_[0].signal;
+        oss << "core " << path_ << ": " << (name_.empty() ? "?" : name_) << ", pid " << pid()
+            << ", signal " << sig << " (" << (sig ? strsignal(sig) : "none") << "), " << threads_.size() << " thread(s)\n";
+        for (const auto& m : mismatched_) {
+            oss << "warning: build-id of " << m << " differs from the core, symbols may be wrong\n";
+        }
+        for (size_t i = 0; i < threads_.size(); ++i) {
+            const CoreThread& t = threads_[i];
+            oss << "\nThread " << t.tid << (i == 0 ? " (crashed)" : "") << ":\n";
+            for (const auto& f : resolve(t)) {
+                oss << "    " << f.to_string();
+            }
+        }
+        return oss.str();
+    }
+
+  private:
+    struct Load {
+        uintptr_t vaddr;
+        size_t memsz;
+        size_t filesz;
+        size_t offset;
+    };
+
+    // NT_FILE 中的一条映射, offset 已换算为字节
+    struct FileMap {
+        uintptr_t start;
+        uintptr_t end;
+        uint64_t offset;
+        std::string path;
+    };
+
+#if defined(__x86_64__)
+    static const int kMachine = EM_X86_64;
+    static uintptr_t reg_pc(const elf_gregset_t& r) { return r[16]; } // RIP
+    static uintptr_t reg_sp(const elf_gregset_t& r) { return r[19]; } // RSP
+    static uintptr_t reg_fp(const elf_gregset_t& r) { return r[4]; }  // RBP
+    static uintptr_t reg_lr(const elf_gregset_t&) { return 0; }
+#elif defined(__aarch64__)
+    static const int kMachine = EM_AARCH64;
+    static uintptr_t reg_pc(const elf_gregset_t& r) { return r[32]; }
+    static uintptr_t reg_sp(const elf_gregset_t& r) { return r[31]; }
+    static uintptr_t reg_fp(const elf_gregset_t& r) { return r[29]; } // x29
+    static uintptr_t reg_lr(const elf_gregset_t& r) { return r[30]; } // x30
+#else
+#error "sst_core.hpp supports x86_64 and aarch64 only"
+#endif
+
+    std::string path_;
+    std::string error_;
+    const char* data_;
+    size_t size_;
+    std::vector<Load> loads_;
+    std::vector<FileMap> files_;
+    Modules modules_;
+    std::vector<CoreThread> threads_;
+    std::vector<std::string> mismatched_;
+    std::string name_;
+    pid_t pid_;
+
+    bool fail(const std::string& msg) {
+        error_ = msg;
+        close();
+        return false;
+    }
+
+    void parse_notes(const char* notes, size_t size) {
+        size_t off = 0;
+        while (off + sizeof(Elf64_Nhdr) <= size) {
+            const auto* nhdr = reinterpret_cast<const Elf64_Nhdr*>(notes + off);
+            size_t desc_off = off + sizeof(Elf64_Nhdr) + ((nhdr->n_namesz + 3) & ~size_t(3));
+            size_t next = desc_off + ((nhdr->n_descsz + 3) & ~size_t(3));
+            if (next > size) break;
+            const char* desc = notes + desc_off;
+            if (nhdr->n_type == NT_PRSTATUS && nhdr->n_descsz >= sizeof(elf_prstatus)) {
+                elf_prstatus status;
+                memcpy(&status, desc, sizeof(status));
+                CoreThread t;
+                t.tid = status.pr_pid;
+                t.signal = status.pr_cursig;
+                t.pc = reg_pc(status.pr_reg);
+                t.sp = reg_sp(status.pr_reg);
+                t.fp = reg_fp(status.pr_reg);
+                t.lr = reg_lr(status.pr_reg);
+                threads_.push_back(std::move(t));
+            } else if (nhdr->n_type == NT_PRPSINFO && nhdr->n_descsz >= sizeof(elf_prpsinfo)) {
+                elf_prpsinfo info;
+                memcpy(&info, desc, sizeof(info));
+                name_.assign(info.pr_fname, strnlen(info.pr_fname, sizeof(info.pr_fname)));
+                pid_ = info.pr_pid;
+            } else if (nhdr->n_type == NT_FILE) {
+                parse_file_note(desc, nhdr->n_descsz);
+            }
+            off = next;
+        }
+    }
+
+    // NT_FILE: count, page_size, count 个 {start, end, file_ofs}, 然后是 count 个以 '\0' 结尾的路径
+    void parse_file_note(const char* desc, size_t size) {
+        if (size < 2 * sizeof(uint64_t)) return;
+        uint64_t count, page_size;
+        memcpy(&count, desc, sizeof(count));
+        memcpy(&page_size, desc + sizeof(count), sizeof(page_size));
+        size_t names_off = 2 * sizeof(uint64_t) + count * 3 * sizeof(uint64_t);
+        if (count > size || names_off > size) return;
+
+        // 与 load_modules_from_proc_maps 相同: 同一路径的所有映射合并为一个模块
+        std::vector<std::pair<std::string, std::pair<uintptr_t, uintptr_t>>> ranges;
+        const char* name = desc + names_off;
+        const char* end = desc + size;
+        for (uint64_t i = 0; i < count && name < end; ++i) {
+            uint64_t entry[3];
+            memcpy(entry, desc + 2 * sizeof(uint64_t) + i * sizeof(entry), sizeof(entry));
+            size_t len = strnlen(name, static_cast<size_t>(end - name));
+            std::string path(name, len);
+            name += len + 1;
+
+            static const char kDeleted[] = " (deleted)";
+            if (path.size() > sizeof(kDeleted) - 1 && path.compare(path.size() - (sizeof(kDeleted) - 1), std::string::npos, kDeleted) == 0) {
+                path.resize(path.size() - (sizeof(kDeleted) - 1));
+            }
+            files_.push_back(FileMap{entry[0], entry[1], entry[2] * page_size, path});
+            auto it = std::find_if(ranges.begin(), ranges.end(), [&](const decltype(ranges)::value_type& r) { return r.first == path; });
+            if (it == ranges.end()) {
+                ranges.emplace_back(path, std::make_pair(entry[0], entry[1]));
+            } else {
+                it->second.first = std::min<uintptr_t>(it->second.first, entry[0]);
+                it->second.second = std::max<uintptr_t>(it->second.second, entry[1]);
+            }
+        }
+        for (const auto& r : ranges) {
+            modules_.emplace_back(r.first, r.second.first, r.second.second - r.second.first);
+        }
+    }
+
+    // core 默认会转储每个 ELF 映射的第一页, 其中的 PT_NOTE 通常包含 build-id
+    void check_build_ids() {
+        for (const auto& m : modules_) {
+            Elf64_Ehdr ehdr;
+            if (! read_memory(m.base, &ehdr, sizeof(ehdr)) || memcmp(ehdr.e_ident, ELFMAG, SELFMAG) != 0) continue;
+            std::vector<Elf64_Phdr> phdrs(ehdr.e_phnum);
+            if (phdrs.empty() || ! read_memory(m.base + ehdr.e_phoff, phdrs.data(), phdrs.size() * sizeof(Elf64_Phdr))) continue;
+
+            uintptr_t first_vaddr = UINTPTR_MAX;
+            for (const auto& ph : phdrs) {
+                if (ph.p_type == PT_LOAD) first_vaddr = std::min<uintptr_t>(first_vaddr, ph.p_vaddr & ~uintptr_t(0xfff));
+            }
+            if (first_vaddr == UINTPTR_MAX) continue;
+            uintptr_t bias = m.base - first_vaddr;
+
+            std::string in_core;
+            for (const auto& ph : phdrs) {
+                if (ph.p_type != PT_NOTE || ph.p_filesz > 1 << 16) continue;
+                std::vector<char> notes(ph.p_filesz);
+                if (read_memory(bias + ph.p_vaddr, notes.data(), notes.size()) && find_build_id_note(notes.data(), notes.size(), in_core)) break;
+            }
+            if (in_core.empty()) continue;
+            if (read_build_id(m.path.c_str()) != in_core) mismatched_.push_back(m.path);
+        }
+    }
+
+    bool in_module(uintptr_t addr) const {
+        return std::any_of(modules_.begin(), modules_.end(), [addr](const Module& m) { return m.contains(addr); });
+    }
+
+    // core 中通常没有代码段, 从磁盘上的文件读取映射到 addr 的字节
+    bool read_file(uintptr_t addr, void* out, size_t len) const {
+        for (const auto& f : files_) {
+            if (addr < f.start || addr + len > f.end) continue;
+            int fd = ::open(f.path.c_str(), O_RDONLY);
+            if (fd < 0) return false;
+            ssize_t n = pread(fd, out, len, static_cast<off_t>(f.offset + (addr - f.start)));
+            ::close(fd);
+            return n == static_cast<ssize_t>(len);
+        }
+        return false;
+    }
+
+    // ret 之前是否为一条直接调用 pc 所在函数的 call: 目标须在 pc 之前且相距不超过 64KB
+    bool is_call_into(uintptr_t ret, uintptr_t pc) const {
+        uintptr_t target;
+#if defined(__x86_64__)
+        unsigned char insn[5];
+        if (ret < sizeof(insn) || ! read_file(ret - sizeof(insn), insn, sizeof(insn)) || insn[0] != 0xe8) return false;
+        int32_t rel;
+        memcpy(&rel, insn + 1, sizeof(rel));
+        target = ret + static_cast<uintptr_t>(static_cast<intptr_t>(rel));
+#else
+        uint32_t insn;
+        if (ret < sizeof(insn) || ! read_file(ret - sizeof(insn), &insn, sizeof(insn)) || (insn & 0xfc000000u) != 0x94000000u) return false;
+        int32_t imm = static_cast<int32_t>(insn << 6) >> 6; // bl 的 26 位有符号偏移, 单位为 4 字节
+        target = ret - sizeof(insn) + static_cast<uintptr_t>(static_cast<intptr_t>(imm) * 4);
+#endif
+        return target <= pc && pc - target < (1 << 16);
+    }
+
+    // 叶子函数不建栈帧时 fp 仍指向调用者的帧, 返回地址在 [sp] (x86_64) 或 x30 (aarch64)
+    uintptr_t leaf_caller(const CoreThread& t) const {
+        uintptr_t ret = t.lr;
+#if defined(__x86_64__)
+        if (! read_memory(t.sp, &ret, sizeof(ret))) return 0;
+#endif
+        return in_module(ret) && is_call_into(ret, t.pc) ? ret : 0;
+    }
+
+    // 按帧指针链回溯: [fp] 为上一帧的 fp, [fp + 8] 为返回地址; fp 必须在栈所在的段内单调增长,
+    // 返回地址必须落在某个模块内, 否则 fp 寄存器多半被当作了普通寄存器
+    void walk(CoreThread& t, size_t max_frames) {
+        t.frames.push_back(reinterpret_cast<void*>(t.pc));
+        auto it = std::upper_bound(loads_.begin(), loads_.end(), t.sp, [](uintptr_t a, const Load& l) { return a < l.vaddr; });
+        if (it == loads_.begin()) return;
+        uintptr_t stack_lo = t.sp;
+        uintptr_t stack_hi = (it - 1)->vaddr + (it - 1)->filesz;
+
+        uintptr_t caller = leaf_caller(t);
+        if (caller) t.frames.push_back(reinterpret_cast<void*>(caller));
+
+        uintptr_t fp = t.fp;
+        while (t.frames.size() < max_frames && fp >= stack_lo && fp + 2 * sizeof(uintptr_t) <= stack_hi && fp % sizeof(uintptr_t) == 0) {
+            uintptr_t frame[2];
+            if (! read_memory(fp, frame, sizeof(frame)) || ! in_module(frame[1])) break;
+            t.frames.push_back(reinterpret_cast<void*>(frame[1]));
+            if (frame[0] <= fp) break;
+            fp = frame[0];
+        }
+    }
+};
+
+} // namespace stacktrace
@@ -0,0 +1,2587 @@
+// sst_demangle.hpp - 不分配内存、可在信号处理函数中使用的 Itanium C++ ABI demangler
+// - 结果写入调用方给出的缓冲区, 解析树放在栈上的定长数组中 (约 27KB), 递归深度与打印步数都有上限,
+//   超出限制或遇到不支持的构造时返回 0, 调用方可退回到 abi::__cxa_demangle
+// - 打印按 kMaxPrintDepth 递归, 嵌套很深的符号一次调用最多用掉约 100KB 栈 (-O0); 在信号处理函数中调用时,
+//   所在的栈 (包括 sigaltstack 设置的备用栈, 默认的 SIGSTKSZ 远远不够) 至少要留出 128KB
+// - DemangleStyle::Full 的输出与 libstdc++ 的 __cxa_demangle 逐字节一致
+// - DemangleStyle::Simplified 把模板实参与参数列表折叠为 <...> 与 (...), 并省略返回类型:
+//     std::vector<int, std::allocator<int> >::push_back(int const&)  ->  std::vector<...>::push_back(...)
+// - 只接受以 _Z 开头的符号名 (__cxa_demangle 还会把 "f" 之类的 C 符号当作类型名 "float")
+//
+//   char buf[256];
+//   if (stacktrace::demangle_into(name, buf, sizeof(buf), stacktrace::DemangleStyle::Simplified) == 0) ...
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace stacktrace {
+
+enum class DemangleStyle {
+    Full,       // 与 __cxa_demangle 相同
+    Simplified, // ns::Foo<...>::bar(...)
+};
+
+namespace itanium {
+
+enum Kind : uint8_t {
+    kName,    // str
+    kSubStd,  // str, 例如 std::string
+    kQualName, // l::r
+    kLocalName, // l::r, l 为所在函数的 encoding
+    kTypedName, // l 为名字, r 为函数类型
+    kTaggedName, // l[abi:r]
+    kTemplate,   // l<r>
+    kTemplateParam, // num 为下标
+    kFunctionParam, // num
+    kCtor,          // l 为类名
+    kDtor,
+    kVtable,
+    kVtt,
+    kConstructionVtable, // l-in-r
+    kTypeinfo,
+    kTypeinfoName,
+    kTypeinfoFn,
+    kThunk,
+    kVirtualThunk,
+    kCovariantThunk,
+    kJavaClass,
+    kGuard,
+    kReftemp, // l 为名字, r 为序号
+    kHiddenAlias,
+    kTransactionClone,
+    kNonTransactionClone,
+    kTlsInit,
+    kTlsWrapper,
+    kTparmObj,
+    kRestrict,
+    kVolatile,
+    kConst,
+    // 以下至 kThrowSpec 为作用于函数 (this) 的限定符
+    kRestrictThis,
+    kVolatileThis,
+    kConstThis,
+    kReferenceThis,
+    kRvalueReferenceThis,
+    kTransactionSafe,
+    kNoexcept,  // r 为可选的表达式
+    kThrowSpec, // r 为类型列表
+    kVendorTypeQual, // l 为类型, r 为限定符
+    kPointer,
+    kReference,
+    kRvalueReference,
+    kComplex,
+    kImaginary,
+    kBuiltinType, // str, num 为字面量的打印方式
+    kVendorType,  // l
+    kFunctionType, // l 为返回类型 (可为 -1), r 为参数列表
+    kArrayType,    // l 为维度 (可为 -1), r 为元素类型
+    kPtrmemType,   // l 为类, r 为成员类型
+    kVectorType,   // l 为维度, r 为元素类型
+    kArglist,         // l 为元素 (-1 表示空), r 为后续
+    kTemplateArglist, // 同上
+    kInitializerList, // l 为类型 (可为 -1), r 为表达式列表
+    kOperator,        // num 为运算符表下标
+    kExtendedOperator, // num 为操作数个数, l 为名字
+    kCast,             // l 为类型
+    kConversion,       // l 为类型
+    kNullary,
+    kUnary,      // l 为运算符, r 为操作数
+    kBinary,     // l 为运算符, r 为 kBinaryArgs
+    kBinaryArgs,
+    kTrinary,    // l 为运算符, r 为 kTrinaryArg1
+    kTrinaryArg1,
+    kTrinaryArg2,
+    kLiteral,    // l 为类型, r 为数值 (kName)
+    kLiteralNeg,
+    kNumber,     // num
+    kDecltype,   // l
+    kLambda,     // num, l 为参数列表
+    kDefaultArg, // num, l
+    kUnnamedType, // num
+    kPackExpansion, // l
+    kClone,         // l [clone r]
+};
+
+struct Node {
+    uint8_t kind;
+    uint8_t printing; // 打印时的重入计数
+    uint16_t len; // str 的长度
+    int32_t num;
+    union {
+        struct {
+            int32_t l;
+            int32_t r;
+        } kids;
+        const char* str;
+    } u;
+};
+
+// 字面量的打印方式, 与 libiberty 的 d_builtin_type_print 对应
+enum PrintKind : uint8_t { kPrintDefault, kPrintInt, kPrintUnsigned, kPrintLong, kPrintUnsignedLong, kPrintLongLong, kPrintUnsignedLongLong, kPrintBool, kPrintFloat, kPrintVoid };
+
+struct BuiltinInfo {
+    const char* name;
+    uint8_t len;
+    uint8_t print;
+};
+
+// 'a' .. 'z' 与 D 开头的扩展类型 (下标 26 起)
+inline const BuiltinInfo* builtin_types() {
+    static const BuiltinInfo types[] = {
+        {"signed char", 11, kPrintDefault},
+        {"bool", 4, kPrintBool},
+        {"char", 4, kPrintDefault},
+        {"double", 6, kPrintFloat},
+        {"long double", 11, kPrintFloat},
+        {"float", 5, kPrintFloat},
+        {"__float128", 10, kPrintFloat},
+        {"unsigned char", 13, kPrintDefault},
+        {"int", 3, kPrintInt},
+        {"unsigned int", 12, kPrintUnsigned},
+        {nullptr, 0, kPrintDefault},
+        {"long", 4, kPrintLong},
+        {"unsigned long", 13, kPrintUnsignedLong},
+        {"__int128", 8, kPrintDefault},
+        {"unsigned __int128", 17, kPrintDefault},
+        {nullptr, 0, kPrintDefault},
+        {nullptr, 0, kPrintDefault},
+        {nullptr, 0, kPrintDefault},
+        {"short", 5, kPrintDefault},
+        {"unsigned short", 14, kPrintDefault},
+        {nullptr, 0, kPrintDefault},
+        {"void", 4, kPrintVoid},
+        {"wchar_t", 7, kPrintDefault},
+        {"long long", 9, kPrintLongLong},
+        {"unsigned long long", 18, kPrintUnsignedLongLong},
+        {"...", 3, kPrintDefault},
+        {"decimal32", 9, kPrintDefault},
+        {"decimal64", 9, kPrintDefault},
+        {"decimal128", 10, kPrintDefault},
+        {"half", 4, kPrintFloat},
+        {"char8_t", 7, kPrintDefault},
+        {"char16_t", 8, kPrintDefault},
+        {"char32_t", 8, kPrintDefault},
+        {"decltype(nullptr)", 17, kPrintDefault},
+    };
+    return types;
+}
+
+struct OperatorInfo {
+    const char* code;
+    const char* name;
+    uint8_t len;
+    uint8_t args;
+};
+
+// 按 code 排序, 供二分查找
+inline const OperatorInfo* operators(int* count) {
+    static const OperatorInfo ops[] = {
+        {"aN", "&=", 2, 2},         {"aS", "=", 1, 2},          {"aa", "&&", 2, 2},          {"ad", "&", 1, 1},
+        {"an", "&", 1, 2},          {"at", "alignof ", 8, 1},   {"aw", "co_await ", 9, 1},   {"az", "alignof ", 8, 1},
+        {"cc", "const_cast", 10, 2}, {"cl", "()", 2, 2},        {"cm", ",", 1, 2},           {"co", "~", 1, 1},
+        {"dV", "/=", 2, 2},         {"dX", "[...]=", 6, 3},     {"da", "delete[] ", 9, 1},   {"dc", "dynamic_cast", 12, 2},
+        {"de", "*", 1, 1},          {"di", "=", 1, 2},          {"dl", "delete ", 7, 1},     {"ds", ".*", 2, 2},
+        {"dt", ".", 1, 2},          {"dv", "/", 1, 2},          {"dx", "]=", 2, 2},          {"eO", "^=", 2, 2},
+        {"eo", "^", 1, 2},          {"eq", "==", 2, 2},         {"fL", "...", 3, 3},         {"fR", "...", 3, 3},
+        {"fl", "...", 3, 2},        {"fr", "...", 3, 2},        {"ge", ">=", 2, 2},          {"gs", "::", 2, 1},
+        {"gt", ">", 1, 2},          {"ix", "[]", 2, 2},         {"lS", "<<=", 3, 2},         {"le", "<=", 2, 2},
+        {"li", "operator\"\" ", 11, 1}, {"ls", "<<", 2, 2},     {"lt", "<", 1, 2},           {"mI", "-=", 2, 2},
+        {"mL", "*=", 2, 2},         {"mi", "-", 1, 2},          {"ml", "*", 1, 2},           {"mm", "--", 2, 1},
+        {"na", "new[]", 5, 3},      {"ne", "!=", 2, 2},         {"ng", "-", 1, 1},           {"nt", "!", 1, 1},
+        {"nw", "new", 3, 3},        {"oR", "|=", 2, 2},         {"oo", "||", 2, 2},          {"or", "|", 1, 2},
+        {"pL", "+=", 2, 2},         {"pl", "+", 1, 2},          {"pm", "->*", 3, 2},         {"pp", "++", 2, 1},
+        {"ps", "+", 1, 1},          {"pt", "->", 2, 2},         {"qu", "?", 1, 3},           {"rM", "%=", 2, 2},
+        {"rS", ">>=", 3, 2},        {"rc", "reinterpret_cast", 16, 2}, {"rm", "%", 1, 2},    {"rs", ">>", 2, 2},
+        {"sP", "sizeof...", 9, 1},  {"sZ", "sizeof...", 9, 1},  {"sc", "static_cast", 11, 2}, {"ss", "<=>", 3, 2},
+        {"st", "sizeof ", 7, 1},    {"sz", "sizeof ", 7, 1},    {"tr", "throw", 5, 0},       {"tw", "throw ", 6, 1},
+    };
+    *count = static_cast<int>(sizeof(ops) / sizeof(ops[0]));
+    return ops;
+}
+
+struct StandardSub {
+    char code;
+    const char* simple;
+    const char* full;
+    const char* last_name; // 后跟构造/析构函数时使用的类名
+};
+
+inline const StandardSub* standard_subs(int* count) {
+    static const StandardSub subs[] = {
+        {'t', "std", "std", nullptr},
+        {'a', "std::allocator", "std::allocator", "allocator"},
+        {'b', "std::basic_string", "std::basic_string", "basic_string"},
+        {'s', "std::string", "std::basic_string<char, std::char_traits<char>, std::allocator<char> >", "basic_string"},
+        {'i', "std::istream", "std::basic_istream<char, std::char_traits<char> >", "basic_istream"},
+        {'o', "std::ostream", "std::basic_ostream<char, std::char_traits<char> >", "basic_ostream"},
+        {'d', "std::iostream", "std::basic_iostream<char, std::char_traits<char> >", "basic_iostream"},
+    };
+    *count = static_cast<int>(sizeof(subs) / sizeof(subs[0]));
+    return subs;
+}
+
+inline bool is_digit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+inline bool is_lower(char c) {
+    return c >= 'a' && c <= 'z';
+}
+
+inline bool is_upper(char c) {
+    return c >= 'A' && c <= 'Z';
+}
+
+// 解析树与替换表的容量; 超出时放弃 (返回 0), 常见符号远小于此
+static const int kMaxNodes = 1280;
+static const int kMaxSubs = 256;
+static const int kMaxDepth = 128;       // 解析时类型/表达式的嵌套深度
+static const int kMaxPrintDepth = 384;  // 打印时的递归深度
+static const int kMaxPrintSteps = 1 << 18;
+static const int kMaxScopes = 64;       // 引用中的模板参数保存的作用域
+static const int kMaxScopeTemplates = 256;
+
+// 解析与打印均按 libiberty (cp-demangle.c, 即 __cxa_demangle 的实现) 的规则进行, 以保证输出一致;
+// 模板参数 T_ 与 libiberty 一样在打印时按所在的模板作用域查找实参
+class Demangler {
+  public:
+    Demangler(const char* mangled, Node* nodes, int* subs)
+        : p_(mangled), nodes_(nodes), nnodes_(0), subs_(subs), nsubs_(0), last_name_(-1),
+          is_expression_(false), is_conversion_(false), fail_(false), depth_(0), out_(nullptr),
+          cap_(0), pos_(0), last_('\0'), full_(false), err_(false), simplified_(false), mods_(nullptr), templates_(nullptr),
+          current_template_(-1), pack_index_(0), lambda_arg_(0), steps_(0), scopes_(), nscopes_(0), scope_templates_(),
+          nscope_templates_(0) {}
+
+    Demangler(const Demangler&) = delete;
+    Demangler& operator=(const Demangler&) = delete;
+
+    size_t demangle(char* buf, size_t cap, bool simplified) {
+        int root = parse_mangled(true);
+        if (root < 0 || fail_ || *p_ != '\0') return 0;
+        out_ = buf;
+        cap_ = cap;
+        simplified_ = simplified;
+        print(root);
+        if (err_) {
+            buf[0] = '\0';
+            return 0;
+        }
+        if (full_) {
+            // 截断时以 "..." 结尾, 返回 cap
+            size_t n = cap_ - 1;
+            if (n >= 3) memcpy(out_ + n - 3, "...", 3);
+            out_[n] = '\0';
+            return cap_;
+        }
+        out_[pos_] = '\0';
+        return pos_;
+    }
+
+  private:
+    // 打印时的模板作用域链, decl 为 kTemplate 节点
+    struct Tpl {
+        int decl;
+        const Tpl* next;
+    };
+
+    struct Mod {
+        int node;
+        bool printed;
+        Mod* next;
+        const Tpl* templates;
+    };
+
+    // 引用类型中的模板参数第一次打印时的作用域, 作为替换再次出现时沿用
+    struct Scope {
+        int container;
+        const Tpl* templates;
+    };
+
+    // ---------------------------------------------------------------- 解析
+
+    Node& n(int i) {
+        return nodes_[i];
+    }
+
+    Kind kind(int i) const {
+        return static_cast<Kind>(nodes_[i].kind);
+    }
+
+    static bool is_fnqual(Kind k) {
+        return k >= kRestrictThis && k <= kThrowSpec;
+    }
+
+    static bool is_cv(Kind k) {
+        return k == kRestrict || k == kVolatile || k == kConst;
+    }
+
+    char next() {
+        char c = *p_;
+        if (c) ++p_;
+        return c;
+    }
+
+    char peek_next() const {
+        return *p_ ? p_[1] : '\0';
+    }
+
+    bool check(char c) {
+        if (*p_ != c) return false;
+        ++p_;
+        return true;
+    }
+
+    bool enter() {
+        if (++depth_ > kMaxDepth) fail_ = true;
+        return ! fail_;
+    }
+
+    void leave() {
+        --depth_;
+    }
+
+    int alloc(Kind k) {
+        if (nnodes_ >= kMaxNodes) {
+            fail_ = true;
+            return -1;
+        }
+        Node& d = nodes_[nnodes_];
+        d.kind = k;
+        d.printing = 0;
+        d.len = 0;
+        d.num = 0;
+        d.u.kids.l = -1;
+        d.u.kids.r = -1;
+        return nnodes_++;
+    }
+
+    int make(Kind k, int l = -1, int r = -1) {
+        int i = alloc(k);
+        if (i < 0) return -1;
+        n(i).u.kids.l = l;
+        n(i).u.kids.r = r;
+        return i;
+    }
+
+    // 两个子节点都必须存在
+    int make2(Kind k, int l, int r) {
+        return l < 0 || r < 0 ? -1 : make(k, l, r);
+    }
+
+    int make1(Kind k, int l) {
+        return l < 0 ? -1 : make(k, l, -1);
+    }
+
+    int make_num(Kind k, int num, int l = -1) {
+        int i = make(k, l, -1);
+        if (i >= 0) n(i).num = num;
+        return i;
+    }
+
+    int make_str(Kind k, const char* s, size_t len) {
+        if (len > 0xffff) {
+            fail_ = true;
+            return -1;
+        }
+        int i = alloc(k);
+        if (i < 0) return -1;
+        n(i).u.str = s;
+        n(i).len = static_cast<uint16_t>(len);
+        return i;
+    }
+
+    int make_name(const char* s, size_t len) {
+        return make_str(kName, s, len);
+    }
+
+    int make_builtin(int index) {
+        const BuiltinInfo& b = builtin_types()[index];
+        int i = make_str(kBuiltinType, b.name, b.len);
+        if (i >= 0) n(i).num = b.print;
+        return i;
+    }
+
+    bool add_sub(int i) {
+        if (i < 0) return false;
+        if (nsubs_ >= kMaxSubs) {
+            fail_ = true;
+            return false;
+        }
+        subs_[nsubs_++] = i;
+        return true;
+    }
+
+    int parse_number() {
+        bool negative = false;
+        if (*p_ == 'n') {
+            negative = true;
+            ++p_;
+        }
+        int ret = 0;
+        while (is_digit(*p_)) {
+            int d = *p_ - '0';
+            if (ret > (0x7fffffff - d) / 10) return -1;
+            ret = ret * 10 + d;
+            ++p_;
+        }
+        return negative ? -ret : ret;
+    }
+
+    int parse_compact_number() {
+        int num;
+        if (*p_ == '_') {
+            num = 0;
+        } else if (*p_ == 'n') {
+            return -1;
+        } else {
+            num = parse_number();
+            if (num < 0 || num == 0x7fffffff) return -1;
+            num += 1;
+        }
+        if (! check('_')) return -1;
+        return num;
+    }
+
+    bool parse_discriminator() {
+        if (*p_ != '_') return true;
+        ++p_;
+        int underscores = 1;
+        if (*p_ == '_') {
+            ++underscores;
+            ++p_;
+        }
+        int num = parse_number();
+        if (num < 0) return false;
+        if (underscores > 1 && num >= 10) return check('_');
+        return true;
+    }
+
+    int parse_mangled(bool top) {
+        if (! check('_') && top) return -1;
+        if (! check('Z')) return -1;
+        int p = parse_encoding(top);
+        if (top) {
+            while (p >= 0 && *p_ == '.' && (is_lower(p_[1]) || p_[1] == '_' || is_digit(p_[1]))) p = parse_clone(p);
+        }
+        return p;
+    }
+
+    // 编译器生成的克隆后缀, 例如 .cold, .constprop.0, .isra.0
+    int parse_clone(int encoding) {
+        const char* start = p_;
+        const char* e = p_;
+        if (*e == '.' && (is_lower(e[1]) || e[1] == '_' || is_digit(e[1]))) {
+            e += 2;
+            while (is_lower(*e) || *e == '_' || is_digit(*e)) ++e;
+        }
+        while (*e == '.' && is_digit(e[1])) {
+            e += 2;
+            while (is_digit(*e)) ++e;
+        }
+        p_ = e;
+        return make2(kClone, encoding, make_name(start, static_cast<size_t>(e - start)));
+    }
+
+    bool is_ctor_dtor_or_conversion(int dc) const {
+        while (dc >= 0) {
+            Kind k = kind(dc);
+            if (k == kQualName || k == kLocalName) {
+                dc = nodes_[dc].u.kids.r;
+            } else {
+                return k == kCtor || k == kDtor || k == kConversion;
+            }
+        }
+        return false;
+    }
+
+    bool has_return_type(int dc) const {
+        while (dc >= 0) {
+            Kind k = kind(dc);
+            if (k == kLocalName) {
+                dc = nodes_[dc].u.kids.r;
+            } else if (k == kTemplate) {
+                return ! is_ctor_dtor_or_conversion(nodes_[dc].u.kids.l);
+            } else if (is_fnqual(k)) {
+                dc = nodes_[dc].u.kids.l;
+            } else {
+                return false;
+            }
+        }
+        return false;
+    }
+
+    int parse_encoding(bool top) {
+        if (! enter()) return -1;
+        int ret = parse_encoding_1(top);
+        leave();
+        return ret;
+    }
+
+    int parse_encoding_1(bool top) {
+        char c = *p_;
+        if (c == 'G' || c == 'T') return parse_special_name();
+        int name = parse_name();
+        if (name < 0) return -1;
+        c = *p_;
+        if (c == '\0' || c == 'E') return name;
+
+        int ftype = parse_bare_function_type(has_return_type(name));
+        if (ftype < 0) return -1;
+        // 非顶层的 local-name 不显示返回类型, 以免与外层混淆
+        if (! top && kind(name) == kLocalName && kind(ftype) == kFunctionType) n(ftype).u.kids.l = -1;
+        return make(kTypedName, name, ftype);
+    }
+
+    int parse_name() {
+        char c = *p_;
+        int dc;
+        switch (c) {
+            case 'N':
+                return parse_nested_name();
+            case 'Z':
+                return parse_local_name();
+            case 'U':
+                return parse_unqualified_name();
+            case 'S': {
+                bool subst;
+                if (peek_next() != 't') {
+                    dc = parse_substitution(false);
+                    subst = true;
+                } else {
+                    p_ += 2;
+                    int std_name = make_name("std", 3);
+                    dc = make2(kQualName, std_name, parse_unqualified_name());
+                    subst = false;
+                }
+                if (*p_ == 'I') {
+                    // <unscoped-template-name> 是替换候选
+                    if (! subst && ! add_sub(dc)) return -1;
+                    dc = make2(kTemplate, dc, parse_template_args());
+                }
+                return dc;
+            }
+            default:
+                dc = parse_unqualified_name();
+                if (*p_ == 'I') {
+                    if (! add_sub(dc)) return -1;
+                    dc = make2(kTemplate, dc, parse_template_args());
+                }
+                return dc;
+        }
+    }
+
+    int parse_nested_name() {
+        if (! check('N')) return -1;
+        int head = -1, tail = -1;
+        if (! parse_cv_qualifiers(head, tail, true)) return -1;
+        int rqual = -1;
+        if (*p_ == 'R' || *p_ == 'O') rqual = make(next() == 'R' ? kReferenceThis : kRvalueReferenceThis);
+        int prefix = parse_prefix();
+        if (prefix < 0) return -1;
+        int ret = prefix;
+        if (tail >= 0) {
+            n(tail).u.kids.l = prefix;
+            ret = head;
+        }
+        if (rqual >= 0) {
+            n(rqual).u.kids.l = ret;
+            ret = rqual;
+        }
+        if (! check('E')) return -1;
+        return ret;
+    }
+
+    // 与 libstdc++ 一致: 无法解析的替换被跳过, 前缀从下一个名字重新开始
+    int parse_prefix() {
+        int ret = -1;
+        for (;;) {
+            char c = *p_;
+            if (c == '\0') return -1;
+            Kind comb = kQualName;
+            int dc;
+            if (c == 'D') {
+                char d = peek_next();
+                dc = d == 'T' || d == 't' ? parse_type() : parse_unqualified_name();
+            } else if (is_digit(c) || is_lower(c) || c == 'C' || c == 'U' || c == 'L') {
+                dc = parse_unqualified_name();
+            } else if (c == 'S') {
+                dc = parse_substitution(true);
+            } else if (c == 'I') {
+                if (ret < 0) return -1;
+                comb = kTemplate;
+                dc = parse_template_args();
+            } else if (c == 'T') {
+                dc = parse_template_param();
+            } else if (c == 'E') {
+                return ret;
+            } else if (c == 'M') {
+                // lambda 的初始化作用域, 按普通作用域处理即可
+                if (ret < 0) return -1;
+                ++p_;
+                continue;
+            } else {
+                return -1;
+            }
+            ret = ret < 0 ? dc : make2(comb, ret, dc);
+            if (fail_) return -1;
+            if (c != 'S' && *p_ != 'E' && ! add_sub(ret)) return -1;
+        }
+    }
+
+    int parse_unqualified_name() {
+        char c = *p_;
+        int ret;
+        if (is_digit(c)) {
+            ret = parse_source_name();
+        } else if (is_lower(c)) {
+            bool was_expression = is_expression_;
+            if (c == 'o' && peek_next() == 'n') {
+                p_ += 2;
+                is_expression_ = false; // cv 表示转换运算符
+            }
+            ret = parse_operator_name();
+            is_expression_ = was_expression;
+            if (ret >= 0 && kind(ret) == kOperator && strcmp(op(ret).code, "li") == 0) ret = make2(kUnary, ret, parse_source_name());
+        } else if (c == 'C' || c == 'D') {
+            ret = parse_ctor_dtor_name();
+        } else if (c == 'L') {
+            ++p_;
+            ret = parse_source_name();
+            if (ret < 0 || ! parse_discriminator()) return -1;
+        } else if (c == 'U') {
+            if (peek_next() == 'l') {
+                ret = parse_lambda();
+            } else if (peek_next() == 't') {
+                ret = parse_unnamed_type();
+            } else {
+                return -1;
+            }
+        } else {
+            return -1;
+        }
+        if (*p_ == 'B') ret = parse_abi_tags(ret);
+        return ret;
+    }
+
+    int parse_abi_tags(int dc) {
+        int hold = last_name_;
+        while (*p_ == 'B') {
+            ++p_;
+            int tag = parse_source_name();
+            dc = make2(kTaggedName, dc, tag);
+        }
+        last_name_ = hold;
+        return dc;
+    }
+
+    int parse_source_name() {
+        int len = parse_number();
+        if (len <= 0) return -1;
+        const char* name = p_;
+        for (int i = 0; i < len; ++i) {
+            if (name[i] == '\0') return -1;
+        }
+        p_ += len;
+        int ret;
+        // gcc 的匿名命名空间: _GLOBAL__N_1
+        if (len >= 10 && memcmp(name, "_GLOBAL_", 8) == 0 && (name[8] == '.' || name[8] == '_' || name[8] == '$') && name[9] == 'N') {
+            ret = make_name("(anonymous namespace)", 21);
+        } else {
+            ret = make_name(name, static_cast<size_t>(len));
+        }
+        last_name_ = ret;
+        return ret;
+    }
+
+    int parse_ctor_dtor_name() {
+        if (*p_ == 'C') {
+            bool inheriting = false;
+            if (peek_next() == 'I') {
+                inheriting = true;
+                ++p_;
+            }
+            char k = peek_next();
+            if (k < '1' || k > '5') return -1;
+            p_ += 2;
+            if (inheriting) parse_type(); // 被继承构造函数的基类, 不显示
+            return make1(kCtor, last_name_);
+        }
+        char k = peek_next();
+        if (k != '0' && k != '1' && k != '2' && k != '4' && k != '5') return -1;
+        p_ += 2;
+        return make1(kDtor, last_name_);
+    }
+
+    int parse_lambda() {
+        p_ += 2; // Ul
+        int params = parse_parmlist();
+        if (params < 0 || ! check('E')) return -1;
+        int num = parse_compact_number();
+        if (num < 0) return -1;
+        return make_num(kLambda, num, params);
+    }
+
+    int parse_unnamed_type() {
+        p_ += 2; // Ut
+        int num = parse_compact_number();
+        if (num < 0) return -1;
+        return make_num(kUnnamedType, num);
+    }
+
+    const OperatorInfo& op(int dc) const {
+        int count;
+        return operators(&count)[nodes_[dc].num];
+    }
+
+    int parse_operator_name() {
+        char c1 = next();
+        char c2 = next();
+        if (c1 == 'v' && is_digit(c2)) {
+            int name = parse_source_name();
+            return name < 0 ? -1 : make_num(kExtendedOperator, c2 - '0', name);
+        }
+        if (c1 == 'c' && c2 == 'v') {
+            bool was_conversion = is_conversion_;
+            is_conversion_ = ! is_expression_;
+            int type = parse_type();
+            int res = make1(is_conversion_ ? kConversion : kCast, type);
+            is_conversion_ = was_conversion;
+            return res;
+        }
+        int count;
+        const OperatorInfo* ops = operators(&count);
+        int low = 0, high = count;
+        while (low < high) {
+            int mid = low + (high - low) / 2;
+            const char* code = ops[mid].code;
+            if (c1 == code[0] && c2 == code[1]) return make_num(kOperator, mid);
+            if (c1 < code[0] || (c1 == code[0] && c2 < code[1])) {
+                high = mid;
+            } else {
+                low = mid + 1;
+            }
+        }
+        return -1;
+    }
+
+    int lookup_template_arg(int args, int index) const {
+        int a = args;
+        for (; a >= 0; a = nodes_[a].u.kids.r) {
+            if (kind(a) != kTemplateArglist) return -1;
+            if (index <= 0) break;
+            --index;
+        }
+        return a < 0 || index != 0 ? -1 : nodes_[a].u.kids.l;
+    }
+
+    int parse_template_param() {
+        if (! check('T')) return -1;
+        int index = parse_compact_number();
+        return index < 0 ? -1 : make_num(kTemplateParam, index);
+    }
+
+    int parse_template_args() {
+        if (*p_ != 'I' && *p_ != 'J') return -1;
+        ++p_;
+        return parse_template_args_1();
+    }
+
+    int parse_template_args_1() {
+        // 模板实参中的名字不影响其后构造/析构函数的类名
+        int hold = last_name_;
+        if (*p_ == 'E') {
+            ++p_; // 空的参数包
+            return make(kTemplateArglist);
+        }
+        int head = -1, tail = -1;
+        for (;;) {
+            int a = parse_template_arg();
+            if (a < 0) return -1;
+            int node = make(kTemplateArglist, a);
+            if (node < 0) return -1;
+            if (tail < 0) {
+                head = node;
+            } else {
+                n(tail).u.kids.r = node;
+            }
+            tail = node;
+            if (*p_ == 'E') break;
+        }
+        ++p_;
+        last_name_ = hold;
+        return head;
+    }
+
+    int parse_template_arg() {
+        switch (*p_) {
+            case 'X': {
+                ++p_;
+                int ret = parse_expression();
+                if (! check('E')) return -1;
+                return ret;
+            }
+            case 'L':
+                return parse_expr_primary();
+            case 'I':
+            case 'J':
+                return parse_template_args(); // 参数包
+            default:
+                return parse_type();
+        }
+    }
+
+    bool next_is_type_qual() const {
+        char c = *p_;
+        if (c == 'r' || c == 'V' || c == 'K') return true;
+        if (c == 'D') {
+            char d = p_[1];
+            return d == 'x' || d == 'o' || d == 'O' || d == 'w';
+        }
+        return false;
+    }
+
+    // 依次解析 cv 限定符, 构成以 head 开始、tail 结束的链, tail 的 l 留给调用方填写
+    bool parse_cv_qualifiers(int& head, int& tail, bool member_fn) {
+        int first_tail = tail;
+        while (next_is_type_qual()) {
+            char c = next();
+            Kind k;
+            int right = -1;
+            if (c == 'r') {
+                k = member_fn ? kRestrictThis : kRestrict;
+            } else if (c == 'V') {
+                k = member_fn ? kVolatileThis : kVolatile;
+            } else if (c == 'K') {
+                k = member_fn ? kConstThis : kConst;
+            } else {
+                c = next();
+                if (c == 'x') {
+                    k = kTransactionSafe;
+                } else if (c == 'o' || c == 'O') {
+                    k = kNoexcept;
+                    if (c == 'O') {
+                        right = parse_expression();
+                        if (right < 0 || ! check('E')) return false;
+                    }
+                } else {
+                    k = kThrowSpec;
+                    right = parse_parmlist();
+                    if (right < 0 || ! check('E')) return false;
+                }
+            }
+            int q = make(k, -1, right);
+            if (q < 0) return false;
+            if (tail < 0) {
+                head = q;
+            } else {
+                n(tail).u.kids.l = q;
+            }
+            tail = q;
+        }
+        // 函数类型之前的 cv 限定符作用于 this
+        if (! member_fn && *p_ == 'F') {
+            for (int q = first_tail < 0 ? head : n(first_tail).u.kids.l; q >= 0; q = q == tail ? -1 : n(q).u.kids.l) {
+                Kind k = kind(q);
+                if (k == kRestrict) n(q).kind = kRestrictThis;
+                if (k == kVolatile) n(q).kind = kVolatileThis;
+                if (k == kConst) n(q).kind = kConstThis;
+            }
+        }
+        return true;
+    }
+
+    int parse_type() {
+        if (! enter()) return -1;
+        int ret = parse_type_1();
+        leave();
+        return ret;
+    }
+
+    int parse_type_1() {
+        if (next_is_type_qual()) {
+            // 带全部 cv 限定符的类型与去掉全部限定符的类型都是替换候选, 中间形式不是
+            int head = -1, tail = -1;
+            if (! parse_cv_qualifiers(head, tail, false)) return -1;
+            int inner = *p_ == 'F' ? parse_function_type() : parse_type();
+            if (inner < 0) return -1;
+            int ret = head;
+            n(tail).u.kids.l = inner;
+            if (kind(inner) == kRvalueReferenceThis || kind(inner) == kReferenceThis) {
+                // ref-qualifier 移到 cv 限定符之外, 打印顺序才正确
+                int fn = n(inner).u.kids.l;
+                n(inner).u.kids.l = ret;
+                ret = inner;
+                n(tail).u.kids.l = fn;
+            }
+            return add_sub(ret) ? ret : -1;
+        }
+
+        bool can_subst = true;
+        int ret = -1;
+        char c = *p_;
+        switch (c) {
+            case 'a': case 'b': case 'c': case 'd': case 'e': case 'f': case 'g': case 'h': case 'i': case 'j':
+            case 'l': case 'm': case 'n': case 'o': case 's': case 't': case 'v': case 'w': case 'x': case 'y':
+            case 'z':
+                ret = make_builtin(c - 'a');
+                can_subst = false;
+                ++p_;
+                break;
+            case 'u':
+                ++p_;
+                ret = make1(kVendorType, parse_source_name());
+                break;
+            case 'F':
+                ret = parse_function_type();
+                break;
+            case '0': case '1': case '2': case '3': case '4': case '5': case '6': case '7': case '8': case '9':
+            case '_': case 'N': case 'Z':
+                ret = parse_name();
+                break;
+            case 'A':
+                ret = parse_array_type();
+                break;
+            case 'M':
+                ret = parse_ptrmem_type();
+                break;
+            case 'T':
+                ret = parse_template_param();
+                if (ret >= 0 && *p_ == 'I') {
+                    if (! is_conversion_) {
+                        if (! add_sub(ret)) return -1;
+                        ret = make2(kTemplate, ret, parse_template_args());
+                    } else {
+                        // 转换运算符中: 只有后面还有一组模板实参时才是 <template-template-param> <template-args>
+                        const char* save_p = p_;
+                        int save_nodes = nnodes_, save_subs = nsubs_, save_last = last_name_;
+                        int args = parse_template_args();
+                        if (*p_ == 'I') {
+                            if (! add_sub(ret)) return -1;
+                            ret = make2(kTemplate, ret, args);
+                        } else {
+                            p_ = save_p;
+                            nnodes_ = save_nodes;
+                            nsubs_ = save_subs;
+                            last_name_ = save_last;
+                            fail_ = false;
+                        }
+                    }
+                }
+                break;
+            case 'S': {
+                char d = peek_next();
+                if (is_digit(d) || d == '_' || is_upper(d)) {
+                    ret = parse_substitution(false);
+                    // 替换的可能是模板名, 后面跟着模板实参
+                    if (ret >= 0 && *p_ == 'I') {
+                        ret = make2(kTemplate, ret, parse_template_args());
+                    } else {
+                        can_subst = false;
+                    }
+                } else {
+                    ret = parse_name();
+                    if (ret >= 0 && kind(ret) == kSubStd) can_subst = false;
+                }
+                break;
+            }
+            case 'O':
+                ++p_;
+                ret = make1(kRvalueReference, parse_type());
+                break;
+            case 'P':
+                ++p_;
+                ret = make1(kPointer, parse_type());
+                break;
+            case 'R':
+                ++p_;
+                ret = make1(kReference, parse_type());
+                break;
+            case 'C':
+                ++p_;
+                ret = make1(kComplex, parse_type());
+                break;
+            case 'G':
+                ++p_;
+                ret = make1(kImaginary, parse_type());
+                break;
+            case 'U': {
+                ++p_;
+                int qual = parse_source_name();
+                if (qual >= 0 && *p_ == 'I') qual = make2(kTemplate, qual, parse_template_args());
+                if (qual < 0) return -1;
+                ret = make2(kVendorTypeQual, parse_type(), qual);
+                break;
+            }
+            case 'D':
+                can_subst = false;
+                ++p_;
+                switch (next()) {
+                    case 'T':
+                    case 't':
+                        ret = make1(kDecltype, parse_expression());
+                        if (ret >= 0 && next() != 'E') ret = -1;
+                        can_subst = true;
+                        break;
+                    case 'p':
+                        ret = make1(kPackExpansion, parse_type());
+                        can_subst = true;
+                        break;
+                    case 'a':
+                        ret = make_name("auto", 4);
+                        break;
+                    case 'c':
+                        ret = make_name("decltype(auto)", 14);
+                        break;
+                    case 'f':
+                        ret = make_builtin(26);
+                        break;
+                    case 'd':
+                        ret = make_builtin(27);
+                        break;
+                    case 'e':
+                        ret = make_builtin(28);
+                        break;
+                    case 'h':
+                        ret = make_builtin(29);
+                        break;
+                    case 'u':
+                        ret = make_builtin(30);
+                        break;
+                    case 's':
+                        ret = make_builtin(31);
+                        break;
+                    case 'i':
+                        ret = make_builtin(32);
+                        break;
+                    case 'n':
+                        ret = make_builtin(33);
+                        break;
+                    case 'v':
+                        ret = parse_vector_type();
+                        can_subst = true;
+                        break;
+                    default:
+                        return -1; // 定点数、_FloatN 等, 不支持
+                }
+                break;
+            default:
+                return -1;
+        }
+        if (ret < 0) return -1;
+        if (can_subst && ! add_sub(ret)) return -1;
+        return ret;
+    }
+
+    int parse_function_type() {
+        if (! enter()) return -1;
+        int ret = -1;
+        if (check('F')) {
+            if (*p_ == 'Y') ++p_; // extern "C", 不显示
+            ret = parse_bare_function_type(true);
+            if (ret >= 0 && (*p_ == 'R' || *p_ == 'O')) ret = make(next() == 'R' ? kReferenceThis : kRvalueReferenceThis, ret);
+            if (! check('E')) ret = -1;
+        }
+        leave();
+        return ret;
+    }
+
+    int parse_bare_function_type(bool has_return) {
+        if (*p_ == 'J') {
+            ++p_;
+            has_return = true;
+        }
+        int ret_type = -1;
+        if (has_return) {
+            ret_type = parse_type();
+            if (ret_type < 0) return -1;
+        }
+        int params = parse_parmlist();
+        if (params < 0) return -1;
+        return make(kFunctionType, ret_type, params);
+    }
+
+    int parse_parmlist() {
+        int head = -1, tail = -1;
+        for (;;) {
+            char c = *p_;
+            if (c == '\0' || c == 'E' || c == '.') break;
+            if ((c == 'R' || c == 'O') && peek_next() == 'E') break; // 函数的 ref-qualifier
+            int type = parse_type();
+            if (type < 0) return -1;
+            int node = make(kArglist, type);
+            if (node < 0) return -1;
+            if (tail < 0) {
+                head = node;
+            } else {
+                n(tail).u.kids.r = node;
+            }
+            tail = node;
+        }
+        if (head < 0) return -1;
+        // 只有一个 void 参数时即为无参数
+        int first = n(head).u.kids.l;
+        if (n(head).u.kids.r < 0 && kind(first) == kBuiltinType && n(first).num == kPrintVoid) n(head).u.kids.l = -1;
+        return head;
+    }
+
+    int parse_array_type() {
+        if (! check('A')) return -1;
+        int dim = -1;
+        if (is_digit(*p_)) {
+            const char* s = p_;
+            while (is_digit(*p_)) ++p_;
+            dim = make_name(s, static_cast<size_t>(p_ - s));
+            if (dim < 0) return -1;
+        } else if (*p_ != '_') {
+            dim = parse_expression();
+            if (dim < 0) return -1;
+        }
+        if (! check('_')) return -1;
+        int elem = parse_type();
+        return elem < 0 ? -1 : make(kArrayType, dim, elem);
+    }
+
+    int parse_vector_type() {
+        int dim;
+        if (*p_ == '_') {
+            ++p_;
+            dim = parse_expression();
+        } else {
+            dim = make_num(kNumber, parse_number());
+        }
+        if (dim < 0 || ! check('_')) return -1;
+        return make2(kVectorType, dim, parse_type());
+    }
+
+    int parse_ptrmem_type() {
+        if (! check('M')) return -1;
+        int cls = parse_type();
+        if (cls < 0) return -1;
+        return make2(kPtrmemType, cls, parse_type());
+    }
+
+    int parse_substitution(bool prefix) {
+        if (! check('S')) return -1;
+        char c = next();
+        if (c == '_' || is_digit(c) || is_upper(c)) {
+            unsigned id = 0;
+            if (c != '_') {
+                do {
+                    unsigned nid;
+                    if (is_digit(c)) {
+                        nid = id * 36 + static_cast<unsigned>(c - '0');
+                    } else if (is_upper(c)) {
+                        nid = id * 36 + static_cast<unsigned>(c - 'A' + 10);
+                    } else {
+                        return -1;
+                    }
+                    if (nid < id) return -1;
+                    id = nid;
+                    c = next();
+                } while (c != '_');
+                ++id;
+            }
+            if (id >= static_cast<unsigned>(nsubs_)) return -1;
+            return subs_[id];
+        }
+        // 后跟构造/析构函数时展开为完整形式
+        bool verbose = prefix && (*p_ == 'C' || *p_ == 'D');
+        int count;
+        const StandardSub* subs = standard_subs(&count);
+        for (int i = 0; i < count; ++i) {
+            if (c != subs[i].code) continue;
+            if (subs[i].last_name) last_name_ = make_str(kSubStd, subs[i].last_name, strlen(subs[i].last_name));
+            const char* s = verbose ? subs[i].full : subs[i].simple;
+            int dc = make_str(kSubStd, s, strlen(s));
+            if (dc >= 0 && *p_ == 'B') {
+                dc = parse_abi_tags(dc);
+                if (! add_sub(dc)) return -1;
+            }
+            return dc;
+        }
+        return -1;
+    }
+
+    int parse_local_name() {
+        if (! check('Z')) return -1;
+        int function = parse_encoding(false);
+        if (function < 0 || ! check('E')) return -1;
+        int name;
+        if (*p_ == 's') {
+            ++p_;
+            if (! parse_discriminator()) return -1;
+            name = make_name("string literal", 14);
+        } else {
+            int num = -1;
+            if (*p_ == 'd') {
+                // 默认实参中的实体: d <number> _
+                ++p_;
+                num = parse_compact_number();
+                if (num < 0) return -1;
+            }
+            name = parse_name();
+            // lambda 与匿名类型自带编号, 其余可能跟着可忽略的 discriminator
+            if (name >= 0 && kind(name) != kLambda && kind(name) != kUnnamedType && ! parse_discriminator()) return -1;
+            if (num >= 0) name = make_num(kDefaultArg, num, name);
+        }
+        if (name < 0) return -1;
+        // 外层函数的返回类型不显示
+        if (kind(function) == kTypedName && kind(n(function).u.kids.r) == kFunctionType) n(n(function).u.kids.r).u.kids.l = -1;
+        return make(kLocalName, function, name);
+    }
+
+    bool parse_call_offset(char c) {
+        if (c == '\0') c = next();
+        if (c == 'h') {
+            parse_number();
+        } else if (c == 'v') {
+            parse_number();
+            if (! check('_')) return false;
+            parse_number();
+        } else {
+            return false;
+        }
+        return check('_');
+    }
+
+    int parse_special_name() {
+        if (check('T')) {
+            switch (next()) {
+                case 'V':
+                    return make1(kVtable, parse_type());
+                case 'T':
+                    return make1(kVtt, parse_type());
+                case 'I':
+                    return make1(kTypeinfo, parse_type());
+                case 'S':
+                    return make1(kTypeinfoName, parse_type());
+                case 'h':
+                    if (! parse_call_offset('h')) return -1;
+                    return make1(kThunk, parse_encoding(false));
+                case 'v':
+                    if (! parse_call_offset('v')) return -1;
+                    return make1(kVirtualThunk, parse_encoding(false));
+                case 'c':
+                    if (! parse_call_offset('\0') || ! parse_call_offset('\0')) return -1;
+                    return make1(kCovariantThunk, parse_encoding(false));
+                case 'C': {
+                    int derived = parse_type();
+                    int offset = parse_number();
+                    if (derived < 0 || offset < 0 || ! check('_')) return -1;
+                    return make2(kConstructionVtable, parse_type(), derived);
+                }
+                case 'F':
+                    return make1(kTypeinfoFn, parse_type());
+                case 'J':
+                    return make1(kJavaClass, parse_type());
+                case 'H':
+                    return make1(kTlsInit, parse_name());
+                case 'W':
+                    return make1(kTlsWrapper, parse_name());
+                case 'A':
+                    return make1(kTparmObj, parse_template_arg());
+                default:
+                    return -1;
+            }
+        }
+        if (check('G')) {
+            switch (next()) {
+                case 'V':
+                    return make1(kGuard, parse_name());
+                case 'R': {
+                    int name = parse_name();
+                    return make2(kReftemp, name, make_num(kNumber, parse_number()));
+                }
+                case 'A':
+                    return make1(kHiddenAlias, parse_encoding(false));
+                case 'T':
+                    if (next() == 'n') return make1(kNonTransactionClone, parse_encoding(false));
+                    return make1(kTransactionClone, parse_encoding(false));
+                default:
+                    return -1;
+            }
+        }
+        return -1;
+    }
+
+    // ---------------------------------------------------------------- 表达式
+
+    int parse_expression() {
+        bool was_expression = is_expression_;
+        is_expression_ = true;
+        int ret = parse_expression_1();
+        is_expression_ = was_expression;
+        return ret;
+    }
+
+    int parse_exprlist(char terminator) {
+        if (check(terminator)) return make(kArglist);
+        int head = -1, tail = -1;
+        for (;;) {
+            int e = parse_expression_1();
+            if (e < 0) return -1;
+            int node = make(kArglist, e);
+            if (node < 0) return -1;
+            if (tail < 0) {
+                head = node;
+            } else {
+                n(tail).u.kids.r = node;
+            }
+            tail = node;
+            if (check(terminator)) break;
+        }
+        return head;
+    }
+
+    int parse_expression_1() {
+        if (! enter()) return -1;
+        int ret = parse_expression_2();
+        leave();
+        return ret;
+    }
+
+    int parse_expression_2() {
+        char c = *p_;
+        if (c == 'L') return parse_expr_primary();
+        if (c == 'T') return parse_template_param();
+        if (c == 's' && peek_next() == 'r') {
+            p_ += 2;
+            // 先按 sr <unresolved-qualifier-level>+ E <base-unresolved-name> 解析, 不成立时回退为 sr <type> <name>
+            const char* save_p = p_;
+            int save_nodes = nnodes_, save_subs = nsubs_, save_last = last_name_;
+            int levels = parse_unresolved_levels();
+            if (levels >= 0 || fail_) return levels;
+            p_ = save_p;
+            nnodes_ = save_nodes;
+            nsubs_ = save_subs;
+            last_name_ = save_last;
+            int type = parse_type();
+            int name = parse_unqualified_name();
+            if (*p_ != 'I') return make2(kQualName, type, name);
+            return make2(kQualName, type, make2(kTemplate, name, parse_template_args()));
+        }
+        if (c == 's' && peek_next() == 'p') {
+            p_ += 2;
+            return make1(kPackExpansion, parse_expression_1());
+        }
+        if (c == 'f' && peek_next() == 'p') {
+            // 函数参数: fpT 为 this, fp <cv> <number> _ 为第 N+1 个参数
+            p_ += 2;
+            int index;
+            if (*p_ == 'T') {
+                ++p_;
+                index = 0;
+            } else {
+                index = parse_compact_number();
+                if (index < 0 || index == 0x7fffffff) return -1;
+                ++index;
+            }
+            return make_num(kFunctionParam, index);
+        }
+        if (is_digit(c) || (c == 'o' && peek_next() == 'n')) {
+            if (c == 'o') p_ += 2;
+            int name = parse_unqualified_name();
+            if (name < 0) return -1;
+            if (*p_ == 'I') return make2(kTemplate, name, parse_template_args());
+            return name;
+        }
+        if ((c == 'i' || c == 't') && peek_next() == 'l') {
+            // 初始化列表: il <expression>* E, tl <type> <expression>* E
+            int type = -1;
+            p_ += 2;
+            if (c == 't') {
+                type = parse_type();
+                if (type < 0) return -1;
+            }
+            if (! *p_ || ! p_[1]) return -1;
+            int list = parse_exprlist('E');
+            return list < 0 ? -1 : make(kInitializerList, type, list);
+        }
+
+        int oper = parse_operator_name();
+        if (oper < 0) return -1;
+        const char* code = nullptr;
+        int args;
+        if (kind(oper) == kOperator) {
+            code = op(oper).code;
+            if (strcmp(code, "st") == 0) return make2(kUnary, oper, parse_type());
+            args = op(oper).args;
+        } else if (kind(oper) == kExtendedOperator) {
+            args = n(oper).num;
+        } else if (kind(oper) == kCast) {
+            args = 1;
+        } else {
+            return -1;
+        }
+
+        switch (args) {
+            case 0:
+                return make1(kNullary, oper);
+            case 1: {
+                if (code && strcmp(code, "sP") == 0) return -1;
+                // 后缀形式的 ++/--: pp_ <expression>
+                bool suffix = false;
+                if (code && (code[0] == 'p' || code[0] == 'm') && code[0] == code[1]) suffix = ! check('_');
+                int operand;
+                if (kind(oper) == kCast && check('_')) {
+                    operand = parse_exprlist('E');
+                } else {
+                    operand = parse_expression_1();
+                }
+                if (suffix) operand = make2(kBinaryArgs, operand, operand);
+                return make2(kUnary, oper, operand);
+            }
+            case 2: {
+                if (! code || code[0] == 'f' || strcmp(code, "di") == 0 || strcmp(code, "dx") == 0) return -1;
+                int left;
+                if (is_new_cast(code)) {
+                    left = parse_type();
+                } else {
+                    left = parse_expression_1();
+                }
+                if (left < 0) return -1;
+                int right;
+                if (strcmp(code, "cl") == 0) {
+                    right = parse_exprlist('E');
+                } else if (strcmp(code, "dt") == 0 || strcmp(code, "pt") == 0) {
+                    c = *p_;
+                    if ((c == 'g' && peek_next() == 's') || (c == 's' && peek_next() == 'r')) {
+                        right = parse_expression_1();
+                    } else {
+                        right = parse_unqualified_name();
+                        if (right >= 0 && *p_ == 'I') right = make2(kTemplate, right, parse_template_args());
+                    }
+                } else {
+                    right = parse_expression_1();
+                }
+                return make2(kBinary, oper, make2(kBinaryArgs, left, right));
+            }
+            case 3: {
+                // new 与折叠表达式不支持
+                if (! code || strcmp(code, "qu") != 0) return -1;
+                int first = parse_expression_1();
+                if (first < 0) return -1;
+                int second = parse_expression_1();
+                if (second < 0) return -1;
+                int third = parse_expression_1();
+                return make2(kTrinary, oper, make2(kTrinaryArg1, first, make2(kTrinaryArg2, second, third)));
+            }
+            default:
+                return -1;
+        }
+    }
+
+    int parse_unresolved_levels() {
+        int ret = -1;
+        do {
+            if (! is_digit(*p_)) return -1;
+            int level = parse_source_name();
+            if (level >= 0 && *p_ == 'I') level = make2(kTemplate, level, parse_template_args());
+            ret = ret < 0 ? level : make2(kQualName, ret, level);
+            if (ret < 0) return -1;
+        } while (*p_ != 'E');
+        ++p_;
+        int base = parse_unqualified_name();
+        if (base >= 0 && *p_ == 'I') base = make2(kTemplate, base, parse_template_args());
+        return make2(kQualName, ret, base);
+    }
+
+    static bool is_new_cast(const char* code) {
+        return strcmp(code, "cc") == 0 || strcmp(code, "dc") == 0 || strcmp(code, "rc") == 0 || strcmp(code, "sc") == 0;
+    }
+
+    int parse_expr_primary() {
+        if (! check('L')) return -1;
+        int ret;
+        if (*p_ == '_' || *p_ == 'Z') {
+            ret = parse_mangled(false); // 外部名字, 例如指针模板实参
+        } else {
+            int type = parse_type();
+            if (type < 0) return -1;
+            // nullptr 字面量: LDnE
+            if (kind(type) == kBuiltinType && n(type).u.str == builtin_types()[33].name && check('E')) return type;
+            Kind k = kLiteral;
+            if (*p_ == 'n') {
+                k = kLiteralNeg;
+                ++p_;
+            }
+            const char* s = p_;
+            while (*p_ != 'E') {
+                if (*p_ == '\0') return -1;
+                ++p_;
+            }
+            ret = make2(k, type, make_name(s, static_cast<size_t>(p_ - s)));
+        }
+        if (! check('E')) return -1;
+        return ret;
+    }
+
+    // ---------------------------------------------------------------- 打印
+
+    void append(char c) {
+        if (full_) return;
+        if (pos_ + 1 >= cap_) {
+            full_ = true;
+            return;
+        }
+        out_[pos_++] = c;
+        last_ = c;
+    }
+
+    void append(const char* s, size_t len) {
+        if (full_ || len == 0) return;
+        if (pos_ + len >= cap_) {
+            // 放不下时逐个写入, 直到缓冲区满
+            for (size_t i = 0; i < len && ! full_; ++i) append(s[i]);
+            return;
+        }
+        memcpy(out_ + pos_, s, len);
+        pos_ += len;
+        last_ = s[len - 1];
+    }
+
+    void append(const char* s) {
+        append(s, strlen(s));
+    }
+
+    void append_num(long v) {
+        char tmp[24];
+        int i = 0;
+        unsigned long u = v < 0 ? 0ul - static_cast<unsigned long>(v) : static_cast<unsigned long>(v);
+        do {
+            tmp[i++] = static_cast<char>('0' + u % 10);
+            u /= 10;
+        } while (u);
+        if (v < 0) append('-');
+        while (i > 0) append(tmp[--i]);
+    }
+
+    int left(int dc) const {
+        return nodes_[dc].u.kids.l;
+    }
+
+    int right(int dc) const {
+        return nodes_[dc].u.kids.r;
+    }
+
+    void print(int dc) {
+        if (err_ || full_) return;
+        if (dc < 0 || nodes_[dc].printing > 1 || depth_ >= kMaxPrintDepth || ++steps_ > kMaxPrintSteps) {
+            err_ = true;
+            return;
+        }
+        ++nodes_[dc].printing;
+        ++depth_;
+        print_1(dc);
+        --depth_;
+        --nodes_[dc].printing;
+    }
+
+    int index_arg(int args, int index) const {
+        return lookup_template_arg(args, index);
+    }
+
+    // 在当前模板作用域中查找 T_ 的实参
+    int lookup_template_param(int dc) {
+        if (! templates_) {
+            err_ = true;
+            return -1;
+        }
+        return lookup_template_arg(right(templates_->decl), nodes_[dc].num);
+    }
+
+    const Scope* find_scope(int container) const {
+        for (int i = 0; i < nscopes_; ++i) {
+            if (scopes_[i].container == container) return &scopes_[i];
+        }
+        return nullptr;
+    }
+
+    void save_scope(int container) {
+        if (nscopes_ >= kMaxScopes) {
+            err_ = true;
+            return;
+        }
+        Scope& scope = scopes_[nscopes_++];
+        scope.container = container;
+        scope.templates = nullptr;
+        Tpl* prev = nullptr;
+        for (const Tpl* src = templates_; src; src = src->next) {
+            if (nscope_templates_ >= kMaxScopeTemplates) {
+                err_ = true;
+                return;
+            }
+            Tpl* dst = &scope_templates_[nscope_templates_++];
+            dst->decl = src->decl;
+            dst->next = nullptr;
+            if (prev) {
+                prev->next = dst;
+            } else {
+                scope.templates = dst;
+            }
+            prev = dst;
+        }
+    }
+
+    // 表达式中第一个 (以参数包为实参的) 模板参数, 用于展开 ...
+    int find_pack(int dc) {
+        if (dc < 0 || err_) return -1;
+        if (depth_ >= kMaxPrintDepth) {
+            err_ = true;
+            return -1;
+        }
+        switch (kind(dc)) {
+            case kTemplateParam: {
+                int a = lookup_template_param(dc);
+                return a >= 0 && kind(a) == kTemplateArglist ? a : -1;
+            }
+            case kPackExpansion:
+            case kLambda:
+            case kName:
+            case kTaggedName:
+            case kOperator:
+            case kBuiltinType:
+            case kSubStd:
+            case kFunctionParam:
+            case kUnnamedType:
+            case kDefaultArg:
+            case kNumber:
+                return -1;
+            case kExtendedOperator:
+            case kCtor:
+            case kDtor:
+                return find_pack(left(dc));
+            default: {
+                ++depth_;
+                int a = find_pack(left(dc));
+                if (a < 0) a = find_pack(right(dc));
+                --depth_;
+                return a;
+            }
+        }
+    }
+
+    int pack_length(int args) const {
+        int count = 0;
+        while (args >= 0 && kind(args) == kTemplateArglist && left(args) >= 0) {
+            ++count;
+            args = right(args);
+        }
+        return count;
+    }
+
+    bool is_empty_list(int list) const {
+        return list < 0 || (left(list) < 0 && right(list) < 0);
+    }
+
+    void print_1(int dc) {
+        const Node& d = nodes_[dc];
+        switch (d.kind) {
+            case kSubStd:
+                if (simplified_) {
+                    // std::basic_string<char, ...> 这类展开形式同样折叠模板实参
+                    const char* lt = static_cast<const char*>(memchr(d.u.str, '<', d.len));
+                    if (lt) {
+                        append(d.u.str, static_cast<size_t>(lt - d.u.str));
+                        append("<...>");
+                        return;
+                    }
+                }
+                append(d.u.str, d.len);
+                return;
+            case kName:
+            case kBuiltinType:
+                append(d.u.str, d.len);
+                return;
+            case kTaggedName:
+                print(left(dc));
+                append("[abi:");
+                print(right(dc));
+                append(']');
+                return;
+            case kQualName:
+            case kLocalName: {
+                print(left(dc));
+                append("::");
+                int local = right(dc);
+                if (local >= 0 && kind(local) == kDefaultArg) {
+                    append("{default arg#");
+                    append_num(n(local).num + 1);
+                    append("}::");
+                    local = left(local);
+                }
+                print(local);
+                return;
+            }
+            case kTypedName:
+                print_typed_name(dc);
+                return;
+            case kTemplate: {
+                int hold_current = current_template_;
+                current_template_ = dc;
+                Mod* hold = mods_;
+                mods_ = nullptr;
+                print(left(dc));
+                if (last_ == '<') append(' ');
+                append('<');
+                if (simplified_) {
+                    append("...");
+                } else {
+                    print(right(dc));
+                }
+                if (last_ == '>') append(' ');
+                append('>');
+                mods_ = hold;
+                current_template_ = hold_current;
+                return;
+            }
+            case kTemplateParam: {
+                if (lambda_arg_ > 0) {
+                    // 泛型 lambda 的 auto 参数
+                    append("auto:");
+                    append_num(d.num + 1);
+                    return;
+                }
+                int a = lookup_template_param(dc);
+                if (a >= 0 && kind(a) == kTemplateArglist) a = index_arg(a, pack_index_);
+                if (a < 0) {
+                    err_ = true;
+                    return;
+                }
+                // 实参本身可能引用外层模板的参数
+                const Tpl* hold = templates_;
+                templates_ = hold->next;
+                print(a);
+                templates_ = hold;
+                return;
+            }
+            case kFunctionParam:
+                if (d.num == 0) {
+                    append("this");
+                } else {
+                    append("{parm#");
+                    append_num(d.num);
+                    append('}');
+                }
+                return;
+            case kCtor:
+                print(left(dc));
+                return;
+            case kDtor:
+                append('~');
+                print(left(dc));
+                return;
+            case kVtable:
+                append("vtable for ");
+                print(left(dc));
+                return;
+            case kVtt:
+                append("VTT for ");
+                print(left(dc));
+                return;
+            case kConstructionVtable:
+                append("construction vtable for ");
+                print(left(dc));
+                append("-in-");
+                print(right(dc));
+                return;
+            case kTypeinfo:
+                append("typeinfo for ");
+                print(left(dc));
+                return;
+            case kTypeinfoName:
+                append("typeinfo name for ");
+                print(left(dc));
+                return;
+            case kTypeinfoFn:
+                append("typeinfo fn for ");
+                print(left(dc));
+                return;
+            case kThunk:
+                append("non-virtual thunk to ");
+                print(left(dc));
+                return;
+            case kVirtualThunk:
+                append("virtual thunk to ");
+                print(left(dc));
+                return;
+            case kCovariantThunk:
+                append("covariant return thunk to ");
+                print(left(dc));
+                return;
+            case kJavaClass:
+                append("java Class for ");
+                print(left(dc));
+                return;
+            case kGuard:
+                append("guard variable for ");
+                print(left(dc));
+                return;
+            case kTlsInit:
+                append("TLS init function for ");
+                print(left(dc));
+                return;
+            case kTlsWrapper:
+                append("TLS wrapper function for ");
+                print(left(dc));
+                return;
+            case kReftemp:
+                append("reference temporary #");
+                print(right(dc));
+                append(" for ");
+                print(left(dc));
+                return;
+            case kHiddenAlias:
+                append("hidden alias for ");
+                print(left(dc));
+                return;
+            case kTransactionClone:
+                append("transaction clone for ");
+                print(left(dc));
+                return;
+            case kNonTransactionClone:
+                append("non-transaction clone for ");
+                print(left(dc));
+                return;
+            case kTparmObj:
+                append("template parameter object for ");
+                print(left(dc));
+                return;
+            case kRestrict:
+            case kVolatile:
+            case kConst:
+                // 已经在修饰栈上 (例如数组元素类型的 cv) 的限定符不重复打印
+                for (Mod* m = mods_; m; m = m->next) {
+                    if (m->printed) continue;
+                    if (! is_cv(kind(m->node))) break;
+                    if (kind(m->node) == d.kind) {
+                        print(left(dc));
+                        return;
+                    }
+                }
+                print_modifier(dc, left(dc));
+                return;
+            case kReference:
+            case kRvalueReference: {
+                // 引用折叠: & + && = &
+                int sub = left(dc);
+                const Tpl* saved = templates_;
+                if (sub >= 0 && lambda_arg_ == 0 && kind(sub) == kTemplateParam) {
+                    const Scope* scope = find_scope(sub);
+                    if (! scope) {
+                        save_scope(sub);
+                        if (err_) return;
+                    } else {
+                        templates_ = scope->templates;
+                    }
+                    int a = lookup_template_param(sub);
+                    if (a >= 0 && kind(a) == kTemplateArglist) a = index_arg(a, pack_index_);
+                    if (a < 0) {
+                        templates_ = saved;
+                        err_ = true;
+                        return;
+                    }
+                    sub = a;
+                }
+                if (sub >= 0 && (kind(sub) == kReference || kind(sub) == d.kind)) {
+                    print_modifier(sub, left(sub));
+                } else if (sub >= 0 && kind(sub) == kRvalueReference) {
+                    print_modifier(dc, left(sub));
+                } else {
+                    print_modifier(dc, left(dc));
+                }
+                templates_ = saved;
+                return;
+            }
+            case kRestrictThis:
+            case kVolatileThis:
+            case kConstThis:
+            case kReferenceThis:
+            case kRvalueReferenceThis:
+            case kTransactionSafe:
+            case kNoexcept:
+            case kThrowSpec:
+            case kVendorTypeQual:
+            case kPointer:
+            case kComplex:
+            case kImaginary:
+                print_modifier(dc, left(dc));
+                return;
+            case kVendorType:
+                print(left(dc));
+                return;
+            case kFunctionType: {
+                if (left(dc) >= 0 && ! simplified_) {
+                    // 返回类型中的修饰符由函数类型打印, 例如 void (*f())()
+                    Mod m = {dc, false, mods_, templates_};
+                    mods_ = &m;
+                    print(left(dc));
+                    mods_ = m.next;
+                    if (m.printed) return;
+                    append(' ');
+                }
+                print_function_type(dc, mods_);
+                return;
+            }
+            case kArrayType:
+                print_array(dc);
+                return;
+            case kPtrmemType:
+            case kVectorType: {
+                Mod m = {dc, false, mods_, templates_};
+                mods_ = &m;
+                print(right(dc));
+                if (! m.printed) print_mod(dc);
+                mods_ = m.next;
+                return;
+            }
+            case kArglist:
+            case kTemplateArglist:
+                if (left(dc) >= 0) print(left(dc));
+                if (right(dc) >= 0) {
+                    append(", ");
+                    size_t mark = pos_;
+                    print(right(dc));
+                    // 空参数包: 去掉多余的 ", " (与 libiberty 一样不更新 last_)
+                    if (! full_ && pos_ == mark) pos_ -= 2;
+                }
+                return;
+            case kInitializerList:
+                if (left(dc) >= 0) print(left(dc));
+                append('{');
+                print(right(dc));
+                append('}');
+                return;
+            case kOperator: {
+                const OperatorInfo& o = op(dc);
+                append("operator");
+                if (is_lower(o.name[0])) append(' ');
+                size_t len = o.len;
+                if (len > 0 && o.name[len - 1] == ' ') --len;
+                append(o.name, len);
+                return;
+            }
+            case kExtendedOperator:
+                append("operator ");
+                print(left(dc));
+                return;
+            case kConversion:
+                append("operator ");
+                print_conversion(dc);
+                return;
+            case kNullary:
+                print_expr_op(left(dc));
+                return;
+            case kUnary:
+                print_unary(dc);
+                return;
+            case kBinary:
+                print_binary(dc);
+                return;
+            case kTrinary:
+                print_trinary(dc);
+                return;
+            case kLiteral:
+            case kLiteralNeg:
+                print_literal(dc);
+                return;
+            case kNumber:
+                append_num(d.num);
+                return;
+            case kDecltype:
+                append("decltype (");
+                print(left(dc));
+                append(')');
+                return;
+            case kLambda:
+                append("{lambda(");
+                if (simplified_) {
+                    if (! is_empty_list(left(dc))) append("...");
+                } else {
+                    ++lambda_arg_;
+                    print(left(dc));
+                    --lambda_arg_;
+                }
+                append(")#");
+                append_num(d.num + 1);
+                append('}');
+                return;
+            case kUnnamedType:
+                append("{unnamed type#");
+                append_num(d.num + 1);
+                append('}');
+                return;
+            case kPackExpansion: {
+                int a = find_pack(left(dc));
+                if (err_) return;
+                if (a < 0) {
+                    // 无法展开时原样打印
+                    print_subexpr(left(dc));
+                    append("...");
+                    return;
+                }
+                int len = pack_length(a);
+                for (int i = 0; i < len; ++i) {
+                    pack_index_ = i;
+                    print(left(dc));
+                    if (i < len - 1) append(", ");
+                }
+                return;
+            }
+            case kClone:
+                print(left(dc));
+                append(" [clone ");
+                print(right(dc));
+                append(']');
+                return;
+            default:
+                err_ = true;
+                return;
+        }
+    }
+
+    // 修饰符 (指针、引用、cv 等) 先压栈, 由内层类型决定打印位置
+    void print_modifier(int mod, int inner) {
+        Mod m = {mod, false, mods_, templates_};
+        mods_ = &m;
+        print(inner);
+        if (! m.printed) print_mod(mod);
+        mods_ = m.next;
+    }
+
+    void print_typed_name(int dc) {
+        Mod* hold = mods_;
+        mods_ = nullptr;
+        Mod adpm[4];
+        int i = 0;
+        int typed = left(dc);
+        // 名字及其后的 this 限定符都要在参数列表之后打印
+        while (typed >= 0) {
+            if (i >= 4) {
+                err_ = true;
+                return;
+            }
+            adpm[i].node = typed;
+            adpm[i].printed = false;
+            adpm[i].next = mods_;
+            adpm[i].templates = templates_;
+            mods_ = &adpm[i];
+            ++i;
+            if (! is_fnqual(kind(typed))) break;
+            typed = left(typed);
+        }
+        if (typed < 0) {
+            err_ = true;
+            return;
+        }
+        if (kind(typed) == kLocalName) {
+            typed = right(typed);
+            if (typed >= 0 && kind(typed) == kDefaultArg) typed = left(typed);
+            while (typed >= 0 && is_fnqual(kind(typed))) {
+                if (i >= 4) {
+                    err_ = true;
+                    return;
+                }
+                adpm[i] = adpm[i - 1];
+                adpm[i].next = &adpm[i - 1];
+                mods_ = &adpm[i];
+                adpm[i - 1].node = typed;
+                adpm[i - 1].printed = false;
+                ++i;
+                typed = left(typed);
+            }
+            if (typed < 0) {
+                err_ = true;
+                return;
+            }
+        }
+        // 函数模板的实参同样作用于其函数类型
+        Tpl dpt = {typed, templates_};
+        bool is_template = kind(typed) == kTemplate;
+        if (is_template) templates_ = &dpt;
+        print(right(dc));
+        if (is_template) templates_ = dpt.next;
+        while (i > 0) {
+            --i;
+            if (! adpm[i].printed) {
+                append(' ');
+                print_mod(adpm[i].node);
+            }
+        }
+        mods_ = hold;
+    }
+
+    void print_mod_list(Mod* mods, bool suffix) {
+        for (; mods && ! err_; mods = mods->next) {
+            if (mods->printed || (! suffix && is_fnqual(kind(mods->node)))) continue;
+            mods->printed = true;
+            const Tpl* hold_templates = templates_;
+            templates_ = mods->templates;
+            int node = mods->node;
+            Kind k = kind(node);
+            if (k == kFunctionType) {
+                print_function_type(node, mods->next);
+                templates_ = hold_templates;
+                return;
+            }
+            if (k == kArrayType) {
+                print_array_type(node, mods->next);
+                templates_ = hold_templates;
+                return;
+            }
+            if (k == kLocalName) {
+                // 局部名字的函数部分要放在修饰符之外
+                Mod* hold = mods_;
+                mods_ = nullptr;
+                print(left(node));
+                mods_ = hold;
+                append("::");
+                int name = right(node);
+                if (name >= 0 && kind(name) == kDefaultArg) {
+                    append("{default arg#");
+                    append_num(n(name).num + 1);
+                    append("}::");
+                    name = left(name);
+                }
+                while (name >= 0 && is_fnqual(kind(name))) name = left(name);
+                print(name);
+                templates_ = hold_templates;
+                return;
+            }
+            print_mod(node);
+            templates_ = hold_templates;
+        }
+    }
+
+    void print_mod(int mod) {
+        switch (kind(mod)) {
+            case kRestrict:
+            case kRestrictThis:
+                append(" restrict");
+                return;
+            case kVolatile:
+            case kVolatileThis:
+                append(" volatile");
+                return;
+            case kConst:
+            case kConstThis:
+                append(" const");
+                return;
+            case kTransactionSafe:
+                append(" transaction_safe");
+                return;
+            case kNoexcept:
+                append(" noexcept");
+                if (right(mod) >= 0) {
+                    append('(');
+                    print(right(mod));
+                    append(')');
+                }
+                return;
+            case kThrowSpec:
+                append(" throw");
+                if (right(mod) >= 0) {
+                    append('(');
+                    print(right(mod));
+                    append(')');
+                }
+                return;
+            case kVendorTypeQual:
+                append(' ');
+                print(right(mod));
+                return;
+            case kPointer:
+                append('*');
+                return;
+            case kReferenceThis:
+                append(' ');
+                append('&');
+                return;
+            case kReference:
+                append('&');
+                return;
+            case kRvalueReferenceThis:
+                append(' ');
+                append("&&");
+                return;
+            case kRvalueReference:
+                append("&&");
+                return;
+            case kComplex:
+                append(" _Complex");
+                return;
+            case kImaginary:
+                append(" _Imaginary");
+                return;
+            case kPtrmemType:
+                if (last_ != '(') append(' ');
+                print(left(mod));
+                append("::*");
+                return;
+            case kTypedName:
+                print(left(mod));
+                return;
+            case kVectorType:
+                append(" __vector(");
+                print(left(mod));
+                append(')');
+                return;
+            default:
+                print(mod);
+                return;
+        }
+    }
+
+    void print_function_type(int dc, Mod* mods) {
+        bool need_paren = false, need_space = false;
+        for (Mod* p = mods; p; p = p->next) {
+            if (p->printed) break;
+            switch (kind(p->node)) {
+                case kPointer:
+                case kReference:
+                case kRvalueReference:
+                    need_paren = true;
+                    break;
+                case kRestrict:
+                case kVolatile:
+                case kConst:
+                case kVendorTypeQual:
+                case kComplex:
+                case kImaginary:
+                case kPtrmemType:
+                    need_space = true;
+                    need_paren = true;
+                    break;
+                default:
+                    break;
+            }
+            if (need_paren) break;
+        }
+        if (need_paren) {
+            if (! need_space && last_ != '(' && last_ != '*') need_space = true;
+            if (need_space && last_ != ' ') append(' ');
+            append('(');
+        }
+        Mod* hold = mods_;
+        mods_ = nullptr;
+        print_mod_list(mods, false);
+        if (need_paren) append(')');
+        append('(');
+        if (simplified_) {
+            if (! is_empty_list(right(dc))) append("...");
+        } else if (right(dc) >= 0) {
+            print(right(dc));
+        }
+        append(')');
+        print_mod_list(mods, true);
+        mods_ = hold;
+    }
+
+    void print_array(int dc) {
+        // 数组本身的 cv 限定符作用于元素类型, 复制到本层的修饰栈上
+        Mod* hold = mods_;
+        Mod adpm[4];
+        adpm[0].node = dc;
+        adpm[0].printed = false;
+        adpm[0].next = hold;
+        adpm[0].templates = templates_;
+        mods_ = &adpm[0];
+        int i = 1;
+        for (Mod* p = hold; p && is_cv(kind(p->node)); p = p->next) {
+            if (p->printed) continue;
+            if (i >= 4) {
+                err_ = true;
+                return;
+            }
+            adpm[i] = *p;
+            adpm[i].next = mods_;
+            mods_ = &adpm[i];
+            p->printed = true;
+            ++i;
+        }
+        print(right(dc));
+        mods_ = hold;
+        if (adpm[0].printed) return;
+        while (i > 1) {
+            --i;
+            print_mod(adpm[i].node);
+        }
+        print_array_type(dc, mods_);
+    }
+
+    void print_array_type(int dc, Mod* mods) {
+        bool need_space = true;
+        if (mods) {
+            bool need_paren = false;
+            for (Mod* p = mods; p; p = p->next) {
+                if (p->printed) continue;
+                if (kind(p->node) == kArrayType) {
+                    need_space = false;
+                } else {
+                    need_paren = true;
+                    need_space = true;
+                }
+                break;
+            }
+            if (need_paren) append(" (");
+            print_mod_list(mods, false);
+            if (need_paren) append(')');
+        }
+        if (need_space) append(' ');
+        append('[');
+        if (left(dc) >= 0) print(left(dc));
+        append(']');
+    }
+
+    // 转换运算符的类型中的 T_ 指代所在模板 (即运算符自身) 的实参
+    void print_conversion(int dc) {
+        Tpl dpt = {current_template_, templates_};
+        bool pushed = current_template_ >= 0;
+        if (pushed) templates_ = &dpt;
+        int type = left(dc);
+        if (kind(type) != kTemplate) {
+            print(type);
+            if (pushed) templates_ = dpt.next;
+            return;
+        }
+        print(left(type));
+        if (pushed) templates_ = dpt.next;
+        if (last_ == '<') append(' ');
+        append('<');
+        if (simplified_) {
+            append("...");
+        } else {
+            print(right(type));
+        }
+        if (last_ == '>') append(' ');
+        append('>');
+    }
+
+    void print_subexpr(int dc) {
+        bool simple = false;
+        if (dc >= 0) {
+            Kind k = kind(dc);
+            simple = k == kName || k == kQualName || k == kInitializerList || k == kFunctionParam;
+        }
+        if (! simple) append('(');
+        print(dc);
+        if (! simple) append(')');
+    }
+
+    void print_expr_op(int dc) {
+        if (dc >= 0 && kind(dc) == kOperator) {
+            append(op(dc).name, op(dc).len);
+        } else {
+            print(dc);
+        }
+    }
+
+    void print_unary(int dc) {
+        int oper = left(dc);
+        int operand = right(dc);
+        const char* code = kind(oper) == kOperator ? op(oper).code : nullptr;
+        if (code) {
+            if (strcmp(code, "ad") == 0 && kind(operand) == kTypedName && kind(left(operand)) == kQualName &&
+                kind(right(operand)) == kFunctionType) {
+                operand = left(operand); // &A::f 不打印参数列表
+            }
+            if (kind(operand) == kBinaryArgs) {
+                // 后缀 ++/--
+                print_subexpr(left(operand));
+                print_expr_op(oper);
+                return;
+            }
+            if (strcmp(code, "sZ") == 0) {
+                append_num(pack_length(find_pack(operand)));
+                return;
+            }
+        }
+        if (kind(oper) != kCast) {
+            print_expr_op(oper);
+        } else {
+            append('(');
+            print(left(oper));
+            append(')');
+        }
+        if (code && strcmp(code, "gs") == 0) {
+            print(operand);
+        } else if (code && strcmp(code, "st") == 0) {
+            append('(');
+            print(operand);
+            append(')');
+        } else {
+            print_subexpr(operand);
+        }
+    }
+
+    void print_binary(int dc) {
+        int oper = left(dc);
+        int args = right(dc);
+        if (kind(oper) != kOperator || kind(args) != kBinaryArgs) {
+            err_ = true;
+            return;
+        }
+        const OperatorInfo& o = op(oper);
+        if (is_new_cast(o.code)) {
+            print_expr_op(oper);
+            append('<');
+            print(left(args));
+            append(">(");
+            print(right(args));
+            append(')');
+            return;
+        }
+        // 模板实参中的 > 需要括起来
+        bool gt = o.len == 1 && o.name[0] == '>';
+        if (gt) append('(');
+        bool call = strcmp(o.code, "cl") == 0;
+        if (call && kind(left(args)) == kTypedName) {
+            int func = left(args);
+            if (kind(right(func)) != kFunctionType) {
+                err_ = true;
+                return;
+            }
+            print_subexpr(left(func));
+        } else {
+            print_subexpr(left(args));
+        }
+        if (strcmp(o.code, "ix") == 0) {
+            append('[');
+            print(right(args));
+            append(']');
+        } else {
+            if (! call) print_expr_op(oper);
+            print_subexpr(right(args));
+        }
+        if (gt) append(')');
+    }
+
+    void print_trinary(int dc) {
+        int oper = left(dc);
+        int arg1 = right(dc);
+        if (kind(arg1) != kTrinaryArg1 || kind(right(arg1)) != kTrinaryArg2) {
+            err_ = true;
+            return;
+        }
+        int arg2 = right(arg1);
+        print_subexpr(left(arg1));
+        print_expr_op(oper);
+        print_subexpr(left(arg2));
+        append(" : ");
+        print_subexpr(right(arg2));
+    }
+
+    void print_literal(int dc) {
+        int type = left(dc);
+        int value = right(dc);
+        bool neg = kind(dc) == kLiteralNeg;
+        int tp = kPrintDefault;
+        if (kind(type) == kBuiltinType) {
+            tp = n(type).num;
+            switch (tp) {
+                case kPrintInt:
+                case kPrintUnsigned:
+                case kPrintLong:
+                case kPrintUnsignedLong:
+                case kPrintLongLong:
+                case kPrintUnsignedLongLong:
+                    if (kind(value) == kName) {
+                        if (neg) append('-');
+                        print(value);
+                        switch (tp) {
+                            case kPrintUnsigned:
+                                append('u');
+                                break;
+                            case kPrintLong:
+                                append('l');
+                                break;
+                            case kPrintUnsignedLong:
+                                append("ul");
+                                break;
+                            case kPrintLongLong:
+                                append("ll");
+                                break;
+                            case kPrintUnsignedLongLong:
+                                append("ull");
+                                break;
+                            default:
+                                break;
+                        }
+                        return;
+                    }
+                    break;
+                case kPrintBool:
+                    if (kind(value) == kName && n(value).len == 1 && ! neg) {
+                        if (n(value).u.str[0] == '0') {
+                            append("false");
+                            return;
+                        }
+                        if (n(value).u.str[0] == '1') {
+                            append("true");
+                            return;
+                        }
+                    }
+                    break;
+                default:
+                    break;
+            }
+        }
+        append('(');
+        print(type);
+        append(')');
+        if (neg) append('-');
+        if (tp == kPrintFloat) append('[');
+        print(value);
+        if (tp == kPrintFloat) append(']');
+    }
+
+    // 解析状态
+    const char* p_;
+    Node* nodes_;
+    int nnodes_;
+    int* subs_;
+    int nsubs_;
+    int last_name_;  // 最近的 source-name, 构造/析构函数使用
+    bool is_expression_;
+    bool is_conversion_;
+    bool fail_;      // 超出容量
+    int depth_;
+
+    // 打印状态
+    char* out_;
+    size_t cap_;
+    size_t pos_;
+    char last_;
+    bool full_;
+    bool err_;
+    bool simplified_;
+    Mod* mods_;
+    const Tpl* templates_;
+    int current_template_; // 正在打印的模板, 供其中的转换运算符使用
+    int pack_index_;
+    int lambda_arg_;
+    int steps_;
+    Scope scopes_[kMaxScopes];
+    int nscopes_;
+    Tpl scope_templates_[kMaxScopeTemplates];
+    int nscope_templates_;
+};
+
+} // namespace itanium
+
+// 把以 _Z 开头的符号名 demangle 到 buf (不分配内存, 可在信号处理函数中调用, 但需要约 128KB 的栈余量, 见文件开头)
+// 返回写入的长度 (不含结尾的 '\0'); 结果被截断时以 "..." 结尾并返回 cap; 不是合法的符号名或不支持时返回 0
+inline size_t demangle_into(const char* mangled, char* buf, size_t cap, DemangleStyle style = DemangleStyle::Full) {
+    if (! buf || cap == 0) return 0;
+    buf[0] = '\0';
+    if (! mangled || mangled[0] != '_' || mangled[1] != 'Z') return 0;
+    itanium::Node nodes[itanium::kMaxNodes];
+    int subs[itanium::kMaxSubs];
+    itanium::Demangler d(mangled, nodes, subs);
+    return d.demangle(buf, cap, style == DemangleStyle::Simplified);
+}
+
+} // namespace stacktrace
@@ -0,0 +1,263 @@
+// sst_fiber.hpp - 用户态协程 (fiber / 有栈协程) 的栈回溯 (仅 Linux, x86_64 / aarch64)
+// - walk_context() 从保存的上下文 (ucontext_t 或 {pc, sp, fp}) 沿 frame pointer 链回溯另一个栈,
+//   读取限制在 [sp, 栈顶) 之内; 协程代码须以 -fno-omit-frame-pointer 编译
+// - FiberRegistry 供协程库登记协程栈: 创建/销毁时 add()/remove() 取一次锁,
+//   每次切换的 park()/resume() 只写所属槽位中的几个原子变量
+// - dump_parked() 一次抓取所有挂起协程的栈, 所有栈共用一次模块加载, 相同的地址只解析一次
+//
+//   auto& reg = stacktrace::FiberRegistry::instance();
+//   int h = reg.add(stack, stack_size, "conn-42");   // 创建协程时
+//   reg.resume(h);                                   // 调度器切入之前
+//   swapcontext(&sched_uc, &fiber_uc);
+//   reg.park(h, fiber_uc);                           // 切换完成之后, 此时 fiber_uc 已保存好
+//   ...
+//   reg.print_parked(std::cerr);                     // 卡死时输出所有挂起的协程
+//   reg.remove(h);                                   // 释放栈内存之前
+
+#pragma once
+
+#include "sst.hpp"
+
+#include <mutex>
+#include <unordered_map>
+
+#include <ucontext.h>
+
+namespace stacktrace {
+
+// 协程切出时保存的寄存器: 恢复执行的地址, 栈指针与帧指针
+struct FiberContext {
+    uintptr_t pc;
+    uintptr_t sp;
+    uintptr_t fp;
+};
+
+inline FiberContext context_from_ucontext(const ucontext_t& uc) {
+#if defined(__x86_64__)
+    return {static_cast<uintptr_t>(uc.uc_mcontext.gregs[REG_RIP]), static_cast<uintptr_t>(uc.uc_mcontext.gregs[REG_RSP]),
+            static_cast<uintptr_t>(uc.uc_mcontext.gregs[REG_RBP])};
+#elif defined(__aarch64__)
+    return {static_cast<uintptr_t>(uc.uc_mcontext.pc), static_cast<uintptr_t>(uc.uc_mcontext.sp),
+            static_cast<uintptr_t>(uc.uc_mcontext.regs[29])};
+#else
+#error "sst_fiber.hpp supports x86_64 and aarch64 only"
+#endif
+}
+
+// frames[0] 为 pc, 之后为帧指针链上的返回地址; sp 在栈内时只读取 [sp, high), 更低处是已经弹出的帧
+// swapcontext() 保存的 pc 是其调用者中的返回地址, fp 是调用者的帧, 栈顶因此就是切换点
+inline size_t walk_context(const FiberContext& ctx, StackBounds stack, void** frames, size_t max_frames) {
+    if (max_frames == 0 || ctx.pc == 0) return 0;
+    frames[0] = reinterpret_cast<void*>(ctx.pc);
+    uintptr_t low = ctx.sp >= stack.low && ctx.sp < stack.high ? ctx.sp : stack.low;
+    return 1 + walk_frame_pointers(ctx.fp, low, stack.high, frames + 1, max_frames - 1);
+}
+
+inline size_t walk_context(const ucontext_t& uc, StackBounds stack, void** frames, size_t max_frames) {
+    return walk_context(context_from_ucontext(uc), stack, frames, max_frames);
+}
+
+// 一个挂起协程的栈
+struct FiberTrace {
+    int handle;         // add() 返回的句柄
+    std::string name;   // 登记时的名字
+    StackBounds stack;  // 协程栈的地址范围
+    std::vector<ResolvedFrame> frames;
+
+    FiberTrace() : handle(-1), name(), stack{0, 0}, frames() {}
+};
+
+struct FiberRegistryStats {
+    size_t registered; // 当前登记的协程数
+    size_t parked;     // 其中处于挂起状态的
+};
+
+namespace fiber {
+
+static constexpr size_t kNameLen = 32;
+static constexpr size_t kChunkSlots = 1024;
+static constexpr size_t kMaxChunks = 256; // 最多 26 万个协程
+// 回溯与协程恢复执行撞上时的重试次数
+static constexpr int kWalkAttempts = 3;
+
+// park()/resume() 由协程的所有者 (当前调度它的线程) 写入, 按 seqlock 发布: seq 为奇数时正在修改;
+// 读者在 seq 不变的窗口内读取上下文并回溯, 窗口内协程恢复执行则丢弃结果重试
+struct Slot {
+    std::atomic<uint32_t> seq{0};
+    std::atomic<bool> parked{false};
+    std::atomic<uintptr_t> pc{0};
+    std::atomic<uintptr_t> sp{0};
+    std::atomic<uintptr_t> fp{0};
+    // 以下字段只在持有 FiberRegistry 的锁时读写
+    bool used = false;
+    StackBounds stack = {0, 0};
+    char name[kNameLen] = {};
+};
+
+} // namespace fiber
+
+class FiberRegistry {
+  public:
+    FiberRegistry() : mu_(), chunks_(), next_(0), free_() {}
+
+    FiberRegistry(const FiberRegistry&) = delete;
+    FiberRegistry& operator=(const FiberRegistry&) = delete;
+
+    static FiberRegistry& instance() {
+        static FiberRegistry* r = new FiberRegistry(); // 不析构: 协程可能在静态对象析构之后才注销
+        return *r;
+    }
+
+    // 登记协程栈 [stack, stack + size), 返回句柄; 已满时返回 -1
+    // 新登记的协程视为正在运行, 第一次 park() 之后才会出现在 dump_parked() 中
+    int add(const void* stack, size_t size, const char* name = nullptr) {
+        std::lock_guard<std::mutex> lock(mu_);
+        int handle;
+        if (! free_.empty()) {
+            handle = free_.back();
+            free_.pop_back();
+        } else {
+            if (next_ >= fiber::kChunkSlots * fiber::kMaxChunks) return -1;
+            handle = static_cast<int>(next_++);
+            size_t chunk = static_cast<size_t>(handle) / fiber::kChunkSlots;
+            if (! chunks_[chunk].load(std::memory_order_relaxed)) {
+                chunks_[chunk].store(new fiber::Slot[fiber::kChunkSlots], std::memory_order_release);
+            }
+        }
+        fiber::Slot& s = slot(handle);
+        s.used = true;
+        s.stack.low = reinterpret_cast<uintptr_t>(stack);
+        s.stack.high = s.stack.low + size;
+        snprintf(s.name, sizeof(s.name), "%s", name ? name : "");
+        s.parked.store(false, std::memory_order_relaxed);
+        return handle;
+    }
+
+    // 注销协程; 必须在释放其栈内存之前调用, 返回后 dump_parked() 不会再读取这段栈
+    void remove(int handle) {
+        std::lock_guard<std::mutex> lock(mu_);
+        fiber::Slot& s = slot(handle);
+        if (! s.used) return;
+        publish(s, nullptr);
+        s.used = false;
+        free_.push_back(handle);
+    }
+
+    // 协程已切出: ctx 须是切换完成后保存下来的上下文
+    void park(int handle, const FiberContext& ctx) {
+        publish(slot(handle), &ctx);
+    }
+
+    void park(int handle, const ucontext_t& uc) {
+        FiberContext ctx = context_from_ucontext(uc);
+        publish(slot(handle), &ctx);
+    }
+
+    // 协程即将恢复执行, 之后它的栈不再被回溯
+    void resume(int handle) {
+        publish(slot(handle), nullptr);
+    }
+
+    FiberRegistryStats stats() const {
+        std::lock_guard<std::mutex> lock(mu_);
+        FiberRegistryStats st = {0, 0};
+        for (size_t i = 0; i < next_; ++i) {
+            const fiber::Slot& s = slot(static_cast<int>(i));
+            if (! s.used) continue;
+            ++st.registered;
+            if (s.parked.load(std::memory_order_relaxed)) ++st.parked;
+        }
+        return st;
+    }
+
+    // 抓取所有挂起协程的栈并符号化, 按句柄排序
+    // 回溯时持有锁 (add()/remove() 会等待), 符号化在锁外进行; 与其他解析接口一样不能并发调用
+    std::vector<FiberTrace> dump_parked(size_t max_frames = 64) {
+        std::vector<FiberTrace> traces;
+        std::vector<void*> addrs; // 所有栈的地址首尾相接
+        std::vector<size_t> counts;
+        std::vector<void*> frames(max_frames);
+        {
+            std::lock_guard<std::mutex> lock(mu_);
+            for (size_t i = 0; i < next_; ++i) {
+                const fiber::Slot& s = slot(static_cast<int>(i));
+                if (! s.used) continue;
+                size_t n = walk_parked(s, frames.data(), max_frames);
+                if (n == 0) continue;
+                FiberTrace t;
+                t.handle = static_cast<int>(i);
+                t.name = s.name;
+                t.stack = s.stack;
+                traces.push_back(std::move(t));
+                addrs.insert(addrs.end(), frames.begin(), frames.begin() + static_cast<std::ptrdiff_t>(n));
+                counts.push_back(n);
+            }
+        }
+
+        // 协程大多停在相同的几个调度点上, 按地址去重后只解析一次
+        Modules& modules = ModuleManager::instance().load_self_modules();
+        std::unordered_map<void*, ResolvedFrame> resolved;
+        size_t pos = 0;
+        for (size_t i = 0; i < traces.size(); ++i) {
+            traces[i].frames.reserve(counts[i]);
+            for (size_t j = 0; j < counts[i]; ++j, ++pos) {
+                auto it = resolved.find(addrs[pos]);
+                if (it == resolved.end()) it = resolved.emplace(addrs[pos], resolve_with_modules(addrs[pos], modules)).first;
+                traces[i].frames.push_back(it->second);
+                traces[i].frames.back().index = j;
+            }
+        }
+        return traces;
+    }
+
+    void print_parked(std::ostream& os, size_t max_frames = 64) {
+        for (const auto& t : dump_parked(max_frames)) {
+            os << "fiber #" << t.handle;
+            if (! t.name.empty()) os << " (" << t.name << ")";
+            os << ":\n";
+            print_frames(os, t.frames);
+        }
+    }
+
+  private:
+    mutable std::mutex mu_;
+    std::atomic<fiber::Slot*> chunks_[fiber::kMaxChunks];
+    size_t next_; // 已分配过的句柄数
+    std::vector<int> free_;
+
+    fiber::Slot& slot(int handle) const {
+        size_t h = static_cast<size_t>(handle);
+        return chunks_[h / fiber::kChunkSlots].load(std::memory_order_acquire)[h % fiber::kChunkSlots];
+    }
+
+    // 单写者的 seqlock 写入: ctx 为空表示恢复运行
+    static void publish(fiber::Slot& s, const FiberContext* ctx) {
+        uint32_t seq = s.seq.load(std::memory_order_relaxed);
+        s.seq.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        if (ctx) {
+            s.pc.store(ctx->pc, std::memory_order_relaxed);
+            s.sp.store(ctx->sp, std::memory_order_relaxed);
+            s.fp.store(ctx->fp, std::memory_order_relaxed);
+        }
+        s.parked.store(ctx != nullptr, std::memory_order_relaxed);
+        s.seq.store(seq + 2, std::memory_order_release);
+    }
+
+    // 在 seq 不变的窗口内读取上下文并回溯; 协程一直在运行或反复被调度时返回 0
+    static size_t walk_parked(const fiber::Slot& s, void** frames, size_t max_frames) {
+        for (int attempt = 0; attempt < fiber::kWalkAttempts; ++attempt) {
+            uint32_t seq = s.seq.load(std::memory_order_acquire);
+            if (seq & 1) continue;
+            if (! s.parked.load(std::memory_order_relaxed)) return 0;
+            FiberContext ctx = {s.pc.load(std::memory_order_relaxed), s.sp.load(std::memory_order_relaxed),
+                                s.fp.load(std::memory_order_relaxed)};
+            size_t n = walk_context(ctx, s.stack, frames, max_frames);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (s.seq.load(std::memory_order_relaxed) == seq) return n;
+        }
+        return 0;
+    }
+};
+
+} // namespace stacktrace
@@ -0,0 +1,351 @@
+// sst_fwd.hpp - sst.hpp 的轻量前置头文件: 公开的帧类型、展开/解析策略与 BasicStacktrace
+// - 默认 (header-only) 时等同于包含 sst.hpp
+// - 整个程序统一以 -DSST_COMPILED 编译时, 只引入本文件所需的少量标准头文件, 实现由唯一一个
+//   定义了 SST_IMPLEMENTATION 再包含 sst.hpp 的源文件提供 (libsst.{a,so} 已包含这份实现)
+//
+//   // 常用的日志头文件中
+//   #include "sst_fwd.hpp"
+//   stacktrace::Stacktrace::capture().print();
+//
+//   // sst_impl.cpp (或直接链接 -lsst)
+//   #define SST_IMPLEMENTATION
+//   #include "sst.hpp"
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+#include <execinfo.h>
+#include <sys/types.h>
+
+#if defined(SST_IMPLEMENTATION) && ! defined(SST_COMPILED)
+#define SST_COMPILED
+#endif
+
+// 下列函数在 header-only 模式下为 inline, SST_COMPILED 时由 SST_IMPLEMENTATION 所在的源文件给出唯一定义
+#ifdef SST_COMPILED
+#define SST_API
+#else
+#define SST_API inline
+#endif
+
+// 整个程序统一以 -DSST_SHADOW_STACK (并以 -finstrument-functions) 编译时, 默认的展开策略为影子调用栈
+#ifdef SST_SHADOW_STACK
+#include "sst_shadow.hpp"
+#endif
+
+namespace stacktrace {
+
+// 定义 (及各取值) 在 sst_demangle.hpp 中; 本文件只在声明中用到它, 不必引入整个 demangler
+enum class DemangleStyle;
+
+// 按名字反查的匹配方式
+enum class NameMatch {
+    Mangled,   // mangled 名精确匹配 (优先走 .gnu_hash)
+    Demangled, // demangled 名精确匹配, 例如 "ns::foo(int)"
+    Prefix,    // demangled 名前缀匹配, 例如 "ns::foo" 可匹配所有重载
+    Glob,      // demangled 名 glob 匹配, 例如 "ns::net::*"
+};
+
+// 一个函数符号所占的地址区间 [start, end)
+struct SymbolRange {
+    uintptr_t start = 0;
+    uintptr_t end = 0;
+    std::string name; // mangled name
+    std::string module;
+
+    SymbolRange() : start(0), end(0), name(), module() {}
+};
+
+struct RawFrame {
+    uintptr_t abs_addr = 0;
+    uintptr_t offset = 0;
+    std::string module;
+    bool has_symbol = false;
+
+    RawFrame() : abs_addr(0), offset(0), module(), has_symbol(false) {}
+};
+
+struct ResolvedFrame {
+    size_t index = 0;
+    uintptr_t abs_addr = 0;
+    std::string function;
+    std::string module;
+    uintptr_t offset = 0;
+    bool has_symbol = false;
+
+    ResolvedFrame() : index(0), abs_addr(0), function(), module(), offset(0), has_symbol(false) {}
+
+    std::string to_string() const;
+};
+
+// 轻量的帧视图: 只持有指向模块路径与缓存的 demangled 名的指针, 不分配任何内存
+// 指针在下一次 clear_modules_cache() 之前有效 (设置了符号内存预算时只在回调期间有效), 需要长期保存请使用 ResolvedFrame
+struct FrameView {
+    size_t index;
+    uintptr_t abs_addr;
+    uintptr_t offset;
+    const char* function; // 以 '\0' 结尾, 无符号时为 ""
+    size_t function_len;
+    const char* module;
+    size_t module_len;
+    bool has_symbol;
+
+    // 格式与 ResolvedFrame::to_string() 一致, 返回值同 snprintf (不含 '\0' 的完整长度)
+    int format(char* buf, size_t cap) const {
+        if (has_symbol) {
+            return snprintf(buf,
+                            cap,
+                            "[%zu] %.*s+0x%lx in %.*s (%p)\n",
+                            index,
+                            static_cast<int>(function_len),
+                            function,
+                            static_cast<unsigned long>(offset),
+                            static_cast<int>(module_len),
+                            module,
+                            reinterpret_cast<void*>(abs_addr));
+        }
+        return snprintf(buf,
+                        cap,
+                        "[%zu] (no symbol) in %.*s (%p)\n",
+                        index,
+                        static_cast<int>(module_len),
+                        module,
+                        reinterpret_cast<void*>(abs_addr));
+    }
+};
+
+// 已加载符号表的内存统计
+struct SymbolMemoryStats {
+    size_t footprint;        // 当前已加载符号数据的估算字节数 (符号表 + demangle 缓存 + 按名字反查索引)
+    size_t budget;           // 预算, 0 表示不限制
+    size_t resident_modules; // 当前已加载符号表的模块数
+    uint64_t evictions;      // 因超出预算被释放的次数
+    uint64_t reloads;        // 被释放后再次加载的次数
+};
+
+// 与 BasicStacktrace 的同名静态函数相同, 与模板参数无关
+SST_API void set_symbol_memory_budget(size_t bytes);
+SST_API SymbolMemoryStats symbol_memory_stats();
+
+// 解析结果 (ResolvedFrame::function 与 FrameView::function) 的函数名风格, 默认 Full; 切换时清空已加载的模块缓存
+// find_symbols() 的按名字反查不受影响, 始终使用完整的名字
+SST_API void set_demangle_style(DemangleStyle style);
+SST_API DemangleStyle demangle_style();
+
+SST_API std::vector<ResolvedFrame> resolve_on_pid(const std::vector<void*>& addr_batch, pid_t target_pid);
+SST_API std::vector<RawFrame> resolve_to_raw_on_pid(const std::vector<void*>& addr_batch, pid_t target_pid);
+
+// 按名字反查函数地址区间, 在当前进程 / 目标进程的所有模块中查找
+SST_API std::vector<SymbolRange> find_symbols(const std::string& pattern, NameMatch mode);
+SST_API std::vector<SymbolRange> find_symbols_on_pid(const std::string& pattern, NameMatch mode, pid_t target_pid);
+
+// 逐帧输出 ResolvedFrame::to_string(), 不带 os 时输出到 std::cout
+SST_API void print_frames(std::ostream& os, const std::vector<ResolvedFrame>& frames);
+SST_API void print_frames(const std::vector<ResolvedFrame>& frames);
+
+// 当前线程栈的地址范围, frame pointer 回溯时用于越界检查
+struct StackBounds {
+    uintptr_t low;
+    uintptr_t high;
+};
+
+SST_API StackBounds current_stack_bounds();
+
+// 沿 frame pointer 链回溯, x86_64 与 aarch64 的帧记录均为 [fp] = 上一帧 fp, [fp + 8] = 返回地址
+// 所有读取都限制在 [low, high) 之内, 遇到不带 frame pointer 的帧时只会提前结束而不会越界
+inline size_t walk_frame_pointers(uintptr_t fp, uintptr_t low, uintptr_t high, void** frames, size_t max_frames) {
+    size_t n = 0;
+    while (n < max_frames) {
+        if (fp < low || fp + 2 * sizeof(uintptr_t) > high || (fp & (sizeof(uintptr_t) - 1)) != 0) break;
+        auto* record = reinterpret_cast<const uintptr_t*>(fp);
+        uintptr_t next = record[0];
+        uintptr_t ret = record[1];
+        if (ret == 0) break;
+        frames[n++] = reinterpret_cast<void*>(ret);
+        if (next <= fp) break; // 栈向低地址增长, 调用者的帧一定在更高处
+        fp = next;
+    }
+    return n;
+}
+
+// 栈展开策略: 默认使用 execinfo 的 backtrace(), 依赖 .eh_frame, 对任何编译选项都可用
+struct ExecinfoUnwinder {
+    static size_t unwind(void** frames, size_t max_frames) {
+        int n = ::backtrace(frames, static_cast<int>(max_frames));
+        return n > 0 ? static_cast<size_t>(n) : 0;
+    }
+};
+
+// 栈展开策略: 沿 frame pointer 链回溯, 开销远低于 backtrace(), 但要求以 -fno-omit-frame-pointer 编译
+struct FramePointerUnwinder {
+    __attribute__((noinline)) static size_t unwind(void** frames, size_t max_frames) {
+        StackBounds bounds = current_stack_bounds();
+        uintptr_t fp = reinterpret_cast<uintptr_t>(__builtin_frame_address(0));
+        return walk_frame_pointers(fp, bounds.low, bounds.high, frames, max_frames);
+    }
+};
+
+#ifdef SST_SHADOW_STACK
+using DefaultUnwinder = ShadowStackUnwinder;
+#else
+using DefaultUnwinder = ExecinfoUnwinder;
+#endif
+
+// 解析策略: 通过 ModuleManager 解析当前进程已加载模块中的符号
+struct ModuleResolver {
+    static ResolvedFrame resolve(void* address);
+    static RawFrame resolve_to_raw(void* address);
+    static void resolve_view(void* address, FrameView& view);
+    static void clear_cache();
+};
+
+// 解析策略: 只保留地址, 不加载任何模块与符号 (例如只需按地址聚合的采样场景)
+struct AddressOnlyResolver {
+    static ResolvedFrame resolve(void* address) {
+        ResolvedFrame f;
+        f.abs_addr = reinterpret_cast<uintptr_t>(address);
+        return f;
+    }
+
+    static RawFrame resolve_to_raw(void* address) {
+        RawFrame f;
+        f.abs_addr = reinterpret_cast<uintptr_t>(address);
+        return f;
+    }
+
+    static void resolve_view(void* address, FrameView& view) {
+        view = FrameView{0, reinterpret_cast<uintptr_t>(address), 0, "", 0, "", 0, false};
+    }
+
+    static void clear_cache() {}
+};
+
+// MaxFrames 决定帧存储的大小 (编译期确定, 无堆分配)
+// Unwinder 决定如何抓栈, Resolver 决定如何解析, 未使用的策略不会被实例化
+template <size_t MaxFrames, typename Unwinder = DefaultUnwinder, typename Resolver = ModuleResolver>
+class BasicStacktrace {
+    static_assert(MaxFrames > 0, "MaxFrames must be positive");
+
+  public:
+    static constexpr size_t kMaxFrames = MaxFrames;
+
+    static BasicStacktrace capture(size_t max_frames = kMaxFrames) {
+        BasicStacktrace st;
+        if (max_frames > st.frames_.size()) {
+            max_frames = st.frames_.size(); // 确保不越界
+        }
+        st.size_ = Unwinder::unwind(st.frames_.data(), max_frames);
+        return st;
+    }
+
+    static void clear_modules_cache() {
+        Resolver::clear_cache();
+    }
+
+    // 设置已加载符号数据的全局内存预算 (字节, 0 表示不限制, 默认不限制)
+    // 设置了预算时, FrameView 中的指针只保证在回调期间有效
+    static void set_symbol_memory_budget(size_t bytes) {
+        stacktrace::set_symbol_memory_budget(bytes);
+    }
+
+    static SymbolMemoryStats symbol_memory_stats() {
+        return stacktrace::symbol_memory_stats();
+    }
+
+    // DemangleStyle::Simplified 时函数名形如 ns::Foo<...>::bar(...)
+    static void set_demangle_style(DemangleStyle style) {
+        stacktrace::set_demangle_style(style);
+    }
+
+    static ResolvedFrame resolve(void* address) {
+        return Resolver::resolve(address);
+    }
+
+    static RawFrame resolve_to_raw(void* address) {
+        return Resolver::resolve_to_raw(address);
+    }
+
+    static std::vector<ResolvedFrame> resolve_on_pid(const std::vector<void*>& addr_batch, pid_t target_pid) {
+        return stacktrace::resolve_on_pid(addr_batch, target_pid);
+    }
+
+    static std::vector<RawFrame> resolve_to_raw_on_pid(const std::vector<void*>& addr_batch, pid_t target_pid) {
+        return stacktrace::resolve_to_raw_on_pid(addr_batch, target_pid);
+    }
+
+    // 按名字反查函数地址区间, 例如用于设置采样过滤或按子系统归因
+    static std::vector<SymbolRange> find_symbols(const std::string& pattern, NameMatch mode = NameMatch::Mangled) {
+        return stacktrace::find_symbols(pattern, mode);
+    }
+
+    static std::vector<SymbolRange> find_symbols_on_pid(const std::string& pattern, NameMatch mode, pid_t target_pid) {
+        return stacktrace::find_symbols_on_pid(pattern, mode, target_pid);
+    }
+
+    size_t size() const {
+        return size_;
+    }
+
+    void* const* addresses() const {
+        return frames_.data();
+    }
+
+    std::vector<RawFrame> get_raw_frames() const {
+        std::vector<RawFrame> out;
+        for (size_t i = 0; i < size_; ++i) {
+            auto rf = Resolver::resolve_to_raw(frames_[i]);
+            out.push_back(std::move(rf));
+        }
+        return out;
+    }
+
+    std::vector<ResolvedFrame> get_frames() const {
+        std::vector<ResolvedFrame> out;
+        for (size_t i = 0; i < size_; ++i) {
+            auto f = Resolver::resolve(frames_[i]);
+            f.index = i;
+            out.push_back(std::move(f));
+        }
+        return out;
+    }
+
+    // 逐帧回调 callback(const FrameView&), 符号已加载时全程不分配堆内存
+    template <typename F>
+    void for_each_frame(F&& callback) const {
+        for (size_t i = 0; i < size_; ++i) {
+            FrameView v;
+            Resolver::resolve_view(frames_[i], v);
+            v.index = i;
+            callback(static_cast<const FrameView&>(v));
+        }
+    }
+
+    void print() const {
+        print_frames(get_frames());
+    }
+
+    void print(std::ostream& os) const {
+        print_frames(os, get_frames());
+    }
+
+  private:
+    std::array<void*, MaxFrames> frames_{};
+    size_t size_ = 0;
+};
+
+template <size_t MaxFrames, typename Unwinder, typename Resolver>
+constexpr size_t BasicStacktrace<MaxFrames, Unwinder, Resolver>::kMaxFrames;
+
+using Stacktrace = BasicStacktrace<32>;
+} // namespace stacktrace
+
+#ifndef SST_COMPILED
+#include "sst.hpp"
+#endif
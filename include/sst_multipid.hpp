@@ -0,0 +1,346 @@
+// sst_multipid.hpp - 一次解析多个进程的地址 (例如整机快照), 各进程共用同一份符号索引 (仅 Linux)
+// - resolve_on_pid() 每次调用都要重新解析目标进程的每个模块; 这里同一个文件 (设备号 + inode + mtime)
+//   在所有进程中只加载一次, 路径不同但 build-id 相同的文件 (例如各容器里相同的 libc) 也共用一份
+// - 索引以 base = 0 加载: PIE / 共享库中是模块内偏移, 非 PIE 主程序中是绝对地址, 各进程只按自己的加载基址换算
+// - 读取 maps、加载符号表、解析地址三个阶段分别按进程 / 文件并行; 索引在多次 resolve() 之间保留
+//
+//   stacktrace::MultiPidResolver resolver;             // 线程数默认为 CPU 数
+//   std::vector<stacktrace::PidAddresses> req = {{pid1, addrs1}, {pid2, addrs2}};
+//   auto frames = resolver.resolve(req);               // frames[i][j] 对应 req[i].addrs[j]
+//   printf("%.1f ms\n", resolver.last_stats().total_ms);
+
+#pragma once
+
+#include "sst.hpp"
+
+#include <chrono>
+#include <map>
+#include <memory>
+#include <thread>
+
+#include <sys/sysmacros.h>
+
+namespace stacktrace {
+
+// 一个进程中需要解析的地址
+struct PidAddresses {
+    pid_t pid;
+    std::vector<void*> addrs;
+};
+
+// 最近一次 resolve() 的统计
+struct MultiPidStats {
+    size_t pids;
+    size_t failed_pids;    // 读不到 maps 的进程 (已退出或无权限), 其地址只给出 abs_addr
+    size_t mappings;       // 所有进程的模块数之和
+    size_t files;          // 其中不同的文件数 (设备号 + inode + mtime)
+    size_t loaded;         // 本次新加载的符号索引数, 其余模块都复用了已有的索引
+    size_t cached;         // 缓存中的索引总数
+    double maps_ms;        // 读取并解析所有进程的 maps
+    double load_ms;        // 读取 build-id 并加载新的符号索引
+    double resolve_ms;     // 逐个地址查找
+    double total_ms;
+};
+
+namespace multipid {
+
+struct FileId {
+    uint64_t dev;
+    uint64_t ino;
+    int64_t mtime_ns;
+
+    bool operator<(const FileId& o) const {
+        if (dev != o.dev) return dev < o.dev;
+        if (ino != o.ino) return ino < o.ino;
+        return mtime_ns < o.mtime_ns;
+    }
+};
+
+// 只读的符号索引, 加载时一次性 demangle, 之后多线程无锁共享
+struct SymbolIndex {
+    bool pie;
+    std::vector<Symbol> symbols;    // 按地址排序, 只保留地址与大小
+    std::vector<std::string> names; // 与 symbols 一一对应的 demangled 名
+
+    SymbolIndex() : pie(false), symbols(), names() {}
+};
+
+using IndexPtr = std::shared_ptr<const SymbolIndex>;
+
+// 一个进程中的一个模块, 地址区间的计算与 ModuleManager::load_modules() 相同
+struct Mapping {
+    std::string path;  // 目标进程中的路径, 作为 ResolvedFrame::module
+    std::string file;  // 在本进程中打开它所用的路径, 经由 /proc/<pid>/root 或 /proc/<pid>/map_files
+    std::string range; // 该文件第一个映射的 "begin-end", 即 map_files 中的文件名
+    uintptr_t base;
+    size_t size;
+    bool executable;    // 有可执行的映射
+    bool first_segment; // 映射了文件开头 (offset 为 0)
+    bool has_file;      // 是可以打开的 ELF 文件, id 有效, 需要建立索引
+    FileId id;          // dev 与 inode 取自 maps, mtime 取自打开的文件
+    const SymbolIndex* index;
+
+    Mapping()
+        : path(), file(), range(), base(0), size(0), executable(false), first_segment(false), has_file(false), id{0, 0, 0}, index(nullptr) {}
+    Mapping(const Mapping&) = default;
+    Mapping(Mapping&&) = default;
+    Mapping& operator=(const Mapping&) = default;
+    Mapping& operator=(Mapping&&) = default;
+};
+
+inline double ms_since(std::chrono::steady_clock::time_point begin) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+}
+
+// 用 threads 个线程执行 fn(0) ... fn(n - 1)
+template <typename F>
+void parallel_for(size_t n, unsigned threads, F&& fn) {
+    if (threads <= 1 || n <= 1) {
+        for (size_t i = 0; i < n; ++i) fn(i);
+        return;
+    }
+    std::atomic<size_t> next{0};
+    auto worker = [&] {
+        for (size_t i = next.fetch_add(1); i < n; i = next.fetch_add(1)) fn(i);
+    };
+    std::vector<std::thread> pool;
+    size_t extra = std::min<size_t>(threads, n) - 1;
+    for (size_t t = 0; t < extra; ++t) pool.emplace_back(worker);
+    worker();
+    for (auto& th : pool) th.join();
+}
+
+// 在本进程中找到目标进程映射的文件: 目标可能在另一个 mount namespace (容器) 中, 同一路径在本进程中是另一个文件
+// 先用 /proc/<pid>/root/<path>; inode 与 maps 不一致 (文件已被替换或删除) 时改用 map_files, 它总是指向映射的那个文件
+// 但需要更高的权限; 两者都对不上时 (例如 overlayfs 上 maps 给出的是底层 inode) 仍然使用 root 下的路径
+inline void locate_file(pid_t pid, Mapping& m) {
+    std::string proc = "/proc/" + std::to_string(pid);
+    std::string candidates[2] = {proc + "/root" + m.path, proc + "/map_files/" + m.range};
+    for (const auto& file : candidates) {
+        struct stat st;
+        if (stat(file.c_str(), &st) != 0) continue;
+        bool same = st.st_ino == m.id.ino;
+        if (same || ! m.has_file) {
+            m.file = file;
+            m.has_file = true;
+            m.id.mtime_ns = static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+        }
+        if (same) break;
+    }
+}
+
+// 读取 /proc/<pid>/maps, 按路径合并为模块并按基址排序; 读不到时返回 false
+inline bool read_maps(pid_t pid, std::vector<Mapping>& out) {
+    std::ifstream maps("/proc/" + std::to_string(pid) + "/maps");
+    if (! maps.is_open()) return false;
+    std::unordered_map<std::string, size_t> by_path;
+    std::string line;
+    // e.g. 55b08b769000-55b08b7ab000 r--p 00000000 08:10 149169 /usr/bin/bat
+    while (std::getline(maps, line)) {
+        const char* p = line.c_str();
+        char* end;
+        uintptr_t begin = strtoull(p, &end, 16);
+        if (*end != '-') continue;
+        uintptr_t stop = strtoull(end + 1, &end, 16);
+        const char* range_end = end;
+        const char* perms = end + 1;
+        if (perms[0] != 'r') continue; // 过滤掉 guard 段等不可读的映射
+        bool executable = strlen(perms) > 2 && perms[2] == 'x';
+        // 跳过 perms 列, 读取 offset, dev (十六进制 major:minor) 与 inode
+        const char* q = strchr(perms, ' ');
+        if (! q) continue;
+        unsigned long long offset = strtoull(q + 1, &end, 16);
+        q = end;
+        while (*q == ' ') ++q;
+        unsigned long major = strtoul(q, &end, 16);
+        if (*end != ':') continue;
+        unsigned long minor = strtoul(end + 1, &end, 16);
+        unsigned long long inode = strtoull(end, &end, 10);
+        while (*end == ' ') ++end;
+        if (inode == 0 || *end == '\0') continue;
+
+        std::string path(end);
+        auto it = by_path.find(path);
+        if (it == by_path.end()) {
+            by_path.emplace(path, out.size());
+            Mapping m;
+            m.path = std::move(path);
+            m.range.assign(p, range_end);
+            m.base = begin;
+            m.size = stop - begin;
+            m.executable = executable;
+            m.first_segment = offset == 0;
+            m.id.dev = static_cast<uint64_t>(makedev(static_cast<unsigned>(major), static_cast<unsigned>(minor)));
+            m.id.ino = inode;
+            out.push_back(std::move(m));
+        } else {
+            Mapping& m = out[it->second];
+            m.executable = m.executable || executable;
+            m.first_segment = m.first_segment || offset == 0;
+            uintptr_t hi = std::max(m.base + m.size, stop);
+            m.base = std::min(m.base, begin);
+            m.size = hi - m.base;
+        }
+    }
+    std::sort(out.begin(), out.end(), [](const Mapping& a, const Mapping& b) { return a.base < b.base; });
+    for (auto& m : out) {
+        locate_file(pid, m);
+        // 进程还可能 mmap 数据文件 (locale-archive, /dev/shm, 数据库文件等), 只为代码所在的 ELF 文件建立索引
+        if (m.has_file && (! (m.executable || m.first_segment) || ! is_elf_file(m.file.c_str()))) m.has_file = false;
+    }
+    return true;
+}
+
+inline std::shared_ptr<SymbolIndex> load_index(const std::string& path, DemangleStyle style) {
+    auto idx = std::make_shared<SymbolIndex>();
+    idx->pie = is_pie_binary(path.c_str());
+    idx->symbols = load_symbols(path.c_str(), 0);
+    idx->names.reserve(idx->symbols.size());
+    for (auto& sym : idx->symbols) {
+        idx->names.push_back(demangle(sym.name.c_str(), style));
+        std::string().swap(sym.name);
+    }
+    return idx;
+}
+
+} // namespace multipid
+
+// 线程安全性与其他解析接口相同: 同一个对象不能并发调用 resolve()
+class MultiPidResolver {
+  public:
+    explicit MultiPidResolver(unsigned threads = 0)
+        : threads_(threads ? threads : std::max(1u, std::thread::hardware_concurrency())), by_file_(), by_build_id_(), stats_() {}
+
+    MultiPidResolver(const MultiPidResolver&) = delete;
+    MultiPidResolver& operator=(const MultiPidResolver&) = delete;
+
+    // 结果与逐个调用 resolve_on_pid() 相同, out[i][j] 对应 requests[i].addrs[j]
+    // 模块路径总是取自 /proc/<pid>/maps, 包括当前进程自身
+    std::vector<std::vector<ResolvedFrame>> resolve(const std::vector<PidAddresses>& requests) {
+        using Clock = std::chrono::steady_clock;
+        auto begin = Clock::now();
+        MultiPidStats st = {};
+        st.pids = requests.size();
+
+        // 1. 并行读取每个进程的模块
+        std::vector<std::vector<multipid::Mapping>> maps(requests.size());
+        std::vector<char> ok(requests.size(), 0);
+        multipid::parallel_for(requests.size(), threads_, [&](size_t i) { ok[i] = multipid::read_maps(requests[i].pid, maps[i]) ? 1 : 0; });
+        st.maps_ms = multipid::ms_since(begin);
+
+        // 2. 收集还没有索引的文件, 并行读取 build-id; build-id 相同的文件只加载一次
+        auto load_begin = Clock::now();
+        std::map<multipid::FileId, const std::string*> files; // 文件 -> 任意一个可以打开它的路径
+        for (size_t i = 0; i < maps.size(); ++i) {
+            st.failed_pids += ok[i] ? 0 : 1;
+            st.mappings += maps[i].size();
+            for (const auto& m : maps[i]) {
+                if (m.has_file) files.emplace(m.id, &m.file);
+            }
+        }
+        st.files = files.size();
+        std::vector<std::pair<multipid::FileId, const std::string*>> missing;
+        for (const auto& kv : files) {
+            if (! by_file_.count(kv.first)) missing.push_back(kv);
+        }
+        std::vector<std::string> build_ids(missing.size());
+        multipid::parallel_for(missing.size(), threads_, [&](size_t i) { build_ids[i] = read_build_id(missing[i].second->c_str()); });
+
+        std::vector<size_t> to_load; // missing 的下标, 每个需要加载的索引一个
+        std::map<std::string, size_t> pending; // 本轮新出现的 build-id -> to_load 中的位置
+        std::vector<size_t> slot_of(missing.size());
+        for (size_t i = 0; i < missing.size(); ++i) {
+            if (! build_ids[i].empty()) {
+                auto cached = by_build_id_.find(build_ids[i]);
+                if (cached != by_build_id_.end()) {
+                    by_file_[missing[i].first] = cached->second;
+                    slot_of[i] = SIZE_MAX;
+                    continue;
+                }
+                auto it = pending.find(build_ids[i]);
+                if (it != pending.end()) {
+                    slot_of[i] = it->second;
+                    continue;
+                }
+                pending.emplace(build_ids[i], to_load.size());
+            }
+            slot_of[i] = to_load.size();
+            to_load.push_back(i);
+        }
+        std::vector<std::shared_ptr<multipid::SymbolIndex>> loaded(to_load.size());
+        DemangleStyle style = demangle_style();
+        multipid::parallel_for(to_load.size(), threads_, [&](size_t k) { loaded[k] = multipid::load_index(*missing[to_load[k]].second, style); });
+        for (size_t i = 0; i < missing.size(); ++i) {
+            if (slot_of[i] == SIZE_MAX) continue;
+            multipid::IndexPtr idx = loaded[slot_of[i]];
+            by_file_[missing[i].first] = idx;
+            if (! build_ids[i].empty()) by_build_id_.emplace(build_ids[i], idx);
+        }
+        st.loaded = to_load.size();
+        st.cached = by_file_.size();
+        for (auto& pid_maps : maps) {
+            for (auto& m : pid_maps) {
+                if (m.has_file) m.index = by_file_[m.id].get();
+            }
+        }
+        st.load_ms = multipid::ms_since(load_begin);
+
+        // 3. 并行解析, 每个进程只按自己的基址换算
+        auto resolve_begin = Clock::now();
+        std::vector<std::vector<ResolvedFrame>> out(requests.size());
+        multipid::parallel_for(requests.size(), threads_, [&](size_t i) {
+            out[i].reserve(requests[i].addrs.size());
+            for (void* a : requests[i].addrs) out[i].push_back(resolve_one(reinterpret_cast<uintptr_t>(a), maps[i], requests[i].pid));
+        });
+        st.resolve_ms = multipid::ms_since(resolve_begin);
+        st.total_ms = multipid::ms_since(begin);
+        stats_ = st;
+        return out;
+    }
+
+    const MultiPidStats& last_stats() const {
+        return stats_;
+    }
+
+    // 释放所有缓存的索引, 例如被观测的程序升级之后
+    void clear() {
+        by_file_.clear();
+        by_build_id_.clear();
+    }
+
+  private:
+    unsigned threads_;
+    std::map<multipid::FileId, multipid::IndexPtr> by_file_;
+    std::map<std::string, multipid::IndexPtr> by_build_id_;
+    MultiPidStats stats_;
+
+    static ResolvedFrame resolve_one(uintptr_t addr, const std::vector<multipid::Mapping>& maps, pid_t pid) {
+        ResolvedFrame f;
+        f.abs_addr = addr;
+        auto it = std::upper_bound(maps.begin(), maps.end(), addr, [](uintptr_t a, const multipid::Mapping& m) { return a < m.base; });
+        if (it != maps.begin() && addr < (it - 1)->base + (it - 1)->size) {
+            const multipid::Mapping& m = *(it - 1);
+            f.module = m.path;
+            if (m.index) {
+                uintptr_t rel = addr - (m.index->pie ? m.base : 0);
+                const Symbol* sym = find_symbol(rel, m.index->symbols);
+                if (sym) {
+                    f.has_symbol = true;
+                    f.offset = rel - sym->addr;
+                    f.function = m.index->names[static_cast<size_t>(sym - m.index->symbols.data())];
+                }
+            }
+            return f;
+        }
+        ProvidedSymbol ps;
+        if (ModuleManager::instance().find_provided_symbol(pid, addr, ps)) {
+            f.has_symbol = true;
+            f.offset = addr - ps.start;
+            f.function = *ps.name;
+            f.module = *ps.source;
+        }
+        return f;
+    }
+};
+
+} // namespace stacktrace
@@ -0,0 +1,367 @@
+// sst_perf.hpp - 基于 perf_event_open 的采样后端 (仅 Linux)
+// - 使用 cpu-clock / task-clock 等软件事件与 PERF_SAMPLE_CALLCHAIN, 由内核完成抓栈, 目标进程不会收到任何信号
+// - 每个 CPU mmap 一个 ring buffer, 批量读取, 样本以指针形式直接交给回调 (零拷贝)
+// - 用户态地址通过 ModuleManager 的模块表解析, 模块表由 PERF_RECORD_MMAP2 增量维护, 无需反复读取 maps
+// 注意: 内核按 frame pointer 回溯用户栈, 目标程序需以 -fno-omit-frame-pointer 编译才能得到完整调用链
+
+#pragma once
+
+#include "sst.hpp"
+
+#include <cerrno>
+#include <dirent.h>
+#include <poll.h>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+
+namespace stacktrace {
+
+// 一个样本, 所有指针都指向 ring buffer (跨越 ring 末尾的样本除外), 仅在回调期间有效
+struct PerfSample {
+    uint32_t pid;
+    uint32_t tid;
+    uint64_t time;
+    const uint64_t* kernel_ips; // 内核态调用链, 栈顶在前
+    size_t kernel_nr;
+    const uint64_t* user_ips; // 用户态调用链, 栈顶在前
+    size_t user_nr;
+};
+
+struct PerfSamplerOptions {
+    uint64_t frequency = 99;                 // 每线程每秒的采样次数
+    uint32_t event = PERF_COUNT_SW_CPU_CLOCK; // 软件事件, 例如 PERF_COUNT_SW_TASK_CLOCK
+    bool include_kernel = false;             // 是否包含内核调用链 (受 perf_event_paranoid 限制)
+    size_t ring_pages = 64;                  // 每个 CPU ring buffer 的数据页数, 必须是 2 的幂
+    uint16_t max_stack = 127;                // 调用链最大深度
+
+    PerfSamplerOptions() {}
+};
+
+class PerfSampler {
+  public:
+    explicit PerfSampler(pid_t pid, const PerfSamplerOptions& options = PerfSamplerOptions())
+        : pid_(pid), options_(options), fds_(), rings_(), modules_(), lost_(0), scratch_() {}
+
+    PerfSampler(const PerfSampler&) = delete;
+    PerfSampler& operator=(const PerfSampler&) = delete;
+
+    ~PerfSampler() {
+        stop();
+        for (auto& r : rings_) {
+            munmap(r.base, r.mmap_size);
+        }
+        for (int fd : fds_) {
+            close(fd);
+        }
+    }
+
+    // 为目标进程当前的每个线程在每个 CPU 上打开事件, 之后新建的线程由 inherit 继承
+    // (内核不允许 cpu == -1 的 inherit 事件 mmap, 所以按 CPU 打开, 同一 CPU 的事件共享一个 ring buffer)
+    // 返回成功打开的线程数, 0 表示失败 (errno 为最后一次失败的原因)
+    size_t start() {
+        ModuleManager::load_modules(modules_, pid_); // 启动前已存在的映射只能从 maps 获得一次
+
+        std::vector<pid_t> tids;
+        std::string task_dir = "/proc/" + std::to_string(pid_) + "/task";
+        DIR* dir = opendir(task_dir.c_str());
+        if (! dir) return 0;
+        while (struct dirent* ent = readdir(dir)) {
+            if (ent->d_name[0] < '0' || ent->d_name[0] > '9') continue;
+            tids.push_back(static_cast<pid_t>(atoi(ent->d_name)));
+        }
+        closedir(dir);
+
+        size_t opened_threads = 0;
+        int ncpus = static_cast<int>(sysconf(_SC_NPROCESSORS_CONF));
+        for (pid_t tid : tids) {
+            bool opened = false;
+            for (int cpu = 0; cpu < ncpus; ++cpu) {
+                opened = open_event(tid, cpu) || opened;
+            }
+            if (opened) ++opened_threads;
+        }
+
+        for (int fd : fds_) {
+            ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+        return opened_threads;
+    }
+
+    void stop() {
+        for (int fd : fds_) {
+            ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+        }
+    }
+
+    // 等待最多 timeout_ms 毫秒, 然后排空所有 ring buffer, 对每个样本调用 on_sample(const PerfSample&)
+    // 返回本次处理的样本数
+    template <typename F>
+    size_t poll(F&& on_sample, int timeout_ms) {
+        if (rings_.empty()) return 0;
+
+        std::vector<pollfd> fds(rings_.size());
+        for (size_t i = 0; i < rings_.size(); ++i) {
+            fds[i].fd = rings_[i].fd;
+            fds[i].events = POLLIN;
+            fds[i].revents = 0;
+        }
+        ::poll(fds.data(), fds.size(), timeout_ms);
+
+        size_t samples = 0;
+        for (auto& r : rings_) {
+            samples += drain(r, on_sample);
+        }
+        return samples;
+    }
+
+    // 处理一段连续的、完整的 perf 记录 (例如从 perf.data 中读出的), 与 poll() 一样维护模块表并回调样本
+    // 返回处理的样本数; 遇到长度不合法的记录时停止
+    template <typename F>
+    size_t feed(const void* data, size_t size, F&& on_sample) {
+        const char* p = static_cast<const char*>(data);
+        size_t samples = 0;
+        for (size_t off = 0; size - off >= sizeof(perf_event_header);) {
+            const auto* hdr = reinterpret_cast<const perf_event_header*>(p + off);
+            if (hdr->size < sizeof(perf_event_header) || hdr->size > size - off) break;
+            handle_record(hdr, p + off, on_sample, samples);
+            off += hdr->size;
+        }
+        return samples;
+    }
+
+    // 解析用户态地址, 使用由 MMAP2 事件增量维护的模块表
+    ResolvedFrame resolve(uint64_t ip) {
+        return resolve_with_modules(reinterpret_cast<void*>(ip), modules_, pid_);
+    }
+
+    void resolve_view(uint64_t ip, FrameView& view) {
+        resolve_view_with_modules(reinterpret_cast<void*>(ip), modules_, view, pid_);
+    }
+
+    const Modules& modules() const {
+        return modules_;
+    }
+
+    // 内核因 ring buffer 满而丢弃的记录数
+    uint64_t lost() const {
+        return lost_;
+    }
+
+  private:
+    struct Ring {
+        int cpu;
+        int fd;
+        void* base;
+        size_t mmap_size;
+        perf_event_mmap_page* meta;
+        const char* data;
+        size_t data_size;
+    };
+
+    // PERF_RECORD_MMAP2 的固定部分, 之后紧跟以 '\0' 结尾的文件名
+    struct Mmap2Record {
+        uint32_t pid, tid;
+        uint64_t addr;
+        uint64_t len;
+        uint64_t pgoff;
+        uint32_t maj, min;
+        uint64_t ino;
+        uint64_t ino_generation;
+        uint32_t prot, flags;
+    };
+
+    pid_t pid_;
+    PerfSamplerOptions options_;
+    std::vector<int> fds_;
+    std::vector<Ring> rings_; // 每个 CPU 一个
+    Modules modules_;
+    uint64_t lost_;
+    std::vector<char> scratch_;
+
+    bool open_event(pid_t tid, int cpu) {
+        perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_SOFTWARE;
+        attr.config = options_.event;
+        attr.freq = 1;
+        attr.sample_freq = options_.frequency;
+        attr.sample_type = PERF_SAMPLE_TID | PERF_SAMPLE_TIME | PERF_SAMPLE_CALLCHAIN;
+        attr.disabled = 1;
+        attr.inherit = 1;
+        attr.exclude_kernel = options_.include_kernel ? 0 : 1;
+        attr.exclude_callchain_kernel = options_.include_kernel ? 0 : 1;
+        attr.exclude_hv = 1;
+        attr.mmap = 1;
+        attr.mmap2 = 1;
+        attr.sample_id_all = 1;
+        attr.sample_max_stack = options_.max_stack;
+        attr.watermark = 1; // 数据量达到 1/4 个 ring 时才唤醒 poll, 以便批量处理
+        attr.wakeup_watermark = static_cast<uint32_t>(options_.ring_pages * page_size() / 4);
+
+        long ret = syscall(SYS_perf_event_open, &attr, tid, cpu, -1, 0);
+        if (ret < 0) return false;
+        int fd = static_cast<int>(ret);
+
+        for (const auto& r : rings_) {
+            if (r.cpu == cpu) {
+                if (ioctl(fd, PERF_EVENT_IOC_SET_OUTPUT, r.fd) != 0) {
+                    close(fd);
+                    return false;
+                }
+                fds_.push_back(fd);
+                return true;
+            }
+        }
+
+        Ring r;
+        r.cpu = cpu;
+        r.fd = fd;
+        r.data_size = options_.ring_pages * page_size();
+        r.mmap_size = r.data_size + page_size(); // 第一页是元数据页
+        r.base = mmap(nullptr, r.mmap_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (r.base == MAP_FAILED) {
+            close(fd);
+            return false;
+        }
+        r.meta = static_cast<perf_event_mmap_page*>(r.base);
+        r.data = static_cast<const char*>(r.base) + page_size();
+        rings_.push_back(r);
+        fds_.push_back(fd);
+        return true;
+    }
+
+    static size_t page_size() {
+        return static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    }
+
+    template <typename F>
+    size_t drain(Ring& r, F& on_sample) {
+        uint64_t head = __atomic_load_n(&r.meta->data_head, __ATOMIC_ACQUIRE);
+        uint64_t tail = r.meta->data_tail;
+        size_t samples = 0;
+
+        while (tail < head) {
+            size_t off = static_cast<size_t>(tail % r.data_size);
+            const auto* hdr = reinterpret_cast<const perf_event_header*>(r.data + off);
+            const char* rec = r.data + off;
+
+            // 记录跨越了 ring 的末尾, 只有这种情况需要拷贝
+            if (off + sizeof(perf_event_header) > r.data_size || off + hdr->size > r.data_size) {
+                size_t size = off + sizeof(perf_event_header) > r.data_size ? read_wrapped_size(r, off) : hdr->size;
+                scratch_.resize(size);
+                size_t first = r.data_size - off;
+                memcpy(scratch_.data(), r.data + off, first);
+                memcpy(scratch_.data() + first, r.data, size - first);
+                rec = scratch_.data();
+                hdr = reinterpret_cast<const perf_event_header*>(rec);
+            }
+
+            if (hdr->size < sizeof(perf_event_header)) break; // 不应出现, 防止死循环
+            handle_record(hdr, rec, on_sample, samples);
+            tail += hdr->size;
+        }
+
+        __atomic_store_n(&r.meta->data_tail, tail, __ATOMIC_RELEASE);
+        return samples;
+    }
+
+    static size_t read_wrapped_size(const Ring& r, size_t off) {
+        perf_event_header hdr;
+        size_t first = r.data_size - off;
+        memcpy(&hdr, r.data + off, first);
+        memcpy(reinterpret_cast<char*>(&hdr) + first, r.data, sizeof(hdr) - first);
+        return hdr.size;
+    }
+
+    template <typename F>
+    void handle_record(const perf_event_header* hdr, const char* rec, F& on_sample, size_t& samples) {
+        const char* body = rec + sizeof(perf_event_header);
+        size_t body_size = hdr->size - sizeof(perf_event_header);
+        switch (hdr->type) {
+            case PERF_RECORD_SAMPLE: {
+                // PERF_SAMPLE_TID | PERF_SAMPLE_TIME | PERF_SAMPLE_CALLCHAIN 的布局
+                if (body_size < 24) break;
+                const auto* p = reinterpret_cast<const uint32_t*>(body);
+                PerfSample s;
+                s.pid = p[0];
+                s.tid = p[1];
+                const auto* q = reinterpret_cast<const uint64_t*>(body + 8);
+                s.time = q[0];
+                uint64_t nr = q[1];
+                if (nr > (body_size - 24) / sizeof(uint64_t)) break;
+                const uint64_t* ips = q + 2;
+                split_callchain(ips, static_cast<size_t>(nr), s);
+                on_sample(static_cast<const PerfSample&>(s));
+                ++samples;
+                break;
+            }
+            case PERF_RECORD_MMAP2: {
+                const char* filename = body + sizeof(Mmap2Record);
+                if (body_size <= sizeof(Mmap2Record) || ! memchr(filename, '\0', body_size - sizeof(Mmap2Record))) break;
+                const auto* m = reinterpret_cast<const Mmap2Record*>(body);
+                on_mmap(m->addr, m->len, m->pgoff, filename);
+                break;
+            }
+            case PERF_RECORD_LOST: {
+                if (body_size < 16) break;
+                const auto* q = reinterpret_cast<const uint64_t*>(body);
+                lost_ += q[1]; // {id, lost}
+                break;
+            }
+            default: break;
+        }
+    }
+
+    // 调用链中以 PERF_CONTEXT_KERNEL / PERF_CONTEXT_USER 等标记分段, 每段内部是连续的
+    static void split_callchain(const uint64_t* ips, size_t nr, PerfSample& s) {
+        s.kernel_ips = nullptr;
+        s.kernel_nr = 0;
+        s.user_ips = nullptr;
+        s.user_nr = 0;
+
+        const uint64_t** cur_ips = nullptr;
+        size_t* cur_nr = nullptr;
+        for (size_t i = 0; i < nr; ++i) {
+            uint64_t ip = ips[i];
+            if (ip >= static_cast<uint64_t>(PERF_CONTEXT_MAX)) {
+                cur_ips = nullptr;
+                cur_nr = nullptr;
+                if (ip == static_cast<uint64_t>(PERF_CONTEXT_KERNEL)) {
+                    cur_ips = &s.kernel_ips;
+                    cur_nr = &s.kernel_nr;
+                } else if (ip == static_cast<uint64_t>(PERF_CONTEXT_USER)) {
+                    cur_ips = &s.user_ips;
+                    cur_nr = &s.user_nr;
+                }
+                if (cur_ips) *cur_ips = ips + i + 1;
+                continue;
+            }
+            if (cur_nr) ++*cur_nr;
+        }
+    }
+
+    // 增量更新模块表: 同一文件按 (addr - pgoff) 得到加载基址, 与 maps 解析出的基址一致
+    void on_mmap(uint64_t addr, uint64_t len, uint64_t pgoff, const char* filename) {
+        if (filename[0] != '/' || filename[1] == '/') return; // [vdso], //anon 等非文件映射
+        uintptr_t base = static_cast<uintptr_t>(addr - pgoff);
+        uintptr_t end = static_cast<uintptr_t>(addr + len);
+
+        for (auto& m : modules_) {
+            if (m.base == base && m.path == filename) {
+                if (end > m.base + m.size) m.size = end - m.base;
+                return;
+            }
+        }
+
+        // 新映射覆盖的旧模块必然已被 munmap (perf 不报告 munmap)
+        modules_.erase(std::remove_if(modules_.begin(),
+                                      modules_.end(),
+                                      [&](const Module& m) { return m.base < end && base < m.base + m.size; }),
+                       modules_.end());
+        modules_.emplace_back(filename, base, end - base);
+    }
+};
+
+} // namespace stacktrace
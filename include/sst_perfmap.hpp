@@ -0,0 +1,194 @@
+// sst_perfmap.hpp - 从 /tmp/perf-<pid>.map 解析 JIT 代码的符号 (LuaJIT、PCRE2 JIT 等均可输出该格式)
+// - 每行格式为 "START SIZE name", START 与 SIZE 为十六进制 (可带 0x 前缀)
+// - 查不到地址时, 或距上次检查超过 refresh_interval_ms 时, 只读取文件新增的部分
+//   (从上次读到的完整行之后开始), 不重新解析整个文件; 文件被截断或重新创建时才从头读取
+// - 区间按起始地址排序, 与后写入的条目重叠的旧条目整体失效 (JIT 回收后复用的代码区域)
+// - 返回的名字指针在 provider 销毁或 clear() 之前一直有效: 从头读取时旧名字移入 retired, 不释放
+// - 按 pid 分别维护, 既用于自身也用于 resolve_on_pid 的目标进程
+//
+//   stacktrace::ModuleManager::instance().add_symbol_provider(std::make_shared<stacktrace::PerfMapProvider>());
+
+#pragma once
+
+#include "sst.hpp"
+
+#include <chrono>
+#include <deque>
+#include <map>
+#include <mutex>
+
+namespace stacktrace {
+
+struct PerfMapStats {
+    size_t entries = 0;   // 当前索引中的区间数
+    size_t bytes_read = 0; // 累计读取的字节数
+    size_t reloads = 0;   // 因截断或重建而从头读取的次数
+};
+
+class PerfMapProvider : public SymbolProvider {
+  public:
+    // dir 为 perf map 所在目录, 目标在其他 mount namespace 时可传入 "/proc/<pid>/root/tmp"
+    // 命中已有条目时最多每 refresh_interval_ms 检查一次文件, 以发现覆盖旧区域的新条目
+    explicit PerfMapProvider(std::string dir = "/tmp", int refresh_interval_ms = 100)
+        : dir_(std::move(dir)), interval_(std::chrono::milliseconds(refresh_interval_ms)), mu_(), maps_() {}
+
+    bool find(pid_t pid, uintptr_t addr, ProvidedSymbol& out) override {
+        std::lock_guard<std::mutex> lock(mu_);
+        auto it = maps_.find(pid);
+        if (it == maps_.end()) {
+            it = maps_.emplace(pid, PerfMap(dir_ + "/perf-" + std::to_string(pid) + ".map")).first;
+        }
+        PerfMap& map = it->second;
+        auto now = std::chrono::steady_clock::now();
+        if (map.lookup(addr, out) && now - map.checked < interval_) return true;
+        map.checked = now;
+        map.refresh();
+        return map.lookup(addr, out);
+    }
+
+    PerfMapStats stats(pid_t pid) {
+        std::lock_guard<std::mutex> lock(mu_);
+        auto it = maps_.find(pid);
+        return it == maps_.end() ? PerfMapStats() : it->second.stats;
+    }
+
+    // 丢弃所有已解析的条目, 之前返回的名字指针随之失效
+    void clear() {
+        std::lock_guard<std::mutex> lock(mu_);
+        maps_.clear();
+    }
+
+  private:
+    struct Entry {
+        uintptr_t start;
+        uintptr_t end;
+        uint64_t seq; // 在文件中的行号, 越大越新
+        const std::string* name;
+    };
+
+    struct PerfMap {
+        std::string path;
+        dev_t dev = 0;
+        ino_t ino = 0;
+        off_t offset = 0; // 已解析到的位置, 总是某个完整行的末尾
+        uint64_t seq = 0;
+        std::chrono::steady_clock::time_point checked;
+        std::deque<std::string> names; // deque 追加时不移动已有元素, 名字指针保持有效
+        // 从头读取之前的名字: 其他线程可能刚由 find() 拿到指针还在使用, 随 provider 一起释放
+        std::vector<std::unique_ptr<std::deque<std::string>>> retired;
+        std::vector<Entry> index;
+        PerfMapStats stats;
+
+        explicit PerfMap(std::string p) : path(std::move(p)), checked(), names(), retired(), index(), stats() {}
+
+        bool lookup(uintptr_t addr, ProvidedSymbol& out) const {
+            auto it = std::upper_bound(index.begin(), index.end(), addr, [](uintptr_t a, const Entry& e) { return a < e.start; });
+            if (it == index.begin() || addr >= (it - 1)->end) return false;
+            out.start = (it - 1)->start;
+            out.size = (it - 1)->end - (it - 1)->start;
+            out.name = (it - 1)->name;
+            out.source = &path;
+            return true;
+        }
+
+        // 读取新增的完整行并合并进索引, 有新条目时返回 true
+        bool refresh() {
+            struct stat st;
+            if (stat(path.c_str(), &st) != 0) return false;
+            if (st.st_dev != dev || st.st_ino != ino || st.st_size < offset) {
+                if (ino != 0) stats.reloads++;
+                dev = st.st_dev;
+                ino = st.st_ino;
+                offset = 0;
+                if (! names.empty()) {
+                    retired.emplace_back(new std::deque<std::string>());
+                    retired.back()->swap(names); // swap 不移动元素, 已返回的指针仍然有效
+                }
+                index.clear();
+            }
+            if (st.st_size == offset) return false;
+
+            int fd = ::open(path.c_str(), O_RDONLY);
+            if (fd < 0) return false;
+            std::string buf(static_cast<size_t>(st.st_size - offset), '\0');
+            ssize_t n = pread(fd, &buf[0], buf.size(), offset);
+            ::close(fd);
+            if (n <= 0) return false;
+            buf.resize(static_cast<size_t>(n));
+            stats.bytes_read += buf.size();
+
+            // 最后一行可能还没写完, 留到下次
+            size_t last_nl = buf.rfind('\n');
+            if (last_nl == std::string::npos) return false;
+            offset += static_cast<off_t>(last_nl + 1);
+
+            std::vector<Entry> added;
+            size_t pos = 0;
+            while (pos <= last_nl) {
+                size_t eol = buf.find('\n', pos);
+                parse_line(buf.c_str() + pos, buf.c_str() + eol, added);
+                pos = eol + 1;
+            }
+            if (added.empty()) return false;
+            merge(added);
+            stats.entries = index.size();
+            return true;
+        }
+
+        void parse_line(const char* p, const char* end, std::vector<Entry>& added) {
+            char* next;
+            uintptr_t start = strtoul(p, &next, 16);
+            if (next == p || next >= end) return;
+            p = next;
+            size_t size = strtoul(p, &next, 16);
+            if (next == p || size == 0 || next >= end) return;
+            p = next;
+            while (p < end && (*p == ' ' || *p == '\t')) ++p;
+            const char* name_end = end;
+            while (name_end > p && (name_end[-1] == '\r' || name_end[-1] == ' ')) --name_end;
+            if (p == name_end) return;
+            names.emplace_back(p, name_end);
+            added.push_back(Entry{start, start + size, seq++, &names.back()});
+        }
+
+        // 新条目排序后与索引归并, 再按序扫描去掉重叠中较旧的一方
+        void merge(std::vector<Entry>& added) {
+            auto by_start = [](const Entry& a, const Entry& b) { return a.start < b.start || (a.start == b.start && a.seq < b.seq); };
+            std::sort(added.begin(), added.end(), by_start);
+            bool overlaps = false;
+            for (size_t i = 1; i < added.size() && ! overlaps; ++i) {
+                overlaps = added[i - 1].end > added[i].start;
+            }
+            // 常见情形: JIT 在更高的地址上生成新代码, 直接追加
+            if (! overlaps && (index.empty() || index.back().end <= added.front().start)) {
+                index.insert(index.end(), added.begin(), added.end());
+                return;
+            }
+            size_t mid = index.size();
+            index.insert(index.end(), added.begin(), added.end());
+            std::inplace_merge(index.begin(), index.begin() + static_cast<std::ptrdiff_t>(mid), index.end(), by_start);
+
+            size_t kept = 0;
+            for (size_t i = 0; i < index.size(); ++i) {
+                const Entry& e = index[i];
+                bool drop = false;
+                while (kept > 0 && index[kept - 1].end > e.start) {
+                    if (index[kept - 1].seq > e.seq) {
+                        drop = true;
+                        break;
+                    }
+                    --kept;
+                }
+                if (! drop) index[kept++] = e;
+            }
+            index.resize(kept);
+        }
+    };
+
+    std::string dir_;
+    std::chrono::steady_clock::duration interval_;
+    std::mutex mu_;
+    std::map<pid_t, PerfMap> maps_;
+};
+
+} // namespace stacktrace
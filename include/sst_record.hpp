@@ -0,0 +1,343 @@
+// sst_record.hpp - RawFrame 序列的紧凑二进制格式
+// - 模块表: 每个模块只在第一次出现时写一次 (路径 + GNU build-id), 之后帧里只引用模块 id
+// - 帧: 模块 id + 模块内偏移, 偏移相对同一记录中同一模块的上一帧做 zigzag 差分后按 varint 编码
+// - 指纹: 由 (模块 build-id 或路径, 偏移) 计算的 64 位哈希, 与 ASLR 无关, 同一二进制的相同栈在不同运行间指纹相同
+//
+// 流格式 (小端):
+//   "SSTR" u8 version
+//   记录 = tag(u8) + 内容
+//     kModuleTag: varint id, varint path_len, path, varint build_id_len, build_id
+//     kStackTag : varint nframes, u64 fingerprint, nframes x { varint module_ref, varint zigzag(delta) }
+//                 module_ref 为 0 表示未知模块 (此时 delta 基于绝对地址), 否则为 id + 1
+
+#pragma once
+
+#include "sst.hpp"
+
+namespace stacktrace {
+
+namespace record {
+
+static constexpr char kMagic[4] = {'S', 'S', 'T', 'R'};
+static constexpr uint8_t kVersion = 1;
+static constexpr uint8_t kModuleTag = 1;
+static constexpr uint8_t kStackTag = 2;
+
+inline void put_varint(std::string& out, uint64_t v) {
+    while (v >= 0x80) {
+        out.push_back(static_cast<char>(v | 0x80));
+        v >>= 7;
+    }
+    out.push_back(static_cast<char>(v));
+}
+
+// 读取一个 varint, 数据不足或超长时返回 false
+inline bool get_varint(const char*& p, const char* end, uint64_t& v) {
+    v = 0;
+    for (unsigned shift = 0; shift < 64 && p < end; shift += 7) {
+        uint8_t b = static_cast<uint8_t>(*p++);
+        v |= static_cast<uint64_t>(b & 0x7f) << shift;
+        if (! (b & 0x80)) return true;
+    }
+    return false;
+}
+
+inline uint64_t zigzag(int64_t v) {
+    return (static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63);
+}
+
+inline int64_t unzigzag(uint64_t v) {
+    return static_cast<int64_t>(v >> 1) ^ -static_cast<int64_t>(v & 1);
+}
+
+inline uint64_t fnv1a(const std::string& s) {
+    uint64_t h = 0xcbf29ce484222325ull;
+    for (unsigned char c : s) {
+        h = (h ^ c) * 0x100000001b3ull;
+    }
+    return h;
+}
+
+inline uint64_t mix(uint64_t h) {
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdull;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ull;
+    h ^= h >> 33;
+    return h;
+}
+
+// 模块身份: 有 build-id 时只用 build-id (同一二进制换了路径也相同), 否则用路径
+inline uint64_t module_hash(const std::string& path, const std::string& build_id) {
+    return build_id.empty() ? fnv1a(path) : fnv1a(build_id) ^ 0x9e3779b97f4a7c15ull;
+}
+
+// 指纹的逐帧累加, 编码端与解码端共用; 未知模块的 module_hash 取 0
+inline uint64_t fingerprint_step(uint64_t h, uint64_t module_hash, uint64_t offset) {
+    return mix(mix(h ^ module_hash) ^ offset);
+}
+
+inline uint64_t fingerprint_seed(size_t nframes) {
+    return mix(0x5353545246505254ull ^ nframes);
+}
+
+// 一条记录内, 每个模块上一帧的偏移; 一个栈涉及的模块通常只有几个, 线性查找即可
+class DeltaState {
+  public:
+    DeltaState() : last_() {}
+
+    void reset() {
+        last_.clear();
+    }
+
+    uint64_t& last(uint64_t module_ref) {
+        for (auto& e : last_) {
+            if (e.first == module_ref) return e.second;
+        }
+        last_.emplace_back(module_ref, 0);
+        return last_.back().second;
+    }
+
+  private:
+    std::vector<std::pair<uint64_t, uint64_t>> last_;
+};
+
+} // namespace record
+
+// 流式编码器: 每次 write() 把新出现的模块与一条栈记录追加到内部缓冲区, 由调用方取走后 consume()
+class StackRecordWriter {
+  public:
+    StackRecordWriter() : buf_(), modules_(), next_id_(0), refs_(), delta_() {
+        buf_.append(record::kMagic, sizeof(record::kMagic));
+        buf_.push_back(static_cast<char>(record::kVersion));
+    }
+
+    // 编码一条栈, 返回其指纹
+    uint64_t write(const RawFrame* frames, size_t n) {
+        // 模块记录必须在引用它的栈记录之前, 所以先扫一遍帧
+        refs_.resize(n);
+        uint64_t h = record::fingerprint_seed(n);
+        for (size_t i = 0; i < n; ++i) {
+            const RawFrame& f = frames[i];
+            if (! f.has_symbol || f.module.empty()) {
+                refs_[i] = 0;
+                h = record::fingerprint_step(h, 0, f.abs_addr);
+                continue;
+            }
+            ModuleEntry& m = module_of(f.module);
+            refs_[i] = m.id + 1;
+            h = record::fingerprint_step(h, m.hash, f.offset);
+        }
+
+        buf_.push_back(static_cast<char>(record::kStackTag));
+        record::put_varint(buf_, n);
+        buf_.append(reinterpret_cast<const char*>(&h), sizeof(h));
+
+        delta_.reset();
+        for (size_t i = 0; i < n; ++i) {
+            uint64_t value = refs_[i] ? frames[i].offset : frames[i].abs_addr;
+            uint64_t& last = delta_.last(refs_[i]);
+            record::put_varint(buf_, refs_[i]);
+            record::put_varint(buf_, record::zigzag(static_cast<int64_t>(value - last)));
+            last = value;
+        }
+        return h;
+    }
+
+    uint64_t write(const std::vector<RawFrame>& frames) {
+        return write(frames.data(), frames.size());
+    }
+
+    // 已编码但尚未取走的数据
+    const char* data() const {
+        return buf_.data();
+    }
+
+    size_t size() const {
+        return buf_.size();
+    }
+
+    // 丢弃已取走的数据; 模块表状态保留, 之后的数据仍需按同一条流解码
+    void consume() {
+        buf_.clear();
+    }
+
+    // 只计算指纹, 不写入任何数据
+    uint64_t fingerprint(const RawFrame* frames, size_t n) {
+        uint64_t h = record::fingerprint_seed(n);
+        for (size_t i = 0; i < n; ++i) {
+            const RawFrame& f = frames[i];
+            if (! f.has_symbol || f.module.empty()) {
+                h = record::fingerprint_step(h, 0, f.abs_addr);
+            } else {
+                h = record::fingerprint_step(h, hash_of(f.module), f.offset);
+            }
+        }
+        return h;
+    }
+
+  private:
+    struct ModuleEntry {
+        uint64_t id; // 写出模块记录时才分配, 解码端按出现顺序编号
+        uint64_t hash;
+        std::string build_id;
+        bool emitted;
+    };
+
+    std::string buf_;
+    std::unordered_map<std::string, ModuleEntry> modules_; // 路径 -> 模块, build-id 每个路径只读一次
+    uint64_t next_id_;                                     // 下一个写出的模块的编号
+    std::vector<uint64_t> refs_;
+    record::DeltaState delta_;
+
+    ModuleEntry& lookup(const std::string& path) {
+        auto it = modules_.find(path);
+        if (it == modules_.end()) {
+            ModuleEntry e{0, 0, read_build_id(path.c_str()), false};
+            e.hash = record::module_hash(path, e.build_id);
+            it = modules_.emplace(path, std::move(e)).first;
+        }
+        return it->second;
+    }
+
+    uint64_t hash_of(const std::string& path) {
+        return lookup(path).hash;
+    }
+
+    // 第一次被某条栈引用时写出模块记录
+    ModuleEntry& module_of(const std::string& path) {
+        ModuleEntry& m = lookup(path);
+        if (! m.emitted) {
+            m.id = next_id_++;
+            buf_.push_back(static_cast<char>(record::kModuleTag));
+            record::put_varint(buf_, m.id);
+            record::put_varint(buf_, path.size());
+            buf_.append(path);
+            record::put_varint(buf_, m.build_id.size());
+            buf_.append(m.build_id);
+            m.emitted = true;
+        }
+        return m;
+    }
+};
+
+// 流式解码器: feed() 追加任意长度的数据, next() 每次取出一条完整的栈记录
+// 解码出的 RawFrame::abs_addr 仅对未知模块的帧有效 (编码时不保存加载基址)
+class StackRecordReader {
+  public:
+    enum Status {
+        kRecord = 1,   // 取出了一条栈
+        kNeedMore = 0, // 数据不完整, 需要继续 feed()
+        kCorrupt = -1, // 数据损坏, 之后的数据无法继续解码
+    };
+
+    struct ModuleInfo {
+        std::string path;
+        std::string build_id;
+        uint64_t hash;
+    };
+
+    StackRecordReader() : buf_(), pos_(0), header_ok_(false), corrupt_(false), modules_(), delta_() {}
+
+    void feed(const char* data, size_t n) {
+        // 把已消费的部分移走, 避免缓冲区无限增长
+        if (pos_ > 0 && pos_ * 2 >= buf_.size()) {
+            buf_.erase(0, pos_);
+            pos_ = 0;
+        }
+        buf_.append(data, n);
+    }
+
+    Status next(std::vector<RawFrame>& frames, uint64_t& fingerprint) {
+        if (corrupt_) return kCorrupt;
+        if (! header_ok_) {
+            if (buf_.size() - pos_ < sizeof(record::kMagic) + 1) return kNeedMore;
+            if (memcmp(buf_.data() + pos_, record::kMagic, sizeof(record::kMagic)) != 0 ||
+                static_cast<uint8_t>(buf_[pos_ + sizeof(record::kMagic)]) != record::kVersion) {
+                return fail();
+            }
+            pos_ += sizeof(record::kMagic) + 1;
+            header_ok_ = true;
+        }
+
+        for (;;) {
+            const char* begin = buf_.data() + pos_;
+            const char* end = buf_.data() + buf_.size();
+            const char* p = begin;
+            if (p >= end) return kNeedMore;
+
+            uint8_t tag = static_cast<uint8_t>(*p++);
+            if (tag == record::kModuleTag) {
+                uint64_t id = 0, path_len = 0, id_len = 0;
+                if (! record::get_varint(p, end, id) || ! record::get_varint(p, end, path_len)) return more_or_fail(p, end);
+                if (static_cast<uint64_t>(end - p) < path_len) return kNeedMore;
+                const char* path = p;
+                p += path_len;
+                if (! record::get_varint(p, end, id_len)) return more_or_fail(p, end);
+                if (static_cast<uint64_t>(end - p) < id_len) return kNeedMore;
+                if (id != modules_.size()) return fail();
+                ModuleInfo m{std::string(path, path_len), std::string(p, id_len), 0};
+                m.hash = record::module_hash(m.path, m.build_id);
+                modules_.push_back(std::move(m));
+                p += id_len;
+                pos_ += static_cast<size_t>(p - begin);
+                continue;
+            }
+            if (tag != record::kStackTag) return fail();
+
+            uint64_t n = 0;
+            if (! record::get_varint(p, end, n)) return more_or_fail(p, end);
+            if (static_cast<size_t>(end - p) < sizeof(uint64_t)) return kNeedMore;
+            memcpy(&fingerprint, p, sizeof(uint64_t));
+            p += sizeof(uint64_t);
+
+            frames.clear();
+            delta_.reset();
+            for (uint64_t i = 0; i < n; ++i) {
+                uint64_t ref = 0, zz = 0;
+                if (! record::get_varint(p, end, ref) || ! record::get_varint(p, end, zz)) return more_or_fail(p, end);
+                if (ref > modules_.size()) return fail();
+                uint64_t& last = delta_.last(ref);
+                uint64_t value = last + static_cast<uint64_t>(record::unzigzag(zz));
+                last = value;
+
+                RawFrame f;
+                if (ref == 0) {
+                    f.abs_addr = static_cast<uintptr_t>(value);
+                } else {
+                    f.offset = static_cast<uintptr_t>(value);
+                    f.module = modules_[ref - 1].path;
+                    f.has_symbol = true;
+                }
+                frames.push_back(std::move(f));
+            }
+            pos_ += static_cast<size_t>(p - begin);
+            return kRecord;
+        }
+    }
+
+    // 已读到的模块表, 下标即模块 id
+    const std::vector<ModuleInfo>& modules() const {
+        return modules_;
+    }
+
+  private:
+    std::string buf_;
+    size_t pos_;
+    bool header_ok_;
+    bool corrupt_;
+    std::vector<ModuleInfo> modules_;
+    record::DeltaState delta_;
+
+    Status fail() {
+        corrupt_ = true;
+        return kCorrupt;
+    }
+
+    // varint 读不完整时: 数据用完了就是需要更多数据, 否则是超长的非法 varint
+    Status more_or_fail(const char* p, const char* end) {
+        return p >= end ? kNeedMore : fail();
+    }
+};
+
+} // namespace stacktrace
@@ -0,0 +1,97 @@
+// sst_shadow.hpp - 基于 -finstrument-functions 的影子调用栈, 抓栈只需复制一段 TLS 数组
+// - 以 -finstrument-functions 编译的函数在入口 / 出口调用 __cyg_profile_func_enter / exit,
+//   钩子把 (函数地址, 调用点) 压入 / 弹出当前线程 TLS 中的定长数组, 每次函数调用多两次 TLS 写入
+// - ShadowStackUnwinder::unwind() 不读取栈内存, 也不依赖 frame pointer 或 .eh_frame, 只做至多两次 memcpy;
+//   结果为 [最内层函数的入口地址, 各层的调用点 (返回地址) ...], 之后的解析流程与其他展开策略相同
+// - 整个程序统一以 -DSST_SHADOW_STACK 编译时, Stacktrace 等默认的展开策略也换成 ShadowStackUnwinder
+// 注意:
+// - 只记录插桩过的函数, 未重新编译的库 (libc 等) 中的帧不会出现; 超过 kCapacity 层时只保留最内层的部分
+// - longjmp、swapcontext 等绕过函数出口的跳转会使影子栈与真实的栈不一致
+// - 库自身的头文件不应插桩: -finstrument-functions-exclude-file-list=include/sst
+//
+// 钩子需要在可执行文件的某个翻译单元中展开一次: SST_DEFINE_SHADOW_STACK_HOOKS()
+// 共享库中插桩的函数要调用到这里的钩子 (而不是 libc 中的空实现), 可执行文件需以 -rdynamic 链接
+//
+//   g++ -finstrument-functions -finstrument-functions-exclude-file-list=include/sst -DSST_SHADOW_STACK ...
+//   SST_DEFINE_SHADOW_STACK_HOOKS()
+//   stacktrace::Stacktrace::capture().print();
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+
+namespace stacktrace {
+
+namespace shadow {
+
+static constexpr size_t kCapacity = 256;
+
+// 深度 d 的帧存放在下标 kCapacity - 1 - (d % kCapacity): 数组从高向低增长,
+// 从最内层开始向外正好是递增的下标, 复制时不需要反转; 超过容量后回绕, 覆盖最外层的帧
+struct ShadowStack {
+    size_t depth; // 当前深度, 可以超过 kCapacity
+    void* fn[kCapacity];
+    void* call_site[kCapacity];
+};
+
+// 零初始化的 POD, 访问时没有初始化检查
+__attribute__((no_instrument_function)) inline ShadowStack& current() {
+    static __thread ShadowStack s;
+    return s;
+}
+
+// 先占住槽位再写入: 在两者之间到达的信号处理函数中插桩的函数压在更深的一层, 不会覆盖这一帧
+// (此时在处理函数中抓栈, 最内层的这一帧可能还是旧值)
+__attribute__((no_instrument_function)) inline void enter(void* fn, void* call_site) {
+    ShadowStack& s = current();
+    size_t i = (kCapacity - 1) - (s.depth & (kCapacity - 1));
+    ++s.depth;
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+    s.fn[i] = fn;
+    s.call_site[i] = call_site;
+}
+
+__attribute__((no_instrument_function)) inline void leave() {
+    ShadowStack& s = current();
+    if (s.depth > 0) --s.depth;
+}
+
+// 当前线程的插桩函数嵌套深度
+__attribute__((no_instrument_function)) inline size_t depth() {
+    return current().depth;
+}
+
+} // namespace shadow
+
+static_assert((shadow::kCapacity & (shadow::kCapacity - 1)) == 0, "shadow stack capacity must be a power of two");
+
+// 栈展开策略: 复制影子调用栈, 要求以 -finstrument-functions 编译并展开 SST_DEFINE_SHADOW_STACK_HOOKS()
+struct ShadowStackUnwinder {
+    __attribute__((no_instrument_function)) static size_t unwind(void** frames, size_t max_frames) {
+        const shadow::ShadowStack& s = shadow::current();
+        if (s.depth == 0 || max_frames == 0) return 0;
+        size_t top = (shadow::kCapacity - 1) - ((s.depth - 1) & (shadow::kCapacity - 1));
+        frames[0] = s.fn[top];
+        size_t n = s.depth < shadow::kCapacity ? s.depth : shadow::kCapacity;
+        if (n > max_frames - 1) n = max_frames - 1;
+        size_t first = n < shadow::kCapacity - top ? n : shadow::kCapacity - top;
+        memcpy(frames + 1, &s.call_site[top], first * sizeof(void*));
+        memcpy(frames + 1 + first, &s.call_site[0], (n - first) * sizeof(void*));
+        return 1 + n;
+    }
+};
+
+} // namespace stacktrace
+
+#define SST_DEFINE_SHADOW_STACK_HOOKS()                                                                 \
+    extern "C" __attribute__((no_instrument_function)) void __cyg_profile_func_enter(void* fn, void* call_site) { \
+        ::stacktrace::shadow::enter(fn, call_site);                                                    \
+    }                                                                                                  \
+    extern "C" __attribute__((no_instrument_function)) void __cyg_profile_func_exit(void*, void*) {    \
+        ::stacktrace::shadow::leave();                                                                 \
+    }
+
+// 放在末尾: sst_fwd.hpp 在 SST_SHADOW_STACK 下会反过来包含本文件, 此时上面的定义已经可用
+#include "sst_fwd.hpp"
@@ -0,0 +1,486 @@
+// sst_slowop.hpp - 慢操作现场抓栈 (仅 Linux)
+// - SlowOpGuard 标记一段作用域及其耗时阈值, 进入/离开只写线程局部槽位中的几个原子变量, 不做系统调用
+// - 看门狗线程以粗粒度时钟 (默认 1 ms) 扫描所有槽位, 发现超时的作用域时用 tgkill 给该线程发信号,
+//   由信号处理函数在线程仍处于慢代码中时抓栈
+// - 栈按地址去重, 新栈经过限速后交给独立的上报线程符号化并回调, 重复的栈只计数
+// 注意: 抓栈信号带 SA_RESTART, 但作用域内不会自动重启的系统调用 (epoll_wait、nanosleep、设置了超时的 socket 读等)
+//       被打断时仍会返回 EINTR
+//
+//   SlowOpWatchdog::start();
+//   {
+//       SlowOpGuard guard(std::chrono::milliseconds(50), "handle_request");
+//       handle_request();   // 超过 50 ms 时上报此刻的调用栈
+//   }
+
+#pragma once
+
+#include "sst.hpp"
+
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+#include <signal.h>
+#include <sys/syscall.h>
+#include <time.h>
+
+namespace stacktrace {
+
+// 一次超时的上报
+struct SlowOpReport {
+    const char* name;      // SlowOpGuard 的名字 (须为静态字符串)
+    uint64_t threshold_us; // 阈值
+    uint64_t elapsed_us;   // 抓栈时已经过的时间 (粗粒度时钟, 误差约为一个 tick)
+    pid_t tid;             // 慢操作所在线程
+    uint64_t fingerprint;  // 调用路径 (除栈顶 pc 外的返回地址) 的哈希, 去重的键
+    uint64_t occurrences;  // 该栈累计出现的次数 (上报时为 1, summary() 中为累计值)
+    std::vector<ResolvedFrame> frames;
+};
+
+struct SlowOpStats {
+    uint64_t fired;        // 发出的抓栈信号数
+    uint64_t captured;     // 成功抓到的栈数
+    uint64_t missed;       // 信号到达时操作已经结束
+    uint64_t unique;       // 去重后的栈数
+    uint64_t duplicates;   // 与已有栈重复, 只计数不上报
+    uint64_t rate_limited; // 新栈因限速未上报
+    uint64_t dropped;      // 去重表已满, 未记录
+};
+
+struct SlowOpOptions {
+    uint32_t tick_us = 1000;             // 看门狗的扫描周期, 也是粗粒度时钟的精度
+    int signal = 0;                      // 抓栈使用的信号, 0 表示 SIGRTMIN + 5
+    uint32_t max_reports_per_sec = 10;   // 新栈的上报速率上限
+    size_t max_unique_stacks = 4096;     // 去重表容量
+    std::function<void(const SlowOpReport&)> on_report; // 在上报线程中调用, 为空时打印到 stderr
+
+    SlowOpOptions() : on_report() {}
+};
+
+namespace slowop {
+
+static constexpr size_t kMaxFrames = 64;
+// 信号处理函数自身与内核的 sigreturn 跳板
+static constexpr size_t kSkipFrames = 2;
+
+enum SlotState : int {
+    kIdle = 0,
+    kRequested = 1, // 看门狗已发信号, 等待处理函数抓栈
+    kCaptured = 2,  // 处理函数已写好 frames, 等待看门狗取走
+};
+
+// 每个线程一个, 由所属线程写入 armed_at 等字段, 看门狗只读; frames 由信号处理函数写, 看门狗在 kCaptured 后读
+struct Slot {
+    std::atomic<uint64_t> armed_at{0}; // 进入作用域时的粗粒度时钟, 0 表示没有生效的 guard
+    std::atomic<uint64_t> threshold_us{0};
+    std::atomic<const char*> name{nullptr};
+    std::atomic<uint64_t> seq{0}; // 当前生效的操作编号, 区分同一线程的不同操作
+    uint64_t next_seq = 0;        // 所属线程: 已分配的最大操作编号
+
+    std::atomic<int> state{kIdle};
+    uint64_t fired_seq = 0;   // 看门狗: 已为哪一次操作发过信号, 每次操作最多抓一次
+    uint64_t elapsed_us = 0;  // 看门狗: 发信号时的耗时
+    uint64_t requested_at = 0; // 看门狗: 发信号时的粗粒度时钟
+    // 看门狗: 发信号时的名字与阈值; 取走结果时 guard 可能已经离开, name/threshold_us 已恢复为外层的值
+    const char* fired_name = nullptr;
+    uint64_t fired_threshold_us = 0;
+    uint64_t captured_seq = 0; // 处理函数: 抓栈时的 seq
+    size_t nframes = 0;
+    void* frames[kMaxFrames] = {};
+    pid_t tid;
+
+    Slot() : tid(static_cast<pid_t>(syscall(SYS_gettid))) {}
+};
+
+// 粗粒度时钟 (微秒, 从 1 开始), 由看门狗线程推进
+inline std::atomic<uint64_t>& coarse_clock() {
+    static std::atomic<uint64_t> clock{1};
+    return clock;
+}
+
+inline Slot*& current_slot() {
+    static thread_local Slot* slot = nullptr;
+    return slot;
+}
+
+struct Registry {
+    std::mutex mu;
+    std::vector<Slot*> slots;
+
+    Registry() : mu(), slots() {}
+};
+
+inline Registry& registry() {
+    static Registry* r = new Registry(); // 不析构: 线程退出可能晚于静态对象析构
+    return *r;
+}
+
+// 线程退出时注销槽位: 先清空线程局部指针 (信号处理函数据此忽略), 再释放
+struct SlotOwner {
+    Slot* slot;
+
+    SlotOwner() : slot(new Slot()) {
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mu);
+        r.slots.push_back(slot);
+    }
+
+    SlotOwner(const SlotOwner&) = delete;
+    SlotOwner& operator=(const SlotOwner&) = delete;
+
+    ~SlotOwner() {
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mu);
+        current_slot() = nullptr;
+        r.slots.erase(std::find(r.slots.begin(), r.slots.end(), slot));
+        delete slot;
+    }
+};
+
+__attribute__((noinline)) inline Slot* register_thread() {
+    static thread_local SlotOwner owner;
+    current_slot() = owner.slot;
+    return owner.slot;
+}
+
+inline void on_signal(int, siginfo_t*, void*) {
+    Slot* slot = current_slot();
+    if (! slot || slot->state.load(std::memory_order_acquire) != kRequested) return;
+
+    // 信号到达时作用域已经结束 (离开最外层 guard 不改变 seq): 不抓栈, 看门狗计为 missed
+    if (slot->armed_at.load(std::memory_order_relaxed) == 0) {
+        slot->nframes = 0;
+        slot->state.store(kCaptured, std::memory_order_release);
+        return;
+    }
+
+    int saved_errno = errno;
+    int n = backtrace(slot->frames, static_cast<int>(kMaxFrames));
+    slot->nframes = n > 0 ? static_cast<size_t>(n) : 0;
+    slot->captured_seq = slot->seq.load(std::memory_order_relaxed);
+    slot->state.store(kCaptured, std::memory_order_release);
+    errno = saved_errno;
+}
+
+inline uint64_t hash_frames(void* const* frames, size_t n) {
+    uint64_t h = 0xcbf29ce484222325ull;
+    for (size_t i = 0; i < n; ++i) {
+        h = (h ^ reinterpret_cast<uintptr_t>(frames[i])) * 0x100000001b3ull;
+        h ^= h >> 29;
+    }
+    return h;
+}
+
+} // namespace slowop
+
+// 标记一个需要监控耗时的作用域; 可嵌套, 离开时恢复外层 guard
+class SlowOpGuard {
+  public:
+    template <typename Rep, typename Period>
+    explicit SlowOpGuard(std::chrono::duration<Rep, Period> threshold, const char* name = "slow op")
+        : slot_(slowop::current_slot()), prev_armed_(0), prev_threshold_(0), prev_name_(nullptr), prev_seq_(0) {
+        if (! slot_) slot_ = slowop::register_thread();
+        prev_armed_ = slot_->armed_at.load(std::memory_order_relaxed);
+        prev_threshold_ = slot_->threshold_us.load(std::memory_order_relaxed);
+        prev_name_ = slot_->name.load(std::memory_order_relaxed);
+        prev_seq_ = slot_->seq.load(std::memory_order_relaxed);
+
+        slot_->armed_at.store(0, std::memory_order_relaxed);
+        slot_->threshold_us.store(
+            static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(threshold).count()),
+            std::memory_order_relaxed);
+        slot_->name.store(name, std::memory_order_relaxed);
+        slot_->seq.store(++slot_->next_seq, std::memory_order_relaxed);
+        slot_->armed_at.store(slowop::coarse_clock().load(std::memory_order_relaxed), std::memory_order_release);
+    }
+
+    SlowOpGuard(const SlowOpGuard&) = delete;
+    SlowOpGuard& operator=(const SlowOpGuard&) = delete;
+
+    ~SlowOpGuard() {
+        slot_->armed_at.store(0, std::memory_order_relaxed);
+        if (prev_armed_ == 0) return;
+        slot_->threshold_us.store(prev_threshold_, std::memory_order_relaxed);
+        slot_->name.store(prev_name_, std::memory_order_relaxed);
+        // 外层操作继续, 沿用它的 seq, 已经抓过栈的外层不会重复抓
+        slot_->seq.store(prev_seq_, std::memory_order_relaxed);
+        slot_->armed_at.store(prev_armed_, std::memory_order_release);
+    }
+
+  private:
+    slowop::Slot* slot_;
+    uint64_t prev_armed_;
+    uint64_t prev_threshold_;
+    const char* prev_name_;
+    uint64_t prev_seq_;
+};
+
+class SlowOpWatchdog {
+  public:
+    // 启动看门狗与上报线程, 安装信号处理函数; 已经启动时返回 false
+    static bool start(const SlowOpOptions& options = SlowOpOptions()) {
+        return instance().do_start(options);
+    }
+
+    static void stop() {
+        instance().do_stop();
+    }
+
+    static SlowOpStats stats() {
+        SlowOpWatchdog& w = instance();
+        std::lock_guard<std::mutex> lock(w.mu_);
+        return w.stats_;
+    }
+
+    // 所有去重后的栈及其累计次数, 按次数降序; 在调用线程中符号化
+    static std::vector<SlowOpReport> summary() {
+        SlowOpWatchdog& w = instance();
+        std::vector<Captured> stacks;
+        {
+            std::lock_guard<std::mutex> lock(w.mu_);
+            for (const auto& e : w.unique_) {
+                stacks.push_back(e.second);
+            }
+        }
+        std::sort(stacks.begin(), stacks.end(), [](const Captured& a, const Captured& b) { return a.count > b.count; });
+
+        Modules mods;
+        ModuleManager::load_modules(mods, getpid());
+        std::vector<SlowOpReport> out;
+        for (const auto& c : stacks) {
+            out.push_back(to_report(c, mods));
+        }
+        return out;
+    }
+
+  private:
+    // 看门狗取走的一次抓栈结果
+    struct Captured {
+        const char* name;
+        uint64_t threshold_us;
+        uint64_t elapsed_us;
+        pid_t tid;
+        uint64_t fingerprint;
+        uint64_t count;
+        std::vector<void*> frames;
+
+        Captured() : name(nullptr), threshold_us(0), elapsed_us(0), tid(0), fingerprint(0), count(0), frames() {}
+        Captured(const Captured&) = default;
+        Captured(Captured&&) = default;
+        Captured& operator=(const Captured&) = default;
+        Captured& operator=(Captured&&) = default;
+    };
+
+    SlowOpOptions options_;
+    std::atomic<bool> running_;
+    std::thread watchdog_;
+    std::thread reporter_;
+
+    std::mutex mu_; // 保护以下成员
+    std::condition_variable cv_;
+    std::deque<Captured> queue_;
+    std::unordered_map<uint64_t, Captured> unique_;
+    SlowOpStats stats_;
+    double tokens_;
+
+    SlowOpWatchdog()
+        : options_(), running_(false), watchdog_(), reporter_(), mu_(), cv_(), queue_(), unique_(), stats_(), tokens_(0) {}
+
+    static SlowOpWatchdog& instance() {
+        static SlowOpWatchdog* w = new SlowOpWatchdog(); // 不析构, 由使用者显式 stop()
+        return *w;
+    }
+
+    bool do_start(const SlowOpOptions& options) {
+        if (running_.exchange(true)) return false;
+        options_ = options;
+        if (options_.signal == 0) options_.signal = SIGRTMIN + 5;
+        if (options_.tick_us == 0) options_.tick_us = 1000;
+        tokens_ = options_.max_reports_per_sec;
+
+        // 首次调用 backtrace() 会加载 libgcc_s, 在信号处理函数中使用前先预热
+        void* warm[1];
+        backtrace(warm, 1);
+
+        struct sigaction sa;
+        memset(&sa, 0, sizeof(sa));
+        sa.sa_sigaction = slowop::on_signal;
+        sa.sa_flags = SA_SIGINFO | SA_RESTART;
+        sigemptyset(&sa.sa_mask);
+        sigaction(options_.signal, &sa, nullptr);
+
+        watchdog_ = std::thread(&SlowOpWatchdog::watchdog_loop, this);
+        reporter_ = std::thread(&SlowOpWatchdog::reporter_loop, this);
+        return true;
+    }
+
+    void do_stop() {
+        if (! running_.exchange(false)) return;
+        cv_.notify_all();
+        watchdog_.join();
+        reporter_.join();
+    }
+
+    void watchdog_loop() {
+        using Clock = std::chrono::steady_clock;
+        const auto begin = Clock::now();
+        const pid_t pid = getpid();
+        std::vector<Captured> captured;
+        uint64_t last_refill = 1;
+
+        while (running_.load(std::memory_order_relaxed)) {
+            timespec ts{0, static_cast<long>(options_.tick_us) * 1000};
+            nanosleep(&ts, nullptr);
+            uint64_t now = 1 + static_cast<uint64_t>(
+                                   std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - begin).count());
+            slowop::coarse_clock().store(now, std::memory_order_relaxed);
+
+            uint64_t fired = 0, missed = 0;
+            captured.clear();
+            {
+                slowop::Registry& r = slowop::registry();
+                std::lock_guard<std::mutex> lock(r.mu);
+                for (slowop::Slot* slot : r.slots) {
+                    int state = slot->state.load(std::memory_order_acquire);
+                    if (state == slowop::kCaptured) {
+                        if (slot->captured_seq == slot->fired_seq && slot->nframes > slowop::kSkipFrames) {
+                            captured.push_back(take(*slot));
+                        } else {
+                            ++missed;
+                        }
+                        slot->state.store(slowop::kIdle, std::memory_order_relaxed);
+                        continue;
+                    }
+                    if (state == slowop::kRequested) {
+                        // 信号被屏蔽或丢失时不要永远卡住
+                        if (now - slot->requested_at > 1000000) slot->state.store(slowop::kIdle, std::memory_order_relaxed);
+                        continue;
+                    }
+
+                    uint64_t armed = slot->armed_at.load(std::memory_order_acquire);
+                    if (armed == 0 || armed > now) continue;
+                    uint64_t seq = slot->seq.load(std::memory_order_relaxed);
+                    uint64_t elapsed = now - armed;
+                    uint64_t threshold = slot->threshold_us.load(std::memory_order_relaxed);
+                    if (elapsed < threshold || slot->fired_seq == seq) continue;
+
+                    slot->fired_seq = seq;
+                    slot->elapsed_us = elapsed;
+                    slot->requested_at = now;
+                    slot->fired_name = slot->name.load(std::memory_order_relaxed);
+                    slot->fired_threshold_us = threshold;
+                    slot->state.store(slowop::kRequested, std::memory_order_release);
+                    if (syscall(SYS_tgkill, pid, slot->tid, options_.signal) != 0) {
+                        slot->state.store(slowop::kIdle, std::memory_order_relaxed);
+                        continue;
+                    }
+                    ++fired;
+                }
+            }
+
+            std::lock_guard<std::mutex> lock(mu_);
+            stats_.fired += fired;
+            stats_.missed += missed;
+            // 令牌桶: 每秒补充 max_reports_per_sec 个
+            double rate = options_.max_reports_per_sec;
+            tokens_ = std::min(rate, tokens_ + rate * static_cast<double>(now - last_refill) / 1e6);
+            last_refill = now;
+            for (auto& c : captured) {
+                admit(std::move(c));
+            }
+        }
+    }
+
+    // 在持有 registry 锁时从槽位取出抓栈结果; 信号处理函数此时不会再写入该槽位
+    static Captured take(slowop::Slot& slot) {
+        Captured c;
+        c.name = slot.fired_name;
+        c.threshold_us = slot.fired_threshold_us;
+        c.elapsed_us = slot.elapsed_us;
+        c.tid = slot.tid;
+        c.frames.assign(slot.frames + slowop::kSkipFrames, slot.frames + slot.nframes);
+        // 栈顶是被打断的 pc, 在同一个慢函数里每次都不同; 只用返回地址 (即调用路径) 去重
+        c.fingerprint = slowop::hash_frames(c.frames.data() + 1, c.frames.size() - 1);
+        c.count = 1;
+        return c;
+    }
+
+    // 去重 + 限速, 调用方持有 mu_
+    void admit(Captured&& c) {
+        stats_.captured++;
+        auto it = unique_.find(c.fingerprint);
+        if (it != unique_.end()) {
+            it->second.count++;
+            stats_.duplicates++;
+            return;
+        }
+        if (unique_.size() >= options_.max_unique_stacks) {
+            stats_.dropped++;
+            return;
+        }
+        unique_.emplace(c.fingerprint, c);
+        stats_.unique++;
+        if (tokens_ < 1) {
+            stats_.rate_limited++;
+            return;
+        }
+        tokens_ -= 1;
+        queue_.push_back(std::move(c));
+        cv_.notify_one();
+    }
+
+    static SlowOpReport to_report(const Captured& c, Modules& mods) {
+        SlowOpReport r{c.name, c.threshold_us, c.elapsed_us, c.tid, c.fingerprint, c.count, {}};
+        for (size_t i = 0; i < c.frames.size(); ++i) {
+            ResolvedFrame f = resolve_with_modules(c.frames[i], mods);
+            f.index = i;
+            r.frames.push_back(std::move(f));
+        }
+        return r;
+    }
+
+    // 上报线程使用自己的模块表符号化, 不与业务线程共享 ModuleManager
+    void reporter_loop() {
+        Modules mods;
+        ModuleManager::load_modules(mods, getpid());
+        for (;;) {
+            Captured c;
+            {
+                std::unique_lock<std::mutex> lock(mu_);
+                cv_.wait(lock, [this] { return ! queue_.empty() || ! running_.load(std::memory_order_relaxed); });
+                if (queue_.empty()) return;
+                c = std::move(queue_.front());
+                queue_.pop_front();
+            }
+
+            SlowOpReport r = to_report(c, mods);
+            // 有帧落在未知模块时 (例如之后 dlopen 的库), 重新加载一次模块表
+            bool unknown = false;
+            for (const auto& f : r.frames) {
+                unknown = unknown || f.module.empty();
+            }
+            if (unknown) {
+                ModuleManager::load_modules(mods, getpid());
+                r = to_report(c, mods);
+            }
+
+            if (options_.on_report) {
+                options_.on_report(r);
+            } else {
+                std::ostringstream oss;
+                oss << "[sst] " << r.name << " exceeded " << r.threshold_us << " us (elapsed " << r.elapsed_us
+                    << " us) on thread " << r.tid << ":\n";
+                for (const auto& f : r.frames) {
+                    oss << f.to_string();
+                }
+                fputs(oss.str().c_str(), stderr);
+            }
+        }
+    }
+};
+
+} // namespace stacktrace
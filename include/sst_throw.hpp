@@ -0,0 +1,326 @@
+// sst_throw.hpp - C++ 异常抛出点统计 (仅 Linux)
+// - 通过 __cxa_throw 钩子在抛出时抓栈, 按 (异常类型, 抛出点调用栈) 在无锁的定长表中计数
+// - 抓栈受每秒次数上限约束, 超出的抛出只按类型计数, 异常风暴下开销有上界
+// - 上报线程定期符号化本周期内次数最多的抛出点并回调, 类型名用 demangle() 还原
+//
+// 钩子需要在某个翻译单元中展开一次 (二选一):
+//   SST_DEFINE_THROW_HOOK_WRAP()       链接时加 -Wl,--wrap=__cxa_throw; 静态链接、no-PIE、PIE 均可用,
+//                                      只覆盖参与本次链接的目标文件与静态库中的 throw
+//   SST_DEFINE_THROW_HOOK_INTERPOSE()  动态链接时在可执行文件中直接定义 __cxa_throw,
+//                                      同时覆盖 libstdc++.so 等共享库内部的 throw; 不能用于静态链接
+//
+//   ThrowTracer::start();              // 启动前钩子只做一次原子读
+//   ...
+//   for (const auto& site : ThrowTracer::top(10)) { ... }
+
+#pragma once
+
+#include "sst.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <typeinfo>
+
+#include <time.h>
+
+namespace stacktrace {
+
+// 一个 (异常类型, 抛出点) 的统计
+struct ThrowSite {
+    std::string type;     // demangle 后的异常类型名
+    uint64_t count;       // 累计次数 (周期上报中为本周期的次数)
+    bool has_stack;       // false 表示限速期间未抓栈的抛出, 只按类型汇总
+    std::vector<ResolvedFrame> frames; // frames[0] 为抛出点
+};
+
+struct ThrowStats {
+    uint64_t throws;       // 启动后的抛出总数
+    uint64_t captured;     // 抓到栈的次数
+    uint64_t rate_limited; // 因限速未抓栈, 只按类型计数
+    uint64_t unique;       // 表中的 (类型, 栈) 数
+    uint64_t dropped;      // 表已满, 未计入
+};
+
+struct ThrowTracerOptions {
+    uint32_t max_captures_per_sec = 1000; // 每秒抓栈次数上限
+    uint32_t report_interval_ms = 10000;  // 周期上报间隔, 0 表示不启动上报线程
+    size_t top_n = 10;                    // 每次上报的抛出点个数
+    std::function<void(const std::vector<ThrowSite>&)> on_report; // 在上报线程中调用, 为空时打印到 stderr
+
+    ThrowTracerOptions() : on_report() {}
+};
+
+namespace throwtrace {
+
+const size_t kTableSize = 4096; // 2 的幂
+const size_t kMaxProbe = 64;
+
+struct Entry {
+    std::atomic<uint64_t> key; // 0 表示空槽; 写入者 CAS 占位后填充其余字段, 再置 ready
+    std::atomic<bool> ready;
+    const std::type_info* type;
+    uint32_t depth;
+    void* frames[Stacktrace::kMaxFrames];
+    std::atomic<uint64_t> count;
+    uint64_t reported; // 上一次周期上报时的 count, 只由上报线程访问
+};
+
+struct State {
+    std::atomic<uint32_t> max_per_sec;
+    std::atomic<int64_t> window;    // 当前限速窗口 (秒)
+    std::atomic<uint32_t> captures; // 当前窗口内的抓栈次数
+    std::atomic<uint64_t> throws;
+    std::atomic<uint64_t> captured;
+    std::atomic<uint64_t> rate_limited;
+    std::atomic<uint64_t> unique;
+    std::atomic<uint64_t> dropped;
+    Entry table[kTableSize];
+};
+
+// 未启动时钩子只读这个标志, 计数表在首次 start() 时才分配
+inline std::atomic<bool>& enabled() {
+    static std::atomic<bool> flag(false);
+    return flag;
+}
+
+inline State& state() {
+    static State* s = new State(); // 值初始化为全零; 不析构: 其他静态对象析构时仍可能抛出
+    return *s;
+}
+
+inline uint64_t hash_site(const std::type_info* type, void* const* frames, size_t depth) {
+    uint64_t h = 1469598103934665603ull ^ reinterpret_cast<uintptr_t>(type);
+    for (size_t i = 0; i < depth; ++i) {
+        h ^= reinterpret_cast<uintptr_t>(frames[i]);
+        h *= 1099511628211ull;
+    }
+    return h == 0 ? 1 : h;
+}
+
+// 按 64 位哈希识别 (类型, 栈), 不再比较帧内容
+inline void count_site(State& s, const std::type_info* type, void* const* frames, size_t depth) {
+    uint64_t key = hash_site(type, frames, depth);
+    size_t idx = key & (kTableSize - 1);
+    for (size_t probe = 0; probe < kMaxProbe; ++probe, idx = (idx + 1) & (kTableSize - 1)) {
+        Entry& e = s.table[idx];
+        uint64_t cur = e.key.load(std::memory_order_acquire);
+        if (cur == 0) {
+            if (e.key.compare_exchange_strong(cur, key, std::memory_order_acq_rel)) {
+                e.type = type;
+                e.depth = static_cast<uint32_t>(depth);
+                memcpy(e.frames, frames, depth * sizeof(void*));
+                e.ready.store(true, std::memory_order_release);
+                e.count.fetch_add(1, std::memory_order_relaxed);
+                s.unique.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            // cur 已被更新为抢先占位者的 key
+        }
+        if (cur == key) {
+            e.count.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+    }
+    s.dropped.fetch_add(1, std::memory_order_relaxed);
+}
+
+// 简单的每秒窗口计数, 窗口切换时的竞争只会让个别抓栈多算或少算
+inline bool take_token(State& s) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+    int64_t now = static_cast<int64_t>(ts.tv_sec);
+    int64_t window = s.window.load(std::memory_order_relaxed);
+    if (window != now && s.window.compare_exchange_strong(window, now, std::memory_order_relaxed)) {
+        s.captures.store(0, std::memory_order_relaxed);
+    }
+    return s.captures.fetch_add(1, std::memory_order_relaxed) < s.max_per_sec.load(std::memory_order_relaxed);
+}
+
+// site 为 __cxa_throw 的返回地址, 即 throw 表达式所在的位置; 栈中位于它之前的帧属于钩子本身
+__attribute__((noinline)) inline void on_throw(const std::type_info* type, void* site) {
+    if (__builtin_expect(! enabled().load(std::memory_order_acquire), 1)) return;
+    State& s = state();
+    s.throws.fetch_add(1, std::memory_order_relaxed);
+    if (! take_token(s)) {
+        s.rate_limited.fetch_add(1, std::memory_order_relaxed);
+        count_site(s, type, nullptr, 0);
+        return;
+    }
+    s.captured.fetch_add(1, std::memory_order_relaxed);
+
+    Stacktrace st = Stacktrace::capture();
+    void* const* frames = st.addresses();
+    size_t skip = 0;
+    while (skip < st.size() && frames[skip] != site) {
+        ++skip;
+    }
+    if (skip == st.size()) skip = 0;
+    count_site(s, type, frames + skip, st.size() - skip);
+}
+
+} // namespace throwtrace
+
+class ThrowTracer {
+  public:
+    // 开始统计; 设置了 report_interval_ms 时启动上报线程; 已经启动时返回 false
+    static bool start(const ThrowTracerOptions& options = ThrowTracerOptions()) {
+        return instance().do_start(options);
+    }
+
+    // 停止统计与上报线程, 已有的计数保留
+    static void stop() {
+        instance().do_stop();
+    }
+
+    static ThrowStats stats() {
+        throwtrace::State& s = throwtrace::state();
+        return ThrowStats{s.throws.load(std::memory_order_relaxed),
+                          s.captured.load(std::memory_order_relaxed),
+                          s.rate_limited.load(std::memory_order_relaxed),
+                          s.unique.load(std::memory_order_relaxed),
+                          s.dropped.load(std::memory_order_relaxed)};
+    }
+
+    // 累计次数最多的 n 个抛出点, 按次数降序; 在调用线程中符号化
+    static std::vector<ThrowSite> top(size_t n) {
+        std::vector<Snapshot> snaps;
+        for (auto& e : throwtrace::state().table) {
+            if (! e.ready.load(std::memory_order_acquire)) continue;
+            snaps.push_back(Snapshot{&e, e.count.load(std::memory_order_relaxed)});
+        }
+        Modules mods;
+        ModuleManager::load_modules(mods, getpid());
+        return to_sites(snaps, n, mods);
+    }
+
+  private:
+    struct Snapshot {
+        throwtrace::Entry* entry;
+        uint64_t count;
+    };
+
+    ThrowTracerOptions options_;
+    std::thread reporter_;
+    std::mutex mu_;
+    std::condition_variable cv_;
+    bool running_;
+
+    ThrowTracer() : options_(), reporter_(), mu_(), cv_(), running_(false) {}
+
+    static ThrowTracer& instance() {
+        static ThrowTracer* t = new ThrowTracer(); // 不析构, 由使用者显式 stop()
+        return *t;
+    }
+
+    bool do_start(const ThrowTracerOptions& options) {
+        {
+            std::lock_guard<std::mutex> lock(mu_);
+            if (running_) return false;
+            running_ = true;
+            options_ = options;
+        }
+        // 首次调用 backtrace() 会加载 libgcc_s, 先在这里预热
+        Stacktrace::capture();
+        throwtrace::State& s = throwtrace::state();
+        s.max_per_sec.store(options.max_captures_per_sec, std::memory_order_relaxed);
+        throwtrace::enabled().store(true, std::memory_order_release);
+        if (options.report_interval_ms > 0) {
+            reporter_ = std::thread(&ThrowTracer::reporter_loop, this);
+        }
+        return true;
+    }
+
+    void do_stop() {
+        throwtrace::enabled().store(false, std::memory_order_relaxed);
+        {
+            std::lock_guard<std::mutex> lock(mu_);
+            if (! running_) return;
+            running_ = false;
+        }
+        cv_.notify_all();
+        if (reporter_.joinable()) reporter_.join();
+    }
+
+    static std::vector<ThrowSite> to_sites(std::vector<Snapshot>& snaps, size_t n, Modules& mods) {
+        n = std::min(n, snaps.size());
+        std::partial_sort(snaps.begin(), snaps.begin() + static_cast<std::ptrdiff_t>(n), snaps.end(),
+                          [](const Snapshot& a, const Snapshot& b) { return a.count > b.count; });
+        std::vector<ThrowSite> out;
+        for (size_t i = 0; i < n; ++i) {
+            const throwtrace::Entry& e = *snaps[i].entry;
+            ThrowSite site{demangle(e.type->name()), snaps[i].count, e.depth > 0, {}};
+            for (size_t k = 0; k < e.depth; ++k) {
+                ResolvedFrame f = resolve_with_modules(e.frames[k], mods);
+                f.index = k;
+                site.frames.push_back(std::move(f));
+            }
+            out.push_back(std::move(site));
+        }
+        return out;
+    }
+
+    // 上报线程使用自己的模块表符号化, 每个周期只上报本周期内有新增次数的抛出点
+    void reporter_loop() {
+        Modules mods;
+        ModuleManager::load_modules(mods, getpid());
+        std::unique_lock<std::mutex> lock(mu_);
+        for (;;) {
+            cv_.wait_for(lock, std::chrono::milliseconds(options_.report_interval_ms), [this] { return ! running_; });
+            if (! running_) return;
+            lock.unlock();
+
+            std::vector<Snapshot> snaps;
+            for (auto& e : throwtrace::state().table) {
+                if (! e.ready.load(std::memory_order_acquire)) continue;
+                uint64_t count = e.count.load(std::memory_order_relaxed);
+                if (count > e.reported) snaps.push_back(Snapshot{&e, count - e.reported});
+                e.reported = count;
+            }
+            if (! snaps.empty()) {
+                // 新出现的抛出点可能来自之后 dlopen 的库, 每个周期重新加载一次模块表
+                ModuleManager::load_modules(mods, getpid());
+                report(to_sites(snaps, options_.top_n, mods));
+            }
+            lock.lock();
+        }
+    }
+
+    void report(const std::vector<ThrowSite>& sites) {
+        if (options_.on_report) {
+            options_.on_report(sites);
+            return;
+        }
+        std::ostringstream oss;
+        oss << "[sst] hottest throw sites in the last " << options_.report_interval_ms << " ms:\n";
+        for (const auto& site : sites) {
+            oss << site.count << " x " << site.type << (site.has_stack ? "\n" : " (stack not captured)\n");
+            for (const auto& f : site.frames) {
+                oss << "    " << f.to_string();
+            }
+        }
+        fputs(oss.str().c_str(), stderr);
+    }
+};
+
+} // namespace stacktrace
+
+// 编译器隐式声明的 __cxa_throw 以 void* 传递 type_info, 签名须与之一致; 钩子先计数, 再交给真正的实现
+#define SST_DEFINE_THROW_HOOK_WRAP()                                                                             \
+    extern "C" __attribute__((noreturn)) void __real___cxa_throw(void*, void*, void (*)(void*));                \
+    extern "C" __attribute__((noreturn)) void __wrap___cxa_throw(void* obj, void* type, void (*dest)(void*)) {   \
+        ::stacktrace::throwtrace::on_throw(static_cast<const std::type_info*>(type), __builtin_return_address(0)); \
+        __real___cxa_throw(obj, type, dest);                                                                      \
+    }
+
+#define SST_DEFINE_THROW_HOOK_INTERPOSE()                                                                         \
+    extern "C" __attribute__((noreturn)) void __cxa_throw(void* obj, void* type, void (*dest)(void*)) {          \
+        typedef void (*throw_fn)(void*, void*, void (*)(void*));                                                  \
+        static throw_fn real = reinterpret_cast<throw_fn>(dlsym(RTLD_NEXT, "__cxa_throw"));                      \
+        ::stacktrace::throwtrace::on_throw(static_cast<const std::type_info*>(type), __builtin_return_address(0)); \
+        real(obj, type, dest);                                                                                    \
+        __builtin_unreachable();                                                                                  \
+    }
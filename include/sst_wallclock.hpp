@@ -0,0 +1,460 @@
+// sst_wallclock.hpp - 按墙钟时间采样的 profiler (仅 Linux), 同时覆盖 on-CPU 与 off-CPU 时间
+// - 采样线程以固定的实际时间间隔遍历所有登记的线程, 无论线程在运行还是阻塞:
+//   先从 /proc/self/task/<tid>/stat 读出线程状态, 再用 tgkill 发信号, 由信号处理函数抓栈
+// - 状态为 R 的样本计入 on-CPU, 其余 (S 睡眠 / D 不可中断 I/O 等) 计入 off-CPU, 每个样本的权重为一个采样间隔
+// - 样本按完整的栈聚合, summary() 按栈给出 on-CPU / off-CPU 时间, tree() 导出为 CallTree (folded / pprof)
+// 注意: 阻塞中的线程收到信号后, 不会自动重启的系统调用 (nanosleep、epoll_wait 等) 会返回 EINTR
+//
+//   WallClockProfiler::start();
+//   WallClockProfiler::register_thread();   // 在每个需要采样的线程中调用一次
+//   ...
+//   for (const auto& s : WallClockProfiler::summary()) { /* s.on_cpu_ns, s.off_cpu_ns, s.frames */ }
+//   WallClockProfiler::write_folded(std::cout);   // on-cpu;main;... / off-cpu;main;...
+
+#pragma once
+
+#include "sst_calltree.hpp"
+
+#include <cerrno>
+#include <chrono>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/syscall.h>
+#include <time.h>
+
+namespace stacktrace {
+
+// 一个栈的累计时间
+struct WallClockStack {
+    uint64_t on_cpu_ns;  // 采样时线程处于 R 状态
+    uint64_t off_cpu_ns; // 采样时线程处于其他状态
+    uint64_t samples;
+    uint64_t state_samples[4]; // 按线程状态细分的样本数, 下标为 WallClockState
+    std::vector<ResolvedFrame> frames;
+};
+
+// /proc/<tid>/stat 中的状态, 只区分对延迟分析有意义的几类
+enum WallClockState : int {
+    kWallRunning = 0,  // R
+    kWallSleeping = 1, // S: 可中断睡眠, 例如锁、条件变量、网络 I/O、sleep
+    kWallDiskWait = 2, // D: 不可中断睡眠, 通常是磁盘 I/O 或缺页
+    kWallOther = 3,    // T / t / Z 等
+};
+
+struct WallClockStats {
+    uint64_t ticks;       // 采样周期数
+    uint64_t signals;     // 发出的抓栈信号数
+    uint64_t samples;     // 成功抓到的样本数
+    uint64_t on_cpu;      // 其中处于 R 状态的
+    uint64_t off_cpu;     // 其中处于其他状态的
+    uint64_t missed;      // 下一个周期前信号仍未处理 (线程屏蔽了信号等)
+    uint64_t dropped;     // 聚合表已满, 未记录
+    size_t threads;       // 当前登记的线程数
+};
+
+struct WallClockOptions {
+    uint32_t interval_us = 10000;    // 采样间隔 (实际时间), 每个登记的线程每个间隔采样一次
+    int signal = 0;                  // 抓栈使用的信号, 0 表示 SIGRTMIN + 6
+    size_t max_unique_stacks = 16384; // 聚合表容量
+
+    WallClockOptions() {}
+};
+
+namespace wallclock {
+
+static constexpr size_t kMaxFrames = 64;
+// 信号处理函数自身与内核的 sigreturn 跳板
+static constexpr size_t kSkipFrames = 2;
+
+enum SlotState : int {
+    kIdle = 0,
+    kRequested = 1, // 采样线程已发信号, 等待处理函数抓栈
+    kCaptured = 2,  // 处理函数已写好 frames, 等待采样线程取走
+};
+
+// 每个登记的线程一个; frames 由信号处理函数写, 采样线程在 kCaptured 后读
+struct Slot {
+    std::atomic<int> state{kIdle};
+    int sample_state = kWallOther; // 采样线程: 发信号前读到的线程状态
+    int stat_fd = -1;              // 采样线程: /proc/self/task/<tid>/stat, 第一次采样时打开, 之后复用
+    size_t nframes = 0;
+    void* frames[kMaxFrames] = {};
+    pid_t tid;
+
+    Slot() : tid(static_cast<pid_t>(syscall(SYS_gettid))) {}
+
+    Slot(const Slot&) = delete;
+    Slot& operator=(const Slot&) = delete;
+
+    ~Slot() {
+        if (stat_fd >= 0) close(stat_fd);
+    }
+};
+
+inline Slot*& current_slot() {
+    static thread_local Slot* slot = nullptr;
+    return slot;
+}
+
+struct Registry {
+    std::mutex mu;
+    std::vector<Slot*> slots;
+
+    Registry() : mu(), slots() {}
+};
+
+inline Registry& registry() {
+    static Registry* r = new Registry(); // 不析构: 线程退出可能晚于静态对象析构
+    return *r;
+}
+
+// 线程退出时注销槽位: 先清空线程局部指针 (信号处理函数据此忽略), 再释放
+struct SlotOwner {
+    Slot* slot;
+
+    SlotOwner() : slot(new Slot()) {
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mu);
+        r.slots.push_back(slot);
+    }
+
+    SlotOwner(const SlotOwner&) = delete;
+    SlotOwner& operator=(const SlotOwner&) = delete;
+
+    ~SlotOwner() {
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mu);
+        current_slot() = nullptr;
+        r.slots.erase(std::find(r.slots.begin(), r.slots.end(), slot));
+        delete slot;
+    }
+};
+
+inline void on_signal(int, siginfo_t*, void*) {
+    Slot* slot = current_slot();
+    if (! slot || slot->state.load(std::memory_order_acquire) != kRequested) return;
+
+    int saved_errno = errno;
+    int n = backtrace(slot->frames, static_cast<int>(kMaxFrames));
+    slot->nframes = n > 0 ? static_cast<size_t>(n) : 0;
+    slot->state.store(kCaptured, std::memory_order_release);
+    errno = saved_errno;
+}
+
+// 解析 stat 的第三个字段; comm 可能包含空格与括号, 以最后一个 ')' 为界
+inline int parse_stat_state(const char* buf, size_t len) {
+    const char* end = buf + len;
+    const char* paren = nullptr;
+    for (const char* p = buf; p < end; ++p) {
+        if (*p == ')') paren = p;
+    }
+    if (! paren || paren + 2 >= end) return -1;
+    switch (paren[2]) {
+        case 'R':
+            return kWallRunning;
+        case 'S':
+            return kWallSleeping;
+        case 'D':
+            return kWallDiskWait;
+        default:
+            return kWallOther;
+    }
+}
+
+// 读取线程状态, 线程已经退出时返回 -1; procfs 的 stat 每次从偏移 0 读取时重新生成, fd 可以一直复用
+inline int read_thread_state(Slot& slot) {
+    if (slot.stat_fd < 0) {
+        char path[64];
+        snprintf(path, sizeof(path), "/proc/self/task/%d/stat", static_cast<int>(slot.tid));
+        slot.stat_fd = open(path, O_RDONLY | O_CLOEXEC);
+        if (slot.stat_fd < 0) return -1;
+    }
+    char buf[512];
+    ssize_t n = pread(slot.stat_fd, buf, sizeof(buf), 0);
+    if (n <= 0) return -1;
+    return parse_stat_state(buf, static_cast<size_t>(n));
+}
+
+inline uint64_t hash_frames(void* const* frames, size_t n) {
+    uint64_t h = 0xcbf29ce484222325ull;
+    for (size_t i = 0; i < n; ++i) {
+        h = (h ^ reinterpret_cast<uintptr_t>(frames[i])) * 0x100000001b3ull;
+        h ^= h >> 29;
+    }
+    return h;
+}
+
+// 一条栈及其在各线程状态下的样本数
+struct Aggregated {
+    uint64_t state_samples[4];
+    std::vector<void*> frames;
+
+    uint64_t samples() const {
+        return state_samples[0] + state_samples[1] + state_samples[2] + state_samples[3];
+    }
+};
+
+// 按完整的栈 (含栈顶 pc) 聚合; 哈希只用于分桶, 哈希相同而帧不同的栈各占一项
+class StackTable {
+  public:
+    StackTable() : stacks_() {}
+
+    // 计入一个样本; 已有 max_unique 个不同的栈且这是新栈时丢弃并返回 false
+    bool add(std::vector<void*>&& frames, int state, size_t max_unique) {
+        uint64_t h = hash_frames(frames.data(), frames.size());
+        auto range = stacks_.equal_range(h);
+        for (auto it = range.first; it != range.second; ++it) {
+            if (it->second.frames == frames) {
+                it->second.state_samples[state]++;
+                return true;
+            }
+        }
+        if (stacks_.size() >= max_unique) return false;
+        auto it = stacks_.emplace(h, Aggregated{{0, 0, 0, 0}, std::move(frames)});
+        it->second.state_samples[state]++;
+        return true;
+    }
+
+    size_t size() const {
+        return stacks_.size();
+    }
+
+    void clear() {
+        stacks_.clear();
+    }
+
+    std::vector<Aggregated> snapshot() const {
+        std::vector<Aggregated> out;
+        out.reserve(stacks_.size());
+        for (const auto& e : stacks_) {
+            out.push_back(e.second);
+        }
+        return out;
+    }
+
+  private:
+    std::unordered_multimap<uint64_t, Aggregated> stacks_;
+};
+
+} // namespace wallclock
+
+class WallClockProfiler {
+  public:
+    // 安装信号处理函数并启动采样线程; 已经启动时返回 false
+    static bool start(const WallClockOptions& options = WallClockOptions()) {
+        return instance().do_start(options);
+    }
+
+    static void stop() {
+        instance().do_stop();
+    }
+
+    // 登记调用线程, 之后每个采样间隔都会采样它; 重复调用无副作用, 线程退出时自动注销
+    static void register_thread() {
+        static thread_local wallclock::SlotOwner owner;
+        wallclock::current_slot() = owner.slot;
+    }
+
+    static WallClockStats stats() {
+        WallClockProfiler& p = instance();
+        WallClockStats st;
+        {
+            std::lock_guard<std::mutex> lock(p.mu_);
+            st = p.stats_;
+        }
+        wallclock::Registry& r = wallclock::registry();
+        std::lock_guard<std::mutex> lock(r.mu);
+        st.threads = r.slots.size();
+        return st;
+    }
+
+    // 清空已聚合的样本, 例如每个报告周期开始时
+    static void reset() {
+        WallClockProfiler& p = instance();
+        std::lock_guard<std::mutex> lock(p.mu_);
+        p.stacks_.clear();
+    }
+
+    // 所有栈及其 on-CPU / off-CPU 时间, 按总时间降序; 在调用线程中符号化, 相同的地址只解析一次
+    static std::vector<WallClockStack> summary() {
+        std::vector<Aggregated> stacks = instance().snapshot();
+        std::sort(stacks.begin(), stacks.end(), [](const Aggregated& a, const Aggregated& b) { return a.samples() > b.samples(); });
+
+        uint64_t interval_ns = instance().interval_ns();
+        Modules mods;
+        ModuleManager::load_modules(mods, getpid());
+        std::unordered_map<void*, ResolvedFrame> resolved;
+        std::vector<WallClockStack> out;
+        out.reserve(stacks.size());
+        for (const auto& a : stacks) {
+            WallClockStack s{a.state_samples[kWallRunning] * interval_ns, (a.samples() - a.state_samples[kWallRunning]) * interval_ns,
+                             a.samples(), {a.state_samples[0], a.state_samples[1], a.state_samples[2], a.state_samples[3]}, {}};
+            for (size_t i = 0; i < a.frames.size(); ++i) {
+                auto it = resolved.find(a.frames[i]);
+                if (it == resolved.end()) it = resolved.emplace(a.frames[i], resolve_with_modules(a.frames[i], mods)).first;
+                s.frames.push_back(it->second);
+                s.frames.back().index = i;
+            }
+            out.push_back(std::move(s));
+        }
+        return out;
+    }
+
+    // on_cpu 为 true 时只含 R 状态的样本, 否则只含其他状态的; 权重为纳秒
+    static CallTree tree(bool on_cpu) {
+        uint64_t interval_ns = instance().interval_ns();
+        CallTree t(on_cpu ? "on_cpu" : "off_cpu", "nanoseconds");
+        for (const auto& a : instance().snapshot()) {
+            uint64_t running = a.state_samples[kWallRunning];
+            uint64_t n = on_cpu ? running : a.samples() - running;
+            for (uint64_t i = 0; i < n; ++i) {
+                t.add(a.frames, interval_ns);
+            }
+        }
+        return t;
+    }
+
+    // folded stacks, 每行以 on-cpu 或 off-cpu 为根, 值为纳秒; 可直接交给 flamegraph.pl
+    static void write_folded(std::ostream& os) {
+        for (bool on_cpu : {true, false}) {
+            std::ostringstream folded;
+            tree(on_cpu).write_folded(folded);
+            std::istringstream lines(folded.str());
+            std::string line;
+            while (std::getline(lines, line)) {
+                os << (on_cpu ? "on-cpu;" : "off-cpu;") << line << '\n';
+            }
+        }
+    }
+
+  private:
+    using Aggregated = wallclock::Aggregated;
+
+    struct Sample {
+        int state;
+        std::vector<void*> frames;
+    };
+
+    WallClockOptions options_;
+    std::atomic<bool> running_;
+    std::thread sampler_;
+
+    std::mutex mu_; // 保护以下成员
+    wallclock::StackTable stacks_;
+    WallClockStats stats_;
+
+    WallClockProfiler() : options_(), running_(false), sampler_(), mu_(), stacks_(), stats_() {}
+
+    static WallClockProfiler& instance() {
+        static WallClockProfiler* p = new WallClockProfiler(); // 不析构, 由使用者显式 stop()
+        return *p;
+    }
+
+    uint64_t interval_ns() {
+        std::lock_guard<std::mutex> lock(mu_);
+        return static_cast<uint64_t>(options_.interval_us) * 1000;
+    }
+
+    std::vector<Aggregated> snapshot() {
+        std::lock_guard<std::mutex> lock(mu_);
+        return stacks_.snapshot();
+    }
+
+    bool do_start(const WallClockOptions& options) {
+        if (running_.exchange(true)) return false;
+        {
+            std::lock_guard<std::mutex> lock(mu_);
+            options_ = options;
+            if (options_.signal == 0) options_.signal = SIGRTMIN + 6;
+            if (options_.interval_us == 0) options_.interval_us = 10000;
+        }
+
+        // 首次调用 backtrace() 会加载 libgcc_s, 在信号处理函数中使用前先预热
+        void* warm[1];
+        backtrace(warm, 1);
+
+        struct sigaction sa;
+        memset(&sa, 0, sizeof(sa));
+        sa.sa_sigaction = wallclock::on_signal;
+        sa.sa_flags = SA_SIGINFO | SA_RESTART;
+        sigemptyset(&sa.sa_mask);
+        sigaction(options_.signal, &sa, nullptr);
+
+        sampler_ = std::thread(&WallClockProfiler::sampler_loop, this);
+        return true;
+    }
+
+    void do_stop() {
+        if (! running_.exchange(false)) return;
+        sampler_.join();
+    }
+
+    // 每个周期先取走上个周期抓到的栈, 再读取各线程状态并发出新的信号
+    // 用绝对时间睡眠, 采样间隔不随每个周期的处理时间漂移
+    void sampler_loop() {
+        const pid_t pid = getpid();
+        std::vector<Sample> samples;
+        timespec next;
+        clock_gettime(CLOCK_MONOTONIC, &next);
+
+        while (running_.load(std::memory_order_relaxed)) {
+            next.tv_nsec += static_cast<long>(options_.interval_us) * 1000;
+            while (next.tv_nsec >= 1000000000L) {
+                next.tv_nsec -= 1000000000L;
+                ++next.tv_sec;
+            }
+            while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, nullptr) == EINTR) {
+            }
+
+            uint64_t signals = 0, missed = 0;
+            samples.clear();
+            {
+                wallclock::Registry& r = wallclock::registry();
+                std::lock_guard<std::mutex> lock(r.mu);
+                for (wallclock::Slot* slot : r.slots) {
+                    int state = slot->state.load(std::memory_order_acquire);
+                    if (state == wallclock::kCaptured) {
+                        if (slot->nframes > wallclock::kSkipFrames) {
+                            samples.push_back(Sample{slot->sample_state,
+                                                     std::vector<void*>(slot->frames + wallclock::kSkipFrames, slot->frames + slot->nframes)});
+                        }
+                    } else if (state == wallclock::kRequested) {
+                        ++missed;
+                    }
+                    slot->state.store(wallclock::kIdle, std::memory_order_relaxed);
+
+                    int thread_state = wallclock::read_thread_state(*slot);
+                    if (thread_state < 0) continue;
+                    slot->sample_state = thread_state;
+                    slot->state.store(wallclock::kRequested, std::memory_order_release);
+                    if (syscall(SYS_tgkill, pid, slot->tid, options_.signal) != 0) {
+                        slot->state.store(wallclock::kIdle, std::memory_order_relaxed);
+                        continue;
+                    }
+                    ++signals;
+                }
+            }
+
+            std::lock_guard<std::mutex> lock(mu_);
+            stats_.ticks++;
+            stats_.signals += signals;
+            stats_.missed += missed;
+            for (auto& s : samples) {
+                admit(std::move(s));
+            }
+        }
+    }
+
+    // 调用方持有 mu_
+    void admit(Sample&& s) {
+        stats_.samples++;
+        (s.state == kWallRunning ? stats_.on_cpu : stats_.off_cpu)++;
+        if (! stacks_.add(std::move(s.frames), s.state, options_.max_unique_stacks)) stats_.dropped++;
+    }
+};
+
+} // namespace stacktrace
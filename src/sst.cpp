@@ -1,13 +1,39 @@
 #include "sst.h"
+#include "sst_symd_proto.h"
+// libsst 同时提供 SST_COMPILED 模式下 sst_fwd.hpp 所声明函数的唯一定义
+#define SST_IMPLEMENTATION
 #include "../include/sst.hpp"
+#include "../include/sst_demangle.hpp"
+#include "../include/sst_async.hpp"
+#include "../include/sst_fiber.hpp"
+#include "../include/sst_record.hpp"
 
 #include <cstdio>
 #include <cstring>
+#include <deque>
+#include <unordered_map>
 #include <vector>
 
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
 // this .cpp would compile to .so/.a, so `using namespace` is ok
 using namespace stacktrace;
 
+/// 帮助函数：拷贝字符串到定长缓冲区，超长时尾部加 "..."
+static void copy_truncated(char* dst, size_t cap, const char* src, size_t len) {
+    if (len >= cap - 4) {
+        snprintf(dst, cap, "%.*s...", static_cast<int>(cap - 4 - 1), src);
+    } else {
+        snprintf(dst, cap, "%.*s", static_cast<int>(len), src);
+    }
+}
+
+static void copy_truncated(char* dst, size_t cap, const std::string& src) {
+    copy_truncated(dst, cap, src.c_str(), src.size());
+}
+
 /// 帮助函数：安全填充 sst_frame
 static void fill_frame_info(const ResolvedFrame& src, sst_frame* dst) {
     dst->index = src.index;
@@ -15,39 +41,27 @@ static void fill_frame_info(const ResolvedFrame& src, sst_frame* dst) {
     dst->offset = src.offset;
     dst->has_symbol = src.has_symbol;
 
-    // 拷贝函数名，尾部可能加 "..."
-    if (src.function.size() >= SST_SYMBOL_NAME_LEN - 4) {
-        snprintf(dst->function,
-                 SST_SYMBOL_NAME_LEN,
-                 "%.*s...",
-                 static_cast<int>(SST_SYMBOL_NAME_LEN - 4 - 1),
-                 src.function.c_str());
-    } else {
-        snprintf(dst->function, SST_SYMBOL_NAME_LEN, "%s", src.function.c_str());
-    }
-
-    // 拷贝模块名，尾部可能加 "..."
-    if (src.module.size() >= SST_MODULE_NAME_LEN - 4) {
-        snprintf(dst->module,
-                 SST_MODULE_NAME_LEN,
-                 "%.*s...",
-                 static_cast<int>(SST_MODULE_NAME_LEN - 4 - 1),
-                 src.module.c_str());
-    } else {
-        snprintf(dst->module, SST_MODULE_NAME_LEN, "%s", src.module.c_str());
-    }
+    copy_truncated(dst->function, SST_SYMBOL_NAME_LEN, src.function);
+    copy_truncated(dst->module, SST_MODULE_NAME_LEN, src.module);
 }
 
 void sst_capture(sst_backtrace* out) {
     if (! out) return;
 
     Stacktrace st = Stacktrace::capture(SST_MAX_FRAMES);
-    const auto& frames = st.get_frames();
 
-    out->size = std::min(frames.size(), static_cast<size_t>(SST_MAX_FRAMES));
-    for (size_t i = 0; i < out->size; ++i) {
-        fill_frame_info(frames[i], &out->frames[i]);
-    }
+    // 走 FrameView 直接拷贝到定长数组, 符号已加载时不产生任何堆分配
+    out->size = 0;
+    st.for_each_frame([out](const FrameView& v) {
+        if (out->size >= SST_MAX_FRAMES) return;
+        sst_frame* dst = &out->frames[out->size++];
+        dst->index = v.index;
+        dst->abs_addr = v.abs_addr;
+        dst->offset = v.offset;
+        dst->has_symbol = v.has_symbol;
+        copy_truncated(dst->function, SST_SYMBOL_NAME_LEN, v.function, v.function_len);
+        copy_truncated(dst->module, SST_MODULE_NAME_LEN, v.module, v.module_len);
+    });
 }
 
 void sst_resolve(void* addr, sst_frame* out) {
@@ -61,6 +75,59 @@ void sst_clear_modules_cache() {
     Stacktrace::clear_modules_cache();
 }
 
+void sst_set_symbol_memory_budget(size_t bytes) {
+    Stacktrace::set_symbol_memory_budget(bytes);
+}
+
+void sst_get_symbol_memory_stats(sst_symbol_memory_stats* out) {
+    if (! out) return;
+
+    SymbolMemoryStats st = Stacktrace::symbol_memory_stats();
+    out->footprint = st.footprint;
+    out->budget = st.budget;
+    out->resident_modules = st.resident_modules;
+    out->evictions = st.evictions;
+    out->reloads = st.reloads;
+}
+
+size_t sst_demangle(const char* mangled, char* buf, size_t cap, int simplified) {
+    return demangle_into(mangled, buf, cap, simplified ? DemangleStyle::Simplified : DemangleStyle::Full);
+}
+
+void sst_set_demangle_style(int simplified) {
+    Stacktrace::set_demangle_style(simplified ? DemangleStyle::Simplified : DemangleStyle::Full);
+}
+
+int sst_fiber_register(const void* stack, size_t size, const char* name) {
+    return FiberRegistry::instance().add(stack, size, name);
+}
+
+void sst_fiber_unregister(int handle) {
+    FiberRegistry::instance().remove(handle);
+}
+
+void sst_fiber_park(int handle, uintptr_t pc, uintptr_t sp, uintptr_t fp) {
+    FiberRegistry::instance().park(handle, FiberContext{pc, sp, fp});
+}
+
+void sst_fiber_park_ucontext(int handle, const struct ucontext_t* uc) {
+    FiberRegistry::instance().park(handle, *uc);
+}
+
+void sst_fiber_resume(int handle) {
+    FiberRegistry::instance().resume(handle);
+}
+
+size_t sst_fiber_dump(FILE* file) {
+    if (! file) return 0;
+    std::vector<FiberTrace> traces = FiberRegistry::instance().dump_parked(SST_MAX_FRAMES);
+    for (const auto& t : traces) {
+        fprintf(file, "fiber #%d%s%s%s:\n", t.handle, t.name.empty() ? "" : " (", t.name.c_str(), t.name.empty() ? "" : ")");
+        for (const auto& f : t.frames) fputs(f.to_string().c_str(), file);
+    }
+    return traces.size();
+}
+
 void sst_print(const sst_backtrace* trace, FILE* file) {
     if (! trace || ! file) return;
 
@@ -156,6 +223,304 @@ void sst_resolve_raw_batch_on_pid(pid_t target_pid, void** addrs, size_t count,
     }
 }
 
+size_t sst_find_symbols(const char* pattern, sst_name_match mode, sst_symbol_range* outs, size_t capacity) {
+    if (! pattern) return 0;
+
+    std::vector<SymbolRange> ranges = Stacktrace::find_symbols(pattern, static_cast<NameMatch>(mode));
+    if (outs) {
+        size_t n = std::min(ranges.size(), capacity);
+        for (size_t i = 0; i < n; ++i) {
+            outs[i].start = ranges[i].start;
+            outs[i].end = ranges[i].end;
+            copy_truncated(outs[i].function, SST_SYMBOL_NAME_LEN, ranges[i].name);
+            copy_truncated(outs[i].module, SST_MODULE_NAME_LEN, ranges[i].module);
+        }
+    }
+    return ranges.size();
+}
+
+struct sst_symd {
+    int fd;
+    std::unordered_map<std::string, std::string> build_ids; // 模块路径 -> build-id, 每个路径只读一次文件
+    std::string request;
+    std::string response;
+};
+
+sst_symd* sst_symd_connect(const char* socket_path) {
+    const char* path = socket_path ? socket_path : SST_SYMD_DEFAULT_SOCKET;
+
+    sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    size_t len = strlen(path);
+    if (len >= sizeof(addr.sun_path)) return nullptr;
+    memcpy(addr.sun_path, path, len + 1);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) return nullptr;
+    if (connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        close(fd);
+        return nullptr;
+    }
+    return new sst_symd{fd, {}, {}, {}};
+}
+
+int sst_symd_resolve(sst_symd* conn, const sst_raw_frame* frames, size_t count, sst_frame* outs) {
+    if (! conn || ! frames || ! outs) return -1;
+    if (count == 0) return 0;
+
+    // 先收集本批次用到的模块, 帧里只引用模块表下标
+    std::vector<const char*> modules;
+    std::vector<uint16_t> frame_module(count, SST_SYMD_NO_MODULE);
+    std::unordered_map<std::string, uint16_t> module_index;
+    for (size_t i = 0; i < count; ++i) {
+        if (! frames[i].module || ! frames[i].module[0]) continue;
+        auto it = module_index.find(frames[i].module);
+        if (it == module_index.end()) {
+            if (modules.size() >= SST_SYMD_NO_MODULE) continue;
+            it = module_index.emplace(frames[i].module, static_cast<uint16_t>(modules.size())).first;
+            modules.push_back(frames[i].module);
+        }
+        frame_module[i] = it->second;
+    }
+
+    std::string& req = conn->request;
+    req.clear();
+    symd::Writer w(req);
+    w.put<uint16_t>(static_cast<uint16_t>(modules.size()));
+    for (const char* m : modules) {
+        auto it = conn->build_ids.find(m);
+        if (it == conn->build_ids.end()) {
+            it = conn->build_ids.emplace(m, read_build_id(m)).first;
+        }
+        size_t path_len = std::min<size_t>(strlen(m), 0xffff);
+        size_t id_len = std::min<size_t>(it->second.size(), 0xff);
+        w.put<uint16_t>(static_cast<uint16_t>(path_len));
+        w.put<uint8_t>(static_cast<uint8_t>(id_len));
+        w.put_bytes(m, path_len);
+        w.put_bytes(it->second.data(), id_len);
+    }
+    for (size_t i = 0; i < count; ++i) {
+        w.put<uint16_t>(frame_module[i]);
+        w.put<uint64_t>(frames[i].offset);
+    }
+
+    sst_symd_header hdr;
+    if (! symd::send_message(conn->fd, SST_SYMD_RESOLVE, static_cast<uint32_t>(count), req) ||
+        ! symd::recv_message(conn->fd, hdr, conn->response) || hdr.type != SST_SYMD_RESULT || hdr.count != count) {
+        return -1;
+    }
+
+    symd::Reader in(conn->response.data(), conn->response.size());
+    std::string name;
+    for (size_t i = 0; i < count; ++i) {
+        uint8_t status = 0;
+        uint64_t sym_offset = 0;
+        uint16_t name_len = 0;
+        if (! in.get(status) || ! in.get(sym_offset) || ! in.get(name_len) || ! in.get_bytes(name, name_len)) {
+            return -1;
+        }
+
+        sst_frame* out = &outs[i];
+        out->index = i;
+        out->abs_addr = frames[i].abs_addr;
+        // SST_SYMD_BAD_MODULE 与找不到符号一样, 原样返回模块内偏移
+        bool has_symbol = status == SST_SYMD_FOUND;
+        out->offset = has_symbol ? static_cast<uintptr_t>(sym_offset) : frames[i].offset;
+        out->has_symbol = has_symbol;
+        copy_truncated(out->function, SST_SYMBOL_NAME_LEN, name);
+        const char* m = frames[i].module ? frames[i].module : "";
+        copy_truncated(out->module, SST_MODULE_NAME_LEN, m, strlen(m));
+    }
+    return 0;
+}
+
+void sst_symd_close(sst_symd* conn) {
+    if (! conn) return;
+    close(conn->fd);
+    delete conn;
+}
+
+struct sst_record_writer {
+    StackRecordWriter writer;
+    std::vector<RawFrame> frames; // 复用, 避免每次编码重新分配模块路径
+};
+
+sst_record_writer* sst_record_writer_new(void) {
+    return new sst_record_writer{StackRecordWriter(), {}};
+}
+
+uint64_t sst_record_write(sst_record_writer* w, const sst_raw_frame* frames, size_t count) {
+    if (! w || (! frames && count > 0)) return 0;
+
+    w->frames.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        RawFrame& f = w->frames[i];
+        f.abs_addr = frames[i].abs_addr;
+        f.offset = frames[i].offset;
+        f.has_symbol = frames[i].has_symbol != 0;
+        if (frames[i].module) {
+            f.module.assign(frames[i].module);
+        } else {
+            f.module.clear();
+        }
+    }
+    return w->writer.write(w->frames.data(), count);
+}
+
+const void* sst_record_writer_data(const sst_record_writer* w, size_t* size) {
+    if (! w) return nullptr;
+    if (size) *size = w->writer.size();
+    return w->writer.data();
+}
+
+void sst_record_writer_consume(sst_record_writer* w) {
+    if (w) w->writer.consume();
+}
+
+void sst_record_writer_free(sst_record_writer* w) {
+    delete w;
+}
+
+struct sst_record_reader {
+    StackRecordReader reader;
+    std::vector<RawFrame> frames;
+};
+
+sst_record_reader* sst_record_reader_new(void) {
+    return new sst_record_reader{StackRecordReader(), {}};
+}
+
+void sst_record_feed(sst_record_reader* r, const void* data, size_t size) {
+    if (! r || ! data) return;
+    r->reader.feed(static_cast<const char*>(data), size);
+}
+
+int sst_record_next(sst_record_reader* r, sst_raw_frame* outs, size_t capacity, size_t* count, uint64_t* fingerprint) {
+    if (! r) return -1;
+
+    uint64_t fp = 0;
+    int status = r->reader.next(r->frames, fp);
+    if (status != StackRecordReader::kRecord) return status;
+
+    size_t n = outs ? std::min(capacity, r->frames.size()) : 0;
+    for (size_t i = 0; i < n; ++i) {
+        const RawFrame& f = r->frames[i];
+        outs[i].abs_addr = f.abs_addr;
+        outs[i].offset = f.offset;
+        outs[i].has_symbol = f.has_symbol;
+        outs[i].module = f.module.empty() ? nullptr : strdup(f.module.c_str()); // 必须由调用方负责释放
+    }
+    if (count) *count = n;
+    if (fingerprint) *fingerprint = fp;
+    return status;
+}
+
+void sst_record_reader_free(sst_record_reader* r) {
+    delete r;
+}
+
+// 结果在后台线程中转为 C 结构体排队, 由 sst_async_poll 按完成顺序取走
+struct sst_async {
+    struct Completed {
+        uint64_t ticket;
+        sst_async_status status;
+        sst_backtrace trace;
+    };
+
+    std::atomic<uint64_t> next_ticket;
+    sst_async_overflow overflow;
+    size_t capacity;
+    std::mutex mu; // 保护 completed 与 expired
+    std::deque<Completed> completed;
+    uint64_t expired;
+    AsyncResolver resolver; // 最后声明, 最先析构: 先停止后台线程, 回调不会访问已析构的成员
+
+    sst_async(const AsyncResolverOptions& options, sst_async_overflow policy)
+        : next_ticket(1), overflow(policy), capacity(0), mu(), completed(), expired(0), resolver(options) {
+        capacity = resolver.stats().capacity;
+    }
+
+    void complete(uint64_t ticket, const AsyncResult& r) {
+        if (r.status == AsyncStatus::Dropped) return;
+        std::lock_guard<std::mutex> lock(mu);
+        if (completed.size() >= capacity) {
+            completed.pop_front(); // 未及时取回, 丢弃最旧的
+            ++expired;
+        }
+        completed.emplace_back();
+        Completed& c = completed.back();
+        c.ticket = ticket;
+        c.status = r.status == AsyncStatus::Resolved ? SST_ASYNC_RESOLVED : SST_ASYNC_RAW_ADDRESSES;
+        c.trace.size = std::min<size_t>(r.frames.size(), SST_MAX_FRAMES);
+        for (size_t i = 0; i < c.trace.size; ++i) {
+            fill_frame_info(r.frames[i], &c.trace.frames[i]);
+        }
+    }
+};
+
+sst_async* sst_async_new(size_t capacity, sst_async_overflow overflow) {
+    AsyncResolverOptions options;
+    if (capacity > 0) options.capacity = capacity;
+    switch (overflow) {
+        case SST_ASYNC_BLOCK: options.overflow = AsyncOverflow::Block; break;
+        case SST_ASYNC_RAW: options.overflow = AsyncOverflow::RawAddresses; break;
+        default: options.overflow = AsyncOverflow::Drop; break;
+    }
+    return new sst_async(options, overflow);
+}
+
+uint64_t sst_async_submit(sst_async* q) {
+    if (! q) return 0;
+    Stacktrace st = Stacktrace::capture(SST_MAX_FRAMES);
+    return sst_async_submit_addrs(q, st.addresses(), st.size());
+}
+
+uint64_t sst_async_submit_addrs(sst_async* q, void* const* addrs, size_t count) {
+    if (! q || (! addrs && count > 0)) return 0;
+
+    uint64_t ticket = q->next_ticket.fetch_add(1, std::memory_order_relaxed);
+    bool queued = q->resolver.submit(addrs, std::min<size_t>(count, SST_MAX_FRAMES), [q, ticket](const AsyncResult& r) {
+        q->complete(ticket, r);
+    });
+    // 队列满且降级为只含地址时, 结果已在本线程中放入完成队列
+    return queued || q->overflow == SST_ASYNC_RAW ? ticket : 0;
+}
+
+int sst_async_poll(sst_async* q, uint64_t* ticket, sst_async_status* status, sst_backtrace* out) {
+    if (! q || ! out) return 0;
+
+    std::lock_guard<std::mutex> lock(q->mu);
+    if (q->completed.empty()) return 0;
+    const sst_async::Completed& c = q->completed.front();
+    if (ticket) *ticket = c.ticket;
+    if (status) *status = c.status;
+    out->size = c.trace.size;
+    memcpy(out->frames, c.trace.frames, c.trace.size * sizeof(sst_frame));
+    q->completed.pop_front();
+    return 1;
+}
+
+void sst_async_flush(sst_async* q) {
+    if (q) q->resolver.flush();
+}
+
+void sst_async_get_stats(sst_async* q, sst_async_stats* out) {
+    if (! q || ! out) return;
+
+    AsyncResolverStats st = q->resolver.stats();
+    std::lock_guard<std::mutex> lock(q->mu);
+    out->submitted = st.submitted;
+    out->resolved = st.delivered;
+    out->dropped = st.dropped + q->expired;
+    out->degraded = st.degraded;
+    out->pending = q->completed.size();
+}
+
+void sst_async_free(sst_async* q) {
+    delete q;
+}
+
 void sst_free_raw_frames(sst_raw_frame* frames, size_t count) {
     if (! frames || count == 0) return;
 
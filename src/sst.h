@@ -40,6 +40,31 @@ typedef struct sst_raw_frame {
     char* module;       ///< 模块名，C 字符串
 } sst_raw_frame;
 
+/// 按名字反查的匹配方式
+typedef enum sst_name_match {
+    SST_MATCH_MANGLED = 0,   ///< mangled 名精确匹配
+    SST_MATCH_DEMANGLED = 1, ///< demangled 名精确匹配
+    SST_MATCH_PREFIX = 2,    ///< demangled 名前缀匹配
+    SST_MATCH_GLOB = 3,      ///< demangled 名 glob 匹配，例如 "ns::net::*"
+} sst_name_match;
+
+/// 一个函数符号所占的地址区间 [start, end)
+typedef struct sst_symbol_range {
+    uintptr_t start;                    ///< 起始地址（含）
+    uintptr_t end;                      ///< 结束地址（不含）
+    char function[SST_SYMBOL_NAME_LEN]; ///< mangled 函数名，可能被截断为 "..."
+    char module[SST_MODULE_NAME_LEN];   ///< 模块路径，可能被截断
+} sst_symbol_range;
+
+/// 已加载符号数据的内存统计
+typedef struct sst_symbol_memory_stats {
+    size_t footprint;        ///< 当前已加载符号数据的估算字节数
+    size_t budget;           ///< 预算，0 表示不限制
+    size_t resident_modules; ///< 当前已加载符号表的模块数
+    uint64_t evictions;      ///< 因超出预算被释放的次数
+    uint64_t reloads;        ///< 被释放后再次加载的次数
+} sst_symbol_memory_stats;
+
 /// 栈回溯结构体，包含若干帧
 typedef struct sst_backtrace {
     sst_frame frames[SST_MAX_FRAMES]; ///< 栈帧数组
@@ -65,6 +90,83 @@ void sst_resolve(void* addr, sst_frame* out);
  */
 void sst_clear_modules_cache();
 
+/**
+ * @brief 设置已加载符号数据的全局内存预算
+ * @param bytes 预算（字节），0 表示不限制（默认）
+ * @note 超出预算时最久未使用的模块的符号表会被释放，下次解析到该模块时自动重新加载
+ */
+void sst_set_symbol_memory_budget(size_t bytes);
+
+/**
+ * @brief 读取符号内存统计
+ * @param out [out] 结果
+ */
+void sst_get_symbol_memory_stats(sst_symbol_memory_stats* out);
+
+/**
+ * @brief 把 _Z 开头的符号名 demangle 到 buf，不分配内存，可在信号处理函数中调用
+ *
+ * 解析与打印都在调用方的栈上进行，嵌套很深的符号最多用掉约 100KB 栈；在信号处理函数中调用时，
+ * 所在的栈（包括 sigaltstack 设置的备用栈）至少要留出 128KB
+ * @param simplified 非 0 时折叠模板实参与参数列表，例如 ns::Foo<...>::bar(...)
+ * @return 写入的长度（不含 '\0'）；结果被截断时以 "..." 结尾并返回 cap；不是合法的符号名或不支持时返回 0
+ */
+size_t sst_demangle(const char* mangled, char* buf, size_t cap, int simplified);
+
+/**
+ * @brief 设置解析结果中函数名的风格
+ * @param simplified 0 为完整名字（默认），非 0 为简化名字
+ * @note 切换时清空已加载的模块缓存；sst_find_symbols 不受影响
+ */
+void sst_set_demangle_style(int simplified);
+
+/**
+ * @brief 登记一个用户态协程的栈，供 sst_fiber_dump 回溯挂起的协程
+ * @param stack 栈内存的最低地址
+ * @param size 栈大小（字节）
+ * @param name 协程名，可为 NULL，超过 31 字节时截断
+ * @return 句柄；登记数已满时返回 -1
+ * @note 必须在释放栈内存之前调用 sst_fiber_unregister；协程代码须以 -fno-omit-frame-pointer 编译
+ */
+int sst_fiber_register(const void* stack, size_t size, const char* name);
+
+/**
+ * @brief 注销协程，返回后其栈不会再被读取
+ * @param handle sst_fiber_register 返回的句柄
+ */
+void sst_fiber_unregister(int handle);
+
+/**
+ * @brief 协程已切出，记录切换完成后保存的寄存器（只写几个原子变量，不加锁）
+ * @param handle 协程句柄
+ * @param pc 恢复执行的地址
+ * @param sp 栈指针
+ * @param fp 帧指针（x86_64 的 rbp / aarch64 的 x29）
+ */
+void sst_fiber_park(int handle, uintptr_t pc, uintptr_t sp, uintptr_t fp);
+
+struct ucontext_t;
+
+/**
+ * @brief 同 sst_fiber_park，寄存器取自 swapcontext / getcontext 保存的 ucontext_t
+ * @param handle 协程句柄
+ * @param uc 保存的上下文
+ */
+void sst_fiber_park_ucontext(int handle, const struct ucontext_t* uc);
+
+/**
+ * @brief 协程即将恢复执行
+ * @param handle 协程句柄
+ */
+void sst_fiber_resume(int handle);
+
+/**
+ * @brief 回溯所有挂起的协程并打印到文件流，所有栈共用一次符号解析
+ * @param file 目标文件流
+ * @return 打印的协程个数
+ */
+size_t sst_fiber_dump(FILE* file);
+
 /**
  * @brief 打印栈信息到指定文件流
  * @param trace 栈结构体（来自 sst_capture）
@@ -119,6 +221,196 @@ void sst_resolve_raw_batch_on_pid(pid_t target_pid, void** addrs, size_t count,
  */
 void sst_resolve_batch_on_pid(pid_t target_pid, void** addrs, size_t count, sst_frame* outs);
 
+/**
+ * @brief 按名字反查当前进程中函数的地址区间
+ * @param pattern 函数名或模式，含义由 mode 决定
+ * @param mode 匹配方式
+ * @param outs [out] 输出数组，可为 NULL（此时仅统计个数）
+ * @param capacity outs 的元素个数
+ * @return 匹配到的总个数，可能大于 capacity（超出部分不写入）
+ */
+size_t sst_find_symbols(const char* pattern, sst_name_match mode, sst_symbol_range* outs, size_t capacity);
+
+/// sst-symbolized 守护进程的客户端连接（不透明类型），同一连接不可被多个线程同时使用
+typedef struct sst_symd sst_symd;
+
+/**
+ * @brief 连接本机的 sst-symbolized 守护进程
+ * @param socket_path Unix domain socket 路径，为 NULL 时使用 "/tmp/sst-symbolized.sock"
+ * @return 成功返回连接句柄，失败返回 NULL
+ */
+sst_symd* sst_symd_connect(const char* socket_path);
+
+/**
+ * @brief 将一批原始帧（来自 sst_resolve_raw_batch 等）交给守护进程符号化
+ * @param conn 连接句柄
+ * @param frames 原始帧数组，module 为 NULL 的帧视为未知模块
+ * @param count 帧个数
+ * @param outs [out] 输出数组，应至少具有 count 个元素空间；offset 为符号内偏移
+ * @return 成功返回 0，通信失败返回 -1（此时连接应被关闭）
+ * @note 客户端会读取模块的 GNU build-id 一并发送，守护进程以 build-id 为键缓存符号表
+ * @note 模块文件不存在、不是 ELF 文件或 build-id 不一致时，该模块的帧 has_symbol 为 0，offset 为原始偏移
+ */
+int sst_symd_resolve(sst_symd* conn, const sst_raw_frame* frames, size_t count, sst_frame* outs);
+
+/**
+ * @brief 关闭连接并释放句柄
+ * @param conn 连接句柄，可为 NULL
+ */
+void sst_symd_close(sst_symd* conn);
+
+/// 紧凑二进制栈记录的流式编码器（不透明类型），格式见 include/sst_record.hpp
+typedef struct sst_record_writer sst_record_writer;
+
+/// 紧凑二进制栈记录的流式解码器（不透明类型）
+typedef struct sst_record_reader sst_record_reader;
+
+/**
+ * @brief 创建编码器，编码结果以流头 "SSTR" 开始
+ * @return 编码器句柄，使用完毕后以 sst_record_writer_free 释放
+ */
+sst_record_writer* sst_record_writer_new(void);
+
+/**
+ * @brief 编码一条栈，追加到编码器的内部缓冲区
+ * @param w 编码器
+ * @param frames 原始帧数组（来自 sst_resolve_raw_batch 等）
+ * @param count 帧个数
+ * @return 栈指纹：由 (模块 build-id 或路径, 模块内偏移) 计算，不受 ASLR 影响
+ */
+uint64_t sst_record_write(sst_record_writer* w, const sst_raw_frame* frames, size_t count);
+
+/**
+ * @brief 取得尚未取走的编码数据
+ * @param w 编码器
+ * @param size [out] 数据长度
+ * @return 数据指针，在下一次 sst_record_write / sst_record_writer_consume 之前有效
+ */
+const void* sst_record_writer_data(const sst_record_writer* w, size_t* size);
+
+/**
+ * @brief 丢弃已取走的编码数据（模块表状态保留，后续数据属于同一条流）
+ * @param w 编码器
+ */
+void sst_record_writer_consume(sst_record_writer* w);
+
+/**
+ * @brief 释放编码器
+ * @param w 编码器，可为 NULL
+ */
+void sst_record_writer_free(sst_record_writer* w);
+
+/**
+ * @brief 创建解码器
+ * @return 解码器句柄，使用完毕后以 sst_record_reader_free 释放
+ */
+sst_record_reader* sst_record_reader_new(void);
+
+/**
+ * @brief 向解码器追加任意长度的数据
+ * @param r 解码器
+ * @param data 数据
+ * @param size 数据长度
+ */
+void sst_record_feed(sst_record_reader* r, const void* data, size_t size);
+
+/**
+ * @brief 取出下一条完整的栈记录
+ * @param r 解码器
+ * @param outs [out] 输出数组；已知模块的帧 abs_addr 为 0（编码时不保存加载基址）
+ * @param capacity outs 的元素个数，超出部分被丢弃
+ * @param count [out] 写入 outs 的帧个数
+ * @param fingerprint [out] 栈指纹，可为 NULL
+ * @return 1 表示取出了一条记录，0 表示需要继续 sst_record_feed，-1 表示数据损坏
+ * @note outs 中的 module 必须由调用方使用 sst_free_raw_frames 释放
+ */
+int sst_record_next(sst_record_reader* r, sst_raw_frame* outs, size_t capacity, size_t* count, uint64_t* fingerprint);
+
+/**
+ * @brief 释放解码器
+ * @param r 解码器，可为 NULL
+ */
+void sst_record_reader_free(sst_record_reader* r);
+
+/// 异步符号化队列（不透明类型）：请求线程只抓栈入队，后台线程批量解析，结果由 sst_async_poll 取回
+typedef struct sst_async sst_async;
+
+/// 队列满时的策略
+typedef enum sst_async_overflow {
+    SST_ASYNC_DROP = 0,  ///< 丢弃，sst_async_submit 返回 0
+    SST_ASYNC_BLOCK = 1, ///< 等待后台线程腾出空位
+    SST_ASYNC_RAW = 2,   ///< 立即产生只含地址的结果（状态为 SST_ASYNC_RAW_ADDRESSES）
+} sst_async_overflow;
+
+/// sst_async_poll 取回的结果状态
+typedef enum sst_async_status {
+    SST_ASYNC_RESOLVED = 0,      ///< 已解析
+    SST_ASYNC_RAW_ADDRESSES = 1, ///< 队列满，只有 abs_addr
+} sst_async_status;
+
+/// 异步符号化队列的统计
+typedef struct sst_async_stats {
+    uint64_t submitted; ///< 成功入队的栈数
+    uint64_t resolved;  ///< 后台线程已解析的栈数
+    uint64_t dropped;   ///< 队列满被丢弃，或结果未及时取回被丢弃的栈数
+    uint64_t degraded;  ///< 队列满，只给出地址的栈数
+    uint64_t pending;   ///< 已产生但尚未取回的结果数
+} sst_async_stats;
+
+/**
+ * @brief 创建异步符号化队列并启动后台线程
+ * @param capacity 队列容量（向上取整为 2 的幂），0 表示 1024；未取回的结果最多保留同样多个，超出时丢弃最旧的
+ * @param overflow 队列满时的策略
+ * @return 队列句柄，使用完毕后以 sst_async_free 释放
+ */
+sst_async* sst_async_new(size_t capacity, sst_async_overflow overflow);
+
+/**
+ * @brief 抓取当前线程的栈并入队，不做任何符号解析
+ * @param q 队列
+ * @return 非 0 的票号，结果以同一票号由 sst_async_poll 取回；被丢弃时返回 0
+ */
+uint64_t sst_async_submit(sst_async* q);
+
+/**
+ * @brief 将一组已抓取的地址入队
+ * @param q 队列
+ * @param addrs 地址数组（例如来自 backtrace）
+ * @param count 地址个数，超过 SST_MAX_FRAMES 的部分被截断
+ * @return 同 sst_async_submit
+ */
+uint64_t sst_async_submit_addrs(sst_async* q, void* const* addrs, size_t count);
+
+/**
+ * @brief 按完成顺序取回一个结果，不等待
+ * @param q 队列
+ * @param ticket [out] 票号，可为 NULL
+ * @param status [out] 结果状态，可为 NULL
+ * @param out [out] 解析后的栈
+ * @return 1 表示取回了一个结果，0 表示暂时没有
+ */
+int sst_async_poll(sst_async* q, uint64_t* ticket, sst_async_status* status, sst_backtrace* out);
+
+/**
+ * @brief 等待调用前已入队的栈全部解析完成，之后它们都可由 sst_async_poll 取回
+ * @param q 队列
+ */
+void sst_async_flush(sst_async* q);
+
+/**
+ * @brief 读取队列统计
+ * @param q 队列
+ * @param out [out] 结果
+ */
+void sst_async_get_stats(sst_async* q, sst_async_stats* out);
+
+/**
+ * @brief 解析完已入队的栈后停止后台线程并释放队列，未取回的结果一并丢弃
+ * @param q 队列，可为 NULL
+ * @note 调用时不能有其他线程正在 sst_async_submit
+ */
+void sst_async_free(sst_async* q);
+
 /**
  * @brief 批量释放一组 sst_raw_frame 中动态分配的模块名
  * 
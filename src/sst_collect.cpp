@@ -0,0 +1,165 @@
+// sst-collect: 共享内存栈事件通道 (sst_channel.hpp) 的参考消费者
+//
+// 业务进程用 StackChannelWriter 写入原始栈, 本程序读取通道, 只根据通道中的模块事件离线符号化,
+// 不读取业务进程的 /proc, 业务进程 dlclose 或退出之后写入的栈仍可解析
+//
+// 用法: sst-collect [-f] [-i poll_interval_ms] (-n shm_name | -p path)
+//   -n  按 shm_open 名字打开, 例如 /sst-myapp
+//   -p  按路径打开, 例如写端 memfd 的 /proc/<pid>/fd/<n>
+//   -f  不逐条输出, 退出 (SIGINT / SIGTERM) 时按 folded stacks 格式输出聚合结果
+
+#include "../include/sst_channel.hpp"
+
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+#include <unistd.h>
+
+using namespace stacktrace;
+
+namespace {
+
+volatile sig_atomic_t g_stop = 0;
+
+void on_signal(int) {
+    g_stop = 1;
+}
+
+void usage(const char* argv0) {
+    fprintf(stderr, "usage: %s [-f] [-i poll_interval_ms] (-n shm_name | -p path)\n", argv0);
+}
+
+class Collector {
+  public:
+    Collector(pid_t pid, bool folded) : sym_(pid), folded_(folded), names_(), stacks_(), count_(0), modules_(0) {}
+
+    void on_stack(const ChannelStack& s) {
+        ++count_;
+        if (folded_) {
+            std::string key;
+            for (size_t i = s.depth; i-- > 0;) {
+                key += name(s.addrs[i]);
+                if (i > 0) key += ';';
+            }
+            ++stacks_[key];
+            return;
+        }
+        printf("tid %d @ %llu.%09llu:\n",
+               static_cast<int>(s.tid),
+               static_cast<unsigned long long>(s.timestamp_ns / 1000000000ull),
+               static_cast<unsigned long long>(s.timestamp_ns % 1000000000ull));
+        for (size_t i = 0; i < s.depth; ++i) {
+            ResolvedFrame f = sym_.resolve(s.addrs[i]);
+            f.index = i;
+            fputs(f.to_string().c_str(), stdout);
+        }
+    }
+
+    void on_module(const ChannelModule& m) {
+        ++modules_;
+        sym_.on_module(m);
+        names_.clear(); // 地址区间可能被新的模块复用
+        fprintf(stderr,
+                "[sst-collect] %s %s base 0x%lx size 0x%zx build-id %s\n",
+                m.loaded ? "load" : "unload",
+                m.path.c_str(),
+                static_cast<unsigned long>(m.base),
+                m.size,
+                m.build_id.empty() ? "-" : build_id_to_hex(m.build_id).c_str());
+    }
+
+    void write_folded() const {
+        for (const auto& kv : stacks_) {
+            printf("%s %llu\n", kv.first.c_str(), static_cast<unsigned long long>(kv.second));
+        }
+    }
+
+    void report(const ChannelStats& st) const {
+        fprintf(stderr,
+                "[sst-collect] %llu stacks, %llu module events, %llu dropped by writer, %zu build-id mismatches\n",
+                static_cast<unsigned long long>(count_),
+                static_cast<unsigned long long>(modules_),
+                static_cast<unsigned long long>(st.dropped),
+                sym_.build_id_mismatches());
+    }
+
+  private:
+    ChannelSymbolizer sym_;
+    bool folded_;
+    std::unordered_map<uintptr_t, std::string> names_; // 地址 -> folded 中的帧名
+    std::map<std::string, uint64_t> stacks_;
+    uint64_t count_;
+    uint64_t modules_;
+
+    const std::string& name(uintptr_t addr) {
+        auto it = names_.find(addr);
+        if (it != names_.end()) return it->second;
+        ResolvedFrame f = sym_.resolve(addr);
+        std::string n;
+        if (f.has_symbol) {
+            n = f.function;
+        } else {
+            char buf[32];
+            snprintf(buf, sizeof(buf), "0x%lx", static_cast<unsigned long>(addr));
+            n = buf;
+        }
+        for (char& c : n) {
+            if (c == ';') c = ':'; // folded 格式的分隔符
+        }
+        return names_.emplace(addr, std::move(n)).first->second;
+    }
+};
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::string shm_name, path;
+    bool folded = false;
+    unsigned interval_ms = 10;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "n:p:fi:h")) != -1) {
+        switch (opt) {
+            case 'n': shm_name = optarg; break;
+            case 'p': path = optarg; break;
+            case 'f': folded = true; break;
+            case 'i': interval_ms = static_cast<unsigned>(strtoul(optarg, nullptr, 10)); break;
+            default: usage(argv[0]); return 1;
+        }
+    }
+    if (shm_name.empty() == path.empty()) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    StackChannelReader reader;
+    bool ok = shm_name.empty() ? reader.open_path(path.c_str()) : reader.open(shm_name.c_str());
+    if (! ok) {
+        fprintf(stderr, "[sst-collect] cannot open channel %s\n", shm_name.empty() ? path.c_str() : shm_name.c_str());
+        return 1;
+    }
+
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = on_signal;
+    sigaction(SIGINT, &sa, nullptr);
+    sigaction(SIGTERM, &sa, nullptr);
+
+    Collector collector(reader.pid(), folded);
+    fprintf(stderr, "[sst-collect] attached to pid %d\n", static_cast<int>(reader.pid()));
+    auto on_stack = [&](const ChannelStack& s) { collector.on_stack(s); };
+    auto on_module = [&](const ChannelModule& m) { collector.on_module(m); };
+    while (! g_stop) {
+        if (reader.poll(on_stack, on_module) == 0) std::this_thread::sleep_for(std::chrono::milliseconds(interval_ms));
+    }
+    reader.poll(on_stack, on_module);
+
+    if (folded) collector.write_folded();
+    collector.report(reader.stats());
+    return 0;
+}
@@ -0,0 +1,620 @@
+// sst_heap.cpp - 采样堆分析器, 编译为可 LD_PRELOAD 的 libsst_heap.so
+//
+// - 拦截 malloc/free/calloc/realloc/memalign/posix_memalign/aligned_alloc 与 operator new/delete
+// - 每个线程按泊松过程 (指数分布的字节间隔) 采样, 采到的分配用 Stacktrace::capture() 记录调用栈
+// - 存活的采样分配存放在分片加锁的哈希表中, free 时先查一个计数过滤器, 绝大多数 free 无需加锁
+// - 通过 sst_heap_dump() 或信号输出 folded / pprof(heap_v2) 文本
+
+#include "sst_heap.h"
+#include "../include/sst.hpp"
+
+#include <atomic>
+#include <cerrno>
+#include <cmath>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#include <semaphore.h>
+
+// glibc 内部分配函数, 绕过 PLT 直接调用真正的实现, 避免 dlsym(RTLD_NEXT) 自身分配内存导致递归
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t n, size_t size);
+void* __libc_realloc(void* ptr, size_t size);
+void* __libc_memalign(size_t alignment, size_t size);
+void __libc_free(void* ptr);
+}
+
+using namespace stacktrace;
+
+namespace {
+
+const size_t kShards = 64;            // 存活表分片数
+const size_t kBucketsPerShard = 1024; // 每个分片的桶数
+const size_t kMaxStacks = 16384;      // 去重栈表容量, 下标 0 保留给溢出项
+const size_t kFilterSize = 1 << 16;   // free 快速路径的计数过滤器大小
+const int64_t kRecheckBytes = int64_t(1) << 30; // 采样关闭时, 多久重新检查一次
+
+// 全部全局状态都是零初始化的 POD/atomic, 不依赖任何动态初始化 (malloc 可能先于构造函数被调用)
+struct SpinLock {
+    std::atomic<int> state;
+
+    void lock() {
+        while (state.exchange(1, std::memory_order_acquire) != 0) {
+            while (state.load(std::memory_order_relaxed) != 0) {
+                sched_yield();
+            }
+        }
+    }
+
+    void unlock() {
+        state.store(0, std::memory_order_release);
+    }
+};
+
+struct StackEntry {
+    uint64_t hash;
+    uint32_t depth;
+    bool used;
+    void* frames[Stacktrace::kMaxFrames];
+    // 原始采样值, 用于 heap_v2 (pprof 自行按采样间隔还原)
+    std::atomic<uint64_t> alloc_count;
+    std::atomic<uint64_t> alloc_bytes;
+    std::atomic<uint64_t> inuse_count;
+    std::atomic<uint64_t> inuse_bytes;
+    // 按采样概率还原后的估算值, 用于 folded 输出
+    std::atomic<uint64_t> est_alloc_bytes;
+    std::atomic<uint64_t> est_inuse_bytes;
+};
+
+struct LiveAlloc {
+    void* ptr;
+    size_t size;
+    uint64_t est_bytes;
+    uint32_t stack;
+    LiveAlloc* next;
+};
+
+struct Shard {
+    SpinLock lock;
+    LiveAlloc* buckets[kBucketsPerShard];
+};
+
+struct ThreadState {
+    int64_t bytes_until_sample;
+    uint64_t rng;
+    bool in_hook; // 正在采样/输出, 本线程的分配直接透传, 防止递归
+};
+
+StackEntry g_stacks[kMaxStacks];
+SpinLock g_stacks_lock;
+SpinLock g_dump_lock; // 信号触发的输出线程、sst_heap_dump() 与退出时的输出可能同时进行
+Shard g_shards[kShards];
+std::atomic<uint16_t> g_filter[kFilterSize];
+
+std::atomic<size_t> g_interval;
+std::atomic<bool> g_ready;
+std::atomic<uint64_t> g_sampled;
+std::atomic<uint64_t> g_live;
+std::atomic<uint64_t> g_unique_stacks;
+std::atomic<uint64_t> g_dropped;
+std::atomic<uint32_t> g_dump_seq;
+
+uintptr_t g_self_lo, g_self_hi; // 本库的地址范围, 记录栈时去掉位于本库内的栈顶帧
+const char* g_out_prefix;
+sem_t g_dump_sem;
+
+__thread ThreadState t_state __attribute__((tls_model("initial-exec")));
+
+inline uint64_t mix_ptr(const void* ptr) {
+    return static_cast<uint64_t>(reinterpret_cast<uintptr_t>(ptr)) * 0x9E3779B97F4A7C15ull;
+}
+
+inline std::atomic<uint16_t>& filter_slot(uint64_t h) {
+    return g_filter[(h >> 32) & (kFilterSize - 1)];
+}
+
+inline Shard& shard_of(uint64_t h) {
+    return g_shards[h >> 58];
+}
+
+inline LiveAlloc*& bucket_of(Shard& shard, uint64_t h) {
+    return shard.buckets[(h >> 40) & (kBucketsPerShard - 1)];
+}
+
+// 指数分布的下一个采样间隔, 均值为 interval
+int64_t next_sample_interval(ThreadState& ts, size_t interval) {
+    if (ts.rng == 0) {
+        ts.rng = mix_ptr(&ts) ^ static_cast<uint64_t>(gettid()) ^ 0x2545F4914F6CDD1Dull;
+    }
+    // xorshift64*
+    ts.rng ^= ts.rng >> 12;
+    ts.rng ^= ts.rng << 25;
+    ts.rng ^= ts.rng >> 27;
+    uint64_t r = ts.rng * 0x2545F4914F6CDD1Dull;
+    double u = (static_cast<double>(r >> 11) + 1.0) / 9007199254740993.0; // (0, 1]
+    double next = -std::log(u) * static_cast<double>(interval);
+    return static_cast<int64_t>(next) + 1;
+}
+
+uint32_t intern_stack(void* const* frames, size_t depth) {
+    uint64_t h = 1469598103934665603ull;
+    for (size_t i = 0; i < depth; ++i) {
+        h ^= reinterpret_cast<uintptr_t>(frames[i]);
+        h *= 1099511628211ull;
+    }
+    if (h == 0) h = 1;
+
+    g_stacks_lock.lock();
+    size_t idx = h % (kMaxStacks - 1) + 1;
+    for (size_t probe = 0; probe < kMaxStacks - 1; ++probe) {
+        StackEntry& e = g_stacks[idx];
+        if (! e.used) {
+            e.used = true;
+            e.hash = h;
+            e.depth = static_cast<uint32_t>(depth);
+            memcpy(e.frames, frames, depth * sizeof(void*));
+            g_stacks_lock.unlock();
+            g_unique_stacks.fetch_add(1, std::memory_order_relaxed);
+            return static_cast<uint32_t>(idx);
+        }
+        if (e.hash == h && e.depth == depth && memcmp(e.frames, frames, depth * sizeof(void*)) == 0) {
+            g_stacks_lock.unlock();
+            return static_cast<uint32_t>(idx);
+        }
+        idx = idx + 1 < kMaxStacks ? idx + 1 : 1;
+    }
+    g_stacks_lock.unlock();
+    g_dropped.fetch_add(1, std::memory_order_relaxed);
+    return 0;
+}
+
+void link_sample(LiveAlloc* node) {
+    uint64_t h = mix_ptr(node->ptr);
+    Shard& shard = shard_of(h);
+    shard.lock.lock();
+    LiveAlloc*& head = bucket_of(shard, h);
+    node->next = head;
+    head = node;
+    shard.lock.unlock();
+    filter_slot(h).fetch_add(1, std::memory_order_relaxed);
+}
+
+__attribute__((noinline)) void record_sample(void* ptr, size_t size) {
+    ThreadState& ts = t_state;
+    if (! g_ready.load(std::memory_order_acquire)) {
+        ts.bytes_until_sample = 0; // 初始化完成之前每次分配都重新检查
+        return;
+    }
+    size_t interval = g_interval.load(std::memory_order_relaxed);
+    if (ts.in_hook || interval == 0) {
+        ts.bytes_until_sample = interval == 0 ? kRecheckBytes : static_cast<int64_t>(interval);
+        return;
+    }
+
+    ts.in_hook = true;
+    ts.bytes_until_sample = next_sample_interval(ts, interval);
+
+    Stacktrace st = Stacktrace::capture();
+    void* const* frames = st.addresses();
+    size_t skip = 0;
+    while (skip < st.size() && reinterpret_cast<uintptr_t>(frames[skip]) >= g_self_lo
+           && reinterpret_cast<uintptr_t>(frames[skip]) < g_self_hi) {
+        ++skip;
+    }
+    uint32_t stack = intern_stack(frames + skip, st.size() - skip);
+
+    // 大小为 size 的分配被采中的概率为 1 - exp(-size / interval), 以其倒数作为还原权重
+    double scale = 1.0 / (1.0 - std::exp(-static_cast<double>(size) / static_cast<double>(interval)));
+    uint64_t est_bytes = static_cast<uint64_t>(static_cast<double>(size) * scale);
+
+    auto* node = static_cast<LiveAlloc*>(__libc_malloc(sizeof(LiveAlloc)));
+    if (node) {
+        node->ptr = ptr;
+        node->size = size;
+        node->est_bytes = est_bytes;
+        node->stack = stack;
+
+        link_sample(node);
+
+        StackEntry& e = g_stacks[stack];
+        e.inuse_count.fetch_add(1, std::memory_order_relaxed);
+        e.inuse_bytes.fetch_add(size, std::memory_order_relaxed);
+        e.est_inuse_bytes.fetch_add(est_bytes, std::memory_order_relaxed);
+        g_live.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    StackEntry& e = g_stacks[stack];
+    e.alloc_count.fetch_add(1, std::memory_order_relaxed);
+    e.alloc_bytes.fetch_add(size, std::memory_order_relaxed);
+    e.est_alloc_bytes.fetch_add(est_bytes, std::memory_order_relaxed);
+    g_sampled.fetch_add(1, std::memory_order_relaxed);
+
+    ts.in_hook = false;
+}
+
+__attribute__((noinline)) LiveAlloc* unlink_sample(void* ptr, uint64_t h) {
+    Shard& shard = shard_of(h);
+    shard.lock.lock();
+    LiveAlloc** link = &bucket_of(shard, h);
+    while (*link && (*link)->ptr != ptr) {
+        link = &(*link)->next;
+    }
+    LiveAlloc* node = *link;
+    if (node) *link = node->next;
+    shard.lock.unlock();
+
+    if (node) filter_slot(h).fetch_sub(1, std::memory_order_relaxed); // 否则为过滤器冲突, 并非采样分配
+    return node;
+}
+
+// 采样的分配已被释放: 从所属栈的存活统计中扣除
+void retire_sample(LiveAlloc* node) {
+    StackEntry& e = g_stacks[node->stack];
+    e.inuse_count.fetch_sub(1, std::memory_order_relaxed);
+    e.inuse_bytes.fetch_sub(node->size, std::memory_order_relaxed);
+    e.est_inuse_bytes.fetch_sub(node->est_bytes, std::memory_order_relaxed);
+    g_live.fetch_sub(1, std::memory_order_relaxed);
+    __libc_free(node);
+}
+
+inline void on_alloc(void* ptr, size_t size) {
+    if (! ptr) return;
+    ThreadState& ts = t_state;
+    ts.bytes_until_sample -= static_cast<int64_t>(size);
+    if (__builtin_expect(ts.bytes_until_sample > 0, 1)) return;
+    record_sample(ptr, size);
+}
+
+// 摘下 ptr 的采样, 不是采样分配时返回 nullptr;
+// 必须在真正释放之前调用, 否则同一地址可能已被其他线程重新分配并采样
+inline LiveAlloc* take_sample(void* ptr) {
+    if (! ptr) return nullptr;
+    uint64_t h = mix_ptr(ptr);
+    if (__builtin_expect(filter_slot(h).load(std::memory_order_relaxed) == 0, 1)) return nullptr;
+    return unlink_sample(ptr, h);
+}
+
+inline void on_free(void* ptr) {
+    if (LiveAlloc* node = take_sample(ptr)) retire_sample(node);
+}
+
+void* new_impl(size_t size) {
+    if (size == 0) size = 1;
+    for (;;) {
+        void* p = __libc_malloc(size);
+        if (p) {
+            on_alloc(p, size);
+            return p;
+        }
+        std::new_handler handler = std::get_new_handler();
+        if (! handler) throw std::bad_alloc();
+        handler();
+    }
+}
+
+void* new_nothrow_impl(size_t size) noexcept {
+    if (size == 0) size = 1;
+    void* p = __libc_malloc(size);
+    on_alloc(p, size);
+    return p;
+}
+
+// 把一个栈写成 folded 格式 "root;...;leaf", 名字中的 ';' 与空格会破坏格式, 替换为 '_'
+void write_folded_stack(FILE* file, const StackEntry& e, Modules& mods) {
+    if (e.depth == 0) {
+        fputs("[overflow]", file);
+        return;
+    }
+    for (size_t i = e.depth; i-- > 0;) {
+        FrameView v;
+        resolve_view_with_modules(e.frames[i], mods, v);
+        if (v.has_symbol) {
+            for (size_t k = 0; k < v.function_len; ++k) {
+                char c = v.function[k];
+                fputc(c == ';' || c == ' ' ? '_' : c, file);
+            }
+        } else if (v.module_len > 0) {
+            const char* slash = strrchr(v.module, '/');
+            fprintf(file, "[%s]", slash ? slash + 1 : v.module);
+        } else {
+            fprintf(file, "%p", e.frames[i]);
+        }
+        if (i > 0) fputc(';', file);
+    }
+}
+
+void dump_folded(FILE* file, bool inuse) {
+    // 每次输出使用私有的模块表: 包含采样之后 dlopen 的模块, 也不与其他线程共用全局模块缓存
+    Modules mods;
+    ModuleManager::load_modules(mods, getpid());
+    for (size_t i = 0; i < kMaxStacks; ++i) {
+        const StackEntry& e = g_stacks[i];
+        if (i != 0 && ! e.used) continue;
+        uint64_t value = inuse ? e.est_inuse_bytes.load(std::memory_order_relaxed)
+                               : e.est_alloc_bytes.load(std::memory_order_relaxed);
+        if (value == 0) continue;
+        write_folded_stack(file, e, mods);
+        fprintf(file, " %llu\n", static_cast<unsigned long long>(value));
+    }
+}
+
+// gperftools 的 heap_v2 文本格式, 值为原始采样值, 由 pprof 按 heap_v2/<interval> 自行还原
+void dump_pprof(FILE* file) {
+    uint64_t inuse_count = 0, inuse_bytes = 0, alloc_count = 0, alloc_bytes = 0;
+    for (size_t i = 0; i < kMaxStacks; ++i) {
+        const StackEntry& e = g_stacks[i];
+        inuse_count += e.inuse_count.load(std::memory_order_relaxed);
+        inuse_bytes += e.inuse_bytes.load(std::memory_order_relaxed);
+        alloc_count += e.alloc_count.load(std::memory_order_relaxed);
+        alloc_bytes += e.alloc_bytes.load(std::memory_order_relaxed);
+    }
+    fprintf(file,
+            "heap profile: %llu: %llu [%llu: %llu] @ heap_v2/%zu\n",
+            static_cast<unsigned long long>(inuse_count),
+            static_cast<unsigned long long>(inuse_bytes),
+            static_cast<unsigned long long>(alloc_count),
+            static_cast<unsigned long long>(alloc_bytes),
+            g_interval.load(std::memory_order_relaxed));
+
+    for (size_t i = 1; i < kMaxStacks; ++i) {
+        const StackEntry& e = g_stacks[i];
+        if (! e.used || e.alloc_count.load(std::memory_order_relaxed) == 0) continue;
+        fprintf(file,
+                "%llu: %llu [%llu: %llu] @",
+                static_cast<unsigned long long>(e.inuse_count.load(std::memory_order_relaxed)),
+                static_cast<unsigned long long>(e.inuse_bytes.load(std::memory_order_relaxed)),
+                static_cast<unsigned long long>(e.alloc_count.load(std::memory_order_relaxed)),
+                static_cast<unsigned long long>(e.alloc_bytes.load(std::memory_order_relaxed)));
+        for (size_t k = 0; k < e.depth; ++k) {
+            fprintf(file, " %p", e.frames[k]);
+        }
+        fputc('\n', file);
+    }
+
+    fputs("\nMAPPED_LIBRARIES:\n", file);
+    FILE* maps = fopen("/proc/self/maps", "r");
+    if (maps) {
+        char buf[4096];
+        size_t n;
+        while ((n = fread(buf, 1, sizeof(buf), maps)) > 0) {
+            fwrite(buf, 1, n, file);
+        }
+        fclose(maps);
+    }
+}
+
+int dump_impl(FILE* file, sst_heap_format format) {
+    if (! file) return -1;
+    ThreadState& ts = t_state;
+    bool prev = ts.in_hook;
+    ts.in_hook = true;
+    int rc = 0;
+    g_dump_lock.lock();
+    switch (format) {
+        case SST_HEAP_FOLDED_INUSE: dump_folded(file, true); break;
+        case SST_HEAP_FOLDED_ALLOC: dump_folded(file, false); break;
+        case SST_HEAP_PPROF: dump_pprof(file); break;
+        default: rc = -1; break;
+    }
+    if (rc == 0) fflush(file);
+    g_dump_lock.unlock();
+    ts.in_hook = prev;
+    return rc;
+}
+
+void dump_to_outputs() {
+    if (! g_out_prefix) {
+        dump_impl(stderr, SST_HEAP_FOLDED_INUSE);
+        return;
+    }
+    unsigned seq = g_dump_seq.fetch_add(1, std::memory_order_relaxed);
+    char path[PATH_MAX];
+    snprintf(path, sizeof(path), "%s.%d.%u.heap", g_out_prefix, static_cast<int>(getpid()), seq);
+    sst_heap_dump_file(path, SST_HEAP_PPROF);
+    snprintf(path, sizeof(path), "%s.%d.%u.folded", g_out_prefix, static_cast<int>(getpid()), seq);
+    sst_heap_dump_file(path, SST_HEAP_FOLDED_INUSE);
+}
+
+void dump_at_exit() {
+    dump_to_outputs();
+}
+
+void on_dump_signal(int) {
+    sem_post(&g_dump_sem); // async-signal-safe, 真正的输出在后台线程中完成
+}
+
+void* dump_thread_main(void*) {
+    t_state.in_hook = true; // 后台线程自身的分配不参与采样
+    for (;;) {
+        if (sem_wait(&g_dump_sem) != 0) {
+            if (errno == EINTR) continue;
+            return nullptr;
+        }
+        dump_to_outputs();
+    }
+}
+
+void find_self_range() {
+    Dl_info info;
+    if (! dladdr(reinterpret_cast<void*>(&record_sample), &info)) return;
+    dl_iterate_phdr(
+        [](struct dl_phdr_info* phdr, size_t, void* data) {
+            auto* fbase = static_cast<Dl_info*>(data)->dli_fbase;
+            auto range = get_addr_range_from_info(phdr);
+            if (reinterpret_cast<uintptr_t>(fbase) >= range.first && reinterpret_cast<uintptr_t>(fbase) < range.second) {
+                g_self_lo = range.first;
+                g_self_hi = range.second;
+                return 1;
+            }
+            return 0;
+        },
+        &info);
+}
+
+__attribute__((constructor)) void heap_profiler_init() {
+    t_state.in_hook = true;
+
+    size_t interval = SST_HEAP_DEFAULT_INTERVAL;
+    if (const char* env = getenv("SST_HEAP_SAMPLE_INTERVAL")) {
+        interval = static_cast<size_t>(strtoull(env, nullptr, 10));
+    }
+    g_interval.store(interval, std::memory_order_relaxed);
+    g_out_prefix = getenv("SST_HEAP_OUT");
+
+    find_self_range();
+    Stacktrace::capture(); // 预热: 首次 backtrace() 会 dlopen libgcc_s
+    // 退出时的输出注册在 atexit 中, 原因与 libsst_lock.so 相同: destructor 晚于静态对象的析构,
+    // 那时 ModuleManager 已经析构. 先构造它再注册, 输出就先于它的析构
+    ModuleManager::instance();
+    if (g_out_prefix) atexit(dump_at_exit);
+
+    if (const char* env = getenv("SST_HEAP_SIGNAL")) {
+        int sig = atoi(env);
+        pthread_t tid;
+        if (sig > 0 && sem_init(&g_dump_sem, 0, 0) == 0 && pthread_create(&tid, nullptr, dump_thread_main, nullptr) == 0) {
+            pthread_detach(tid);
+            struct sigaction sa {};
+            sa.sa_handler = on_dump_signal;
+            sigemptyset(&sa.sa_mask);
+            sa.sa_flags = SA_RESTART;
+            sigaction(sig, &sa, nullptr);
+        }
+    }
+
+    t_state.in_hook = false;
+    g_ready.store(true, std::memory_order_release);
+}
+
+} // namespace
+
+extern "C" {
+
+void* malloc(size_t size) {
+    void* p = __libc_malloc(size);
+    on_alloc(p, size);
+    return p;
+}
+
+void free(void* ptr) {
+    on_free(ptr);
+    __libc_free(ptr);
+}
+
+void* calloc(size_t n, size_t size) {
+    void* p = __libc_calloc(n, size);
+    on_alloc(p, n * size);
+    return p;
+}
+
+void* realloc(void* ptr, size_t size) {
+    // 与 free 相同, 原块的采样要在 realloc 之前摘下; 失败时原块仍然有效, 放回存活表
+    LiveAlloc* old = take_sample(ptr);
+    void* p = __libc_realloc(ptr, size);
+    if (! p && size != 0) {
+        if (old) link_sample(old);
+        return p;
+    }
+    if (old) retire_sample(old);
+    on_alloc(p, size);
+    return p;
+}
+
+void* memalign(size_t alignment, size_t size) {
+    void* p = __libc_memalign(alignment, size);
+    on_alloc(p, size);
+    return p;
+}
+
+void* aligned_alloc(size_t alignment, size_t size) {
+    void* p = __libc_memalign(alignment, size);
+    on_alloc(p, size);
+    return p;
+}
+
+int posix_memalign(void** out, size_t alignment, size_t size) {
+    if (alignment % sizeof(void*) != 0 || (alignment & (alignment - 1)) != 0) return EINVAL;
+    void* p = __libc_memalign(alignment, size);
+    if (! p) return ENOMEM;
+    on_alloc(p, size);
+    *out = p;
+    return 0;
+}
+
+int sst_heap_dump(FILE* file, sst_heap_format format) {
+    return dump_impl(file, format);
+}
+
+int sst_heap_dump_file(const char* path, sst_heap_format format) {
+    if (! path) return -1;
+    ThreadState& ts = t_state;
+    bool prev = ts.in_hook;
+    ts.in_hook = true;
+    FILE* file = fopen(path, "w");
+    int rc = file ? dump_impl(file, format) : -1;
+    if (file) fclose(file);
+    ts.in_hook = prev;
+    return rc;
+}
+
+void sst_heap_set_sample_interval(size_t bytes) {
+    g_interval.store(bytes, std::memory_order_relaxed);
+}
+
+void sst_heap_get_stats(sst_heap_stats* out) {
+    if (! out) return;
+    out->sampled_allocs = g_sampled.load(std::memory_order_relaxed);
+    out->live_samples = g_live.load(std::memory_order_relaxed);
+    out->unique_stacks = g_unique_stacks.load(std::memory_order_relaxed);
+    out->dropped_stacks = g_dropped.load(std::memory_order_relaxed);
+}
+
+} // extern "C"
+
+void* operator new(size_t size) {
+    return new_impl(size);
+}
+
+void* operator new[](size_t size) {
+    return new_impl(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    return new_nothrow_impl(size);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+    return new_nothrow_impl(size);
+}
+
+void operator delete(void* ptr) noexcept {
+    on_free(ptr);
+    __libc_free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+    on_free(ptr);
+    __libc_free(ptr);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept {
+    on_free(ptr);
+    __libc_free(ptr);
+}
+
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept {
+    on_free(ptr);
+    __libc_free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    on_free(ptr);
+    __libc_free(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept {
+    on_free(ptr);
+    __libc_free(ptr);
+}
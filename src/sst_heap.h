@@ -0,0 +1,74 @@
+#ifndef SST_HEAP_H
+#define SST_HEAP_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/**
+ * libsst_heap.so: 基于 malloc 拦截的采样堆分析器
+ *
+ * 用法: LD_PRELOAD=libsst_heap.so ./your_program
+ *
+ * 环境变量:
+ *   SST_HEAP_SAMPLE_INTERVAL  平均采样间隔（字节），默认 524288（512 KB）
+ *   SST_HEAP_SIGNAL           收到该信号时输出一次 profile，例如 12（SIGUSR2），默认不安装
+ *   SST_HEAP_OUT              输出文件前缀，生成 <prefix>.<pid>.<seq>.heap 与 .folded；
+ *                             设置后进程退出时也会输出一次，未设置时信号触发的输出写到 stderr
+ */
+
+/// 平均采样间隔的默认值（字节）
+#define SST_HEAP_DEFAULT_INTERVAL (512 * 1024)
+
+/// 输出格式
+typedef enum sst_heap_format {
+    SST_HEAP_FOLDED_INUSE = 0, ///< folded stacks，值为估算的存活字节数（可直接用于 flamegraph.pl）
+    SST_HEAP_FOLDED_ALLOC = 1, ///< folded stacks，值为估算的累计分配字节数
+    SST_HEAP_PPROF = 2,        ///< gperftools heap_v2 文本格式，可用 `pprof <binary> <file>` 打开
+} sst_heap_format;
+
+/// 采样统计
+typedef struct sst_heap_stats {
+    uint64_t sampled_allocs; ///< 累计采样到的分配次数
+    uint64_t live_samples;   ///< 当前仍存活的采样分配数
+    uint64_t unique_stacks;  ///< 去重后的栈个数
+    uint64_t dropped_stacks; ///< 栈表已满而被归入 "[overflow]" 的采样数
+} sst_heap_stats;
+
+/**
+ * @brief 输出当前的采样 profile
+ * @param file 目标文件流
+ * @param format 输出格式
+ * @return 成功返回 0，失败返回 -1
+ */
+int sst_heap_dump(FILE* file, sst_heap_format format);
+
+/**
+ * @brief 输出当前的采样 profile 到文件
+ * @param path 文件路径（覆盖写）
+ * @param format 输出格式
+ * @return 成功返回 0，失败返回 -1
+ */
+int sst_heap_dump_file(const char* path, sst_heap_format format);
+
+/**
+ * @brief 修改平均采样间隔，对各线程的下一次采样生效
+ * @param bytes 平均间隔（字节），0 表示关闭采样
+ */
+void sst_heap_set_sample_interval(size_t bytes);
+
+/**
+ * @brief 读取采样统计
+ * @param out [out] 结果
+ */
+void sst_heap_get_stats(sst_heap_stats* out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SST_HEAP_H
@@ -0,0 +1,609 @@
+// sst_lock.cpp - 锁竞争分析器, 编译为可 LD_PRELOAD 的 libsst_lock.so
+//
+// - 拦截 pthread_mutex_lock / pthread_rwlock_{rd,wr}lock / pthread_cond_{timed,}wait
+// - 加锁先 trylock, 未竞争时只多一次 trylock; 失败后才读时钟并进入真正的阻塞加锁
+// - 等待超过阈值时用 Stacktrace::capture() 记录调用栈, 在线程本地的小哈希表中按 (类型, 栈) 累加,
+//   表满、线程退出或输出报告时合并到全局栈表
+// - 通过 sst_lock_dump() 或信号输出按累计等待时间排序的文本报告 / folded 文本
+
+#include "sst_lock.h"
+#include "../include/sst.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <vector>
+
+#include <pthread.h>
+#include <semaphore.h>
+
+using namespace stacktrace;
+
+namespace {
+
+const size_t kMaxStacks = 4096;  // 全局栈表容量, 下标 0 保留给溢出项
+const size_t kThreadSlots = 32;  // 每个线程本地缓冲的栈数
+const size_t kMaxFrames = Stacktrace::kMaxFrames;
+
+enum Kind : uint32_t { kMutex, kRdlock, kWrlock, kCond, kKinds };
+const char* const kKindNames[kKinds] = {"mutex", "rwlock-rd", "rwlock-wr", "cond"};
+
+// 内部只用自旋锁, 不能经过被拦截的 pthread 函数
+struct SpinLock {
+    std::atomic<int> state;
+
+    void lock() {
+        while (state.exchange(1, std::memory_order_acquire) != 0) {
+            while (state.load(std::memory_order_relaxed) != 0) {
+                sched_yield();
+            }
+        }
+    }
+
+    void unlock() {
+        state.store(0, std::memory_order_release);
+    }
+};
+
+// 一个 (类型, 栈) 的累计等待, 线程缓冲与全局表共用
+struct WaitEntry {
+    uint64_t hash;
+    uint32_t kind;
+    uint32_t depth;
+    bool used;
+    void* frames[kMaxFrames];
+    uint64_t count;
+    uint64_t wait_ns;
+    uint64_t max_ns;
+};
+
+struct ThreadBuffer {
+    SpinLock lock;
+    std::atomic<bool> in_use;
+    ThreadBuffer* next;
+    WaitEntry entries[kThreadSlots];
+};
+
+struct RealFunctions {
+    int (*mutex_lock)(pthread_mutex_t*);
+    int (*mutex_trylock)(pthread_mutex_t*);
+    int (*rwlock_rdlock)(pthread_rwlock_t*);
+    int (*rwlock_tryrdlock)(pthread_rwlock_t*);
+    int (*rwlock_wrlock)(pthread_rwlock_t*);
+    int (*rwlock_trywrlock)(pthread_rwlock_t*);
+    int (*cond_wait)(pthread_cond_t*, pthread_mutex_t*);
+    int (*cond_timedwait)(pthread_cond_t*, pthread_mutex_t*, const struct timespec*);
+};
+
+// 全部全局状态都是零初始化的 POD/atomic, 不依赖动态初始化 (其他库的构造函数可能先于本库加锁)
+RealFunctions g_real;
+std::atomic<bool> g_real_loaded;
+WaitEntry g_stacks[kMaxStacks];
+SpinLock g_stacks_lock;
+ThreadBuffer* g_buffers;
+SpinLock g_buffers_lock;
+SpinLock g_dump_lock; // 信号触发的输出线程、sst_lock_dump() 与退出时的输出可能同时进行
+pthread_key_t g_buffer_key;
+
+std::atomic<uint64_t> g_threshold_ns;
+std::atomic<bool> g_ready;
+std::atomic<uint64_t> g_contended;
+std::atomic<uint64_t> g_contended_ns;
+std::atomic<uint64_t> g_cond;
+std::atomic<uint64_t> g_cond_ns;
+std::atomic<uint64_t> g_sampled;
+std::atomic<uint64_t> g_unique_stacks;
+std::atomic<uint64_t> g_dropped;
+std::atomic<uint32_t> g_dump_seq;
+
+uintptr_t g_self_lo, g_self_hi; // 本库的地址范围, 记录栈时去掉位于本库内的栈顶帧
+const char* g_out_prefix;
+sem_t g_dump_sem;
+
+__thread ThreadBuffer* t_buffer __attribute__((tls_model("initial-exec")));
+__thread bool t_in_hook __attribute__((tls_model("initial-exec"))); // 正在记录/输出, 本线程的加锁直接透传
+
+template <typename F>
+void load_symbol(F& out, const char* name, const char* version) {
+    void* sym = version ? dlvsym(RTLD_NEXT, name, version) : nullptr;
+    if (! sym) sym = dlsym(RTLD_NEXT, name);
+    out = reinterpret_cast<F>(sym);
+}
+
+// 可能在构造函数之前被调用; 多个线程同时解析时写入的值相同
+const RealFunctions& real() {
+    if (__builtin_expect(! g_real_loaded.load(std::memory_order_acquire), 0)) {
+        load_symbol(g_real.mutex_lock, "pthread_mutex_lock", nullptr);
+        load_symbol(g_real.mutex_trylock, "pthread_mutex_trylock", nullptr);
+        load_symbol(g_real.rwlock_rdlock, "pthread_rwlock_rdlock", nullptr);
+        load_symbol(g_real.rwlock_tryrdlock, "pthread_rwlock_tryrdlock", nullptr);
+        load_symbol(g_real.rwlock_wrlock, "pthread_rwlock_wrlock", nullptr);
+        load_symbol(g_real.rwlock_trywrlock, "pthread_rwlock_trywrlock", nullptr);
+        // 不带版本的 dlsym 会取到旧版 (GLIBC_2.2.5) 的条件变量实现, 与新版的 pthread_cond_t 布局不兼容
+        load_symbol(g_real.cond_wait, "pthread_cond_wait", "GLIBC_2.3.2");
+        load_symbol(g_real.cond_timedwait, "pthread_cond_timedwait", "GLIBC_2.3.2");
+        g_real_loaded.store(true, std::memory_order_release);
+    }
+    return g_real;
+}
+
+inline uint64_t now_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+inline bool hooks_active() {
+    return ! t_in_hook && g_ready.load(std::memory_order_relaxed);
+}
+
+uint64_t hash_stack(uint32_t kind, void* const* frames, size_t depth) {
+    uint64_t h = 1469598103934665603ull ^ kind;
+    for (size_t i = 0; i < depth; ++i) {
+        h ^= reinterpret_cast<uintptr_t>(frames[i]);
+        h *= 1099511628211ull;
+    }
+    return h == 0 ? 1 : h;
+}
+
+inline bool same_stack(const WaitEntry& e, uint64_t h, uint32_t kind, void* const* frames, size_t depth) {
+    return e.hash == h && e.kind == kind && e.depth == depth && memcmp(e.frames, frames, depth * sizeof(void*)) == 0;
+}
+
+void accumulate(WaitEntry& e, uint64_t count, uint64_t wait_ns, uint64_t max_ns) {
+    e.count += count;
+    e.wait_ns += wait_ns;
+    e.max_ns = std::max(e.max_ns, max_ns);
+}
+
+// 合并到全局栈表, 需持有 g_stacks_lock
+void merge_locked(const WaitEntry& src) {
+    size_t idx = src.hash % (kMaxStacks - 1) + 1;
+    for (size_t probe = 0; probe < kMaxStacks - 1; ++probe) {
+        WaitEntry& e = g_stacks[idx];
+        if (! e.used) {
+            e = src;
+            g_unique_stacks.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        if (same_stack(e, src.hash, src.kind, src.frames, src.depth)) {
+            accumulate(e, src.count, src.wait_ns, src.max_ns);
+            return;
+        }
+        idx = idx + 1 < kMaxStacks ? idx + 1 : 1;
+    }
+    accumulate(g_stacks[0], src.count, src.wait_ns, src.max_ns);
+    g_dropped.fetch_add(src.count, std::memory_order_relaxed);
+}
+
+// 把线程缓冲清空到全局栈表, 需持有 buf->lock
+void flush_locked(ThreadBuffer* buf) {
+    g_stacks_lock.lock();
+    for (WaitEntry& e : buf->entries) {
+        if (! e.used) continue;
+        merge_locked(e);
+        e.used = false;
+    }
+    g_stacks_lock.unlock();
+}
+
+void release_buffer(void* data) {
+    auto* buf = static_cast<ThreadBuffer*>(data);
+    bool prev = t_in_hook;
+    t_in_hook = true;
+    buf->lock.lock();
+    flush_locked(buf);
+    buf->lock.unlock();
+    buf->in_use.store(false, std::memory_order_release);
+    t_buffer = nullptr;
+    t_in_hook = prev;
+}
+
+// 优先复用已退出线程留下的缓冲, 缓冲只增不减, 输出报告时遍历
+ThreadBuffer* acquire_buffer() {
+    ThreadBuffer* buf = nullptr;
+    g_buffers_lock.lock();
+    for (ThreadBuffer* b = g_buffers; b; b = b->next) {
+        bool expected = false;
+        if (b->in_use.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+            buf = b;
+            break;
+        }
+    }
+    g_buffers_lock.unlock();
+
+    if (! buf) {
+        buf = static_cast<ThreadBuffer*>(calloc(1, sizeof(ThreadBuffer)));
+        if (! buf) return nullptr;
+        buf->in_use.store(true, std::memory_order_relaxed);
+        g_buffers_lock.lock();
+        buf->next = g_buffers;
+        g_buffers = buf;
+        g_buffers_lock.unlock();
+    }
+    pthread_setspecific(g_buffer_key, buf);
+    t_buffer = buf;
+    return buf;
+}
+
+void record_stack(uint32_t kind, uint64_t ns) {
+    Stacktrace st = Stacktrace::capture();
+    void* const* frames = st.addresses();
+    size_t skip = 0;
+    while (skip < st.size() && reinterpret_cast<uintptr_t>(frames[skip]) >= g_self_lo
+           && reinterpret_cast<uintptr_t>(frames[skip]) < g_self_hi) {
+        ++skip;
+    }
+    frames += skip;
+    size_t depth = st.size() - skip;
+    uint64_t h = hash_stack(kind, frames, depth);
+
+    ThreadBuffer* buf = t_buffer ? t_buffer : acquire_buffer();
+    if (! buf) return;
+    buf->lock.lock();
+    size_t idx = h % kThreadSlots;
+    for (size_t probe = 0;; ++probe) {
+        if (probe == kThreadSlots) {
+            flush_locked(buf); // 本线程的不同栈超过了缓冲容量
+            idx = h % kThreadSlots;
+            probe = 0;
+        }
+        WaitEntry& e = buf->entries[idx];
+        if (! e.used) {
+            e.used = true;
+            e.hash = h;
+            e.kind = kind;
+            e.depth = static_cast<uint32_t>(depth);
+            memcpy(e.frames, frames, depth * sizeof(void*));
+            e.count = 1;
+            e.wait_ns = e.max_ns = ns;
+            break;
+        }
+        if (same_stack(e, h, kind, frames, depth)) {
+            accumulate(e, 1, ns, ns);
+            break;
+        }
+        idx = (idx + 1) % kThreadSlots;
+    }
+    buf->lock.unlock();
+}
+
+// 在已经拿到锁之后调用, 超过阈值时抓栈的开销计入临界区, 阈值以下只有两次原子加
+__attribute__((noinline)) void record_wait(uint32_t kind, uint64_t ns) {
+    if (kind == kCond) {
+        g_cond.fetch_add(1, std::memory_order_relaxed);
+        g_cond_ns.fetch_add(ns, std::memory_order_relaxed);
+    } else {
+        g_contended.fetch_add(1, std::memory_order_relaxed);
+        g_contended_ns.fetch_add(ns, std::memory_order_relaxed);
+    }
+    if (ns < g_threshold_ns.load(std::memory_order_relaxed)) return;
+
+    t_in_hook = true;
+    record_stack(kind, ns);
+    g_sampled.fetch_add(1, std::memory_order_relaxed);
+    t_in_hook = false;
+}
+
+// 把所有线程缓冲合并到全局栈表, 返回其副本
+std::vector<WaitEntry> collect() {
+    g_buffers_lock.lock();
+    for (ThreadBuffer* b = g_buffers; b; b = b->next) {
+        b->lock.lock();
+        flush_locked(b);
+        b->lock.unlock();
+    }
+    g_buffers_lock.unlock();
+
+    std::vector<WaitEntry> out;
+    g_stacks_lock.lock();
+    for (size_t i = 0; i < kMaxStacks; ++i) {
+        if ((i == 0 || g_stacks[i].used) && g_stacks[i].count > 0) out.push_back(g_stacks[i]);
+    }
+    g_stacks_lock.unlock();
+    std::sort(out.begin(), out.end(), [](const WaitEntry& a, const WaitEntry& b) { return a.wait_ns > b.wait_ns; });
+    return out;
+}
+
+// 函数名中的 ';' 与空格会破坏 folded 格式, 替换为 '_'
+void write_folded_stack(FILE* file, const WaitEntry& e, Modules& mods) {
+    if (e.depth == 0) {
+        fputs("[overflow]", file);
+        return;
+    }
+    fprintf(file, "[%s];", kKindNames[e.kind]);
+    for (size_t i = e.depth; i-- > 0;) {
+        FrameView v;
+        resolve_view_with_modules(e.frames[i], mods, v);
+        if (v.has_symbol) {
+            for (size_t k = 0; k < v.function_len; ++k) {
+                char c = v.function[k];
+                fputc(c == ';' || c == ' ' ? '_' : c, file);
+            }
+        } else if (v.module_len > 0) {
+            const char* slash = strrchr(v.module, '/');
+            fprintf(file, "[%s]", slash ? slash + 1 : v.module);
+        } else {
+            fprintf(file, "%p", e.frames[i]);
+        }
+        if (i > 0) fputc(';', file);
+    }
+}
+
+void dump_folded(FILE* file, const std::vector<WaitEntry>& entries, Modules& mods) {
+    for (const WaitEntry& e : entries) {
+        write_folded_stack(file, e, mods);
+        fprintf(file, " %llu\n", static_cast<unsigned long long>(e.wait_ns));
+    }
+}
+
+void dump_section(FILE* file, const std::vector<WaitEntry>& entries, bool cond, Modules& mods) {
+    int rank = 0;
+    for (const WaitEntry& e : entries) {
+        if ((e.kind == kCond) != cond) continue;
+        fprintf(file,
+                "\n#%d %s: total %.3f ms, %llu waits, avg %.1f us, max %.1f us\n",
+                ++rank,
+                e.depth == 0 ? "[overflow]" : kKindNames[e.kind],
+                static_cast<double>(e.wait_ns) / 1e6,
+                static_cast<unsigned long long>(e.count),
+                static_cast<double>(e.wait_ns) / 1e3 / static_cast<double>(e.count),
+                static_cast<double>(e.max_ns) / 1e3);
+        for (size_t i = 0; i < e.depth; ++i) {
+            FrameView v;
+            resolve_view_with_modules(e.frames[i], mods, v);
+            v.index = i;
+            char line[1024];
+            v.format(line, sizeof(line));
+            fputs("    ", file);
+            fputs(line, file);
+        }
+    }
+    if (rank == 0) fputs("\n(none)\n", file);
+}
+
+void dump_report(FILE* file, const std::vector<WaitEntry>& entries, Modules& mods) {
+    fprintf(file,
+            "lock contention: %llu contended waits, %.3f ms blocked; %llu cond waits, %.3f ms; "
+            "%llu waits >= %llu us with stacks\n",
+            static_cast<unsigned long long>(g_contended.load(std::memory_order_relaxed)),
+            static_cast<double>(g_contended_ns.load(std::memory_order_relaxed)) / 1e6,
+            static_cast<unsigned long long>(g_cond.load(std::memory_order_relaxed)),
+            static_cast<double>(g_cond_ns.load(std::memory_order_relaxed)) / 1e6,
+            static_cast<unsigned long long>(g_sampled.load(std::memory_order_relaxed)),
+            static_cast<unsigned long long>(g_threshold_ns.load(std::memory_order_relaxed) / 1000));
+    fputs("\n== lock waits by total blocked time\n", file);
+    dump_section(file, entries, false, mods);
+    fputs("\n== condition variable waits by total time\n", file);
+    dump_section(file, entries, true, mods);
+}
+
+int dump_impl(FILE* file, sst_lock_format format) {
+    if (! file || (format != SST_LOCK_REPORT && format != SST_LOCK_FOLDED)) return -1;
+    bool prev = t_in_hook;
+    t_in_hook = true;
+    g_dump_lock.lock();
+    // 每次输出使用私有的模块表: 包含记录之后 dlopen 的模块, 也不与其他线程共用全局模块缓存
+    Modules mods;
+    ModuleManager::load_modules(mods, getpid());
+    std::vector<WaitEntry> entries = collect();
+    if (format == SST_LOCK_REPORT) {
+        dump_report(file, entries, mods);
+    } else {
+        dump_folded(file, entries, mods);
+    }
+    fflush(file);
+    g_dump_lock.unlock();
+    t_in_hook = prev;
+    return 0;
+}
+
+void dump_to_outputs() {
+    if (! g_out_prefix) {
+        dump_impl(stderr, SST_LOCK_REPORT);
+        return;
+    }
+    unsigned seq = g_dump_seq.fetch_add(1, std::memory_order_relaxed);
+    char path[PATH_MAX];
+    snprintf(path, sizeof(path), "%s.%d.%u.txt", g_out_prefix, static_cast<int>(getpid()), seq);
+    sst_lock_dump_file(path, SST_LOCK_REPORT);
+    snprintf(path, sizeof(path), "%s.%d.%u.folded", g_out_prefix, static_cast<int>(getpid()), seq);
+    sst_lock_dump_file(path, SST_LOCK_FOLDED);
+}
+
+void dump_at_exit() {
+    dump_to_outputs();
+}
+
+void on_dump_signal(int) {
+    sem_post(&g_dump_sem); // async-signal-safe, 真正的输出在后台线程中完成
+}
+
+void* dump_thread_main(void*) {
+    t_in_hook = true; // 后台线程自身的加锁不参与统计
+    for (;;) {
+        if (sem_wait(&g_dump_sem) != 0) {
+            if (errno == EINTR) continue;
+            return nullptr;
+        }
+        dump_to_outputs();
+    }
+}
+
+void find_self_range() {
+    Dl_info info;
+    if (! dladdr(reinterpret_cast<void*>(&record_wait), &info)) return;
+    dl_iterate_phdr(
+        [](struct dl_phdr_info* phdr, size_t, void* data) {
+            auto* fbase = static_cast<Dl_info*>(data)->dli_fbase;
+            auto range = get_addr_range_from_info(phdr);
+            if (reinterpret_cast<uintptr_t>(fbase) >= range.first && reinterpret_cast<uintptr_t>(fbase) < range.second) {
+                g_self_lo = range.first;
+                g_self_hi = range.second;
+                return 1;
+            }
+            return 0;
+        },
+        &info);
+}
+
+__attribute__((constructor)) void lock_profiler_init() {
+    t_in_hook = true;
+    real();
+
+    uint64_t threshold_us = SST_LOCK_DEFAULT_THRESHOLD_US;
+    if (const char* env = getenv("SST_LOCK_THRESHOLD_US")) {
+        threshold_us = strtoull(env, nullptr, 10);
+    }
+    g_threshold_ns.store(threshold_us * 1000, std::memory_order_relaxed);
+    g_out_prefix = getenv("SST_LOCK_OUT");
+
+    find_self_range();
+    Stacktrace::capture(); // 预热: 首次 backtrace() 会 dlopen libgcc_s
+    // 退出时的输出注册在 atexit 中而不是放在 destructor: destructor 晚于静态对象的析构执行,
+    // 那时 ModuleManager 已经析构. 先构造 ModuleManager 再注册, 输出就先于它的析构
+    ModuleManager::instance();
+    if (g_out_prefix) atexit(dump_at_exit);
+    if (pthread_key_create(&g_buffer_key, release_buffer) != 0) {
+        t_in_hook = false;
+        return; // 无法在线程退出时回收缓冲, 保持透传
+    }
+
+    if (const char* env = getenv("SST_LOCK_SIGNAL")) {
+        int sig = atoi(env);
+        pthread_t tid;
+        if (sig > 0 && sem_init(&g_dump_sem, 0, 0) == 0 && pthread_create(&tid, nullptr, dump_thread_main, nullptr) == 0) {
+            pthread_detach(tid);
+            struct sigaction sa {};
+            sa.sa_handler = on_dump_signal;
+            sigemptyset(&sa.sa_mask);
+            sa.sa_flags = SA_RESTART;
+            sigaction(sig, &sa, nullptr);
+        }
+    }
+
+    t_in_hook = false;
+    g_ready.store(true, std::memory_order_release);
+}
+
+__attribute__((destructor)) void lock_profiler_fini() {
+    g_ready.store(false, std::memory_order_relaxed);
+}
+
+} // namespace
+
+extern "C" {
+
+int pthread_mutex_lock(pthread_mutex_t* mutex) {
+    const RealFunctions& r = real();
+    if (! hooks_active()) return r.mutex_lock(mutex);
+    int rc = r.mutex_trylock(mutex);
+    if (__builtin_expect(rc != EBUSY, 1)) return rc; // 拿到锁, 或是 trylock 与 lock 共有的错误
+    uint64_t begin = now_ns();
+    rc = r.mutex_lock(mutex);
+    if (rc == 0) record_wait(kMutex, now_ns() - begin);
+    return rc;
+}
+
+int pthread_rwlock_rdlock(pthread_rwlock_t* rwlock) {
+    const RealFunctions& r = real();
+    if (! hooks_active()) return r.rwlock_rdlock(rwlock);
+    int rc = r.rwlock_tryrdlock(rwlock);
+    if (__builtin_expect(rc != EBUSY, 1)) return rc;
+    uint64_t begin = now_ns();
+    rc = r.rwlock_rdlock(rwlock);
+    if (rc == 0) record_wait(kRdlock, now_ns() - begin);
+    return rc;
+}
+
+int pthread_rwlock_wrlock(pthread_rwlock_t* rwlock) {
+    const RealFunctions& r = real();
+    if (! hooks_active()) return r.rwlock_wrlock(rwlock);
+    int rc = r.rwlock_trywrlock(rwlock);
+    if (__builtin_expect(rc != EBUSY, 1)) return rc;
+    uint64_t begin = now_ns();
+    rc = r.rwlock_wrlock(rwlock);
+    if (rc == 0) record_wait(kWrlock, now_ns() - begin);
+    return rc;
+}
+
+int pthread_cond_wait(pthread_cond_t* cond, pthread_mutex_t* mutex) {
+    const RealFunctions& r = real();
+    if (! hooks_active()) return r.cond_wait(cond, mutex);
+    uint64_t begin = now_ns();
+    int rc = r.cond_wait(cond, mutex);
+    record_wait(kCond, now_ns() - begin);
+    return rc;
+}
+
+int pthread_cond_timedwait(pthread_cond_t* cond, pthread_mutex_t* mutex, const struct timespec* abstime) {
+    const RealFunctions& r = real();
+    if (! hooks_active()) return r.cond_timedwait(cond, mutex, abstime);
+    uint64_t begin = now_ns();
+    int rc = r.cond_timedwait(cond, mutex, abstime);
+    record_wait(kCond, now_ns() - begin);
+    return rc;
+}
+
+int sst_lock_dump(FILE* file, sst_lock_format format) {
+    return dump_impl(file, format);
+}
+
+int sst_lock_dump_file(const char* path, sst_lock_format format) {
+    if (! path) return -1;
+    bool prev = t_in_hook;
+    t_in_hook = true;
+    FILE* file = fopen(path, "w");
+    int rc = file ? dump_impl(file, format) : -1;
+    if (file) fclose(file);
+    t_in_hook = prev;
+    return rc;
+}
+
+void sst_lock_set_threshold_us(uint64_t us) {
+    g_threshold_ns.store(us * 1000, std::memory_order_relaxed);
+}
+
+void sst_lock_get_stats(sst_lock_stats* out) {
+    if (! out) return;
+    out->contended_waits = g_contended.load(std::memory_order_relaxed);
+    out->contended_ns = g_contended_ns.load(std::memory_order_relaxed);
+    out->cond_waits = g_cond.load(std::memory_order_relaxed);
+    out->cond_ns = g_cond_ns.load(std::memory_order_relaxed);
+    out->sampled_waits = g_sampled.load(std::memory_order_relaxed);
+    out->unique_stacks = g_unique_stacks.load(std::memory_order_relaxed);
+    out->dropped_stacks = g_dropped.load(std::memory_order_relaxed);
+}
+
+void sst_lock_reset(void) {
+    g_buffers_lock.lock();
+    for (ThreadBuffer* b = g_buffers; b; b = b->next) {
+        b->lock.lock();
+        for (WaitEntry& e : b->entries) {
+            e.used = false;
+        }
+        b->lock.unlock();
+    }
+    g_buffers_lock.unlock();
+
+    g_stacks_lock.lock();
+    for (WaitEntry& e : g_stacks) {
+        e.used = false;
+        e.count = e.wait_ns = e.max_ns = 0;
+    }
+    g_stacks_lock.unlock();
+
+    g_contended.store(0, std::memory_order_relaxed);
+    g_contended_ns.store(0, std::memory_order_relaxed);
+    g_cond.store(0, std::memory_order_relaxed);
+    g_cond_ns.store(0, std::memory_order_relaxed);
+    g_sampled.store(0, std::memory_order_relaxed);
+    g_unique_stacks.store(0, std::memory_order_relaxed);
+    g_dropped.store(0, std::memory_order_relaxed);
+}
+
+} // extern "C"
@@ -0,0 +1,86 @@
+#ifndef SST_LOCK_H
+#define SST_LOCK_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/**
+ * libsst_lock.so: 基于 pthread 拦截的锁竞争分析器
+ *
+ * 用法: LD_PRELOAD=libsst_lock.so ./your_program
+ *
+ * 拦截 pthread_mutex_lock / pthread_rwlock_rdlock / pthread_rwlock_wrlock / pthread_cond_wait / pthread_cond_timedwait。
+ * 加锁先 trylock, 成功则直接返回, 只有失败后的阻塞路径才计时;
+ * 等待时间超过阈值时记录调用栈, 按 (类型, 栈) 在线程本地缓冲中累加等待时间, 输出时汇总。
+ * 条件变量的等待本身就是阻塞的, 每次都计时, 在报告中单独列出。
+ *
+ * 环境变量:
+ *   SST_LOCK_THRESHOLD_US  超过该等待时间（微秒）才记录调用栈，默认 50
+ *   SST_LOCK_SIGNAL        收到该信号时输出一次报告，例如 12（SIGUSR2），默认不安装
+ *   SST_LOCK_OUT           输出文件前缀，生成 <prefix>.<pid>.<seq>.txt 与 .folded；
+ *                          设置后进程退出时也会输出一次，未设置时信号触发的输出写到 stderr
+ */
+
+/// 记录调用栈的等待时间阈值的默认值（微秒）
+#define SST_LOCK_DEFAULT_THRESHOLD_US 50
+
+/// 输出格式
+typedef enum sst_lock_format {
+    SST_LOCK_REPORT = 0, ///< 文本报告，按累计等待时间从大到小排列，锁与条件变量分开
+    SST_LOCK_FOLDED = 1, ///< folded stacks，根帧为等待类型，值为累计等待纳秒数（可直接用于 flamegraph.pl）
+} sst_lock_format;
+
+/// 统计
+typedef struct sst_lock_stats {
+    uint64_t contended_waits; ///< trylock 失败后进入阻塞路径的加锁次数（不含条件变量）
+    uint64_t contended_ns;    ///< 上述加锁的累计等待时间（纳秒）
+    uint64_t cond_waits;      ///< 条件变量等待次数
+    uint64_t cond_ns;         ///< 条件变量累计等待时间（纳秒）
+    uint64_t sampled_waits;   ///< 超过阈值而记录了调用栈的等待次数
+    uint64_t unique_stacks;   ///< 去重后的栈个数
+    uint64_t dropped_stacks;  ///< 栈表已满而被归入 "[overflow]" 的等待次数
+} sst_lock_stats;
+
+/**
+ * @brief 输出当前的竞争报告
+ * @param file 目标文件流
+ * @param format 输出格式
+ * @return 成功返回 0，失败返回 -1
+ */
+int sst_lock_dump(FILE* file, sst_lock_format format);
+
+/**
+ * @brief 输出当前的竞争报告到文件
+ * @param path 文件路径（覆盖写）
+ * @param format 输出格式
+ * @return 成功返回 0，失败返回 -1
+ */
+int sst_lock_dump_file(const char* path, sst_lock_format format);
+
+/**
+ * @brief 修改记录调用栈的等待时间阈值，立即生效
+ * @param us 阈值（微秒），0 表示记录每一次阻塞等待
+ */
+void sst_lock_set_threshold_us(uint64_t us);
+
+/**
+ * @brief 读取统计
+ * @param out [out] 结果
+ */
+void sst_lock_get_stats(sst_lock_stats* out);
+
+/**
+ * @brief 清空已记录的栈与统计，用于分阶段观察
+ */
+void sst_lock_reset(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SST_LOCK_H
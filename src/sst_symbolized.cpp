@@ -0,0 +1,320 @@
+// sst-symbolized: 本机离线符号化守护进程
+//
+// 业务进程只需要用 resolve_to_raw() 得到 (模块路径 / build-id, 偏移), 通过 Unix domain socket
+// 批量发送给守护进程, 由守护进程加载符号表并返回函数名, 避免在被观测进程中加载与 demangle 符号
+//
+// 用法: sst-symbolized [-s socket_path] [-m cache_mb] [-i stats_interval_sec]
+
+#include "sst_symd_proto.h"
+#include "../include/sst.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <pthread.h>
+#include <unistd.h>
+
+using namespace stacktrace;
+
+namespace {
+
+// 一个模块的只读符号索引, 加载时一次性 demangle, 之后多线程无锁共享
+struct SymbolIndex {
+    std::string build_id;
+    std::vector<Symbol> symbols;
+    std::vector<std::string> names; // 与 symbols 一一对应的 demangled 名
+    size_t bytes = 0;               // 估算的内存占用, 用于 LRU 预算
+
+    SymbolIndex() : build_id(), symbols(), names(), bytes(0) {}
+};
+
+using IndexPtr = std::shared_ptr<const SymbolIndex>;
+
+struct Stats {
+    std::atomic<uint64_t> connections{0};
+    std::atomic<uint64_t> requests{0};
+    std::atomic<uint64_t> frames{0};
+    std::atomic<uint64_t> resolved{0};
+    std::atomic<uint64_t> cache_hits{0};
+    std::atomic<uint64_t> cache_misses{0};
+    std::atomic<uint64_t> evictions{0};
+    std::atomic<uint64_t> build_id_mismatch{0};
+    std::atomic<uint64_t> invalid_files{0};
+};
+
+Stats g_stats;
+
+std::shared_ptr<SymbolIndex> load_index(const std::string& path, const std::string& build_id) {
+    auto idx = std::make_shared<SymbolIndex>();
+    idx->build_id = build_id;
+    // base 为 0: pie/so 得到模块内偏移, no-pie 得到绝对地址, 与 RawFrame::offset 的含义一致
+    idx->symbols = load_symbols(path.c_str(), 0);
+    idx->names.reserve(idx->symbols.size());
+    idx->bytes = sizeof(SymbolIndex) + idx->symbols.capacity() * sizeof(Symbol);
+    for (const auto& sym : idx->symbols) {
+        idx->names.push_back(demangle(sym.name.c_str()));
+        idx->bytes += sym.name.capacity() + idx->names.back().capacity() + sizeof(std::string);
+    }
+    return idx;
+}
+
+// 以 build-id (没有时为 路径 + mtime) 为键的 LRU 缓存, 总内存不超过 budget
+class IndexCache {
+  public:
+    explicit IndexCache(size_t budget) : budget_(budget), used_(0), lru_(), map_(), mu_() {}
+
+    IndexCache(const IndexCache&) = delete;
+    IndexCache& operator=(const IndexCache&) = delete;
+
+    // 查找或加载 path 对应的符号索引, 调用方给出的 build-id 与文件不一致时返回空
+    IndexPtr get(const std::string& path, const std::string& build_id) {
+        std::string key;
+        if (! build_id.empty()) {
+            key = "b:" + build_id;
+        } else {
+            struct stat st;
+            if (stat(path.c_str(), &st) != 0) return nullptr;
+            key = "p:" + path + ":" + std::to_string(st.st_mtime) + "." + std::to_string(st.st_mtim.tv_nsec);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mu_);
+            auto it = map_.find(key);
+            if (it != map_.end()) {
+                lru_.splice(lru_.begin(), lru_, it->second);
+                g_stats.cache_hits++;
+                return it->second->second;
+            }
+        }
+
+        // 在锁外加载, 同一模块的并发加载只会有一份进入缓存
+        g_stats.cache_misses++;
+        // 路径来自客户端, 可能指向任意文件: 不是 ELF 文件时不加载
+        if (! is_elf_file(path.c_str())) {
+            g_stats.invalid_files++;
+            return nullptr;
+        }
+        if (! build_id.empty() && read_build_id(path.c_str()) != build_id) {
+            g_stats.build_id_mismatch++;
+            return nullptr;
+        }
+        IndexPtr idx = load_index(path, build_id);
+
+        std::lock_guard<std::mutex> lock(mu_);
+        auto it = map_.find(key);
+        if (it != map_.end()) return it->second->second;
+
+        lru_.emplace_front(key, idx);
+        map_.emplace(key, lru_.begin());
+        used_ += idx->bytes;
+        // 至少保留刚加载的这一个
+        while (used_ > budget_ && lru_.size() > 1) {
+            auto& victim = lru_.back();
+            used_ -= victim.second->bytes;
+            map_.erase(victim.first);
+            lru_.pop_back();
+            g_stats.evictions++;
+        }
+        return idx;
+    }
+
+    void usage(size_t& used, size_t& entries) {
+        std::lock_guard<std::mutex> lock(mu_);
+        used = used_;
+        entries = lru_.size();
+    }
+
+  private:
+    using Entry = std::pair<std::string, IndexPtr>;
+
+    size_t budget_;
+    size_t used_;
+    std::list<Entry> lru_;
+    std::unordered_map<std::string, std::list<Entry>::iterator> map_;
+    std::mutex mu_;
+};
+
+bool handle_resolve(IndexCache& cache, const sst_symd_header& hdr, const std::string& payload, std::string& out) {
+    symd::Reader in(payload.data(), payload.size());
+
+    uint16_t nmodules = 0;
+    if (! in.get(nmodules)) return false;
+
+    std::vector<IndexPtr> indexes(nmodules);
+    std::string path, build_id;
+    for (uint16_t i = 0; i < nmodules; ++i) {
+        uint16_t path_len = 0;
+        uint8_t id_len = 0;
+        if (! in.get(path_len) || ! in.get(id_len) || ! in.get_bytes(path, path_len) || ! in.get_bytes(build_id, id_len)) {
+            return false;
+        }
+        indexes[i] = cache.get(path, build_id);
+    }
+
+    symd::Writer w(out);
+    uint64_t resolved = 0;
+    for (uint32_t i = 0; i < hdr.count; ++i) {
+        uint16_t module = 0;
+        uint64_t offset = 0;
+        if (! in.get(module) || ! in.get(offset)) return false;
+
+        const SymbolIndex* idx = module < nmodules ? indexes[module].get() : nullptr;
+        const Symbol* sym = idx ? find_symbol(static_cast<uintptr_t>(offset), idx->symbols) : nullptr;
+        if (! sym) {
+            w.put<uint8_t>(module < nmodules && ! idx ? SST_SYMD_BAD_MODULE : SST_SYMD_NOT_FOUND);
+            w.put<uint64_t>(0);
+            w.put<uint16_t>(0);
+            continue;
+        }
+
+        const std::string& name = idx->names[static_cast<size_t>(sym - idx->symbols.data())];
+        uint16_t name_len = static_cast<uint16_t>(std::min<size_t>(name.size(), 0xffff));
+        w.put<uint8_t>(SST_SYMD_FOUND);
+        w.put<uint64_t>(offset - sym->addr);
+        w.put<uint16_t>(name_len);
+        w.put_bytes(name.data(), name_len);
+        ++resolved;
+    }
+
+    g_stats.requests++;
+    g_stats.frames += hdr.count;
+    g_stats.resolved += resolved;
+    return true;
+}
+
+void serve_connection(IndexCache& cache, int fd) {
+    g_stats.connections++;
+    sst_symd_header hdr;
+    std::string payload, out;
+    while (symd::recv_message(fd, hdr, payload)) {
+        if (hdr.type != SST_SYMD_RESOLVE) break;
+        out.clear();
+        if (! handle_resolve(cache, hdr, payload, out)) break;
+        if (! symd::send_message(fd, SST_SYMD_RESULT, hdr.count, out)) break;
+    }
+    close(fd);
+}
+
+void report_stats(IndexCache& cache, unsigned interval) {
+    uint64_t last_frames = 0, last_requests = 0;
+    auto last = std::chrono::steady_clock::now();
+    for (;;) {
+        std::this_thread::sleep_for(std::chrono::seconds(interval));
+        auto now = std::chrono::steady_clock::now();
+        double secs = std::chrono::duration<double>(now - last).count();
+        uint64_t frames = g_stats.frames.load(), requests = g_stats.requests.load();
+        size_t used = 0, entries = 0;
+        cache.usage(used, entries);
+        fprintf(stderr,
+                "[sst-symbolized] %.0f frames/s, %.0f req/s, resolved %lu/%lu, cache %zu modules %.1f MB, hit %lu miss %lu "
+                "evict %lu, invalid %lu, conns %lu\n",
+                static_cast<double>(frames - last_frames) / secs,
+                static_cast<double>(requests - last_requests) / secs,
+                static_cast<unsigned long>(g_stats.resolved.load()),
+                static_cast<unsigned long>(frames),
+                entries,
+                static_cast<double>(used) / (1024.0 * 1024.0),
+                static_cast<unsigned long>(g_stats.cache_hits.load()),
+                static_cast<unsigned long>(g_stats.cache_misses.load()),
+                static_cast<unsigned long>(g_stats.evictions.load()),
+                static_cast<unsigned long>(g_stats.invalid_files.load()),
+                static_cast<unsigned long>(g_stats.connections.load()));
+        last_frames = frames;
+        last_requests = requests;
+        last = now;
+    }
+}
+
+volatile sig_atomic_t g_stop = 0;
+
+void on_signal(int) {
+    g_stop = 1;
+}
+
+// 工作线程屏蔽 SIGINT/SIGTERM, 保证信号总是打断主线程的 accept
+template <typename F, typename... Args>
+void spawn_detached(F&& f, Args&&... args) {
+    sigset_t set, old;
+    sigemptyset(&set);
+    sigaddset(&set, SIGINT);
+    sigaddset(&set, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &set, &old);
+    std::thread(std::forward<F>(f), std::forward<Args>(args)...).detach();
+    pthread_sigmask(SIG_SETMASK, &old, nullptr);
+}
+
+void usage(const char* argv0) {
+    fprintf(stderr, "usage: %s [-s socket_path] [-m cache_mb] [-i stats_interval_sec]\n", argv0);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::string socket_path = SST_SYMD_DEFAULT_SOCKET;
+    size_t cache_mb = 256;
+    unsigned stats_interval = 0;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "s:m:i:h")) != -1) {
+        switch (opt) {
+            case 's': socket_path = optarg; break;
+            case 'm': cache_mb = strtoul(optarg, nullptr, 10); break;
+            case 'i': stats_interval = static_cast<unsigned>(strtoul(optarg, nullptr, 10)); break;
+            default: usage(argv[0]); return 1;
+        }
+    }
+
+    sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (socket_path.size() >= sizeof(addr.sun_path)) {
+        fprintf(stderr, "socket path too long: %s\n", socket_path.c_str());
+        return 1;
+    }
+    memcpy(addr.sun_path, socket_path.c_str(), socket_path.size() + 1);
+
+    int listen_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    unlink(socket_path.c_str());
+    if (listen_fd < 0 || bind(listen_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 || listen(listen_fd, 128) != 0) {
+        perror("sst-symbolized");
+        return 1;
+    }
+
+    // 不带 SA_RESTART, 让 accept 被信号打断后退出并清理 socket 文件
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = on_signal;
+    sigaction(SIGINT, &sa, nullptr);
+    sigaction(SIGTERM, &sa, nullptr);
+    signal(SIGPIPE, SIG_IGN);
+
+    IndexCache cache(cache_mb << 20);
+    if (stats_interval > 0) {
+        spawn_detached(report_stats, std::ref(cache), stats_interval);
+    }
+    fprintf(stderr, "[sst-symbolized] listening on %s, cache budget %zu MB\n", socket_path.c_str(), cache_mb);
+
+    while (! g_stop) {
+        int fd = accept4(listen_fd, nullptr, nullptr, SOCK_CLOEXEC);
+        if (fd < 0) continue;
+        // 每个连接一个线程, 连接通常是长连接且数量不多
+        spawn_detached(serve_connection, std::ref(cache), fd);
+    }
+
+    close(listen_fd);
+    unlink(socket_path.c_str());
+    return 0;
+}
@@ -0,0 +1,143 @@
+#ifndef SST_SYMD_PROTO_H
+#define SST_SYMD_PROTO_H
+
+// sst-symbolized 与客户端之间的二进制协议 (Unix domain socket, 仅限本机, 使用主机字节序)
+//
+// 每条消息 = sst_symd_header + payload
+//
+// SST_SYMD_RESOLVE (客户端 -> 守护进程), count 为帧数:
+//   uint16_t nmodules
+//   nmodules x { uint16_t path_len; uint8_t build_id_len; char path[path_len]; uint8_t build_id[build_id_len]; }
+//   count    x { uint16_t module; uint64_t offset; }      module == SST_SYMD_NO_MODULE 表示未知模块
+//
+// SST_SYMD_RESULT (守护进程 -> 客户端), 与请求一一对应:
+//   count    x { uint8_t status; uint64_t sym_offset; uint16_t name_len; char name[name_len]; }
+//   status: SST_SYMD_FOUND 找到符号; SST_SYMD_NOT_FOUND 没有覆盖该偏移的符号;
+//           SST_SYMD_BAD_MODULE 模块文件无法打开、不是合法的 ELF 文件或 build-id 不一致
+//
+// offset 与 resolve_to_raw() 的 RawFrame::offset 含义相同: pie/so 为模块内偏移, no-pie 为绝对地址
+
+#include <stdint.h>
+
+#define SST_SYMD_MAGIC 0x44545353u // "SSTD"
+#define SST_SYMD_VERSION 2 // 2: sym_offset 由 uint32_t 改为 uint64_t
+#define SST_SYMD_RESOLVE 1
+#define SST_SYMD_RESULT 2
+#define SST_SYMD_NO_MODULE 0xffffu
+#define SST_SYMD_NOT_FOUND 0
+#define SST_SYMD_FOUND 1
+#define SST_SYMD_BAD_MODULE 2
+#define SST_SYMD_MAX_PAYLOAD (16u << 20)
+#define SST_SYMD_DEFAULT_SOCKET "/tmp/sst-symbolized.sock"
+
+typedef struct sst_symd_header {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t type;
+    uint32_t count;
+    uint32_t payload_len;
+} sst_symd_header;
+
+#ifdef __cplusplus
+
+#include <cerrno>
+#include <cstring>
+#include <string>
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace symd {
+
+class Writer {
+  public:
+    explicit Writer(std::string& buf) : buf_(buf) {}
+
+    template <typename T>
+    void put(T v) {
+        buf_.append(reinterpret_cast<const char*>(&v), sizeof(v));
+    }
+
+    void put_bytes(const char* p, size_t n) {
+        buf_.append(p, n);
+    }
+
+  private:
+    std::string& buf_;
+};
+
+class Reader {
+  public:
+    Reader(const char* p, size_t n) : p_(p), end_(p + n) {}
+
+    template <typename T>
+    bool get(T& v) {
+        if (static_cast<size_t>(end_ - p_) < sizeof(T)) return false;
+        memcpy(&v, p_, sizeof(T));
+        p_ += sizeof(T);
+        return true;
+    }
+
+    bool get_bytes(std::string& out, size_t n) {
+        if (static_cast<size_t>(end_ - p_) < n) return false;
+        out.assign(p_, n);
+        p_ += n;
+        return true;
+    }
+
+  private:
+    const char* p_;
+    const char* end_;
+};
+
+// 对端已关闭时返回 false 而不是触发 SIGPIPE: 客户端嵌在被观测的进程里, 不能因守护进程退出而被杀死
+inline bool write_all(int fd, const char* p, size_t n) {
+    while (n > 0) {
+        ssize_t w = ::send(fd, p, n, MSG_NOSIGNAL);
+        if (w < 0 && errno == EINTR) continue;
+        if (w <= 0) return false;
+        p += w;
+        n -= static_cast<size_t>(w);
+    }
+    return true;
+}
+
+inline bool read_all(int fd, char* p, size_t n) {
+    while (n > 0) {
+        ssize_t r = ::read(fd, p, n);
+        if (r < 0 && errno == EINTR) continue;
+        if (r <= 0) return false;
+        p += r;
+        n -= static_cast<size_t>(r);
+    }
+    return true;
+}
+
+// 发送一条完整的消息
+inline bool send_message(int fd, uint16_t type, uint32_t count, const std::string& payload) {
+    sst_symd_header hdr;
+    hdr.magic = SST_SYMD_MAGIC;
+    hdr.version = SST_SYMD_VERSION;
+    hdr.type = type;
+    hdr.count = count;
+    hdr.payload_len = static_cast<uint32_t>(payload.size());
+    std::string msg(reinterpret_cast<const char*>(&hdr), sizeof(hdr));
+    msg += payload;
+    return write_all(fd, msg.data(), msg.size());
+}
+
+// 接收一条完整的消息, 校验 magic/version/长度上限
+inline bool recv_message(int fd, sst_symd_header& hdr, std::string& payload) {
+    if (! read_all(fd, reinterpret_cast<char*>(&hdr), sizeof(hdr))) return false;
+    if (hdr.magic != SST_SYMD_MAGIC || hdr.version != SST_SYMD_VERSION || hdr.payload_len > SST_SYMD_MAX_PAYLOAD) {
+        return false;
+    }
+    payload.resize(hdr.payload_len);
+    return hdr.payload_len == 0 || read_all(fd, &payload[0], hdr.payload_len);
+}
+
+} // namespace symd
+
+#endif // __cplusplus
+
+#endif // SST_SYMD_PROTO_H
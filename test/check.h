@@ -0,0 +1,15 @@
+// 测试共用的断言: CHECK 失败时打印位置并计数, 不中止, main 最后按 g_failures 决定退出码
+
+#pragma once
+
+#include <cstdio>
+
+static int g_failures = 0;
+
+#define CHECK(cond) \
+    do { \
+        if (! (cond)) { \
+            fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #cond); \
+            ++g_failures; \
+        } \
+    } while (0)
@@ -0,0 +1,226 @@
+// 验证: AsyncResolver 在后台线程中解析并按入队顺序交付; 同一批中相同的地址只解析一次;
+// 队列满时三种策略 (丢弃 / 等待 / 只给出地址) 的行为; 多生产者; dlopen 之后重新加载模块表
+
+#include "../include/sst_async.hpp"
+#include "check.h"
+
+#include <cstdio>
+#include <cstring>
+
+#include <dlfcn.h>
+#include <link.h>
+
+using stacktrace::AsyncOverflow;
+using stacktrace::AsyncResolver;
+using stacktrace::AsyncResolverOptions;
+using stacktrace::AsyncResolverStats;
+using stacktrace::AsyncResult;
+using stacktrace::AsyncStatus;
+using stacktrace::Stacktrace;
+
+__attribute__((noinline)) static Stacktrace async_marker() {
+    Stacktrace st = Stacktrace::capture();
+    asm volatile("" ::: "memory");
+    return st;
+}
+
+static bool has_marker(const AsyncResult& r) {
+    for (const auto& f : r.frames) {
+        if (f.function == "async_marker()") return true;
+    }
+    return false;
+}
+
+// 第一个栈的回调停在 gate 上, 使之后提交的栈留在队列中
+struct Gate {
+    std::promise<void> open;
+    std::shared_future<void> opened;
+    std::promise<void> entered;
+
+    Gate() : open(), opened(open.get_future().share()), entered() {}
+
+    AsyncResolver::Callback hold() {
+        return [this](const AsyncResult&) {
+            entered.set_value();
+            opened.wait();
+        };
+    }
+};
+
+static void test_resolve_and_order() {
+    AsyncResolver resolver;
+    Stacktrace st = async_marker();
+    std::vector<int> order;
+    std::vector<AsyncResult> results;
+    for (int i = 0; i < 20; ++i) {
+        CHECK(resolver.submit(st, [&order, &results, i](const AsyncResult& r) {
+            order.push_back(i);
+            results.push_back(r);
+        }));
+    }
+    std::future<AsyncResult> f = resolver.submit(st);
+    resolver.flush();
+    CHECK(order.size() == 20);
+    for (size_t i = 0; i < order.size(); ++i) CHECK(order[i] == static_cast<int>(i));
+    for (const auto& r : results) {
+        CHECK(r.status == AsyncStatus::Resolved && r.frames.size() == st.size() && has_marker(r));
+    }
+    CHECK(f.wait_for(std::chrono::seconds(0)) == std::future_status::ready);
+    AsyncResult fr = f.get();
+    CHECK(fr.status == AsyncStatus::Resolved && has_marker(fr));
+    CHECK(! results.empty() && results[0].to_string() == fr.to_string());
+    for (size_t i = 0; i < fr.frames.size(); ++i) {
+        CHECK(fr.frames[i].index == i && fr.frames[i].abs_addr == reinterpret_cast<uintptr_t>(st.addresses()[i]));
+    }
+
+    AsyncResolverStats s = resolver.stats();
+    CHECK(s.submitted == 21 && s.delivered == 21 && s.dropped == 0 && s.frames == 21 * st.size());
+}
+
+static void test_batch_dedup() {
+    AsyncResolverOptions options;
+    options.capacity = 256;
+    Gate gate; // 在 resolver 之后析构
+    AsyncResolver resolver(options);
+    Stacktrace st = async_marker();
+    resolver.submit(st, gate.hold());
+    gate.entered.get_future().wait();
+    size_t done = 0;
+    for (int i = 0; i < 100; ++i) resolver.submit(st, [&done](const AsyncResult&) { ++done; });
+    uint64_t lookups = resolver.stats().lookups;
+    gate.open.set_value();
+    resolver.flush();
+    AsyncResolverStats s = resolver.stats();
+    CHECK(done == 100);
+    // 积压的 100 个栈在一批中取出, 相同的地址只解析一次
+    CHECK(s.batches == 2);
+    CHECK(s.lookups - lookups <= st.size());
+}
+
+static void test_overflow(AsyncOverflow policy) {
+    AsyncResolverOptions options;
+    options.capacity = 4;
+    options.overflow = policy;
+    Gate gate; // 在 resolver 之后析构
+    AsyncResolver resolver(options);
+    Stacktrace st = async_marker();
+    resolver.submit(st, gate.hold());
+    gate.entered.get_future().wait(); // 槽位已归还, 队列为空
+    for (int i = 0; i < 4; ++i) CHECK(resolver.submit(st, nullptr));
+
+    AsyncResult overflowed;
+    bool called = false;
+    auto on_overflow = [&](const AsyncResult& r) {
+        overflowed = r;
+        called = true;
+    };
+    if (policy == AsyncOverflow::Block) {
+        std::atomic<bool> queued(false);
+        std::thread t([&] { queued = resolver.submit(st, on_overflow); });
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        CHECK(! queued.load());
+        gate.open.set_value();
+        t.join();
+        CHECK(queued.load());
+        resolver.flush();
+        CHECK(called && overflowed.status == AsyncStatus::Resolved && has_marker(overflowed));
+        CHECK(resolver.stats().blocked == 1);
+        return;
+    }
+
+    CHECK(! resolver.submit(st, on_overflow));
+    CHECK(called); // 在提交线程中立即交付
+    if (policy == AsyncOverflow::Drop) {
+        CHECK(overflowed.status == AsyncStatus::Dropped && overflowed.frames.empty());
+        CHECK(resolver.stats().dropped == 1);
+    } else {
+        CHECK(overflowed.status == AsyncStatus::RawAddresses && overflowed.frames.size() == st.size());
+        for (size_t i = 0; i < overflowed.frames.size(); ++i) {
+            CHECK(! overflowed.frames[i].has_symbol && overflowed.frames[i].abs_addr == reinterpret_cast<uintptr_t>(st.addresses()[i]));
+        }
+        CHECK(resolver.stats().degraded == 1);
+    }
+    std::future<AsyncResult> f = resolver.submit(st);
+    CHECK(f.wait_for(std::chrono::seconds(0)) == std::future_status::ready);
+    gate.open.set_value();
+}
+
+static void test_producers() {
+    AsyncResolverOptions options;
+    options.capacity = 64;
+    options.overflow = AsyncOverflow::Block;
+    AsyncResolver resolver(options);
+    const int kThreads = 4, kPerThread = 2000;
+    std::atomic<int> resolved(0);
+    std::vector<int> last(kThreads, -1);
+    std::atomic<int> out_of_order(0);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&, t] {
+            Stacktrace st = async_marker();
+            for (int i = 0; i < kPerThread; ++i) {
+                resolver.submit(st, [&, t, i](const AsyncResult& r) {
+                    if (r.status == AsyncStatus::Resolved && has_marker(r)) ++resolved;
+                    if (last[static_cast<size_t>(t)] >= i) ++out_of_order;
+                    last[static_cast<size_t>(t)] = i;
+                });
+            }
+        });
+    }
+    for (auto& t : threads) t.join();
+    resolver.flush();
+    CHECK(resolved.load() == kThreads * kPerThread);
+    CHECK(out_of_order.load() == 0);
+    CHECK(resolver.stats().lookups < resolver.stats().frames);
+}
+
+// 新加载的 libresolv 的代码段中的一个地址 (其中的符号大多转发到 libc, 不能用 dlsym)
+static void* libresolv_text() {
+    void* addr = nullptr;
+    dl_iterate_phdr(
+        [](struct dl_phdr_info* info, size_t, void* data) {
+            if (! info->dlpi_name || ! strstr(info->dlpi_name, "libresolv")) return 0;
+            for (int i = 0; i < info->dlpi_phnum; ++i) {
+                const ElfW(Phdr)& ph = info->dlpi_phdr[i];
+                if (ph.p_type == PT_LOAD && (ph.p_flags & PF_X) && ph.p_memsz > 16) {
+                    *static_cast<void**>(data) = reinterpret_cast<void*>(info->dlpi_addr + ph.p_vaddr + 16);
+                    return 1;
+                }
+            }
+            return 0;
+        },
+        &addr);
+    return addr;
+}
+
+static void test_dlopen() {
+    AsyncResolver resolver;
+    resolver.submit(async_marker(), nullptr);
+    resolver.flush(); // 后台线程已加载模块表
+    void* h = dlopen("libresolv.so.2", RTLD_NOW | RTLD_LOCAL);
+    if (! h) {
+        fprintf(stderr, "test_async: skip dlopen case (%s)\n", dlerror());
+        return;
+    }
+    void* addrs[1] = {libresolv_text()};
+    CHECK(addrs[0] != nullptr);
+    AsyncResult r;
+    resolver.submit(addrs, 1, [&r](const AsyncResult& res) { r = res; });
+    resolver.flush();
+    CHECK(r.frames.size() == 1 && r.frames[0].module.find("libresolv") != std::string::npos);
+    CHECK(resolver.stats().module_reloads == 1);
+    dlclose(h);
+}
+
+int main() {
+    test_resolve_and_order();
+    test_batch_dedup();
+    test_overflow(AsyncOverflow::Drop);
+    test_overflow(AsyncOverflow::RawAddresses);
+    test_overflow(AsyncOverflow::Block);
+    test_producers();
+    test_dlopen();
+
+    if (g_failures == 0) printf("test_async: OK\n");
+    return g_failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,223 @@
+// 验证: CallTree 的 self / total 计数与权重; 节点上限下的截断; merge 与逐条 add 结果一致;
+// folded 输出包含符号化后的调用路径; pprof 输出可按 profile.proto 解析且引用的 id 都存在
+
+#include "../include/sst_calltree.hpp"
+#include "check.h"
+
+#include <cstdio>
+#include <set>
+#include <sstream>
+
+using stacktrace::CallTree;
+using stacktrace::CallTreeStats;
+
+static void* addr(uintptr_t a) {
+    return reinterpret_cast<void*>(a);
+}
+
+static const CallTree::Node* find_path(const CallTree& tree, std::vector<uintptr_t> path) {
+    uint32_t cur = 0;
+    for (uintptr_t a : path) {
+        uint32_t c = tree.nodes()[cur].first_child;
+        while (c != CallTree::kNone && tree.nodes()[c].addr != a) {
+            c = tree.nodes()[c].next_sibling;
+        }
+        if (c == CallTree::kNone) return nullptr;
+        cur = c;
+    }
+    return &tree.nodes()[cur];
+}
+
+// 与 A -> B -> {C, D} 对应的样本 (栈顶在前)
+static void add_samples(CallTree& tree, int part) {
+    void* cba[] = {addr(0xc), addr(0xb), addr(0xa)};
+    void* dba[] = {addr(0xd), addr(0xb), addr(0xa)};
+    void* ba[] = {addr(0xb), addr(0xa)};
+    if (part != 2) {
+        for (int i = 0; i < 3; ++i) {
+            tree.add(cba, 3, 10);
+        }
+    }
+    if (part != 1) {
+        tree.add(dba, 3, 5);
+        tree.add(ba, 2, 1);
+    }
+}
+
+static void check_synthetic(const CallTree& tree) {
+    CHECK(tree.stats().samples == 5);
+    CHECK(tree.stats().nodes == 4);
+    CHECK(tree.root().total_count == 5);
+    CHECK(tree.root().total_weight == 36);
+    const CallTree::Node* a = find_path(tree, {0xa});
+    const CallTree::Node* b = find_path(tree, {0xa, 0xb});
+    const CallTree::Node* c = find_path(tree, {0xa, 0xb, 0xc});
+    const CallTree::Node* d = find_path(tree, {0xa, 0xb, 0xd});
+    CHECK(a && a->self_count == 0 && a->total_count == 5 && a->total_weight == 36);
+    CHECK(b && b->self_count == 1 && b->self_weight == 1 && b->total_weight == 36);
+    CHECK(c && c->self_count == 3 && c->self_weight == 30 && c->total_count == 3);
+    CHECK(d && d->self_count == 1 && d->self_weight == 5);
+}
+
+// 只解析本测试需要的部分: 顶层字段与 Sample / Location 中的 id
+struct Reader {
+    const std::string& buf;
+    size_t pos;
+    size_t end;
+
+    bool done() const {
+        return pos >= end;
+    }
+
+    uint64_t varint() {
+        uint64_t v = 0;
+        for (int shift = 0; pos < end; shift += 7) {
+            uint8_t b = static_cast<uint8_t>(buf[pos++]);
+            v |= static_cast<uint64_t>(b & 0x7f) << shift;
+            if (! (b & 0x80)) break;
+        }
+        return v;
+    }
+
+    // 返回字段号, wire type 2 时 sub 为子消息范围, 0 时 value 为值
+    uint32_t field(Reader& sub, uint64_t& value) {
+        uint64_t tag = varint();
+        if ((tag & 7) == 2) {
+            size_t len = static_cast<size_t>(varint());
+            sub.pos = pos;
+            sub.end = pos + len;
+            pos += len;
+        } else {
+            value = varint();
+        }
+        return static_cast<uint32_t>(tag >> 3);
+    }
+};
+
+__attribute__((noinline)) static void level_three(CallTree& tree, uint64_t w) {
+    tree.add(stacktrace::Stacktrace::capture(), w);
+}
+
+__attribute__((noinline)) static void level_two(CallTree& tree, uint64_t w) {
+    level_three(tree, w);
+    __asm__ volatile("" ::: "memory");
+}
+
+__attribute__((noinline)) static void level_one(CallTree& tree, uint64_t w) {
+    level_two(tree, w);
+    __asm__ volatile("" ::: "memory");
+}
+
+int main() {
+    CallTree tree;
+    add_samples(tree, 0);
+    check_synthetic(tree);
+
+    // merge 与逐条 add 等价
+    CallTree part1, part2, merged;
+    add_samples(part1, 1);
+    add_samples(part2, 2);
+    merged.merge(part1);
+    merged.merge(part2);
+    check_synthetic(merged);
+
+    // 节点上限: 只保留 A, B, 更深的路径截断到 B
+    CallTree small("weight", "count", 2);
+    add_samples(small, 0);
+    CallTreeStats st = small.stats();
+    CHECK(st.nodes == 2);
+    CHECK(st.truncated == 4);
+    const CallTree::Node* b = find_path(small, {0xa, 0xb});
+    CHECK(b && b->self_count == 5 && b->self_weight == 36 && b->total_weight == 36);
+
+    // 截断的树合并进有上限的树时, self 挂到最深的已有节点上
+    CallTree small2("weight", "count", 1);
+    small2.merge(tree);
+    const CallTree::Node* a = find_path(small2, {0xa});
+    CHECK(small2.stats().nodes == 1);
+    CHECK(a && a->self_weight == 36 && a->total_weight == 36);
+    CHECK(small2.root().total_weight == 36);
+
+    // 真实的栈: folded 与 pprof
+    CallTree real("alloc_space", "bytes");
+    volatile int repeat = 4;
+    for (int i = 0; i < repeat; ++i) {
+        level_one(real, 100);
+    }
+    level_two(real, 7);
+
+    std::ostringstream folded;
+    real.write_folded(folded);
+    printf("%s", folded.str().c_str());
+    CHECK(folded.str().find("main;level_one") != std::string::npos);
+    CHECK(folded.str().find(";level_two(stacktrace::CallTree&,_unsigned_long);level_three") != std::string::npos);
+    CHECK(folded.str().find(" 400\n") != std::string::npos);
+    CHECK(folded.str().find(" 7\n") != std::string::npos);
+
+    std::string proto = real.to_pprof();
+    Reader r{proto, 0, proto.size()};
+    std::vector<std::string> strings;
+    std::set<uint64_t> location_ids, referenced_locations, function_ids, referenced_functions;
+    int sample_types = 0, samples = 0;
+    uint64_t total_bytes = 0;
+    while (! r.done()) {
+        Reader sub{proto, 0, 0};
+        uint64_t value = 0;
+        uint32_t f = r.field(sub, value);
+        if (f == 1) {
+            sample_types++;
+        } else if (f == 2) {
+            samples++;
+            while (! sub.done()) {
+                Reader packed{proto, 0, 0};
+                uint32_t sf = sub.field(packed, value);
+                std::vector<uint64_t> values;
+                while (! packed.done()) {
+                    values.push_back(packed.varint());
+                }
+                if (sf == 1) referenced_locations.insert(values.begin(), values.end());
+                if (sf == 2 && values.size() == 2) total_bytes += values[1];
+            }
+        } else if (f == 4) {
+            while (! sub.done()) {
+                Reader line{proto, 0, 0};
+                uint32_t lf = sub.field(line, value);
+                if (lf == 1) location_ids.insert(value);
+                while (lf == 4 && ! line.done()) {
+                    Reader unused{proto, 0, 0};
+                    if (line.field(unused, value) == 1) referenced_functions.insert(value);
+                }
+            }
+        } else if (f == 5) {
+            while (! sub.done()) {
+                Reader unused{proto, 0, 0};
+                if (sub.field(unused, value) == 1) function_ids.insert(value);
+            }
+        } else if (f == 6) {
+            strings.push_back(proto.substr(sub.pos, sub.end - sub.pos));
+        }
+    }
+    CHECK(sample_types == 2);
+    CHECK(samples == 2);
+    CHECK(total_bytes == 407);
+    CHECK(! strings.empty() && strings[0].empty());
+    CHECK(std::find(strings.begin(), strings.end(), "alloc_space") != strings.end());
+    bool has_level_two = false;
+    for (const auto& s : strings) {
+        has_level_two = has_level_two || s.find("level_two") != std::string::npos;
+    }
+    CHECK(has_level_two);
+    for (uint64_t id : referenced_locations) {
+        CHECK(location_ids.count(id) == 1);
+    }
+    for (uint64_t id : referenced_functions) {
+        CHECK(function_ids.count(id) == 1);
+    }
+
+    if (g_failures) {
+        fprintf(stderr, "test_calltree: %d failure(s)\n", g_failures);
+        return 1;
+    }
+    printf("test_calltree: OK\n");
+    return 0;
+}
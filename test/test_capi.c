@@ -1,5 +1,7 @@
 #include "../src/sst.h"
 
+#include <string.h>
+
 int main() {
     sst_backtrace bt;
     sst_capture(&bt);
@@ -21,6 +23,57 @@ int main() {
                raw[i].module ?: "<unknown>");
     }
 
+    // Encode into the compact record format and decode it back
+    sst_record_writer* w = sst_record_writer_new();
+    uint64_t fp = sst_record_write(w, raw, bt.size);
+    size_t len = 0;
+    const void* data = sst_record_writer_data(w, &len);
+
+    sst_record_reader* r = sst_record_reader_new();
+    sst_record_feed(r, data, len);
+    sst_raw_frame decoded[SST_MAX_FRAMES];
+    size_t n = 0;
+    uint64_t decoded_fp = 0;
+    int ok = sst_record_next(r, decoded, SST_MAX_FRAMES, &n, &decoded_fp) == 1 && n == bt.size && decoded_fp == fp;
+    for (size_t i = 0; ok && i < n; ++i) {
+        ok = decoded[i].offset == raw[i].offset || ! raw[i].has_symbol;
+    }
+    printf("record: %zu bytes, fingerprint %016llx, round trip %s\n", len, (unsigned long long)fp, ok ? "ok" : "FAILED");
+
+    // Demangle into a caller buffer, full and simplified
+    char name[128];
+    size_t name_len = sst_demangle("_ZN2ns3FooIiE3barEv", name, sizeof(name), 1);
+    ok = ok && name_len == strlen("ns::Foo<...>::bar()") && memcmp(name, "ns::Foo<...>::bar()", name_len) == 0;
+    name_len = sst_demangle("_ZN2ns3FooIiE3barEv", name, sizeof(name), 0);
+    ok = ok && name_len == strlen("ns::Foo<int>::bar()") && memcmp(name, "ns::Foo<int>::bar()", name_len) == 0;
+    printf("demangle: %.*s\n", (int)name_len, name);
+
+    // Submit stacks to the async queue and poll the resolved results
+    sst_async* q = sst_async_new(64, SST_ASYNC_DROP);
+    uint64_t t1 = sst_async_submit(q);
+    uint64_t t2 = sst_async_submit_addrs(q, pcs, bt.size);
+    sst_async_flush(q);
+    sst_backtrace async_bt;
+    uint64_t ticket = 0;
+    sst_async_status status = SST_ASYNC_RAW_ADDRESSES;
+    int polled = 0;
+    ok = ok && t1 != 0 && t2 != 0 && t1 != t2;
+    while (sst_async_poll(q, &ticket, &status, &async_bt)) {
+        ok = ok && status == SST_ASYNC_RESOLVED && ticket == (polled == 0 ? t1 : t2) && async_bt.size > 0;
+        if (ticket == t2) {
+            ok = ok && async_bt.size == bt.size && strcmp(async_bt.frames[0].function, bt.frames[0].function) == 0;
+        }
+        ++polled;
+    }
+    sst_async_stats st;
+    sst_async_get_stats(q, &st);
+    ok = ok && polled == 2 && st.submitted == 2 && st.resolved == 2 && st.pending == 0;
+    printf("async: %d results polled, top frame %s\n", polled, async_bt.frames[0].function);
+    sst_async_free(q);
+
+    sst_free_raw_frames(decoded, n);
+    sst_record_reader_free(r);
+    sst_record_writer_free(w);
     sst_free_raw_frames(raw, bt.size); // Free allocated module strings
-    return 0;
+    return ok ? 0 : 1;
 }
@@ -0,0 +1,284 @@
+// 验证: 子进程通过命名共享内存写入栈, 父进程只凭通道中的模块事件离线符号化;
+// memfd 通道可经 /proc/<pid>/fd 打开; 队列满时丢弃并计数; dlopen / dlclose 作为模块事件出现在引用它的栈之前;
+// 多个线程同时写入引用新 dlopen 模块的栈时, 每个这样的栈都排在模块加载事件之后;
+// 多个生产者线程并发写入时, 每个线程的记录按写入顺序被完整读出
+
+#include "../include/sst_channel.hpp"
+#include "check.h"
+
+#include <cstdio>
+#include <thread>
+
+#include <dlfcn.h>
+#include <link.h>
+#include <sys/wait.h>
+
+using stacktrace::ChannelModule;
+using stacktrace::ChannelStack;
+using stacktrace::ChannelSymbolizer;
+using stacktrace::ResolvedFrame;
+using stacktrace::StackChannelReader;
+using stacktrace::StackChannelWriter;
+using stacktrace::Stacktrace;
+
+__attribute__((noinline)) static bool channel_marker(StackChannelWriter& ch) {
+    bool ok = ch.write(Stacktrace::capture());
+    asm volatile("" ::: "memory");
+    return ok;
+}
+
+static bool has_function(const std::vector<ResolvedFrame>& frames, const char* name) {
+    for (const auto& f : frames) {
+        if (f.function.find(name) != std::string::npos) return true;
+    }
+    return false;
+}
+
+// 子进程写入 3 个栈后退出, 父进程在子进程退出之后读取并符号化
+static void test_cross_process() {
+    char name[64];
+    snprintf(name, sizeof(name), "/sst-test-channel-%d", getpid());
+    int ready[2], done[2];
+    CHECK(pipe(ready) == 0 && pipe(done) == 0);
+    pid_t child = fork();
+    if (child == 0) {
+        ssize_t w, r;
+        {
+            StackChannelWriter ch;
+            char ok = ch.create(name, 64) ? 1 : 0;
+            for (int i = 0; i < 3; ++i) ok = ok && channel_marker(ch);
+            w = ::write(ready[1], &ok, 1);
+            char c;
+            r = ::read(done[0], &c, 1); // 父进程打开之后才析构 (shm_unlink)
+        }
+        _exit(w == 1 && r == 1 ? 0 : 1);
+    }
+    char ok = 0;
+    CHECK(::read(ready[0], &ok, 1) == 1 && ok == 1);
+    StackChannelReader rd;
+    CHECK(rd.open(name));
+    CHECK(rd.pid() == child);
+    char c = 1;
+    CHECK(::write(done[1], &c, 1) == 1);
+    int status = 0;
+    CHECK(waitpid(child, &status, 0) == child && WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    CHECK(! StackChannelReader().open(name)); // 写端析构时已 shm_unlink
+
+    ChannelSymbolizer sym(rd.pid());
+    size_t stacks = 0, modules = 0, marked = 0;
+    bool self_has_build_id = false;
+    rd.poll(
+        [&](const ChannelStack& s) {
+            ++stacks;
+            CHECK(s.tid == child);
+            CHECK(s.depth > 2 && s.timestamp_ns > 0);
+            if (has_function(sym.resolve(s), "channel_marker")) ++marked;
+        },
+        [&](const ChannelModule& m) {
+            CHECK(stacks == 0); // 初始模块表在所有栈之前
+            CHECK(m.loaded && m.size > 0 && ! m.path.empty());
+            if (m.path.find("test_channel") != std::string::npos) self_has_build_id = ! m.build_id.empty();
+            ++modules;
+            sym.on_module(m);
+        });
+    CHECK(stacks == 3 && marked == 3);
+    CHECK(modules > 1 && sym.module_count() == modules);
+    CHECK(self_has_build_id);
+    CHECK(sym.build_id_mismatches() == 0);
+    close(ready[0]);
+    close(ready[1]);
+    close(done[0]);
+    close(done[1]);
+}
+
+static void test_memfd_and_overflow() {
+    StackChannelWriter ch;
+    CHECK(ch.create_memfd(64));
+    char path[64];
+    snprintf(path, sizeof(path), "/proc/%d/fd/%d", getpid(), ch.fd());
+    StackChannelReader rd;
+    CHECK(rd.open_path(path));
+    CHECK(rd.pid() == getpid());
+    CHECK(! StackChannelReader().open_path("/proc/self/exe")); // 不是通道
+
+    size_t modules = rd.poll([](const ChannelStack&) {}, [](const ChannelModule&) {});
+    CHECK(modules > 0 && rd.stats().consumed == modules);
+
+    void* frames[100];
+    for (size_t i = 0; i < 100; ++i) frames[i] = reinterpret_cast<void*>(&channel_marker);
+    size_t accepted = 0;
+    for (int i = 0; i < 100; ++i) accepted += ch.write(frames, 100) ? 1 : 0;
+    CHECK(accepted == 64);
+    CHECK(ch.stats().dropped == 36 && ch.stats().capacity == 64);
+
+    size_t stacks = 0;
+    CHECK(rd.poll([&](const ChannelStack& s) { stacks += s.depth == stacktrace::channel::kMaxDepth ? 1 : 0; },
+                  [](const ChannelModule&) {}, 10) == 10);
+    CHECK(ch.write(frames, 3)); // 读走之后又有空位
+    rd.poll([&](const ChannelStack& s) { stacks += s.depth == stacktrace::channel::kMaxDepth || s.depth == 3 ? 1 : 0; },
+            [](const ChannelModule&) {});
+    CHECK(stacks == 65);
+    CHECK(rd.stats().consumed == rd.stats().written);
+}
+
+static void test_dlopen() {
+    StackChannelWriter ch;
+    CHECK(ch.create_memfd(256));
+    StackChannelReader rd;
+    CHECK(rd.open_fd(ch.fd()));
+    rd.poll([](const ChannelStack&) {}, [](const ChannelModule&) {});
+
+    void* lib = dlopen("libresolv.so.2", RTLD_NOW | RTLD_LOCAL);
+    if (! lib) {
+        fprintf(stderr, "test_channel: skip dlopen case (%s)\n", dlerror());
+        return;
+    }
+    void* sym = dlsym(lib, "__res_init");
+    if (! sym) sym = dlsym(lib, "res_init");
+    bool in_lib = false;
+    if (sym) {
+        // 引用新模块的栈之前会先自动写入它的加载事件
+        void* frames[2] = {sym, reinterpret_cast<void*>(&channel_marker)};
+        CHECK(ch.write(frames, 2));
+        rd.poll([&](const ChannelStack&) { CHECK(in_lib); },
+                [&](const ChannelModule& m) { in_lib = in_lib || (m.loaded && m.path.find("libresolv") != std::string::npos); });
+        CHECK(in_lib);
+    }
+    CHECK(ch.sync_modules() == (sym ? 0u : 1u));
+    dlclose(lib);
+    bool unloaded = false;
+    if (ch.sync_modules() > 0) {
+        rd.poll([](const ChannelStack&) {}, [&](const ChannelModule& m) { unloaded = unloaded || (! m.loaded && m.path.find("libresolv") != std::string::npos); });
+        CHECK(unloaded);
+    }
+}
+
+// 新加载的 libresolv 的代码段中的一个地址 (其中的符号大多转发到 libc, 不能用 dlsym)
+static void* libresolv_text() {
+    void* addr = nullptr;
+    dl_iterate_phdr(
+        [](struct dl_phdr_info* info, size_t, void* data) {
+            if (! info->dlpi_name || ! strstr(info->dlpi_name, "libresolv")) return 0;
+            for (int i = 0; i < info->dlpi_phnum; ++i) {
+                const ElfW(Phdr)& ph = info->dlpi_phdr[i];
+                if (ph.p_type == PT_LOAD && (ph.p_flags & PF_X) && ph.p_memsz > 16) {
+                    *static_cast<void**>(data) = reinterpret_cast<void*>(info->dlpi_addr + ph.p_vaddr + 16);
+                    return 1;
+                }
+            }
+            return 0;
+        },
+        &addr);
+    return addr;
+}
+
+// dlopen 之后多个线程同时写入引用新模块的栈: 没抢到同步的线程也必须等到加载事件写入之后才写栈
+// 每一轮重新 dlopen / dlclose, 多跑几轮以覆盖不同的线程交错
+static void test_dlopen_threads() {
+    const int kRounds = 20, kThreads = 4, kPerThread = 100;
+    StackChannelWriter ch;
+    CHECK(ch.create_memfd(4096));
+    StackChannelReader rd;
+    CHECK(rd.open_fd(ch.fd()));
+    rd.poll([](const ChannelStack&) {}, [](const ChannelModule&) {});
+
+    uint64_t stacks = 0, early = 0;
+    uintptr_t lo = 0, hi = 0;
+    auto on_stack = [&](const ChannelStack& s) {
+        ++stacks;
+        if (s.depth != 2 || s.addrs[0] < lo || s.addrs[0] >= hi) ++early;
+    };
+    auto on_module = [&](const ChannelModule& m) {
+        if (m.path.find("libresolv") == std::string::npos) return;
+        lo = m.loaded ? m.base : 0;
+        hi = m.loaded ? m.base + m.size : 0;
+    };
+    for (int round = 0; round < kRounds; ++round) {
+        std::atomic<bool> go{false};
+        std::atomic<void*> text{nullptr};
+        std::vector<std::thread> producers;
+        for (int t = 0; t < kThreads; ++t) {
+            producers.emplace_back([&] {
+                while (! go.load()) std::this_thread::yield();
+                void* frames[2] = {text.load(), reinterpret_cast<void*>(&channel_marker)};
+                for (int i = 0; i < kPerThread; ++i) {
+                    ch.write(frames, 2);
+                    if (i % 8 == 0) std::this_thread::yield();
+                }
+            });
+        }
+        void* lib = dlopen("libresolv.so.2", RTLD_NOW | RTLD_LOCAL);
+        if (lib) text = libresolv_text();
+        go = true;
+        for (auto& th : producers) th.join();
+        if (! lib) {
+            fprintf(stderr, "test_channel: skip threaded dlopen case (%s)\n", dlerror());
+            return;
+        }
+        CHECK(text.load() != nullptr);
+        rd.poll(on_stack, on_module);
+        dlclose(lib);
+        ch.sync_modules();
+        rd.poll(on_stack, on_module);
+    }
+    CHECK(stacks + ch.stats().dropped == kRounds * kThreads * kPerThread);
+    CHECK(early == 0);
+}
+
+static void test_many_producers() {
+    const int kThreads = 4;
+    const uint64_t kPerThread = 50000;
+    StackChannelWriter ch;
+    CHECK(ch.create_memfd(1024));
+    StackChannelReader rd;
+    CHECK(rd.open_fd(ch.fd()));
+    rd.poll([](const ChannelStack&) {}, [](const ChannelModule&) {});
+
+    std::atomic<int> running{kThreads};
+    std::vector<std::thread> producers;
+    for (int t = 0; t < kThreads; ++t) {
+        producers.emplace_back([&, t] {
+            void* frames[4] = {reinterpret_cast<void*>(&channel_marker), nullptr, nullptr, nullptr};
+            for (uint64_t i = 0; i < kPerThread; ++i) {
+                frames[1] = reinterpret_cast<void*>(static_cast<uintptr_t>(t));
+                frames[2] = reinterpret_cast<void*>(static_cast<uintptr_t>(i));
+                frames[3] = reinterpret_cast<void*>(static_cast<uintptr_t>(t * 1000003 + i));
+                ch.write(frames, 4);
+            }
+            running.fetch_sub(1);
+        });
+    }
+    uint64_t received = 0;
+    int64_t last[kThreads];
+    for (int t = 0; t < kThreads; ++t) last[t] = -1;
+    auto on_stack = [&](const ChannelStack& s) {
+        ++received;
+        CHECK(s.depth == 4);
+        uint64_t t = s.addrs[1], i = s.addrs[2];
+        if (t >= static_cast<uint64_t>(kThreads)) {
+            CHECK(t < static_cast<uint64_t>(kThreads));
+            return;
+        }
+        CHECK(s.addrs[3] == t * 1000003 + i); // 记录没有被撕裂
+        CHECK(static_cast<int64_t>(i) > last[t]);
+        last[t] = static_cast<int64_t>(i);
+    };
+    while (running.load() > 0) {
+        if (rd.poll(on_stack, [](const ChannelModule&) {}) == 0) std::this_thread::yield();
+    }
+    for (auto& th : producers) th.join();
+    rd.poll(on_stack, [](const ChannelModule&) {});
+    CHECK(received + ch.stats().dropped == kThreads * kPerThread);
+    CHECK(received > 0);
+}
+
+int main() {
+    test_cross_process();
+    test_memfd_and_overflow();
+    test_dlopen();
+    test_dlopen_threads();
+    test_many_producers();
+
+    if (g_failures == 0) printf("test_channel: OK\n");
+    return g_failures == 0 ? 0 : 1;
+}
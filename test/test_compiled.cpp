@@ -0,0 +1,61 @@
+// 验证: 以 -DSST_COMPILED 编译、只包含 sst_fwd.hpp 时, 抓栈、解析、打印、反查与符号预算均由 libsst.a
+// 中的实现提供, 结果与 header-only 模式一致
+
+#include "../include/sst_fwd.hpp"
+#include "check.h"
+
+#include <cstdio>
+#include <sstream>
+#include <unistd.h>
+
+#ifndef SST_COMPILED
+#error "test_compiled must be built with -DSST_COMPILED"
+#endif
+
+using stacktrace::BasicStacktrace;
+using stacktrace::FramePointerUnwinder;
+using stacktrace::NameMatch;
+using stacktrace::Stacktrace;
+
+__attribute__((noinline)) void compiled_mode_marker() {
+    Stacktrace st = Stacktrace::capture();
+    CHECK(st.size() > 2);
+
+    auto frames = st.get_frames();
+    CHECK(! frames.empty() && frames[0].function.find("compiled_mode_marker") != std::string::npos);
+
+    std::ostringstream oss;
+    st.print(oss);
+    CHECK(oss.str().find("[0] compiled_mode_marker") != std::string::npos);
+
+    size_t views = 0;
+    st.for_each_frame([&](const stacktrace::FrameView& v) { views += v.has_symbol; });
+    CHECK(views > 0);
+
+    auto fp = BasicStacktrace<8, FramePointerUnwinder>::capture();
+    CHECK(fp.size() > 0);
+    __asm__ volatile("" ::: "memory");
+}
+
+int main() {
+    compiled_mode_marker();
+
+    auto ranges = Stacktrace::find_symbols("compiled_mode_marker()", NameMatch::Demangled);
+    CHECK(ranges.size() == 1);
+    if (ranges.size() == 1) {
+        auto pid_frames = Stacktrace::resolve_on_pid({reinterpret_cast<void*>(ranges[0].start + 1)}, getpid());
+        CHECK(pid_frames.size() == 1 && pid_frames[0].function == "compiled_mode_marker()");
+    }
+
+    Stacktrace::set_symbol_memory_budget(1);
+    Stacktrace::capture().get_frames();
+    CHECK(Stacktrace::symbol_memory_stats().budget == 1);
+    Stacktrace::set_symbol_memory_budget(0);
+
+    if (g_failures) {
+        fprintf(stderr, "test_compiled: %d failure(s)\n", g_failures);
+        return 1;
+    }
+    printf("test_compiled: OK\n");
+    return 0;
+}
@@ -0,0 +1,168 @@
+// 验证: 子进程崩溃生成 core 后, CoreFile 能还原模块表、线程与信号, 崩溃线程的栈按帧指针回溯
+// 到 crash_inner -> crash_middle -> crash_outer (crash_inner 为不建栈帧的叶子函数), 并能读取崩溃时的全局变量;
+// 崩溃的不是主线程时, 进程 pid 仍取自 core 而不是崩溃线程的 tid
+// core_pattern 交给管道程序或子进程没有生成 core 时跳过
+
+#include "../include/sst_core.hpp"
+#include "check.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <dirent.h>
+#include <signal.h>
+#include <sys/prctl.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+
+using stacktrace::CoreFile;
+using stacktrace::CoreThread;
+
+// fork 后子进程的地址与父进程相同, 父进程可直接用 &g_marker 读取 core 中的值
+static volatile uint64_t g_marker = 0;
+// 经由全局变量传入空指针, 避免编译器生成 constprop 克隆
+static volatile int* volatile g_null = nullptr;
+
+__attribute__((noinline)) static void crash_inner(volatile int* p) {
+    *p = 1;
+    __asm__ volatile("" ::: "memory");
+}
+
+__attribute__((noinline)) static void crash_middle(volatile int* p) {
+    crash_inner(p);
+    __asm__ volatile("" ::: "memory");
+}
+
+__attribute__((noinline)) static void crash_outer(volatile int* p) {
+    crash_middle(p);
+    __asm__ volatile("" ::: "memory");
+}
+
+static void* idle_thread(void*) {
+    for (;;) pause();
+    return nullptr;
+}
+
+__attribute__((noinline)) static void* crash_thread(void*) {
+    crash_outer(g_null);
+    __asm__ volatile("" ::: "memory");
+    return nullptr;
+}
+
+static bool core_pattern_usable() {
+    std::ifstream in("/proc/sys/kernel/core_pattern");
+    std::string pattern;
+    std::getline(in, pattern);
+    return ! pattern.empty() && pattern[0] != '|' && pattern[0] != '/';
+}
+
+static std::string find_core(const std::string& dir) {
+    std::string found;
+    DIR* d = opendir(dir.c_str());
+    if (! d) return found;
+    while (struct dirent* e = readdir(d)) {
+        if (strncmp(e->d_name, "core", 4) == 0) found = dir + "/" + e->d_name;
+    }
+    closedir(d);
+    return found;
+}
+
+static void remove_dir(const std::string& dir) {
+    DIR* d = opendir(dir.c_str());
+    if (! d) return;
+    while (struct dirent* e = readdir(d)) {
+        if (e->d_name[0] != '.') unlink((dir + "/" + e->d_name).c_str());
+    }
+    closedir(d);
+    rmdir(dir.c_str());
+}
+
+static bool skip(const char* why) {
+    printf("test_core: skipped (%s)\n", why);
+    return false;
+}
+
+// 崩溃发生在子进程的非主线程中, 其 tid 与进程 pid 不同
+__attribute__((noinline)) static bool make_core(const std::string& dir, pid_t& pid) {
+    if (! core_pattern_usable()) return skip("core_pattern is not a relative path");
+    pid = fork();
+    if (pid == 0) {
+        struct rlimit rl = {RLIM_INFINITY, RLIM_INFINITY};
+        setrlimit(RLIMIT_CORE, &rl);
+        prctl(PR_SET_DUMPABLE, 1);
+        if (chdir(dir.c_str()) != 0) _exit(2);
+        pthread_t t;
+        pthread_create(&t, nullptr, idle_thread, nullptr);
+        g_marker = 0x5a5a1234abcdull;
+        pthread_t crasher;
+        pthread_create(&crasher, nullptr, crash_thread, nullptr);
+        pthread_join(crasher, nullptr);
+        _exit(3);
+    }
+    int status = 0;
+    waitpid(pid, &status, 0);
+    if (! WIFSIGNALED(status) || WTERMSIG(status) != SIGSEGV) {
+        CHECK(false);
+        return false;
+    }
+    if (! WCOREDUMP(status) || find_core(dir).empty()) return skip("no core dumped");
+    return true;
+}
+
+int main() {
+    char tmpl[] = "/tmp/sst_core_XXXXXX";
+    if (! mkdtemp(tmpl)) {
+        perror("mkdtemp");
+        return 1;
+    }
+    std::string dir = tmpl;
+    pid_t pid = 0;
+    if (! make_core(dir, pid)) {
+        remove_dir(dir);
+        return g_failures ? 1 : 0;
+    }
+
+    CoreFile core;
+    CHECK(! core.open(dir + "/missing"));
+    CHECK(! core.error().empty());
+    CHECK(! core.open("/proc/self/exe"));
+
+    bool ok = core.open(find_core(dir));
+    CHECK(ok);
+    if (! ok) fprintf(stderr, "%s\n", core.error().c_str());
+    if (ok) {
+        printf("%s", core.summary().c_str());
+        CHECK(core.process_name().find("test_core") == 0);
+        CHECK(core.threads().size() == 3);
+        CHECK(core.pid() == pid);
+        CHECK(core.summary().find(", pid " + std::to_string(pid) + ",") != std::string::npos);
+        CHECK(core.mismatched_modules().empty());
+
+        bool has_exe = false;
+        for (const auto& m : core.modules()) {
+            has_exe = has_exe || m.path.find("test_core") != std::string::npos;
+        }
+        CHECK(has_exe);
+
+        uint64_t marker = 0;
+        CHECK(core.read_memory(reinterpret_cast<uintptr_t>(&g_marker), &marker, sizeof(marker)));
+        CHECK(marker == 0x5a5a1234abcdull);
+
+        const CoreThread& crashed = core.threads()[0];
+        CHECK(crashed.signal == SIGSEGV);
+        CHECK(crashed.tid != pid);
+        auto frames = core.resolve(crashed);
+        const char* expected[] = {"crash_inner", "crash_middle", "crash_outer", "crash_thread"};
+        for (size_t i = 0; i < 4; ++i) {
+            CHECK(frames.size() > i && frames[i].function.find(expected[i]) != std::string::npos);
+        }
+    }
+    core.close();
+    remove_dir(dir);
+
+    if (g_failures) {
+        fprintf(stderr, "test_core: %d failure(s)\n", g_failures);
+        return 1;
+    }
+    printf("test_core: OK\n");
+    return 0;
+}
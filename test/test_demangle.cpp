@@ -0,0 +1,117 @@
+// 验证: demangle_into() 对 libstdc++.so.6 与本测试程序中全部 _Z 函数符号的输出与 __cxa_demangle 一致;
+// 简化模式省略模板实参与参数列表; 缓冲区不足时以 "..." 截断并返回 cap; 非 _Z 名字与非法输入返回 0;
+// set_demangle_style() 影响 ResolvedFrame 中的函数名
+
+#include "../include/sst.hpp"
+#include "check.h"
+
+#include <cstdio>
+#include <link.h>
+
+using stacktrace::DemangleStyle;
+using stacktrace::ResolvedFrame;
+using stacktrace::Stacktrace;
+using stacktrace::demangle_into;
+
+namespace demo {
+template <typename T>
+struct Box {
+    __attribute__((noinline)) static T where(T v) {
+        return v + 1;
+    }
+};
+} // namespace demo
+
+static std::string full(const char* mangled) {
+    char buf[4096];
+    size_t len = demangle_into(mangled, buf, sizeof(buf));
+    return std::string(buf, len);
+}
+
+static std::string simplified(const char* mangled) {
+    char buf[4096];
+    size_t len = demangle_into(mangled, buf, sizeof(buf), DemangleStyle::Simplified);
+    return std::string(buf, len);
+}
+
+static int find_libstdcxx(struct dl_phdr_info* info, size_t, void* data) {
+    if (info->dlpi_name && strstr(info->dlpi_name, "libstdc++.so")) {
+        *static_cast<std::string*>(data) = info->dlpi_name;
+        return 1;
+    }
+    return 0;
+}
+
+// 逐个与 __cxa_demangle 比较, 返回成功解析的个数
+static size_t check_parity(const std::vector<stacktrace::Symbol>& syms, size_t* total) {
+    size_t accepted = 0;
+    for (const auto& s : syms) {
+        const char* name = s.name.c_str();
+        if (name[0] != '_' || name[1] != 'Z') continue;
+        int status = 0;
+        char* expect = abi::__cxa_demangle(name, nullptr, nullptr, &status);
+        if (status == 0 && expect) {
+            ++*total;
+            std::string got = full(name);
+            if (! got.empty()) {
+                ++accepted;
+                if (got != expect) fprintf(stderr, "mismatch %s\n  got    %s\n  expect %s\n", name, got.c_str(), expect);
+                CHECK(got == expect);
+            }
+        }
+        free(expect);
+    }
+    return accepted;
+}
+
+int main() {
+    // 与 __cxa_demangle 对照
+    std::string libstdcxx;
+    dl_iterate_phdr(find_libstdcxx, &libstdcxx);
+    CHECK(! libstdcxx.empty());
+    size_t total = 0, accepted = 0;
+    if (! libstdcxx.empty()) accepted += check_parity(stacktrace::load_symbols(libstdcxx.c_str(), 0), &total);
+    accepted += check_parity(stacktrace::load_symbols("/proc/self/exe", 0), &total);
+    CHECK(total > 1000);
+    CHECK(accepted == total);
+
+    // 常见构造
+    CHECK(full("_ZNSt6vectorIiSaIiEE9push_backERKi") == "std::vector<int, std::allocator<int> >::push_back(int const&)");
+    CHECK(full("_ZNKSs4sizeEv") == "std::string::size() const");
+    CHECK(full("_ZNSsC1Ev") == "std::basic_string<char, std::char_traits<char>, std::allocator<char> >::basic_string()");
+    CHECK(full("_ZZ4mainENKUlvE_clEv") == "main::{lambda()#1}::operator()() const");
+    CHECK(full("_ZN12_GLOBAL__N_13fooEv") == "(anonymous namespace)::foo()");
+    CHECK(full("_ZTVN10__cxxabiv117__class_type_infoE") == "vtable for __cxxabiv1::__class_type_info");
+    CHECK(full("_Z3fooIiEDTplfp_Li1EET_") == "decltype ({parm#1}+(1)) foo<int>(int)");
+    CHECK(full("_ZN3foo3barEv.cold") == "foo::bar() [clone .cold]");
+
+    // 简化模式
+    CHECK(simplified("_ZNSt6vectorIiSaIiEE9push_backERKi") == "std::vector<...>::push_back(...)");
+    CHECK(simplified("_ZNSsC1Ev") == "std::basic_string<...>::basic_string()");
+    CHECK(simplified("_ZZ4mainENKUlvE_clEv") == "main::{lambda()#1}::operator()() const");
+    CHECK(simplified("_Z3fooIiEvT_") == "foo<...>(...)");
+    CHECK(simplified("_ZN2ns3FooC2Ev") == "ns::Foo::Foo()");
+
+    // 截断与非法输入
+    char small[16];
+    size_t len = demangle_into("_ZNSt6vectorIiSaIiEE9push_backERKi", small, sizeof(small));
+    CHECK(len == sizeof(small));
+    CHECK(strcmp(small + sizeof(small) - 4, "...") == 0);
+    CHECK(demangle_into("main", small, sizeof(small)) == 0);
+    CHECK(demangle_into("_ZN3foo", small, sizeof(small)) == 0);
+    CHECK(demangle_into("_Z1fIT_EvT_", small, sizeof(small)) == 0);
+    CHECK(demangle_into("", small, sizeof(small)) == 0);
+    CHECK(stacktrace::demangle("main") == "main");
+
+    // 解析结果中的函数名风格
+    ResolvedFrame f = Stacktrace::resolve(reinterpret_cast<void*>(&demo::Box<int>::where));
+    CHECK(f.has_symbol && f.function == "demo::Box<int>::where(int)");
+    Stacktrace::set_demangle_style(DemangleStyle::Simplified);
+    CHECK(stacktrace::demangle_style() == DemangleStyle::Simplified);
+    f = Stacktrace::resolve(reinterpret_cast<void*>(&demo::Box<int>::where));
+    CHECK(f.has_symbol && f.function == "demo::Box<...>::where(...)");
+    Stacktrace::set_demangle_style(DemangleStyle::Full);
+
+    if (g_failures == 0) printf("test_demangle: OK (%zu/%zu symbols)\n", accepted, total);
+    return g_failures == 0 ? 0 : 1;
+}
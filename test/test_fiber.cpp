@@ -0,0 +1,182 @@
+// 验证: 用 makecontext/swapcontext 实现的协程挂起后, dump_parked() 能回溯出协程栈上的函数 (一批共用解析);
+// 正在运行的与已注销的协程不出现在结果中; walk_context() 可直接从 ucontext_t 回溯;
+// 另一个线程反复切换协程时 dump 不会读到越界或撕裂的上下文
+
+#include "../include/sst_fiber.hpp"
+#include "check.h"
+
+#include <cstdio>
+#include <thread>
+
+using stacktrace::FiberContext;
+using stacktrace::FiberRegistry;
+using stacktrace::FiberTrace;
+using stacktrace::ResolvedFrame;
+using stacktrace::StackBounds;
+
+static const size_t kStackSize = 64 * 1024;
+
+struct Fiber {
+    ucontext_t uc;
+    ucontext_t* sched;
+    int handle;
+    int depth;
+    bool stop; // 为 true 时处理完当前请求后结束
+    bool done;
+    char stack[kStackSize];
+};
+
+static thread_local Fiber* g_current = nullptr;
+
+// 切回调度器; 由调度器在切换完成后 park
+__attribute__((noinline)) void fiber_yield() {
+    Fiber* f = g_current;
+    swapcontext(&f->uc, f->sched);
+    asm volatile("" ::: "memory");
+}
+
+__attribute__((noinline)) void fiber_wait_io(int depth) {
+    if (depth > 0) {
+        fiber_wait_io(depth - 1);
+    } else {
+        fiber_yield();
+    }
+    asm volatile("" ::: "memory");
+}
+
+__attribute__((noinline)) void fiber_handle_request() {
+    fiber_wait_io(g_current->depth);
+    asm volatile("" ::: "memory");
+}
+
+static void fiber_main() {
+    do {
+        fiber_handle_request();
+    } while (! g_current->stop);
+    g_current->done = true;
+}
+
+static Fiber* spawn(ucontext_t* sched, int depth, const char* name) {
+    Fiber* f = new Fiber();
+    getcontext(&f->uc);
+    f->uc.uc_stack.ss_sp = f->stack;
+    f->uc.uc_stack.ss_size = sizeof(f->stack);
+    f->uc.uc_link = sched;
+    f->sched = sched;
+    f->depth = depth;
+    f->stop = false;
+    f->done = false;
+    makecontext(&f->uc, fiber_main, 0);
+    f->handle = FiberRegistry::instance().add(f->stack, sizeof(f->stack), name);
+    return f;
+}
+
+// 调度器切入协程, 协程切出 (或结束) 后 park
+static void run(ucontext_t* sched, Fiber* f) {
+    auto& reg = FiberRegistry::instance();
+    reg.resume(f->handle);
+    g_current = f;
+    swapcontext(sched, &f->uc);
+    g_current = nullptr;
+    if (! f->done) reg.park(f->handle, f->uc);
+}
+
+static size_t count_function(const FiberTrace& t, const char* name) {
+    size_t n = 0;
+    for (const ResolvedFrame& f : t.frames) {
+        if (f.function.compare(0, strlen(name), name) == 0) ++n;
+    }
+    return n;
+}
+
+static const FiberTrace* find_trace(const std::vector<FiberTrace>& traces, int handle) {
+    for (const auto& t : traces) {
+        if (t.handle == handle) return &t;
+    }
+    return nullptr;
+}
+
+int main() {
+    auto& reg = FiberRegistry::instance();
+    ucontext_t sched;
+
+    Fiber* fibers[4];
+    const char* names[4] = {"conn-0", "conn-1", "conn-2", "conn-3"};
+    for (int i = 0; i < 4; ++i) {
+        fibers[i] = spawn(&sched, i * 3, names[i]);
+        CHECK(fibers[i]->handle >= 0);
+    }
+    CHECK(reg.stats().registered == 4 && reg.stats().parked == 0);
+    CHECK(reg.dump_parked().empty()); // 还没有运行过的协程没有可回溯的上下文
+
+    for (int i = 0; i < 4; ++i) run(&sched, fibers[i]);
+    CHECK(reg.stats().parked == 4);
+
+    std::vector<FiberTrace> traces = reg.dump_parked();
+    CHECK(traces.size() == 4);
+    for (int i = 0; i < 4; ++i) {
+        const FiberTrace* t = find_trace(traces, fibers[i]->handle);
+        CHECK(t != nullptr);
+        if (! t) continue;
+        CHECK(t->name == names[i]);
+        CHECK(! t->frames.empty() && t->frames[0].function == "fiber_yield()");
+        CHECK(count_function(*t, "fiber_wait_io(int)") == static_cast<size_t>(i * 3 + 1));
+        CHECK(count_function(*t, "fiber_handle_request()") == 1);
+        for (size_t j = 0; j < t->frames.size(); ++j) CHECK(t->frames[j].index == j);
+    }
+
+    // 直接从保存的 ucontext_t 回溯
+    void* frames[64];
+    StackBounds bounds = {reinterpret_cast<uintptr_t>(fibers[2]->stack), reinterpret_cast<uintptr_t>(fibers[2]->stack) + kStackSize};
+    size_t n = stacktrace::walk_context(fibers[2]->uc, bounds, frames, 64);
+    const FiberTrace* t2 = find_trace(traces, fibers[2]->handle);
+    CHECK(t2 && n == t2->frames.size());
+    CHECK(stacktrace::walk_context(FiberContext{0, 0, 0}, bounds, frames, 64) == 0);
+    // 帧指针不在栈内时只有 pc
+    CHECK(stacktrace::walk_context(FiberContext{reinterpret_cast<uintptr_t>(&fiber_yield), bounds.low + 64, 16}, bounds, frames, 64) == 1);
+
+    // 运行中的协程不出现, 已注销的协程不出现
+    reg.resume(fibers[1]->handle);
+    reg.remove(fibers[3]->handle);
+    traces = reg.dump_parked();
+    CHECK(traces.size() == 2);
+    CHECK(find_trace(traces, fibers[1]->handle) == nullptr && find_trace(traces, fibers[3]->handle) == nullptr);
+    reg.park(fibers[1]->handle, fibers[1]->uc);
+
+    // 注销后句柄被复用
+    int reused = reg.add(fibers[3]->stack, kStackSize, "reused");
+    CHECK(reused == fibers[3]->handle);
+    reg.remove(reused);
+
+    // 另一个线程反复切换协程, 同时 dump: 每次结果要么不含该协程, 要么是完整的栈
+    std::atomic<bool> stop{false};
+    std::thread worker([&] {
+        ucontext_t worker_sched;
+        Fiber* f = fibers[0];
+        f->sched = &worker_sched;
+        while (! stop.load(std::memory_order_relaxed)) run(&worker_sched, f);
+    });
+    for (int round = 0; round < 200; ++round) {
+        for (const auto& t : reg.dump_parked()) {
+            if (t.handle != fibers[0]->handle) continue;
+            CHECK(! t.frames.empty() && t.frames[0].function == "fiber_yield()");
+            CHECK(count_function(t, "fiber_handle_request()") == 1);
+        }
+    }
+    stop.store(true);
+    worker.join();
+
+    // 清理: 让剩余的协程运行结束
+    for (int i = 0; i < 3; ++i) {
+        fibers[i]->sched = &sched;
+        fibers[i]->stop = true;
+        run(&sched, fibers[i]);
+        CHECK(fibers[i]->done);
+        reg.remove(fibers[i]->handle);
+    }
+    CHECK(reg.stats().registered == 0);
+    for (Fiber* f : fibers) delete f;
+
+    if (g_failures == 0) printf("test_fiber: OK\n");
+    return g_failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,96 @@
+// 验证: 符号已加载 (warm) 之后, for_each_frame() 遍历与格式化全程不产生堆分配
+// 通过在可执行文件中定义 malloc 系列函数来拦截并计数所有分配 (包括 operator new)
+
+#include "../include/sst.hpp"
+#include "check.h"
+
+#include <cstdio>
+#include <cstring>
+
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t n, size_t size);
+void* __libc_realloc(void* ptr, size_t size);
+void __libc_free(void* ptr);
+}
+
+static size_t g_allocs = 0;
+
+extern "C" void* malloc(size_t size) {
+    ++g_allocs;
+    return __libc_malloc(size);
+}
+
+extern "C" void* calloc(size_t n, size_t size) {
+    ++g_allocs;
+    return __libc_calloc(n, size);
+}
+
+extern "C" void* realloc(void* ptr, size_t size) {
+    ++g_allocs;
+    return __libc_realloc(ptr, size);
+}
+
+extern "C" void free(void* ptr) {
+    __libc_free(ptr);
+}
+
+using stacktrace::FrameView;
+using stacktrace::Stacktrace;
+
+static size_t walk_and_format(const Stacktrace& st, char* buf, size_t cap) {
+    size_t used = 0;
+    st.for_each_frame([&](const FrameView& v) {
+        int n = v.format(buf + used, cap - used);
+        if (n > 0 && static_cast<size_t>(n) < cap - used) used += static_cast<size_t>(n);
+    });
+    return used;
+}
+
+__attribute__((noinline)) static void run() {
+    static char buf[16384];
+    Stacktrace st = Stacktrace::capture();
+    CHECK(st.size() > 0);
+
+    // 冷启动: 加载模块与符号, demangle 并缓存
+    walk_and_format(st, buf, sizeof(buf));
+
+    size_t before = g_allocs;
+    size_t used = walk_and_format(st, buf, sizeof(buf));
+    size_t allocs = g_allocs - before;
+    CHECK(allocs == 0);
+    CHECK(used > 0);
+
+    // 视图与 ResolvedFrame 的解析结果必须一致
+    std::vector<stacktrace::ResolvedFrame> frames = st.get_frames();
+    size_t i = 0;
+    st.for_each_frame([&](const FrameView& v) {
+        CHECK(i < frames.size());
+        if (i >= frames.size()) return;
+        CHECK(v.index == frames[i].index);
+        CHECK(v.abs_addr == frames[i].abs_addr);
+        CHECK(v.has_symbol == frames[i].has_symbol);
+        CHECK(v.offset == frames[i].offset);
+        CHECK(frames[i].function == std::string(v.function, v.function_len));
+        CHECK(frames[i].module == std::string(v.module, v.module_len));
+
+        char line[1024];
+        v.format(line, sizeof(line));
+        CHECK(frames[i].to_string() == line);
+        ++i;
+    });
+    CHECK(i == frames.size());
+
+    fputs(buf, stdout);
+    printf("warm walk allocations: %zu\n", allocs);
+}
+
+int main() {
+    run();
+    if (g_failures) {
+        fprintf(stderr, "test_frame_view: %d failure(s)\n", g_failures);
+        return 1;
+    }
+    printf("test_frame_view: OK\n");
+    return 0;
+}
@@ -0,0 +1,176 @@
+// 验证: 按名字反查的四种匹配方式 (Mangled / Demangled / Prefix / Glob) 在 C++ 与 C 接口下都能找到本程序中的函数;
+// 导出符号经 .gnu_hash 查找, 同一模块的多次查找复用同一份文件映射;
+// .gnu_hash 的偏移、大小或表头损坏、文件被截断时只是查不到, 不会越界读取
+
+#include "../include/sst.hpp"
+#include "../src/sst.h"
+#include "check.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include <dlfcn.h>
+
+#ifndef SST_COMPILED
+#error "test_lookup must be built with -DSST_COMPILED"
+#endif
+
+using stacktrace::Module;
+using stacktrace::ModuleManager;
+using stacktrace::Modules;
+using stacktrace::NameMatch;
+using stacktrace::Stacktrace;
+using stacktrace::SymbolRange;
+
+namespace lookup_ns {
+
+__attribute__((noinline)) int target(int x) {
+    __asm__ volatile("" ::: "memory");
+    return x + 1;
+}
+
+__attribute__((noinline)) int target(double x) {
+    __asm__ volatile("" ::: "memory");
+    return static_cast<int>(x) + 2;
+}
+
+__attribute__((noinline)) int other(int x) {
+    __asm__ volatile("" ::: "memory");
+    return x + 3;
+}
+
+} // namespace lookup_ns
+
+static uintptr_t addr_of(int (*fn)(int)) {
+    return reinterpret_cast<uintptr_t>(fn);
+}
+
+static bool covers(const std::vector<SymbolRange>& ranges, uintptr_t addr) {
+    for (const auto& r : ranges) {
+        if (addr >= r.start && addr < r.end) return true;
+    }
+    return false;
+}
+
+static void test_match_modes() {
+    uintptr_t target_int = addr_of(&lookup_ns::target);
+    uintptr_t target_double = reinterpret_cast<uintptr_t>(static_cast<int (*)(double)>(&lookup_ns::target));
+    uintptr_t other = addr_of(&lookup_ns::other);
+
+    auto mangled = Stacktrace::find_symbols("_ZN9lookup_ns6targetEi", NameMatch::Mangled);
+    CHECK(mangled.size() == 1 && mangled[0].start == target_int && mangled[0].end > target_int);
+
+    auto demangled = Stacktrace::find_symbols("lookup_ns::target(int)", NameMatch::Demangled);
+    CHECK(demangled.size() == 1 && demangled[0].start == target_int);
+    CHECK(Stacktrace::find_symbols("lookup_ns::target", NameMatch::Demangled).empty());
+
+    auto prefix = Stacktrace::find_symbols("lookup_ns::target", NameMatch::Prefix);
+    CHECK(prefix.size() == 2 && covers(prefix, target_int) && covers(prefix, target_double) && ! covers(prefix, other));
+
+    auto glob = Stacktrace::find_symbols("lookup_ns::*(int)", NameMatch::Glob);
+    CHECK(glob.size() == 2 && covers(glob, target_int) && covers(glob, other) && ! covers(glob, target_double));
+
+    // 导出的 C 函数走 .gnu_hash
+    auto exported = Stacktrace::find_symbols("qsort", NameMatch::Mangled);
+    CHECK(covers(exported, reinterpret_cast<uintptr_t>(&qsort)));
+}
+
+static void test_c_api() {
+    sst_symbol_range outs[4];
+    CHECK(sst_find_symbols("_ZN9lookup_ns5otherEi", SST_MATCH_MANGLED, outs, 4) == 1);
+    CHECK(outs[0].start == addr_of(&lookup_ns::other) && strcmp(outs[0].function, "_ZN9lookup_ns5otherEi") == 0);
+    CHECK(sst_find_symbols("lookup_ns::other(int)", SST_MATCH_DEMANGLED, outs, 4) == 1);
+    CHECK(outs[0].start == addr_of(&lookup_ns::other));
+    CHECK(sst_find_symbols("lookup_ns::", SST_MATCH_PREFIX, outs, 4) == 3);
+    // 超出 capacity 的部分只计数
+    CHECK(sst_find_symbols("lookup_ns::target*", SST_MATCH_GLOB, outs, 1) == 2);
+    CHECK(sst_find_symbols("lookup_ns::target*", SST_MATCH_GLOB, nullptr, 0) == 2);
+    CHECK(sst_find_symbols("no_such_function_anywhere", SST_MATCH_MANGLED, outs, 4) == 0);
+}
+
+static std::string libc_path() {
+    Dl_info info;
+    if (dladdr(reinterpret_cast<void*>(&qsort), &info) == 0 || ! info.dli_fname) return std::string();
+    return info.dli_fname;
+}
+
+static void test_file_cached() {
+    Modules mods;
+    ModuleManager::load_modules(mods, getpid());
+    std::string libc = libc_path();
+    for (Module& m : mods) {
+        if (m.path != libc) continue;
+        CHECK(m.lookup("qsort", NameMatch::Mangled).size() == 1);
+        const stacktrace::MappedFile* first = m.file.get();
+        CHECK(first != nullptr && first->data() != nullptr);
+        CHECK(m.lookup("bsearch", NameMatch::Mangled).size() == 1);
+        CHECK(m.file.get() == first);
+        return;
+    }
+    CHECK(false);
+}
+
+static const Elf64_Shdr* find_gnu_hash(std::vector<char>& elf) {
+    auto* ehdr = reinterpret_cast<const Elf64_Ehdr*>(elf.data());
+    auto* shdrs = reinterpret_cast<Elf64_Shdr*>(elf.data() + ehdr->e_shoff);
+    for (int i = 0; i < ehdr->e_shnum; ++i) {
+        if (shdrs[i].sh_type == SHT_GNU_HASH) return &shdrs[i];
+    }
+    return nullptr;
+}
+
+static bool lookup_in(const std::vector<char>& elf, size_t size) {
+    uintptr_t addr = 0;
+    size_t sym_size = 0;
+    return stacktrace::gnu_hash_lookup(elf.data(), size, "qsort", 0, addr, sym_size);
+}
+
+static void test_corrupted_gnu_hash() {
+    stacktrace::MappedFile file(libc_path().c_str());
+    CHECK(file.data() != nullptr);
+    if (! file.data()) return;
+    const std::vector<char> intact(file.data(), file.data() + file.size());
+    CHECK(lookup_in(intact, intact.size()));
+
+    std::vector<char> elf = intact;
+    Elf64_Shdr* sh = const_cast<Elf64_Shdr*>(find_gnu_hash(elf));
+    CHECK(sh != nullptr);
+    if (! sh) return;
+    uint64_t offset = sh->sh_offset, size = sh->sh_size;
+
+    // 节超出文件
+    sh->sh_offset = elf.size() - 8;
+    CHECK(! lookup_in(elf, elf.size()));
+    sh->sh_offset = offset;
+    sh->sh_size = ~uint64_t(0) - offset + 1;
+    CHECK(! lookup_in(elf, elf.size()));
+    sh->sh_size = size;
+
+    // 表头声称的 bucket 数远超节的大小
+    uint32_t* hdr = reinterpret_cast<uint32_t*>(elf.data() + offset);
+    uint32_t nbuckets = hdr[0];
+    hdr[0] = 0x40000000;
+    CHECK(! lookup_in(elf, elf.size()));
+    hdr[0] = nbuckets;
+
+    // 截断到 .gnu_hash 之内
+    CHECK(! lookup_in(elf, static_cast<size_t>(offset + size / 2)));
+    CHECK(! lookup_in(elf, 16));
+    CHECK(lookup_in(elf, elf.size()));
+}
+
+int main() {
+    test_match_modes();
+    test_c_api();
+    test_file_cached();
+    test_corrupted_gnu_hash();
+
+    if (g_failures) {
+        fprintf(stderr, "test_lookup: %d failure(s)\n", g_failures);
+        return 1;
+    }
+    printf("test_lookup: OK\n");
+    return 0;
+}
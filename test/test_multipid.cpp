@@ -0,0 +1,209 @@
+// 验证: MultiPidResolver 对多个进程的解析结果与逐个调用 resolve_on_pid() 一致;
+// 所有进程共用的文件只加载一次, 再次解析时不再加载; 已退出的进程只给出地址;
+// 映射的文件在本进程中已经打不开时 (已删除, 或在另一个 mount namespace 中) 经由 /proc/<pid>/map_files 读取;
+// 进程 mmap 的非 ELF 数据文件不建立索引, 其中的地址只给出文件路径
+
+#include "../include/sst_multipid.hpp"
+#include "check.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+
+using stacktrace::MultiPidResolver;
+using stacktrace::MultiPidStats;
+using stacktrace::PidAddresses;
+using stacktrace::ResolvedFrame;
+using stacktrace::Stacktrace;
+
+static const int kChildren = 3;
+
+__attribute__((noinline)) static Stacktrace multipid_marker(int depth) {
+    Stacktrace st = depth > 0 ? multipid_marker(depth - 1) : Stacktrace::capture();
+    asm volatile("" ::: "memory");
+    return st;
+}
+
+// 抓一个栈, 把地址写到 out_fd 后等待 in_fd 被关闭
+static int child_main(int depth, int out_fd, int in_fd) {
+    Stacktrace st = multipid_marker(depth);
+    size_t n = st.size();
+    bool ok = ::write(out_fd, &n, sizeof(n)) == sizeof(n) &&
+              ::write(out_fd, st.addresses(), n * sizeof(void*)) == static_cast<ssize_t>(n * sizeof(void*));
+    char c;
+    ssize_t r = ::read(in_fd, &c, 1);
+    return ok && r == 0 ? 0 : 1;
+}
+
+// 子进程抓一个栈, 把地址写回父进程后等待父进程关闭管道; exe 不为空时子进程执行该程序 (本程序的副本)
+static pid_t spawn_child(int depth, std::vector<void*>& addrs, const char* exe = nullptr) {
+    int to_parent[2], to_child[2];
+    if (pipe(to_parent) != 0 || pipe(to_child) != 0) return -1;
+    pid_t pid = fork();
+    if (pid == 0) {
+        close(to_parent[0]);
+        close(to_child[1]);
+        if (exe) {
+            dup2(to_parent[1], STDOUT_FILENO);
+            dup2(to_child[0], STDIN_FILENO);
+            execl(exe, exe, "--child", std::to_string(depth).c_str(), static_cast<char*>(nullptr));
+            _exit(127);
+        }
+        _exit(child_main(depth, to_parent[1], to_child[0]));
+    }
+    close(to_parent[1]);
+    close(to_child[0]);
+    size_t n = 0;
+    if (::read(to_parent[0], &n, sizeof(n)) == sizeof(n) && n <= Stacktrace::kMaxFrames) {
+        addrs.resize(n);
+        if (::read(to_parent[0], addrs.data(), n * sizeof(void*)) != static_cast<ssize_t>(n * sizeof(void*))) addrs.clear();
+    }
+    close(to_parent[0]);
+    // 写端留给子进程等待; 父进程退出或关闭后子进程结束
+    static std::vector<int> keep;
+    keep.push_back(to_child[1]);
+    return pid;
+}
+
+static bool same(const ResolvedFrame& a, const ResolvedFrame& b) {
+    return a.abs_addr == b.abs_addr && a.function == b.function && a.module == b.module && a.offset == b.offset &&
+           a.has_symbol == b.has_symbol;
+}
+
+// 子进程运行本程序的副本, 副本随即被删除: maps 中的路径带 " (deleted)", 只能经由 map_files 打开
+static void test_deleted_file() {
+    std::string copy = "/tmp/test_multipid_copy." + std::to_string(getpid());
+    {
+        std::ifstream in("/proc/self/exe", std::ios::binary);
+        std::ofstream out(copy.c_str(), std::ios::binary);
+        out << in.rdbuf();
+    }
+    chmod(copy.c_str(), 0700);
+    PidAddresses p;
+    p.pid = spawn_child(2, p.addrs, copy.c_str());
+    unlink(copy.c_str());
+    CHECK(p.pid > 0 && p.addrs.size() > 3);
+
+    MultiPidResolver resolver;
+    auto frames = resolver.resolve(std::vector<PidAddresses>{p});
+    size_t markers = 0;
+    for (const auto& f : frames[0]) {
+        if (f.function == "multipid_marker(int)") {
+            ++markers;
+            CHECK(f.module.find(copy) == 0);
+        }
+    }
+    CHECK(markers == 3);
+    kill(p.pid, SIGKILL);
+    waitpid(p.pid, nullptr, 0);
+}
+
+// 子进程继承了一个 mmap 的文本文件
+static void test_data_file() {
+    std::string path = "/tmp/test_multipid_data." + std::to_string(getpid());
+    {
+        std::ofstream out(path.c_str());
+        for (int i = 0; i < 800; ++i) out << "not an elf file\n";
+    }
+    int fd = open(path.c_str(), O_RDONLY);
+    CHECK(fd >= 0);
+    if (fd < 0) return;
+    void* data = mmap(nullptr, 9 * 1024, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    CHECK(data != MAP_FAILED);
+    if (data == MAP_FAILED) return;
+
+    PidAddresses p;
+    p.pid = spawn_child(1, p.addrs);
+    munmap(data, 9 * 1024);
+    CHECK(p.pid > 0 && p.addrs.size() > 2);
+    p.addrs.push_back(static_cast<char*>(data) + 100);
+
+    MultiPidResolver resolver;
+    auto frames = resolver.resolve(std::vector<PidAddresses>{p});
+    CHECK(frames.size() == 1 && frames[0].size() == p.addrs.size());
+    if (frames.size() == 1 && ! frames[0].empty()) {
+        CHECK(frames[0][0].has_symbol);
+        CHECK(! frames[0].back().has_symbol && frames[0].back().module == path);
+    }
+    kill(p.pid, SIGKILL);
+    waitpid(p.pid, nullptr, 0);
+    unlink(path.c_str());
+}
+
+int main(int argc, char** argv) {
+    if (argc > 2 && strcmp(argv[1], "--child") == 0) return child_main(atoi(argv[2]), STDOUT_FILENO, STDIN_FILENO);
+
+    std::vector<PidAddresses> req;
+    for (int i = 0; i < kChildren; ++i) {
+        PidAddresses p;
+        p.pid = spawn_child(i + 1, p.addrs);
+        CHECK(p.pid > 0 && p.addrs.size() > 2);
+        req.push_back(p);
+    }
+    // 自身, 以及一个不在任何模块中的地址
+    Stacktrace self = multipid_marker(0);
+    PidAddresses me;
+    me.pid = getpid();
+    me.addrs.assign(self.addresses(), self.addresses() + self.size());
+    me.addrs.push_back(reinterpret_cast<void*>(static_cast<uintptr_t>(0x10)));
+    req.push_back(me);
+
+    MultiPidResolver resolver(4);
+    auto frames = resolver.resolve(req);
+    CHECK(frames.size() == req.size());
+    for (size_t i = 0; i < req.size(); ++i) {
+        std::vector<ResolvedFrame> expect = stacktrace::resolve_on_pid(req[i].addrs, req[i].pid);
+        CHECK(frames[i].size() == expect.size());
+        size_t markers = 0;
+        for (size_t j = 0; j < expect.size() && j < frames[i].size(); ++j) {
+            // 自身的模块路径在 resolve_on_pid() 中来自 dl_iterate_phdr, 写法可能不同 (./a.out 与绝对路径)
+            if (req[i].pid == getpid()) expect[j].module = frames[i][j].module;
+            CHECK(same(frames[i][j], expect[j]));
+            if (frames[i][j].function == "multipid_marker(int)") ++markers;
+        }
+        CHECK(markers == (i < static_cast<size_t>(kChildren) ? i + 2 : 1));
+    }
+    CHECK(! frames.back().back().has_symbol && frames.back().back().module.empty());
+
+    MultiPidStats st = resolver.last_stats();
+    CHECK(st.pids == req.size() && st.failed_pids == 0);
+    // fork 出来的进程与父进程映射的是同一批文件, 每个文件只加载一次
+    CHECK(st.files > 2 && st.mappings >= st.files * req.size());
+    CHECK(st.loaded <= st.files && st.cached == st.files);
+    CHECK(st.total_ms >= st.resolve_ms);
+
+    // 再次解析: 全部命中缓存
+    auto again = resolver.resolve(req);
+    CHECK(resolver.last_stats().loaded == 0);
+    for (size_t i = 0; i < req.size(); ++i) {
+        for (size_t j = 0; j < again[i].size(); ++j) CHECK(same(again[i][j], frames[i][j]));
+    }
+
+    // 子进程退出后只剩地址
+    PidAddresses gone = req[0];
+    kill(gone.pid, SIGKILL);
+    CHECK(waitpid(gone.pid, nullptr, 0) == gone.pid);
+    auto dead = resolver.resolve(std::vector<PidAddresses>{gone});
+    CHECK(resolver.last_stats().failed_pids == 1);
+    CHECK(dead.size() == 1 && dead[0].size() == gone.addrs.size());
+    for (size_t j = 0; j < dead[0].size(); ++j) {
+        CHECK(! dead[0][j].has_symbol && dead[0][j].abs_addr == reinterpret_cast<uintptr_t>(gone.addrs[j]));
+    }
+
+    for (int i = 1; i < kChildren; ++i) {
+        kill(req[static_cast<size_t>(i)].pid, SIGKILL);
+        waitpid(req[static_cast<size_t>(i)].pid, nullptr, 0);
+    }
+
+    test_deleted_file();
+    test_data_file();
+
+    if (g_failures == 0) printf("test_multipid: OK (%zu mappings, %zu files)\n", st.mappings, st.files);
+    return g_failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,209 @@
+// 验证: 构造的 PERF_RECORD_MMAP2 / PERF_RECORD_SAMPLE / PERF_RECORD_LOST 记录经 PerfSampler::feed() 处理后,
+// 调用链按 PERF_CONTEXT_* 标记分成内核态与用户态两段, 模块表由 MMAP2 增量维护 (扩展、覆盖、忽略匿名映射),
+// 用户态地址能解析到本程序中的函数; 长度不合法的记录不会被越界读取
+// 不调用 perf_event_open, 不受 perf_event_paranoid 限制
+
+#include "../include/sst_perf.hpp"
+#include "check.h"
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using stacktrace::PerfSample;
+using stacktrace::PerfSampler;
+
+__attribute__((noinline)) void perf_leaf() {
+    __asm__ volatile("" ::: "memory");
+}
+
+__attribute__((noinline)) void perf_caller() {
+    perf_leaf();
+    __asm__ volatile("" ::: "memory");
+}
+
+// 本程序的可执行映射
+struct TextMapping {
+    uint64_t start = 0;
+    uint64_t end = 0;
+    uint64_t pgoff = 0;
+    std::string path;
+};
+
+static TextMapping find_text_mapping() {
+    TextMapping t;
+    uintptr_t probe = reinterpret_cast<uintptr_t>(&perf_leaf);
+    std::ifstream in("/proc/self/maps");
+    std::string line;
+    while (std::getline(in, line)) {
+        std::istringstream ss(line);
+        std::string range, perms, dev, path;
+        uint64_t offset = 0, inode = 0;
+        ss >> range >> perms >> std::hex >> offset >> dev >> std::dec >> inode >> path;
+        uint64_t start = std::stoull(range.substr(0, range.find('-')), nullptr, 16);
+        uint64_t end = std::stoull(range.substr(range.find('-') + 1), nullptr, 16);
+        if (probe >= start && probe < end) {
+            t.start = start;
+            t.end = end;
+            t.pgoff = offset;
+            t.path = path;
+            break;
+        }
+    }
+    return t;
+}
+
+// 按内核的格式追加一条记录: 头部 + 主体, 总长度按 8 字节对齐
+class RecordBuilder {
+  public:
+    RecordBuilder() : buf_() {}
+
+    template <typename T>
+    RecordBuilder& put(T v) {
+        body_.append(reinterpret_cast<const char*>(&v), sizeof(v));
+        return *this;
+    }
+
+    RecordBuilder& put_string(const std::string& s) {
+        body_.append(s.c_str(), s.size() + 1);
+        while (body_.size() % 8) body_.push_back('\0');
+        return *this;
+    }
+
+    void end(uint32_t type) {
+        while (body_.size() % 8) body_.push_back('\0');
+        perf_event_header hdr;
+        hdr.type = type;
+        hdr.misc = 0;
+        hdr.size = static_cast<uint16_t>(sizeof(hdr) + body_.size());
+        buf_.append(reinterpret_cast<const char*>(&hdr), sizeof(hdr));
+        buf_ += body_;
+        body_.clear();
+    }
+
+    const std::string& data() const {
+        return buf_;
+    }
+
+  private:
+    std::string buf_;
+    std::string body_;
+};
+
+static void add_mmap2(RecordBuilder& b, uint64_t addr, uint64_t len, uint64_t pgoff, const std::string& path) {
+    b.put<uint32_t>(1).put<uint32_t>(1);                       // pid, tid
+    b.put<uint64_t>(addr).put<uint64_t>(len).put<uint64_t>(pgoff);
+    b.put<uint32_t>(8).put<uint32_t>(1);                       // maj, min
+    b.put<uint64_t>(42).put<uint64_t>(0);                      // ino, ino_generation
+    b.put<uint32_t>(PROT_READ | PROT_EXEC).put<uint32_t>(MAP_PRIVATE);
+    b.put_string(path);
+    b.put<uint32_t>(1).put<uint32_t>(1).put<uint64_t>(7);      // sample_id_all: pid, tid, time
+    b.end(PERF_RECORD_MMAP2);
+}
+
+static void add_sample(RecordBuilder& b, uint32_t pid, uint32_t tid, uint64_t time, const std::vector<uint64_t>& chain) {
+    b.put<uint32_t>(pid).put<uint32_t>(tid).put<uint64_t>(time).put<uint64_t>(chain.size());
+    for (uint64_t ip : chain) {
+        b.put<uint64_t>(ip);
+    }
+    b.end(PERF_RECORD_SAMPLE);
+}
+
+struct Collected {
+    uint32_t pid, tid;
+    uint64_t time;
+    std::vector<uint64_t> kernel, user;
+};
+
+static std::vector<Collected> feed(PerfSampler& sampler, const std::string& data, size_t& n) {
+    std::vector<Collected> out;
+    n = sampler.feed(data.data(), data.size(), [&](const PerfSample& s) {
+        out.push_back(Collected{s.pid, s.tid, s.time, std::vector<uint64_t>(s.kernel_ips, s.kernel_ips + s.kernel_nr),
+                                std::vector<uint64_t>(s.user_ips, s.user_ips + s.user_nr)});
+    });
+    return out;
+}
+
+static void test_callchain_and_modules(const TextMapping& text) {
+    PerfSampler sampler(getpid());
+    uint64_t leaf = reinterpret_cast<uintptr_t>(&perf_leaf) + 1;
+    uint64_t caller = reinterpret_cast<uintptr_t>(&perf_caller) + 1;
+    uint64_t kctx = static_cast<uint64_t>(PERF_CONTEXT_KERNEL), uctx = static_cast<uint64_t>(PERF_CONTEXT_USER);
+
+    // 第一个 MMAP2 只覆盖映射的前一页, 第二个为同一文件的后续部分, 合并为一个模块; 匿名映射被忽略
+    RecordBuilder b;
+    add_mmap2(b, text.start, 4096, text.pgoff, text.path);
+    add_mmap2(b, text.start + 4096, text.end - text.start - 4096, text.pgoff + 4096, text.path);
+    add_mmap2(b, 0x10000, 4096, 0, "//anon");
+    add_sample(b, 11, 12, 1000, {kctx, 0xffffffff81000010ull, 0xffffffff81000020ull, uctx, leaf, caller});
+    add_sample(b, 11, 13, 2000, {uctx, caller});
+    b.put<uint64_t>(1).put<uint64_t>(5).end(PERF_RECORD_LOST); // {id, lost}
+    add_sample(b, 11, 14, 3000, {});
+
+    size_t n = 0;
+    auto samples = feed(sampler, b.data(), n);
+    CHECK(n == 3 && samples.size() == 3);
+    CHECK(sampler.lost() == 5);
+    if (samples.size() != 3) return;
+
+    CHECK(samples[0].pid == 11 && samples[0].tid == 12 && samples[0].time == 1000);
+    CHECK((samples[0].kernel == std::vector<uint64_t>{0xffffffff81000010ull, 0xffffffff81000020ull}));
+    CHECK((samples[0].user == std::vector<uint64_t>{leaf, caller}));
+    CHECK(samples[1].kernel.empty() && (samples[1].user == std::vector<uint64_t>{caller}));
+    CHECK(samples[2].kernel.empty() && samples[2].user.empty());
+
+    CHECK(sampler.modules().size() == 1);
+    if (sampler.modules().size() == 1) {
+        const auto& m = sampler.modules()[0];
+        CHECK(m.path == text.path && m.base == text.start - text.pgoff && m.base + m.size == text.end);
+    }
+    CHECK(sampler.resolve(leaf).function.find("perf_leaf") != std::string::npos);
+    CHECK(sampler.resolve(caller).function.find("perf_caller") != std::string::npos);
+
+    // 同一地址上出现新的映射: 旧模块已被 munmap, 由新模块取代
+    RecordBuilder remap;
+    add_mmap2(remap, text.start, text.end - text.start, 0, "/opt/other/libreplaced.so");
+    feed(sampler, remap.data(), n);
+    CHECK(sampler.modules().size() == 1 && sampler.modules()[0].path == "/opt/other/libreplaced.so");
+}
+
+static void test_malformed_records(const TextMapping& text) {
+    PerfSampler sampler(getpid());
+
+    // 调用链长度超出记录: 丢弃该样本, 之后的记录照常处理
+    RecordBuilder b;
+    b.put<uint32_t>(1).put<uint32_t>(1).put<uint64_t>(1).put<uint64_t>(1000).put<uint64_t>(0).end(PERF_RECORD_SAMPLE);
+    // 文件名没有结尾的 '\0'
+    b.put<uint32_t>(1).put<uint32_t>(1).put<uint64_t>(text.start).put<uint64_t>(4096).put<uint64_t>(0);
+    b.put<uint32_t>(0).put<uint32_t>(0).put<uint64_t>(0).put<uint64_t>(0).put<uint32_t>(0).put<uint32_t>(0);
+    b.put<uint64_t>(0x2f2f2f2f2f2f2f2full).end(PERF_RECORD_MMAP2);
+    add_sample(b, 2, 2, 2, {static_cast<uint64_t>(PERF_CONTEXT_USER), 0x1234});
+
+    size_t n = 0;
+    auto samples = feed(sampler, b.data(), n);
+    CHECK(n == 1 && samples.size() == 1 && samples[0].tid == 2);
+    CHECK(sampler.modules().empty());
+
+    // 截断在记录中间: 只处理完整的记录
+    std::string truncated = b.data().substr(0, b.data().size() - 8);
+    feed(sampler, truncated, n);
+    CHECK(n == 0);
+}
+
+int main() {
+    TextMapping text = find_text_mapping();
+    CHECK(! text.path.empty());
+    if (text.path.empty()) return 1;
+
+    test_callchain_and_modules(text);
+    test_malformed_records(text);
+
+    if (g_failures) {
+        fprintf(stderr, "test_perf: %d failure(s)\n", g_failures);
+        return 1;
+    }
+    printf("test_perf: OK\n");
+    return 0;
+}
@@ -0,0 +1,126 @@
+// 验证: 不属于任何 ELF 模块的地址经 PerfMapProvider 解析为 perf map 中的名字;
+// 追加的条目增量读取, 未写完的行留到下次; 与新条目重叠的旧条目失效; 文件重建后从头读取, 已返回的名字仍然有效;
+// FrameView 与 resolve_on_pid (fork 出的子进程) 同样生效
+
+#include "../include/sst_perfmap.hpp"
+#include "check.h"
+
+#include <csignal>
+#include <cstdio>
+#include <sys/wait.h>
+
+using stacktrace::ModuleManager;
+using stacktrace::PerfMapProvider;
+using stacktrace::ResolvedFrame;
+using stacktrace::Stacktrace;
+
+static std::string map_path(pid_t pid) {
+    return "/tmp/perf-" + std::to_string(pid) + ".map";
+}
+
+static void append(const std::string& path, const std::string& text) {
+    FILE* f = fopen(path.c_str(), "a");
+    if (! f) {
+        perror(path.c_str());
+        return;
+    }
+    fputs(text.c_str(), f);
+    fclose(f);
+}
+
+static std::string hex(uintptr_t v) {
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%lx", static_cast<unsigned long>(v));
+    return buf;
+}
+
+static std::string function_at(uintptr_t addr) {
+    ResolvedFrame f = Stacktrace::resolve(reinterpret_cast<void*>(addr));
+    return f.has_symbol ? f.function : std::string();
+}
+
+int main() {
+    // 匿名的可执行映射, 模拟 JIT 代码区
+    const size_t kCode = 1 << 16;
+    void* mem = mmap(nullptr, kCode, PROT_READ | PROT_EXEC, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mem == MAP_FAILED) {
+        perror("mmap");
+        return 1;
+    }
+    uintptr_t code = reinterpret_cast<uintptr_t>(mem);
+    std::string path = map_path(getpid());
+    unlink(path.c_str());
+
+    auto provider = std::make_shared<PerfMapProvider>("/tmp", 0);
+    ModuleManager::instance().add_symbol_provider(provider);
+
+    // 文件不存在时不解析
+    CHECK(function_at(code + 0x10).empty());
+
+    append(path, hex(code) + " 100 LUA:foo.lua:10\n" + "0x" + hex(code + 0x100) + " 0x80 pcre2_jit_match\n");
+    ResolvedFrame f = Stacktrace::resolve(reinterpret_cast<void*>(code + 0x110));
+    CHECK(f.has_symbol && f.function == "pcre2_jit_match");
+    CHECK(f.offset == 0x10);
+    CHECK(f.module == path);
+    CHECK(function_at(code + 0x10) == "LUA:foo.lua:10");
+    CHECK(function_at(code + 0x180).empty());
+    size_t read_before = provider->stats(getpid()).bytes_read;
+
+    // 未写完的行不解析, 补全后只读取新增部分
+    append(path, hex(code + 0x200) + " 40 trace_");
+    CHECK(function_at(code + 0x210).empty());
+    append(path, "42\n");
+    CHECK(function_at(code + 0x210) == "trace_42");
+    CHECK(provider->stats(getpid()).entries == 3);
+    CHECK(provider->stats(getpid()).bytes_read - read_before < 64);
+
+    // 复用的代码区域: 与新条目重叠的旧条目整体失效
+    append(path, hex(code + 0x80) + " 100 LUA:bar.lua:3\n");
+    CHECK(function_at(code + 0x110) == "LUA:bar.lua:3");
+    CHECK(function_at(code + 0x10).empty());
+    CHECK(provider->stats(getpid()).entries == 2);
+    CHECK(function_at(code + 0x190).empty());
+
+    // FrameView
+    stacktrace::FrameView v;
+    stacktrace::ModuleResolver::resolve_view(reinterpret_cast<void*>(code + 0x220), v);
+    CHECK(v.has_symbol && std::string(v.function, v.function_len) == "trace_42" && v.offset == 0x20);
+
+    // ELF 模块中的地址不查询 perf map
+    CHECK(function_at(reinterpret_cast<uintptr_t>(&append)).find("append") != std::string::npos);
+
+    // 文件重建后从头读取; 之前取得的名字指针仍然有效 (其他线程可能还在使用)
+    stacktrace::ProvidedSymbol before;
+    CHECK(provider->find(getpid(), code + 0x220, before) && *before.name == "trace_42");
+    unlink(path.c_str());
+    // 多写几行, 重用旧名字原来所在的位置
+    append(path, hex(code) + " 1000 rebuilt\n" + hex(code + 0x1000) + " 10 rebuilt_2\n" + hex(code + 0x1010) + " 10 rebuilt_3\n");
+    CHECK(function_at(code + 0x210) == "rebuilt");
+    CHECK(provider->stats(getpid()).reloads == 1);
+    CHECK(*before.name == "trace_42");
+    unlink(path.c_str());
+
+    // 远程 pid: 子进程继承了同一地址的映射
+    pid_t child = fork();
+    if (child == 0) {
+        pause();
+        _exit(0);
+    }
+    std::string child_path = map_path(child);
+    append(child_path, hex(code + 0x300) + " 20 child_jit_fn\n");
+    auto frames = Stacktrace::resolve_on_pid({reinterpret_cast<void*>(code + 0x304)}, child);
+    CHECK(frames.size() == 1 && frames[0].has_symbol && frames[0].function == "child_jit_fn" && frames[0].module == child_path);
+    kill(child, SIGKILL);
+    waitpid(child, nullptr, 0);
+    unlink(child_path.c_str());
+
+    ModuleManager::instance().clear_symbol_providers();
+    CHECK(function_at(code + 0x210).empty());
+
+    if (g_failures) {
+        fprintf(stderr, "test_perfmap: %d failure(s)\n", g_failures);
+        return 1;
+    }
+    printf("test_perfmap: OK\n");
+    return 0;
+}
@@ -0,0 +1,169 @@
+// 验证: 以 LD_PRELOAD 加载 libsst_lock.so / libsst_heap.so 并设置 SST_LOCK_OUT / SST_HEAP_OUT 的子进程正常退出,
+// 退出时写出的文件包含发生竞争 / 仍然存活的分配的调用栈; 子进程在退出前已经由多个线程同时主动输出过;
+// 失败的 realloc 不会丢掉原块的采样
+// 子进程是以不同参数重新执行的本程序; make check 在 test 目录下运行, 库位于 ../src/build
+
+#include "../src/sst_heap.h"
+#include "check.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include <dlfcn.h>
+#include <pthread.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+static const char* const kLockLib = "../src/build/libsst_lock.so";
+static const char* const kHeapLib = "../src/build/libsst_heap.so";
+
+static pthread_mutex_t g_mu = PTHREAD_MUTEX_INITIALIZER;
+
+__attribute__((noinline)) void lock_waiter() {
+    pthread_mutex_lock(&g_mu);
+    pthread_mutex_unlock(&g_mu);
+    __asm__ volatile("" ::: "memory");
+}
+
+// 子进程中调用预加载库导出的 dump 函数 (本程序不链接分析器库)
+static void dump_via_dlsym(const char* name) {
+    typedef int (*dump_fn)(FILE*, int);
+    if (auto dump = reinterpret_cast<dump_fn>(dlsym(RTLD_DEFAULT, name))) {
+        FILE* null = fopen("/dev/null", "w");
+        dump(null, 0);
+        fclose(null);
+    }
+}
+
+// 多个线程同时调用 dump 函数, 各自解析调用栈
+static void dump_concurrently(const char* name) {
+    const int kThreads = 4;
+    pthread_t tids[kThreads];
+    for (int i = 0; i < kThreads; ++i) {
+        pthread_create(&tids[i], nullptr, [](void* arg) -> void* {
+            for (int k = 0; k < 10; ++k) dump_via_dlsym(static_cast<const char*>(arg));
+            return nullptr;
+        }, const_cast<char*>(name));
+    }
+    for (int i = 0; i < kThreads; ++i) pthread_join(tids[i], nullptr);
+}
+
+// 主线程持锁 20 ms, 另一个线程在 lock_waiter 中阻塞等待
+static int lock_child() {
+    pthread_mutex_lock(&g_mu);
+    pthread_t tid;
+    pthread_create(&tid, nullptr, [](void*) -> void* {
+        lock_waiter();
+        return nullptr;
+    }, nullptr);
+    usleep(20000);
+    pthread_mutex_unlock(&g_mu);
+    pthread_join(tid, nullptr);
+    dump_concurrently("sst_lock_dump");
+    return 0;
+}
+
+static void* volatile g_kept;
+static volatile size_t g_huge = SIZE_MAX / 2;
+
+__attribute__((noinline)) void* heap_allocator() {
+    void* p = malloc(1 << 20);
+    __asm__ volatile("" ::: "memory");
+    return p;
+}
+
+// 采样间隔为 1 字节, 每次分配都被采样
+static int heap_child() {
+    typedef void (*stats_fn)(sst_heap_stats*);
+    auto get_stats = reinterpret_cast<stats_fn>(dlsym(RTLD_DEFAULT, "sst_heap_get_stats"));
+    CHECK(get_stats != nullptr);
+    if (! get_stats) return 1;
+    g_kept = heap_allocator();
+    sst_heap_stats before, after;
+    get_stats(&before);
+    CHECK(before.live_samples > 0);
+    void* p = realloc(g_kept, g_huge);
+    CHECK(p == nullptr);
+    get_stats(&after);
+    CHECK(after.live_samples == before.live_samples);
+    dump_concurrently("sst_heap_dump");
+    return g_failures == 0 ? 0 : 1;
+}
+
+static std::string read_file(const std::string& path) {
+    std::ifstream in(path.c_str());
+    std::stringstream ss;
+    ss << in.rdbuf();
+    return ss.str();
+}
+
+// 以 mode 参数重新执行本程序, 预加载 lib 并把 out_var 设为 prefix; 返回子进程 pid, 退出状态写入 status
+static pid_t run_preloaded(const char* lib, const char* mode, const char* out_var, const std::string& prefix, int& status) {
+    pid_t pid = fork();
+    if (pid == 0) {
+        setenv("LD_PRELOAD", lib, 1);
+        setenv(out_var, prefix.c_str(), 1);
+        execl("/proc/self/exe", "test_preload", mode, static_cast<char*>(nullptr));
+        _exit(127);
+    }
+    status = -1;
+    if (pid > 0) waitpid(pid, &status, 0);
+    return pid;
+}
+
+static void test_lock_out() {
+    if (access(kLockLib, R_OK) != 0) {
+        fprintf(stderr, "test_preload: skip lock case (%s not built)\n", kLockLib);
+        return;
+    }
+    std::string prefix = "/tmp/test_preload_lock." + std::to_string(getpid());
+    int status;
+    pid_t pid = run_preloaded(kLockLib, "lock", "SST_LOCK_OUT", prefix, status);
+    CHECK(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+
+    std::string base = prefix + "." + std::to_string(pid) + ".0";
+    std::string report = read_file(base + ".txt");
+    std::string folded = read_file(base + ".folded");
+    CHECK(report.find("lock contention:") == 0);
+    CHECK(report.find("lock_waiter") != std::string::npos);
+    CHECK(folded.find("[mutex];") != std::string::npos && folded.find("lock_waiter") != std::string::npos);
+    unlink((base + ".txt").c_str());
+    unlink((base + ".folded").c_str());
+}
+
+static void test_heap_out() {
+    if (access(kHeapLib, R_OK) != 0) {
+        fprintf(stderr, "test_preload: skip heap case (%s not built)\n", kHeapLib);
+        return;
+    }
+    setenv("SST_HEAP_SAMPLE_INTERVAL", "1", 1);
+    std::string prefix = "/tmp/test_preload_heap." + std::to_string(getpid());
+    int status;
+    pid_t pid = run_preloaded(kHeapLib, "heap", "SST_HEAP_OUT", prefix, status);
+    unsetenv("SST_HEAP_SAMPLE_INTERVAL");
+    CHECK(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+
+    std::string base = prefix + "." + std::to_string(pid) + ".0";
+    std::string profile = read_file(base + ".heap");
+    std::string folded = read_file(base + ".folded");
+    CHECK(profile.find("heap profile:") == 0);
+    CHECK(folded.find("heap_allocator") != std::string::npos);
+    unlink((base + ".heap").c_str());
+    unlink((base + ".folded").c_str());
+}
+
+int main(int argc, char** argv) {
+    if (argc > 1 && strcmp(argv[1], "lock") == 0) return lock_child();
+    if (argc > 1 && strcmp(argv[1], "heap") == 0) return heap_child();
+
+    test_lock_out();
+    test_heap_out();
+
+    if (g_failures == 0) printf("test_preload: OK\n");
+    return g_failures == 0 ? 0 : 1;
+}
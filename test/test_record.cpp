@@ -0,0 +1,188 @@
+// 验证: 紧凑栈记录的编码/解码往返一致, 逐字节流式喂入也能正确解码,
+// 先对新模块计算指纹再写入其他模块的栈时模块编号仍然连续,
+// 指纹不受 ASLR 影响 (以子进程重新运行自身, 比较同一调用路径上的指纹)
+
+#include "../include/sst_record.hpp"
+#include "check.h"
+
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+
+#include <sys/wait.h>
+
+using stacktrace::RawFrame;
+using stacktrace::Stacktrace;
+using stacktrace::StackRecordReader;
+using stacktrace::StackRecordWriter;
+
+__attribute__((noinline)) static std::vector<RawFrame> capture_raw(int depth) {
+    if (depth > 0) {
+        std::vector<RawFrame> r = capture_raw(depth - 1);
+        __asm__ volatile("" ::: "memory"); // 阻止尾调用优化
+        return r;
+    }
+    return Stacktrace::capture().get_raw_frames();
+}
+
+__attribute__((noinline)) static uint64_t fixed_fingerprint() {
+    StackRecordWriter w;
+    return w.write(capture_raw(3));
+}
+
+static bool same_frames(const std::vector<RawFrame>& a, const std::vector<RawFrame>& b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (a[i].has_symbol != b[i].has_symbol || a[i].module != b[i].module) return false;
+        // 已知模块只保存偏移, 未知模块只保存绝对地址
+        if (a[i].has_symbol ? a[i].offset != b[i].offset : a[i].abs_addr != b[i].abs_addr) return false;
+    }
+    return true;
+}
+
+static void test_round_trip() {
+    std::vector<std::vector<RawFrame>> stacks;
+    for (int d = 0; d < 8; ++d) {
+        stacks.push_back(capture_raw(d));
+    }
+    // 手工构造一条包含未知模块的栈
+    RawFrame unknown;
+    unknown.abs_addr = 0xdeadbeef;
+    std::vector<RawFrame> odd = stacks[0];
+    odd.insert(odd.begin() + 1, unknown);
+    stacks.push_back(odd);
+    stacks.push_back(std::vector<RawFrame>());
+
+    StackRecordWriter w;
+    std::vector<uint64_t> fps;
+    for (const auto& s : stacks) {
+        fps.push_back(w.write(s));
+        CHECK(fps.back() == w.fingerprint(s.data(), s.size()));
+    }
+    std::string encoded(w.data(), w.size());
+
+    // 相同的栈指纹相同, 不同的栈指纹不同
+    CHECK(w.fingerprint(stacks[2].data(), stacks[2].size()) == fps[2]);
+    for (size_t i = 1; i < fps.size(); ++i) {
+        CHECK(fps[i] != fps[i - 1]);
+    }
+
+    // 一次性喂入
+    {
+        StackRecordReader r;
+        r.feed(encoded.data(), encoded.size());
+        std::vector<RawFrame> frames;
+        uint64_t fp = 0;
+        for (size_t i = 0; i < stacks.size(); ++i) {
+            CHECK(r.next(frames, fp) == StackRecordReader::kRecord);
+            CHECK(same_frames(frames, stacks[i]));
+            CHECK(fp == fps[i]);
+        }
+        CHECK(r.next(frames, fp) == StackRecordReader::kNeedMore);
+    }
+
+    // 逐字节喂入
+    {
+        StackRecordReader r;
+        std::vector<RawFrame> frames;
+        uint64_t fp = 0;
+        size_t decoded = 0;
+        for (char c : encoded) {
+            r.feed(&c, 1);
+            StackRecordReader::Status st;
+            while ((st = r.next(frames, fp)) == StackRecordReader::kRecord) {
+                CHECK(decoded < stacks.size());
+                if (decoded < stacks.size()) {
+                    CHECK(same_frames(frames, stacks[decoded]));
+                    CHECK(fp == fps[decoded]);
+                }
+                ++decoded;
+            }
+            CHECK(st == StackRecordReader::kNeedMore);
+        }
+        CHECK(decoded == stacks.size());
+    }
+
+    // 文本格式作为对照
+    size_t text = 0;
+    for (const auto& s : stacks) {
+        for (const auto& f : s) {
+            text += f.module.size() + 20;
+        }
+    }
+    printf("encoded %zu stacks: %zu bytes (raw text ~%zu bytes)\n", stacks.size(), encoded.size(), text);
+
+    // 损坏的流头
+    StackRecordReader bad;
+    bad.feed("XXXXX", 5);
+    std::vector<RawFrame> frames;
+    uint64_t fp = 0;
+    CHECK(bad.next(frames, fp) == StackRecordReader::kCorrupt);
+}
+
+static RawFrame frame_in(const char* module, uintptr_t offset) {
+    RawFrame f;
+    f.has_symbol = true;
+    f.module = module;
+    f.offset = offset;
+    f.abs_addr = 0x400000 + offset;
+    return f;
+}
+
+// fingerprint() 遇到的新模块不会写出, 不能占用编号
+static void test_fingerprint_before_write() {
+    std::vector<std::vector<RawFrame>> stacks = {
+        {frame_in("/opt/app/liba.so", 0x10), frame_in("/opt/app/liba.so", 0x20)},
+        {frame_in("/opt/app/libb.so", 0x30), frame_in("/opt/app/liba.so", 0x40)},
+    };
+    std::vector<RawFrame> only_b = {frame_in("/opt/app/libb.so", 0x50)};
+
+    StackRecordWriter w;
+    uint64_t fp_b = w.fingerprint(only_b.data(), only_b.size());
+    std::vector<uint64_t> fps;
+    for (const auto& s : stacks) fps.push_back(w.write(s));
+    CHECK(w.fingerprint(only_b.data(), only_b.size()) == fp_b);
+
+    StackRecordReader r;
+    r.feed(w.data(), w.size());
+    std::vector<RawFrame> frames;
+    uint64_t fp = 0;
+    for (size_t i = 0; i < stacks.size(); ++i) {
+        CHECK(r.next(frames, fp) == StackRecordReader::kRecord);
+        CHECK(same_frames(frames, stacks[i]));
+        CHECK(fp == fps[i]);
+    }
+    CHECK(r.next(frames, fp) == StackRecordReader::kNeedMore);
+}
+
+// 子进程会得到不同的加载基址 (ASLR), 同一调用路径上的指纹必须相同
+static void test_stable_across_runs(const char* self, uint64_t fp) {
+    char cmd[4096];
+    snprintf(cmd, sizeof(cmd), "%s --print-fingerprint", self);
+    FILE* p = popen(cmd, "r");
+    CHECK(p != nullptr);
+    if (! p) return;
+    uint64_t child = 0;
+    CHECK(fscanf(p, "%" SCNx64, &child) == 1);
+    CHECK(pclose(p) == 0);
+    CHECK(child == fp);
+}
+
+int main(int argc, char** argv) {
+    uint64_t fp = fixed_fingerprint();
+    if (argc > 1 && strcmp(argv[1], "--print-fingerprint") == 0) {
+        printf("%" PRIx64 "\n", fp);
+        return 0;
+    }
+
+    test_round_trip();
+    test_fingerprint_before_write();
+    test_stable_across_runs(argv[0], fp);
+
+    if (g_failures) {
+        fprintf(stderr, "test_record: %d failure(s)\n", g_failures);
+        return 1;
+    }
+    printf("test_record: OK\n");
+    return 0;
+}
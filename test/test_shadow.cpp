@@ -0,0 +1,119 @@
+// 验证: 以 -finstrument-functions -DSST_SHADOW_STACK 编译时, Stacktrace::capture() 复制影子调用栈,
+// 各帧解析到插桩的函数; 函数返回与异常穿过后深度恢复; 各线程独立; 超过容量时保留最内层的帧
+
+#include "../include/sst_shadow.hpp"
+#include "check.h"
+
+#include <cstdio>
+#include <stdexcept>
+#include <thread>
+
+SST_DEFINE_SHADOW_STACK_HOOKS()
+
+using stacktrace::ResolvedFrame;
+using stacktrace::ShadowStackUnwinder;
+using stacktrace::Stacktrace;
+namespace shadow = stacktrace::shadow;
+
+static_assert(std::is_same<Stacktrace, stacktrace::BasicStacktrace<Stacktrace::kMaxFrames, ShadowStackUnwinder>>::value,
+              "SST_SHADOW_STACK selects the shadow stack unwinder");
+
+__attribute__((noinline)) static Stacktrace shadow_inner() {
+    Stacktrace st = Stacktrace::capture();
+    asm volatile("" ::: "memory");
+    return st;
+}
+
+__attribute__((noinline)) static Stacktrace shadow_middle() {
+    Stacktrace st = shadow_inner();
+    asm volatile("" ::: "memory");
+    return st;
+}
+
+__attribute__((noinline)) static Stacktrace shadow_outer() {
+    Stacktrace st = shadow_middle();
+    asm volatile("" ::: "memory");
+    return st;
+}
+
+// ping / pong 交替递归, 回绕之后复制出的帧仍应严格交替
+__attribute__((noinline)) static size_t pong(int n, void** frames, size_t max_frames);
+
+__attribute__((noinline)) static size_t ping(int n, void** frames, size_t max_frames) {
+    size_t r = n == 0 ? ShadowStackUnwinder::unwind(frames, max_frames) : pong(n - 1, frames, max_frames);
+    asm volatile("" ::: "memory");
+    return r;
+}
+
+__attribute__((noinline)) static size_t pong(int n, void** frames, size_t max_frames) {
+    size_t r = n == 0 ? ShadowStackUnwinder::unwind(frames, max_frames) : ping(n - 1, frames, max_frames);
+    asm volatile("" ::: "memory");
+    return r;
+}
+
+__attribute__((noinline)) static void thrower(int n) {
+    if (n == 0) throw std::runtime_error("shadow");
+    thrower(n - 1);
+    asm volatile("" ::: "memory");
+}
+
+static ResolvedFrame frame(const Stacktrace& st, size_t i) {
+    return Stacktrace::resolve(st.addresses()[i]);
+}
+
+static bool named(const ResolvedFrame& f, const char* name) {
+    return f.has_symbol && f.function.find(name) != std::string::npos;
+}
+
+int main() {
+    size_t base = shadow::depth();
+    CHECK(base == 1); // main
+
+    Stacktrace st = shadow_outer();
+    CHECK(shadow::depth() == base);
+    CHECK(st.size() == 5);
+    if (st.size() == 5) {
+        // [shadow_inner 入口, shadow_middle 中的调用点, shadow_outer 中的调用点, main 中的调用点, main 之外的调用点]
+        CHECK(named(frame(st, 0), "shadow_inner") && st.addresses()[0] == reinterpret_cast<void*>(&shadow_inner));
+        CHECK(named(frame(st, 1), "shadow_middle"));
+        CHECK(named(frame(st, 2), "shadow_outer"));
+        CHECK(named(frame(st, 3), "main"));
+        CHECK(st.addresses()[4] != nullptr);
+    }
+
+    // max_frames 截断
+    Stacktrace two = Stacktrace::capture(2);
+    CHECK(two.size() == 2 && named(frame(two, 0), "main"));
+
+    // 异常穿过插桩的函数时出口钩子同样执行
+    try {
+        thrower(10);
+    } catch (const std::exception&) {
+    }
+    CHECK(shadow::depth() == base);
+
+    // 超过容量: 只保留最内层的 kCapacity 层 (再加上最内层函数的入口)
+    void* frames[shadow::kCapacity + 8];
+    size_t n = ping(static_cast<int>(shadow::kCapacity) + 41, frames, sizeof(frames) / sizeof(frames[0]));
+    CHECK(n == shadow::kCapacity + 1);
+    CHECK(shadow::depth() == base);
+    CHECK(frames[0] == reinterpret_cast<void*>(&pong));
+    for (size_t i = 1; i < n; ++i) {
+        ResolvedFrame f = Stacktrace::resolve(frames[i]);
+        CHECK(named(f, i % 2 == 1 ? "ping" : "pong"));
+    }
+
+    // 各线程有独立的影子栈
+    size_t thread_depth = 0;
+    Stacktrace thread_st;
+    std::thread t([&] {
+        thread_depth = shadow::depth();
+        thread_st = shadow_inner();
+    });
+    t.join();
+    CHECK(thread_depth >= 1 && thread_depth < 8);
+    CHECK(thread_st.size() == thread_depth + 2 && named(frame(thread_st, 0), "shadow_inner"));
+
+    if (g_failures == 0) printf("test_shadow: OK\n");
+    return g_failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,194 @@
+// 验证: 超过阈值的 SlowOpGuard 作用域在仍处于慢代码中时被抓栈并上报;
+// 相同调用路径只上报一次, 其余计为重复; 未超时的作用域不触发; 嵌套 guard 离开后恢复外层;
+// 作用域结束之后才到达的信号不算作抓到的栈; 抓栈后、看门狗取走前内层 guard 已离开时, 上报的仍是内层的名字与阈值
+
+#include "../include/sst_slowop.hpp"
+#include "check.h"
+
+#include <cstdio>
+#include <cstring>
+
+using stacktrace::SlowOpGuard;
+using stacktrace::SlowOpOptions;
+using stacktrace::SlowOpReport;
+using stacktrace::SlowOpStats;
+using stacktrace::SlowOpWatchdog;
+
+static std::mutex g_mu;
+static std::vector<SlowOpReport> g_reports;
+
+__attribute__((noinline)) static void spin_in_slow_function(std::chrono::milliseconds d) {
+    auto end = std::chrono::steady_clock::now() + d;
+    // 绝大部分时间停留在本函数内的循环中, 很少落在 now() 里
+    while (std::chrono::steady_clock::now() < end) {
+        for (int i = 0; i < 200000; ++i) {
+            __asm__ volatile("" ::: "memory");
+        }
+    }
+}
+
+__attribute__((noinline)) static void slow_request() {
+    SlowOpGuard guard(std::chrono::milliseconds(10), "slow_request");
+    spin_in_slow_function(std::chrono::milliseconds(40));
+}
+
+__attribute__((noinline)) static void nested_request() {
+    SlowOpGuard outer(std::chrono::seconds(10), "outer");
+    {
+        SlowOpGuard inner(std::chrono::milliseconds(5), "inner");
+        spin_in_slow_function(std::chrono::milliseconds(30));
+    }
+    // 外层阈值很大, 恢复后不应再触发
+    spin_in_slow_function(std::chrono::milliseconds(20));
+}
+
+// 等到信号处理函数抓完栈就离开内层 guard, 看门狗在下一个 tick 取走结果时槽位中已是外层的名字与阈值
+__attribute__((noinline)) static void leave_right_after_capture() {
+    namespace slowop = stacktrace::slowop;
+    SlowOpGuard outer(std::chrono::seconds(10), "outer_latched");
+    {
+        SlowOpGuard inner(std::chrono::milliseconds(2), "inner_latched");
+        slowop::Slot* slot = slowop::current_slot();
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+        while (slot->state.load(std::memory_order_acquire) != slowop::kCaptured &&
+               std::chrono::steady_clock::now() < deadline) {
+            __asm__ volatile("" ::: "memory");
+        }
+    }
+    spin_in_slow_function(std::chrono::milliseconds(20));
+}
+
+static bool has_frame(const SlowOpReport& r, const char* name) {
+    for (const auto& f : r.frames) {
+        if (f.function.find(name) != std::string::npos) return true;
+    }
+    return false;
+}
+
+// 看门狗发出信号后、信号到达前作用域已经结束: 直接调用处理函数模拟这一时序 (看门狗已停止)
+static void test_late_signal() {
+    namespace slowop = stacktrace::slowop;
+    {
+        SlowOpGuard guard(std::chrono::seconds(10), "late");
+    }
+    slowop::Slot* slot = slowop::current_slot();
+    CHECK(slot != nullptr);
+    if (! slot) return;
+    slot->fired_seq = slot->seq.load();
+    slot->state.store(slowop::kRequested);
+    slowop::on_signal(0, nullptr, nullptr);
+    CHECK(slot->state.load() == slowop::kCaptured);
+    // 看门狗只接受 seq 一致且有帧的结果
+    CHECK(! (slot->captured_seq == slot->fired_seq && slot->nframes > slowop::kSkipFrames));
+    slot->state.store(slowop::kIdle);
+}
+
+static void wait_for_reports(size_t n) {
+    for (int i = 0; i < 200; ++i) {
+        {
+            std::lock_guard<std::mutex> lock(g_mu);
+            if (g_reports.size() >= n) return;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+}
+
+int main() {
+    SlowOpOptions options;
+    options.on_report = [](const SlowOpReport& r) {
+        std::lock_guard<std::mutex> lock(g_mu);
+        g_reports.push_back(r);
+    };
+    CHECK(SlowOpWatchdog::start(options));
+    CHECK(! SlowOpWatchdog::start(options));
+
+    // 快路径: 不超时的 guard 不触发, 顺便测量进入/离开的开销
+    const int kIters = 1000000;
+    auto begin = std::chrono::steady_clock::now();
+    for (int i = 0; i < kIters; ++i) {
+        SlowOpGuard guard(std::chrono::milliseconds(100), "fast");
+        __asm__ volatile("" ::: "memory");
+    }
+    double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - begin).count() / kIters;
+    printf("guard arm + disarm: %.1f ns\n", ns);
+    CHECK(SlowOpWatchdog::stats().fired == 0);
+
+    // 循环次数来自 volatile, 防止编译器完全展开出 3 个不同的调用点
+    volatile int repeat = 3;
+    for (int i = 0; i < repeat; ++i) {
+        slow_request();
+    }
+    wait_for_reports(1);
+
+    SlowOpStats st = SlowOpWatchdog::stats();
+    printf("fired %lu captured %lu missed %lu unique %lu duplicates %lu\n",
+           static_cast<unsigned long>(st.fired),
+           static_cast<unsigned long>(st.captured),
+           static_cast<unsigned long>(st.missed),
+           static_cast<unsigned long>(st.unique),
+           static_cast<unsigned long>(st.duplicates));
+    CHECK(st.fired == 3);
+    CHECK(st.captured == 3);
+    CHECK(st.unique == 1);
+    CHECK(st.duplicates == 2);
+
+    {
+        std::lock_guard<std::mutex> lock(g_mu);
+        CHECK(g_reports.size() == 1);
+        if (! g_reports.empty()) {
+            const SlowOpReport& r = g_reports[0];
+            CHECK(strcmp(r.name, "slow_request") == 0);
+            CHECK(r.threshold_us == 10000);
+            CHECK(r.elapsed_us >= 10000);
+            CHECK(! r.frames.empty() && r.frames[0].function.find("spin_in_slow_function") != std::string::npos);
+            CHECK(has_frame(r, "slow_request"));
+            for (const auto& f : r.frames) {
+                fputs(f.to_string().c_str(), stdout);
+            }
+        }
+    }
+
+    // 另一个线程中的慢操作, 调用路径不同, 作为新栈上报
+    std::thread t(nested_request);
+    t.join();
+    wait_for_reports(2);
+
+    st = SlowOpWatchdog::stats();
+    CHECK(st.fired == 4);
+    CHECK(st.unique == 2);
+    {
+        std::lock_guard<std::mutex> lock(g_mu);
+        CHECK(g_reports.size() == 2);
+        if (g_reports.size() == 2) {
+            CHECK(strcmp(g_reports[1].name, "inner") == 0);
+            CHECK(g_reports[1].tid != g_reports[0].tid);
+            CHECK(has_frame(g_reports[1], "nested_request"));
+        }
+    }
+
+    auto summary = SlowOpWatchdog::summary();
+    CHECK(summary.size() == 2);
+    if (! summary.empty()) CHECK(summary[0].occurrences == 3);
+
+    leave_right_after_capture();
+    wait_for_reports(3);
+    {
+        std::lock_guard<std::mutex> lock(g_mu);
+        CHECK(g_reports.size() == 3);
+        if (g_reports.size() == 3) {
+            CHECK(strcmp(g_reports[2].name, "inner_latched") == 0);
+            CHECK(g_reports[2].threshold_us == 2000);
+            CHECK(has_frame(g_reports[2], "leave_right_after_capture"));
+        }
+    }
+
+    SlowOpWatchdog::stop();
+    test_late_signal();
+
+    if (g_failures) {
+        fprintf(stderr, "test_slowop: %d failure(s)\n", g_failures);
+        return 1;
+    }
+    printf("test_slowop: OK\n");
+    return 0;
+}
@@ -0,0 +1,98 @@
+// 验证: 符号内存预算下, 最久未使用的模块被释放, 再次解析时透明重新加载且结果不变;
+// 统计中的 footprint / 驻留模块数 / evictions / reloads 与实际状态一致
+
+#include "../include/sst.hpp"
+#include "check.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+using stacktrace::Stacktrace;
+using stacktrace::SymbolMemoryStats;
+
+__attribute__((noinline)) static int local_function(int x) {
+    return x * 3 + 1;
+}
+
+static void* libc_addr() {
+    return reinterpret_cast<char*>(&qsort) + 1;
+}
+
+static void* self_addr() {
+    return reinterpret_cast<char*>(&local_function) + 1;
+}
+
+static void print_stats(const char* what) {
+    SymbolMemoryStats st = Stacktrace::symbol_memory_stats();
+    printf("%-24s footprint %8zu  resident %zu  evictions %lu  reloads %lu\n",
+           what,
+           st.footprint,
+           st.resident_modules,
+           static_cast<unsigned long>(st.evictions),
+           static_cast<unsigned long>(st.reloads));
+}
+
+int main() {
+    const std::string libc_name = Stacktrace::resolve(libc_addr()).function;
+    const std::string self_name = Stacktrace::resolve(self_addr()).function;
+    CHECK(libc_name == "qsort");
+    CHECK(self_name.find("local_function") != std::string::npos);
+
+    SymbolMemoryStats st = Stacktrace::symbol_memory_stats();
+    print_stats("unlimited");
+    CHECK(st.budget == 0);
+    CHECK(st.resident_modules >= 2);
+    CHECK(st.footprint > 0);
+    CHECK(st.evictions == 0);
+
+    // 1 字节的预算: 立即全部释放
+    Stacktrace::set_symbol_memory_budget(1);
+    st = Stacktrace::symbol_memory_stats();
+    print_stats("budget 1 byte");
+    CHECK(st.resident_modules == 0);
+    CHECK(st.footprint == 0);
+    CHECK(st.evictions >= 2);
+
+    // 交替解析两个模块: 每次只保留正在使用的模块, 结果不变
+    uint64_t evictions = st.evictions;
+    for (int i = 0; i < 3; ++i) {
+        CHECK(Stacktrace::resolve(libc_addr()).function == libc_name);
+        CHECK(Stacktrace::symbol_memory_stats().resident_modules == 1);
+        CHECK(Stacktrace::resolve(self_addr()).function == self_name);
+        CHECK(Stacktrace::symbol_memory_stats().resident_modules == 1);
+    }
+    st = Stacktrace::symbol_memory_stats();
+    print_stats("alternating x3");
+    CHECK(st.reloads == 6);
+    CHECK(st.evictions == evictions + 5);
+
+    // 帧视图在回调期间有效
+    Stacktrace trace = Stacktrace::capture();
+    size_t frames = 0;
+    trace.for_each_frame([&](const stacktrace::FrameView& v) {
+        CHECK(v.function_len == strlen(v.function));
+        ++frames;
+    });
+    CHECK(frames == trace.size());
+
+    // 取消预算后可以同时驻留
+    Stacktrace::set_symbol_memory_budget(0);
+    Stacktrace::resolve(libc_addr());
+    Stacktrace::resolve(self_addr());
+    CHECK(Stacktrace::symbol_memory_stats().resident_modules >= 2);
+
+    // 模块缓存被清空时, 计入的内存全部归还
+    Stacktrace::clear_modules_cache();
+    st = Stacktrace::symbol_memory_stats();
+    print_stats("after clear");
+    CHECK(st.resident_modules == 0);
+    CHECK(st.footprint == 0);
+
+    if (g_failures) {
+        fprintf(stderr, "test_symbol_budget: %d failure(s)\n", g_failures);
+        return 1;
+    }
+    printf("test_symbol_budget: OK\n");
+    return 0;
+}
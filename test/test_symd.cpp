@@ -0,0 +1,136 @@
+// 验证: sst_symd_* 客户端与 sst-symbolized 守护进程往返后, 函数名与符号内偏移和进程内 sst_resolve() 一致;
+// 超过 4GB 的符号内偏移不被截断; 未知模块的帧原样返回;
+// 模块路径指向非 ELF 文件或不存在的文件时返回未符号化的帧, 守护进程继续服务
+// 守护进程位于 ../src/build (make check 在 test 目录下运行)
+
+#include "../src/sst.h"
+#include "check.h"
+
+#include <csignal>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+static const char* const kDaemon = "../src/build/sst-symbolized";
+
+__attribute__((noinline)) void symd_target_a() {
+    __asm__ volatile("" ::: "memory");
+}
+
+__attribute__((noinline)) void symd_target_b() {
+    __asm__ volatile("" ::: "memory");
+}
+
+static pid_t start_daemon(const std::string& sock) {
+    pid_t pid = fork();
+    if (pid == 0) {
+        execl(kDaemon, kDaemon, "-s", sock.c_str(), static_cast<char*>(nullptr));
+        perror(kDaemon);
+        _exit(127);
+    }
+    // 等待 socket 可连接
+    for (int i = 0; i < 500; ++i) {
+        sst_symd* c = sst_symd_connect(sock.c_str());
+        if (c) {
+            sst_symd_close(c);
+            return pid;
+        }
+        usleep(10000);
+    }
+    kill(pid, SIGTERM);
+    waitpid(pid, nullptr, 0);
+    return -1;
+}
+
+static void test_round_trip(sst_symd* c) {
+    void* addrs[] = {
+        reinterpret_cast<char*>(&symd_target_a) + 1,
+        reinterpret_cast<char*>(&symd_target_b) + 2,
+        reinterpret_cast<char*>(&strlen) + 3,
+        reinterpret_cast<char*>(&sst_symd_resolve) + 4,
+    };
+    const size_t n = sizeof(addrs) / sizeof(addrs[0]);
+    sst_raw_frame raws[n];
+    sst_resolve_raw_batch(addrs, n, raws);
+
+    sst_frame outs[n];
+    CHECK(sst_symd_resolve(c, raws, n, outs) == 0);
+    for (size_t i = 0; i < n; ++i) {
+        sst_frame local;
+        sst_resolve(addrs[i], &local);
+        CHECK(outs[i].has_symbol && local.has_symbol);
+        CHECK(strcmp(outs[i].function, local.function) == 0);
+        CHECK(outs[i].offset == local.offset);
+        CHECK(outs[i].abs_addr == reinterpret_cast<uintptr_t>(addrs[i]));
+    }
+    CHECK(strstr(outs[0].function, "symd_target_a") != nullptr);
+
+    // 模块内偏移远超最后一个符号: 仍落在该符号上, 符号内偏移大于 32 位
+    sst_raw_frame far[2] = {raws[0], raws[0]};
+    far[0].offset += uintptr_t(1) << 36;
+    far[1].module = nullptr;
+    far[1].offset = 0x1234;
+    sst_frame far_outs[2];
+    CHECK(sst_symd_resolve(c, far, 2, far_outs) == 0);
+    CHECK(far_outs[0].has_symbol && far_outs[0].offset > UINT32_MAX);
+    CHECK(! far_outs[1].has_symbol && far_outs[1].offset == 0x1234);
+
+    sst_free_raw_frames(raws, n);
+}
+
+static void test_invalid_module(sst_symd* c, pid_t daemon) {
+    sst_raw_frame bad[2];
+    memset(bad, 0, sizeof(bad));
+    bad[0].module = const_cast<char*>("/etc/passwd");
+    bad[0].offset = 0x10;
+    bad[1].module = const_cast<char*>("/nonexistent/libmissing.so");
+    bad[1].offset = 0x20;
+    sst_frame outs[2];
+    CHECK(sst_symd_resolve(c, bad, 2, outs) == 0);
+    CHECK(! outs[0].has_symbol && outs[0].offset == 0x10 && strcmp(outs[0].module, "/etc/passwd") == 0);
+    CHECK(! outs[1].has_symbol && outs[1].offset == 0x20);
+
+    // 守护进程仍在运行, 同一连接上的后续请求照常解析
+    CHECK(waitpid(daemon, nullptr, WNOHANG) == 0);
+    void* addr = reinterpret_cast<char*>(&symd_target_a) + 1;
+    sst_raw_frame raw;
+    sst_resolve_raw_batch(&addr, 1, &raw);
+    sst_frame out;
+    CHECK(sst_symd_resolve(c, &raw, 1, &out) == 0);
+    CHECK(out.has_symbol && strstr(out.function, "symd_target_a") != nullptr);
+    sst_free_raw_frames(&raw, 1);
+}
+
+int main() {
+    if (access(kDaemon, X_OK) != 0) {
+        printf("test_symd: skipped (%s not built)\n", kDaemon);
+        return 0;
+    }
+    std::string sock = "/tmp/test_symd." + std::to_string(getpid()) + ".sock";
+    pid_t daemon = start_daemon(sock);
+    CHECK(daemon > 0);
+    if (daemon > 0) {
+        sst_symd* c = sst_symd_connect(sock.c_str());
+        CHECK(c != nullptr);
+        if (c) {
+            test_round_trip(c);
+            test_invalid_module(c, daemon);
+        }
+        sst_symd_close(c);
+        kill(daemon, SIGTERM);
+        waitpid(daemon, nullptr, 0);
+    }
+    unlink(sock.c_str());
+
+    if (g_failures) {
+        fprintf(stderr, "test_symd: %d failure(s)\n", g_failures);
+        return 1;
+    }
+    printf("test_symd: OK\n");
+    return 0;
+}
@@ -0,0 +1,131 @@
+// 验证: 符号表过滤内核的标量与 AVX2 实现对任意长度 (含不足 8 个的尾部) 结果一致;
+// load_symbols() 对合成的 ELF 只保留非零地址的 STT_FUNC, 按地址排序且名字正确
+
+#include "../include/sst.hpp"
+#include "check.h"
+
+#include <cstdio>
+#include <cstdlib>
+
+using stacktrace::Symbol;
+
+static uint64_t g_rng = 88172645463325252ull;
+
+static uint64_t next_random() {
+    g_rng ^= g_rng << 13;
+    g_rng ^= g_rng >> 7;
+    g_rng ^= g_rng << 17;
+    return g_rng;
+}
+
+static std::vector<Elf64_Sym> random_symbols(size_t n) {
+    static const unsigned char kTypes[] = {STT_FUNC, STT_OBJECT, STT_NOTYPE, STT_GNU_IFUNC, STT_FUNC};
+    std::vector<Elf64_Sym> syms(n);
+    for (auto& s : syms) {
+        uint64_t r = next_random();
+        s.st_name = static_cast<Elf64_Word>(r & 0xffff);
+        s.st_info = static_cast<unsigned char>(ELF64_ST_INFO(r >> 16 & 1 ? STB_GLOBAL : STB_LOCAL, kTypes[(r >> 20) % 5]));
+        s.st_other = 0;
+        s.st_shndx = 1;
+        s.st_value = (r >> 24) % 4 == 0 ? 0 : (r >> 32);
+        s.st_size = r & 0xff;
+    }
+    return syms;
+}
+
+// 只含 .symtab 与 .strtab 两个节的 ET_DYN
+static bool write_elf(const char* path, const std::vector<Elf64_Sym>& syms, const std::string& strtab) {
+    Elf64_Ehdr ehdr;
+    memset(&ehdr, 0, sizeof(ehdr));
+    memcpy(ehdr.e_ident, ELFMAG, SELFMAG);
+    ehdr.e_ident[EI_CLASS] = ELFCLASS64;
+    ehdr.e_ident[EI_DATA] = ELFDATA2LSB;
+    ehdr.e_ident[EI_VERSION] = EV_CURRENT;
+    ehdr.e_type = ET_DYN;
+    ehdr.e_machine = EM_X86_64;
+    ehdr.e_version = EV_CURRENT;
+    ehdr.e_ehsize = sizeof(Elf64_Ehdr);
+    ehdr.e_shentsize = sizeof(Elf64_Shdr);
+    ehdr.e_shnum = 3;
+
+    Elf64_Shdr shdrs[3];
+    memset(shdrs, 0, sizeof(shdrs));
+    shdrs[1].sh_type = SHT_SYMTAB;
+    shdrs[1].sh_offset = sizeof(Elf64_Ehdr);
+    shdrs[1].sh_size = syms.size() * sizeof(Elf64_Sym);
+    shdrs[1].sh_link = 2;
+    shdrs[1].sh_entsize = sizeof(Elf64_Sym);
+    shdrs[2].sh_type = SHT_STRTAB;
+    shdrs[2].sh_offset = shdrs[1].sh_offset + shdrs[1].sh_size;
+    shdrs[2].sh_size = strtab.size();
+    ehdr.e_shoff = shdrs[2].sh_offset + shdrs[2].sh_size;
+
+    FILE* f = fopen(path, "wb");
+    if (! f) return false;
+    fwrite(&ehdr, sizeof(ehdr), 1, f);
+    fwrite(syms.data(), sizeof(Elf64_Sym), syms.size(), f);
+    fwrite(strtab.data(), 1, strtab.size(), f);
+    fwrite(shdrs, sizeof(shdrs), 1, f);
+    return fclose(f) == 0;
+}
+
+static std::vector<uint32_t> run(size_t (*kernel)(const Elf64_Sym*, size_t, uint32_t*), const std::vector<Elf64_Sym>& syms) {
+    std::vector<uint32_t> out(syms.size() + 8);
+    out.resize(kernel(syms.data(), syms.size(), out.data()));
+    return out;
+}
+
+static size_t scalar(const Elf64_Sym* syms, size_t n, uint32_t* out) {
+    return stacktrace::symtab_filter_scalar(syms, n, out);
+}
+
+int main() {
+    bool has_avx2 = __builtin_cpu_supports("avx2");
+    for (size_t n : {0, 1, 7, 8, 9, 15, 16, 17, 31, 64, 1003, 100000}) {
+        auto syms = random_symbols(n);
+        auto expected = run(scalar, syms);
+        std::vector<uint32_t> naive;
+        for (size_t i = 0; i < n; ++i) {
+            if (ELF64_ST_TYPE(syms[i].st_info) == STT_FUNC && syms[i].st_value > 0) naive.push_back(static_cast<uint32_t>(i));
+        }
+        CHECK(expected == naive);
+        CHECK(run(stacktrace::symtab_filter, syms) == expected);
+#if defined(__x86_64__)
+        if (has_avx2) CHECK(run(stacktrace::symtab_filter_avx2, syms) == expected);
+#endif
+    }
+    if (! has_avx2) printf("test_symtab: AVX2 not available, only the scalar kernel was checked\n");
+
+    // load_symbols: 名字为 "fn_<下标>", base 会加到 ET_DYN 的地址上
+    auto syms = random_symbols(5000);
+    std::string strtab(1, '\0');
+    for (size_t i = 0; i < syms.size(); ++i) {
+        syms[i].st_name = static_cast<Elf64_Word>(strtab.size());
+        strtab += "fn_" + std::to_string(i);
+        strtab += '\0';
+    }
+    char path[] = "/tmp/sst_symtab_XXXXXX";
+    int fd = mkstemp(path);
+    CHECK(fd >= 0);
+    close(fd);
+    CHECK(write_elf(path, syms, strtab));
+    const uintptr_t base = 0x10000000;
+    std::vector<Symbol> loaded = stacktrace::load_symbols(path, base);
+    unlink(path);
+
+    auto hits = run(scalar, syms);
+    CHECK(loaded.size() == hits.size());
+    for (size_t i = 0; i < loaded.size(); ++i) {
+        if (i > 0) CHECK(loaded[i - 1].addr <= loaded[i].addr);
+        size_t idx = static_cast<size_t>(strtoul(loaded[i].name.c_str() + 3, nullptr, 10));
+        CHECK(idx < syms.size() && ELF64_ST_TYPE(syms[idx].st_info) == STT_FUNC);
+        CHECK(idx < syms.size() && loaded[i].addr == syms[idx].st_value + base && loaded[i].size == syms[idx].st_size);
+    }
+
+    if (g_failures) {
+        fprintf(stderr, "test_symtab: %d failure(s)\n", g_failures);
+        return 1;
+    }
+    printf("test_symtab: OK\n");
+    return 0;
+}
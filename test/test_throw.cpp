@@ -0,0 +1,139 @@
+// 验证: 抛出点按 (类型, 栈) 计数, frames[0] 为 throw 所在函数; 超过每秒上限的抛出只按类型计数;
+// 周期上报只包含本周期新增的次数; 未启动时不计数
+
+#include "../include/sst_throw.hpp"
+#include "check.h"
+
+#include <cstdio>
+#include <stdexcept>
+
+SST_DEFINE_THROW_HOOK_INTERPOSE()
+
+using stacktrace::ThrowSite;
+using stacktrace::ThrowStats;
+using stacktrace::ThrowTracer;
+using stacktrace::ThrowTracerOptions;
+
+static std::mutex g_mu;
+static std::vector<std::vector<ThrowSite>> g_reports;
+
+__attribute__((noinline)) static void throw_runtime_error() {
+    throw std::runtime_error("boom");
+}
+
+__attribute__((noinline)) static void throw_int() {
+    throw 42;
+}
+
+// 循环次数来自 volatile, 防止编译器展开出多个不同的调用点
+__attribute__((noinline)) static void throw_runtime_errors(volatile int n) {
+    for (int i = 0; i < n; ++i) {
+        try {
+            throw_runtime_error();
+        } catch (const std::runtime_error&) {
+        }
+    }
+}
+
+__attribute__((noinline)) static void throw_ints(volatile int n) {
+    for (int i = 0; i < n; ++i) {
+        try {
+            throw_int();
+        } catch (int) {
+        }
+    }
+}
+
+static const ThrowSite* find_site(const std::vector<ThrowSite>& sites, const char* type, bool has_stack) {
+    for (const auto& s : sites) {
+        if (s.type == type && s.has_stack == has_stack) return &s;
+    }
+    return nullptr;
+}
+
+int main() {
+    // 未启动时不计数
+    throw_ints(3);
+    CHECK(ThrowTracer::stats().throws == 0);
+
+    ThrowTracerOptions options;
+    options.max_captures_per_sec = 1000000;
+    options.report_interval_ms = 50;
+    options.on_report = [](const std::vector<ThrowSite>& sites) {
+        std::lock_guard<std::mutex> lock(g_mu);
+        g_reports.push_back(sites);
+    };
+    CHECK(ThrowTracer::start(options));
+    CHECK(! ThrowTracer::start(options));
+
+    throw_runtime_errors(30);
+    throw_ints(10);
+
+    ThrowStats st = ThrowTracer::stats();
+    CHECK(st.throws == 40);
+    CHECK(st.captured == 40);
+    CHECK(st.rate_limited == 0);
+    CHECK(st.unique == 2);
+
+    auto sites = ThrowTracer::top(10);
+    CHECK(sites.size() == 2);
+    if (sites.size() == 2) {
+        CHECK(sites[0].type == "std::runtime_error");
+        CHECK(sites[0].count == 30);
+        CHECK(! sites[0].frames.empty() && sites[0].frames[0].function.find("throw_runtime_error") != std::string::npos);
+        CHECK(sites[1].type == "int");
+        CHECK(sites[1].count == 10);
+        for (const auto& f : sites[0].frames) {
+            fputs(f.to_string().c_str(), stdout);
+        }
+    }
+
+    // 等待一次周期上报, 再抛出一批, 下一次上报只包含新增的次数
+    for (int i = 0; i < 200; ++i) {
+        {
+            std::lock_guard<std::mutex> lock(g_mu);
+            if (! g_reports.empty()) break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    throw_ints(5);
+    for (int i = 0; i < 200; ++i) {
+        {
+            std::lock_guard<std::mutex> lock(g_mu);
+            if (g_reports.size() >= 2) break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    {
+        std::lock_guard<std::mutex> lock(g_mu);
+        CHECK(g_reports.size() >= 2);
+        if (g_reports.size() >= 2) {
+            const ThrowSite* first = find_site(g_reports[0], "std::runtime_error", true);
+            CHECK(first && first->count == 30);
+            CHECK(g_reports[1].size() == 1);
+            CHECK(g_reports[1][0].type == "int");
+            CHECK(g_reports[1][0].count == 5);
+        }
+    }
+    ThrowTracer::stop();
+
+    // 限速: 上限为 0 时全部只按类型计数
+    options.max_captures_per_sec = 0;
+    options.report_interval_ms = 0;
+    CHECK(ThrowTracer::start(options));
+    throw_runtime_errors(7);
+    ThrowTracer::stop();
+    st = ThrowTracer::stats();
+    CHECK(st.rate_limited == 7);
+    const ThrowSite* limited = nullptr;
+    sites = ThrowTracer::top(10);
+    limited = find_site(sites, "std::runtime_error", false);
+    CHECK(limited && limited->count == 7 && limited->frames.empty());
+
+    if (g_failures) {
+        fprintf(stderr, "test_throw: %d failure(s)\n", g_failures);
+        return 1;
+    }
+    printf("test_throw: OK\n");
+    return 0;
+}
@@ -0,0 +1,137 @@
+// 验证: 登记的线程无论在运行还是阻塞都会被采样; 自旋线程的栈计入 on-CPU, 睡眠线程的栈计入 off-CPU;
+// 未登记的线程不被采样; folded 输出按 on-cpu / off-cpu 分开; stat 的状态字段解析能处理带括号的线程名;
+// 哈希冲突的不同栈不会合并
+
+#include "../include/sst_wallclock.hpp"
+#include "check.h"
+
+#include <cstdio>
+#include <cstring>
+
+using stacktrace::WallClockOptions;
+using stacktrace::WallClockProfiler;
+using stacktrace::WallClockStack;
+using stacktrace::WallClockStats;
+
+static std::atomic<bool> g_stop{false};
+
+__attribute__((noinline)) static void spin_worker() {
+    WallClockProfiler::register_thread();
+    while (! g_stop.load(std::memory_order_relaxed)) {
+        for (int i = 0; i < 100000; ++i) {
+            __asm__ volatile("" ::: "memory");
+        }
+    }
+}
+
+__attribute__((noinline)) static void sleep_worker() {
+    WallClockProfiler::register_thread();
+    while (! g_stop.load(std::memory_order_relaxed)) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+}
+
+// 没有登记, 不应出现在任何样本中
+__attribute__((noinline)) static void unregistered_worker() {
+    while (! g_stop.load(std::memory_order_relaxed)) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+}
+
+static bool has_frame(const WallClockStack& s, const char* name) {
+    for (const auto& f : s.frames) {
+        if (f.function.find(name) != std::string::npos) return true;
+    }
+    return false;
+}
+
+// 哈希相同而帧不同的两条栈分别聚合, 不会互相计入
+static void test_hash_collision() {
+    namespace wallclock = stacktrace::wallclock;
+    void* a[2] = {reinterpret_cast<void*>(0x1000), reinterpret_cast<void*>(0x2000)};
+    void* b[2] = {reinterpret_cast<void*>(0x3000), nullptr};
+    // 第二帧抵消第一帧造成的差异
+    uint64_t diff = wallclock::hash_frames(a, 1) ^ wallclock::hash_frames(b, 1);
+    b[1] = reinterpret_cast<void*>(static_cast<uintptr_t>(diff ^ 0x2000));
+    CHECK(wallclock::hash_frames(a, 2) == wallclock::hash_frames(b, 2));
+
+    wallclock::StackTable t;
+    CHECK(t.add(std::vector<void*>(a, a + 2), stacktrace::kWallRunning, 2));
+    CHECK(t.add(std::vector<void*>(b, b + 2), stacktrace::kWallSleeping, 2));
+    CHECK(t.add(std::vector<void*>(a, a + 2), stacktrace::kWallRunning, 2));
+    CHECK(! t.add(std::vector<void*>(1, a[0]), stacktrace::kWallRunning, 2));
+    CHECK(t.size() == 2);
+    for (const auto& s : t.snapshot()) {
+        if (s.frames[0] == a[0]) {
+            CHECK(s.state_samples[stacktrace::kWallRunning] == 2 && s.samples() == 2);
+        } else {
+            CHECK(s.frames[1] == b[1] && s.state_samples[stacktrace::kWallSleeping] == 1 && s.samples() == 1);
+        }
+    }
+}
+
+int main() {
+    test_hash_collision();
+
+    const char stat1[] = "1234 (my (weird) name) S 1 1234 1234 0 -1";
+    const char stat2[] = "42 (worker) R 1 42";
+    const char stat3[] = "42 (io) D 1 42";
+    CHECK(stacktrace::wallclock::parse_stat_state(stat1, sizeof(stat1) - 1) == stacktrace::kWallSleeping);
+    CHECK(stacktrace::wallclock::parse_stat_state(stat2, sizeof(stat2) - 1) == stacktrace::kWallRunning);
+    CHECK(stacktrace::wallclock::parse_stat_state(stat3, sizeof(stat3) - 1) == stacktrace::kWallDiskWait);
+    CHECK(stacktrace::wallclock::parse_stat_state("garbage", 7) == -1);
+
+    WallClockOptions options;
+    options.interval_us = 2000;
+    CHECK(WallClockProfiler::start(options));
+    CHECK(! WallClockProfiler::start(options));
+
+    std::thread spinner(spin_worker);
+    std::thread sleeper(sleep_worker);
+    std::thread bystander(unregistered_worker);
+    std::this_thread::sleep_for(std::chrono::milliseconds(400));
+    g_stop.store(true);
+    spinner.join();
+    sleeper.join();
+    bystander.join();
+    WallClockProfiler::stop();
+
+    WallClockStats st = WallClockProfiler::stats();
+    CHECK(st.ticks > 50);
+    CHECK(st.samples > 50);
+    CHECK(st.on_cpu > 0 && st.off_cpu > 0);
+    CHECK(st.threads == 0); // 线程退出时自动注销
+
+    uint64_t spin_on = 0, spin_off = 0, sleep_on = 0, sleep_off = 0;
+    for (const auto& s : WallClockProfiler::summary()) {
+        CHECK(s.on_cpu_ns + s.off_cpu_ns == s.samples * 2000000);
+        CHECK(! has_frame(s, "unregistered_worker"));
+        if (has_frame(s, "spin_worker")) {
+            spin_on += s.on_cpu_ns;
+            spin_off += s.off_cpu_ns;
+        }
+        if (has_frame(s, "sleep_worker")) {
+            sleep_on += s.on_cpu_ns;
+            sleep_off += s.off_cpu_ns;
+        }
+    }
+    // 两个线程都在整个窗口内被持续采样, 时间大部分落在各自预期的一侧
+    CHECK(spin_on > 3 * spin_off);
+    CHECK(sleep_off > 3 * sleep_on);
+    CHECK(spin_on + spin_off > 200000000ull);
+    CHECK(sleep_on + sleep_off > 200000000ull);
+
+    std::ostringstream folded;
+    WallClockProfiler::write_folded(folded);
+    std::string text = folded.str();
+    CHECK(text.find("on-cpu;") != std::string::npos && text.find("spin_worker") != std::string::npos);
+    CHECK(text.find("off-cpu;") != std::string::npos && text.find("sleep_worker") != std::string::npos);
+    CHECK(WallClockProfiler::tree(true).stats().samples + WallClockProfiler::tree(false).stats().samples == st.samples - st.dropped);
+
+    WallClockProfiler::reset();
+    CHECK(WallClockProfiler::summary().empty());
+
+    if (g_failures == 0) printf("test_wallclock: OK (%llu samples, %llu on-cpu, %llu off-cpu)\n", static_cast<unsigned long long>(st.samples),
+                                static_cast<unsigned long long>(st.on_cpu), static_cast<unsigned long long>(st.off_cpu));
+    return g_failures == 0 ? 0 : 1;
+}